@@ -13,11 +13,16 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/clock.h"
+#include "mediapipe/framework/deps/monotonic_clock.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/header_util.h"
 
@@ -27,6 +32,9 @@ constexpr char kFinishedTag[] = "FINISHED";
 constexpr char kAllowTag[] = "ALLOW";
 constexpr char kMaxInFlightTag[] = "MAX_IN_FLIGHT";
 constexpr char kOptionsTag[] = "OPTIONS";
+constexpr char kClockTag[] = "CLOCK";
+constexpr char kInFlightLimitTag[] = "IN_FLIGHT_LIMIT";
+constexpr char kDropCountTag[] = "DROP_COUNT";
 
 // FlowLimiterCalculator is used to limit the number of frames in flight
 // by dropping input frames when necessary.
@@ -64,6 +72,36 @@ constexpr char kOptionsTag[] = "OPTIONS";
 // including the current timestamp, and "ALLOW = false" indicates the start of
 // dropping frames including the current timestamp.
 //
+// With `adaptive_limit`, FlowLimiterCalculator adjusts `max_in_flight` itself
+// to keep the round trip time of frames, from their release to their
+// "FINISHED" signal, under `adaptive_limit.target_latency_us`.  The limit
+// grows additively while frames finish within the target and shrinks
+// multiplicatively when they don't, so it settles near the highest throughput
+// the target allows on the current machine:
+// node {
+//   calculator: "FlowLimiterCalculator"
+//   input_stream: "raw_frames"
+//   input_stream: "FINISHED:finished"
+//   input_stream_info: {
+//     tag_index: 'FINISHED'
+//     back_edge: true
+//   }
+//   output_stream: "sampled_frames"
+//   output_stream: "IN_FLIGHT_LIMIT:in_flight_limit"
+//   output_stream: "DROP_COUNT:drop_count"
+//   options: {
+//     [mediapipe.FlowLimiterCalculatorOptions.ext] {
+//       max_in_queue: 1
+//       adaptive_limit { target_latency_us: 50000 }
+//     }
+//   }
+// }
+//
+// The optional "IN_FLIGHT_LIMIT" and "DROP_COUNT" streams report the current
+// limit and the number of frames dropped so far, at each released or dropped
+// frame, for monitoring.  The optional "CLOCK" side packet replaces the clock
+// used to measure round trip times.
+//
 // FlowLimiterCalculator provides limited support for multiple input streams.
 // The first input stream is treated as the main input stream and successive
 // input streams are treated as auxiliary input streams.  The auxiliary input
@@ -86,6 +124,12 @@ class FlowLimiterCalculator : public CalculatorBase {
     cc->Inputs().Get("FINISHED", 0).SetAny();
     cc->InputSidePackets().Tag(kMaxInFlightTag).Set<int>().Optional();
     cc->Outputs().Tag(kAllowTag).Set<bool>().Optional();
+    cc->Outputs().Tag(kInFlightLimitTag).Set<int>().Optional();
+    cc->Outputs().Tag(kDropCountTag).Set<int64_t>().Optional();
+    cc->InputSidePackets()
+        .Tag(kClockTag)
+        .Set<std::shared_ptr<::mediapipe::Clock>>()
+        .Optional();
     cc->SetInputStreamHandler("ImmediateInputStreamHandler");
     cc->SetProcessTimestampBounds(true);
     return absl::OkStatus();
@@ -98,6 +142,27 @@ class FlowLimiterCalculator : public CalculatorBase {
       options_.set_max_in_flight(
           cc->InputSidePackets().Tag(kMaxInFlightTag).Get<int>());
     }
+    if (cc->InputSidePackets().HasTag(kClockTag)) {
+      clock_ = cc->InputSidePackets()
+                   .Tag(kClockTag)
+                   .Get<std::shared_ptr<::mediapipe::Clock>>();
+    } else {
+      clock_ = std::shared_ptr<::mediapipe::Clock>(
+          ::mediapipe::MonotonicClock::CreateSynchronizedMonotonicClock());
+    }
+    in_flight_limit_ = options_.max_in_flight();
+    if (options_.has_adaptive_limit()) {
+      const auto& adaptive = options_.adaptive_limit();
+      RET_CHECK_GT(adaptive.target_latency_us(), 0);
+      RET_CHECK(adaptive.decrease_factor() > 0 &&
+                adaptive.decrease_factor() < 1)
+          << "decrease_factor must be in (0, 1).";
+      RET_CHECK_LE(adaptive.min_in_flight(), adaptive.max_in_flight());
+      const double min_limit = std::max(adaptive.min_in_flight(), 1);
+      const double max_limit =
+          std::max<double>(adaptive.max_in_flight(), min_limit);
+      in_flight_limit_ = std::clamp(in_flight_limit_, min_limit, max_limit);
+    }
     input_queues_.resize(cc->Inputs().NumEntries(""));
     allowed_[Timestamp::Unset()] = true;
     RET_CHECK_OK(CopyInputHeadersToOutputs(cc->Inputs(), &(cc->Outputs())));
@@ -112,8 +177,9 @@ class FlowLimiterCalculator : public CalculatorBase {
     Packet finished_packet = cc->Inputs().Tag(kFinishedTag).Value();
     if (finished_packet.Timestamp() == cc->InputTimestamp()) {
       while (!frames_in_flight_.empty() &&
-             frames_in_flight_.front() <= finished_packet.Timestamp()) {
-        frames_in_flight_.pop_front();
+             frames_in_flight_.front().timestamp <=
+                 finished_packet.Timestamp()) {
+        FrameFinished(/*timed_out=*/false);
       }
     }
 
@@ -132,8 +198,8 @@ class FlowLimiterCalculator : public CalculatorBase {
     if (timeout > 0 && latest_ts == cc->InputTimestamp() &&
         latest_ts < Timestamp::Max()) {
       while (!frames_in_flight_.empty() &&
-             (latest_ts - frames_in_flight_.front()) > timeout) {
-        frames_in_flight_.pop_front();
+             (latest_ts - frames_in_flight_.front().timestamp) > timeout) {
+        FrameFinished(/*timed_out=*/true);
       }
     }
 
@@ -144,7 +210,7 @@ class FlowLimiterCalculator : public CalculatorBase {
       input_queue.pop_front();
       cc->Outputs().Get("", 0).AddPacket(packet);
       SendAllow(true, packet.Timestamp(), cc);
-      frames_in_flight_.push_back(packet.Timestamp());
+      frames_in_flight_.push_back({packet.Timestamp(), clock_->TimeNow()});
     }
 
     // Limit the number of queued frames.
@@ -153,6 +219,7 @@ class FlowLimiterCalculator : public CalculatorBase {
     while (input_queue.size() > options_.max_in_queue()) {
       Packet packet = input_queue.front();
       input_queue.pop_front();
+      ++drop_count_;
       SendAllow(false, packet.Timestamp(), cc);
     }
 
@@ -164,8 +231,10 @@ class FlowLimiterCalculator : public CalculatorBase {
       Timestamp bound =
           cc->Inputs().Get("", 0).Value().Timestamp().NextAllowedInStream();
       SetNextTimestampBound(bound, &cc->Outputs().Get("", 0));
-      if (cc->Outputs().HasTag(kAllowTag)) {
-        SetNextTimestampBound(bound, &cc->Outputs().Tag(kAllowTag));
+      for (const char* tag : {kAllowTag, kInFlightLimitTag, kDropCountTag}) {
+        if (cc->Outputs().HasTag(tag)) {
+          SetNextTimestampBound(bound, &cc->Outputs().Tag(tag));
+        }
       }
     }
 
@@ -190,7 +259,43 @@ class FlowLimiterCalculator : public CalculatorBase {
   // Returns true if an additional frame can be released for processing.
   // The "ALLOW" output stream indicates this condition at each input frame.
   bool ProcessingAllowed() {
-    return frames_in_flight_.size() < options_.max_in_flight();
+    return frames_in_flight_.size() < InFlightLimit();
+  }
+
+  // Returns the current limit of frames in flight.
+  int InFlightLimit() {
+    return options_.has_adaptive_limit() ? static_cast<int>(in_flight_limit_)
+                                         : options_.max_in_flight();
+  }
+
+  // Removes the oldest frame in flight, and adapts the limit of frames in
+  // flight to its round trip time.
+  void FrameFinished(bool timed_out) {
+    const FrameInFlight frame = frames_in_flight_.front();
+    frames_in_flight_.pop_front();
+    if (!options_.has_adaptive_limit()) {
+      return;
+    }
+    const auto& adaptive = options_.adaptive_limit();
+    const double min_limit = std::max(adaptive.min_in_flight(), 1);
+    const double max_limit = std::max<double>(adaptive.max_in_flight(),
+                                              min_limit);
+    const absl::Duration round_trip = clock_->TimeNow() - frame.release_time;
+    if (timed_out ||
+        round_trip > absl::Microseconds(adaptive.target_latency_us())) {
+      // Frames released before the last decrease don't reflect it yet.
+      if (frame.release_time >= last_decrease_time_) {
+        in_flight_limit_ = std::max(
+            min_limit, in_flight_limit_ * adaptive.decrease_factor());
+        last_decrease_time_ = clock_->TimeNow();
+      }
+    } else if (frames_in_flight_.size() + 1 >= InFlightLimit()) {
+      // Grow only while the limit is in use, so that it doesn't drift up
+      // while the input is slower than the graph.
+      in_flight_limit_ =
+          std::min(max_limit, in_flight_limit_ + 1.0 / in_flight_limit_);
+    }
+    in_flight_limit_ = std::clamp(in_flight_limit_, min_limit, max_limit);
   }
 
   // Outputs a packet indicating whether a frame was sent or dropped.
@@ -198,6 +303,16 @@ class FlowLimiterCalculator : public CalculatorBase {
     if (cc->Outputs().HasTag(kAllowTag)) {
       cc->Outputs().Tag(kAllowTag).AddPacket(MakePacket<bool>(allow).At(ts));
     }
+    if (cc->Outputs().HasTag(kInFlightLimitTag)) {
+      cc->Outputs()
+          .Tag(kInFlightLimitTag)
+          .AddPacket(MakePacket<int>(InFlightLimit()).At(ts));
+    }
+    if (cc->Outputs().HasTag(kDropCountTag)) {
+      cc->Outputs()
+          .Tag(kDropCountTag)
+          .AddPacket(MakePacket<int64_t>(drop_count_).At(ts));
+    }
     allowed_[ts] = allow;
   }
 
@@ -257,10 +372,20 @@ class FlowLimiterCalculator : public CalculatorBase {
   }
 
  private:
+  struct FrameInFlight {
+    Timestamp timestamp;
+    absl::Time release_time;
+  };
+
   FlowLimiterCalculatorOptions options_;
   std::vector<std::deque<Packet>> input_queues_;
-  std::deque<Timestamp> frames_in_flight_;
+  std::deque<FrameInFlight> frames_in_flight_;
   std::map<Timestamp, bool> allowed_;
+  std::shared_ptr<::mediapipe::Clock> clock_;
+  // The adaptive limit of frames in flight, which grows by fractions.
+  double in_flight_limit_ = 1;
+  absl::Time last_decrease_time_ = absl::InfinitePast();
+  int64_t drop_count_ = 0;
 };
 REGISTER_CALCULATOR(FlowLimiterCalculator);
 
@@ -560,6 +560,146 @@ TEST_F(FlowLimiterCalculatorTest, FinishedDelayed) {
   EXPECT_EQ(out_1_packets_, expected_output);
 }
 
+// Shows that the adaptive limit settles at the number of frames in flight
+// that keeps their round trip time under the target latency.  SleepCalculator
+// takes 20 ms per frame, so frames wait for each other and 2 frames in flight
+// finish within the 50 ms target, while 3 frames in flight don't.
+TEST_F(FlowLimiterCalculatorTest, AdaptiveLimit) {
+  // Configure the test.
+  SetUpInputData();
+  SetUpSimulationClock();
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in_1'
+        node {
+          calculator: 'FlowLimiterCalculator'
+          input_side_packet: 'OPTIONS:limiter_options'
+          input_side_packet: 'CLOCK:limiter_clock'
+          input_stream: 'in_1'
+          input_stream: 'FINISHED:out_1'
+          input_stream_info: { tag_index: 'FINISHED' back_edge: true }
+          output_stream: 'in_1_sampled'
+          output_stream: 'ALLOW:allow'
+          output_stream: 'IN_FLIGHT_LIMIT:in_flight_limit'
+          output_stream: 'DROP_COUNT:drop_count'
+        }
+        node {
+          calculator: 'SleepCalculator'
+          input_side_packet: 'WARMUP_TIME:sleep_time'
+          input_side_packet: 'SLEEP_TIME:sleep_time'
+          input_side_packet: 'CLOCK:clock'
+          input_stream: 'PACKET:in_1_sampled'
+          output_stream: 'PACKET:out_1'
+        }
+      )pb");
+  auto limiter_options = ParseTextProtoOrDie<FlowLimiterCalculatorOptions>(R"pb(
+    max_in_flight: 1
+    max_in_queue: 1
+    adaptive_limit { target_latency_us: 50000 max_in_flight: 8 }
+  )pb");
+  std::map<std::string, Packet> side_packets = {
+      {"limiter_options",
+       MakePacket<FlowLimiterCalculatorOptions>(limiter_options)},
+      {"limiter_clock",
+       MakePacket<std::shared_ptr<mediapipe::Clock>>(simulation_clock_)},
+      {"sleep_time", MakePacket<int64_t>(20000)},
+      {"clock", MakePacket<mediapipe::Clock*>(clock_)},
+  };
+
+  // Start the graph.
+  std::vector<Packet> limit_packets, drop_count_packets;
+  MP_ASSERT_OK(graph_.Initialize(graph_config));
+  MP_EXPECT_OK(graph_.ObserveOutputStream("out_1", [this](Packet p) {
+    out_1_packets_.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_EXPECT_OK(graph_.ObserveOutputStream("allow", [this](Packet p) {
+    allow_packets_.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_EXPECT_OK(graph_.ObserveOutputStream("in_flight_limit", [&](Packet p) {
+    limit_packets.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_EXPECT_OK(graph_.ObserveOutputStream("drop_count", [&](Packet p) {
+    drop_count_packets.push_back(p);
+    return absl::OkStatus();
+  }));
+  simulation_clock_->ThreadStart();
+  MP_ASSERT_OK(graph_.StartRun(side_packets));
+
+  // Add 100 input packets, one every 10 ms.
+  for (int i = 0; i < input_packets_.size(); ++i) {
+    MP_EXPECT_OK(graph_.AddPacketToInputStream("in_1", input_packets_[i]));
+    clock_->Sleep(absl::Microseconds(10000));
+  }
+
+  // Finish the graph.
+  MP_EXPECT_OK(graph_.CloseAllPacketSources());
+  clock_->Sleep(absl::Microseconds(100000));
+  MP_EXPECT_OK(graph_.WaitUntilDone());
+  simulation_clock_->ThreadFinish();
+
+  // The limit grows from 1 and oscillates between 2 and 3.
+  ASSERT_EQ(limit_packets.size(), allow_packets_.size());
+  int max_limit = 0;
+  for (int i = 0; i < limit_packets.size(); ++i) {
+    max_limit = std::max(max_limit, limit_packets[i].Get<int>());
+    if (i >= limit_packets.size() / 2) {
+      EXPECT_GE(limit_packets[i].Get<int>(), 2);
+      EXPECT_LE(limit_packets[i].Get<int>(), 3);
+    }
+  }
+  EXPECT_EQ(max_limit, 3);
+
+  // The graph runs at its full rate of one frame per 20 ms, and the drop
+  // count reports each dropped frame.
+  EXPECT_GE(out_1_packets_.size(), 48);
+  int64_t dropped = 0;
+  for (int i = 0; i < allow_packets_.size(); ++i) {
+    if (!allow_packets_[i].Get<bool>()) ++dropped;
+    EXPECT_EQ(drop_count_packets[i].Get<int64_t>(), dropped);
+    EXPECT_EQ(drop_count_packets[i].Timestamp(), allow_packets_[i].Timestamp());
+  }
+  EXPECT_EQ(out_1_packets_.size() + dropped, input_packets_.size());
+}
+
+// Shows that an adaptive limit with inconsistent options fails the graph.
+TEST_F(FlowLimiterCalculatorTest, AdaptiveLimitRejectsInvalidOptions) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in_1'
+        node {
+          calculator: 'FlowLimiterCalculator'
+          input_side_packet: 'OPTIONS:limiter_options'
+          input_stream: 'in_1'
+          input_stream: 'FINISHED:out_1'
+          input_stream_info: { tag_index: 'FINISHED' back_edge: true }
+          output_stream: 'out_1'
+        }
+      )pb");
+  for (const char* options : {
+           "adaptive_limit { target_latency_us: 0 }",
+           "adaptive_limit { target_latency_us: 50000 decrease_factor: 1 }",
+           "adaptive_limit { target_latency_us: 50000 min_in_flight: 8 "
+           "max_in_flight: 4 }",
+       }) {
+    auto limiter_options =
+        ParseTextProtoOrDie<FlowLimiterCalculatorOptions>(options);
+    CalculatorGraph graph;
+    MP_ASSERT_OK(graph.Initialize(graph_config));
+    // Open() may fail after StartRun() has returned.
+    absl::Status status = graph.StartRun(
+        {{"limiter_options",
+          MakePacket<FlowLimiterCalculatorOptions>(limiter_options)}});
+    if (status.ok()) {
+      graph.CloseAllInputStreams().IgnoreError();
+      status = graph.WaitUntilDone();
+    }
+    EXPECT_FALSE(status.ok()) << options;
+  }
+}
+
 // Shows that packets on auxiliary input streams are relesed for the same
 // timestamps as the main input stream, whether the auxiliary packets arrive
 // early or late.
@@ -0,0 +1,149 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/frame_buffer_image_utils.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "mediapipe/framework/formats/frame_buffer.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/util/frame_buffer/frame_buffer_util.h"
+
+namespace mediapipe {
+namespace frame_buffer_image {
+
+namespace {
+
+FrameBuffer::Format ToFrameBufferFormat(ImageFormat::Format format) {
+  switch (format) {
+    case ImageFormat::SRGB:
+      return FrameBuffer::Format::kRGB;
+    case ImageFormat::SRGBA:
+      return FrameBuffer::Format::kRGBA;
+    case ImageFormat::GRAY8:
+      return FrameBuffer::Format::kGRAY;
+    default:
+      return FrameBuffer::Format::kUNKNOWN;
+  }
+}
+
+ImageFormat::Format ToImageFormat(FrameBuffer::Format format) {
+  switch (format) {
+    case FrameBuffer::Format::kRGB:
+      return ImageFormat::SRGB;
+    case FrameBuffer::Format::kRGBA:
+      return ImageFormat::SRGBA;
+    case FrameBuffer::Format::kGRAY:
+      return ImageFormat::GRAY8;
+    default:
+      return ImageFormat::UNKNOWN;
+  }
+}
+
+}  // namespace
+
+bool IsSupportedFormat(ImageFormat::Format format) {
+  return ToFrameBufferFormat(format) != FrameBuffer::Format::kUNKNOWN;
+}
+
+std::unique_ptr<FrameBuffer> MakeView(const ImageFrame& frame, int left,
+                                      int top, int width, int height) {
+  const FrameBuffer::Format format = ToFrameBufferFormat(frame.Format());
+  ABSL_CHECK(format != FrameBuffer::Format::kUNKNOWN)
+      << "Only SRGB, SRGBA and GRAY8 are supported.";
+  ABSL_CHECK(left >= 0 && top >= 0 && left + width <= frame.Width() &&
+             top + height <= frame.Height());
+  const int pixel_stride = frame.NumberOfChannels() * frame.ByteDepth();
+  // FrameBuffer has no read-only variant; callers only pass views of const
+  // frames as kernel inputs.
+  uint8_t* data = const_cast<uint8_t*>(frame.PixelData()) +
+                  top * frame.WidthStep() + left * pixel_stride;
+  const FrameBuffer::Stride stride{/*row_stride_bytes=*/frame.WidthStep(),
+                                   /*pixel_stride_bytes=*/pixel_stride};
+  const std::vector<FrameBuffer::Plane> planes{{data, stride}};
+  return std::make_unique<FrameBuffer>(
+      planes, FrameBuffer::Dimension{width, height}, format);
+}
+
+std::unique_ptr<FrameBuffer> MakeView(const ImageFrame& frame) {
+  return MakeView(frame, 0, 0, frame.Width(), frame.Height());
+}
+
+ImageFrame* GetOrAllocateFrame(ImageFormat::Format format, int width,
+                               int height, std::unique_ptr<ImageFrame>* frame) {
+  if (*frame == nullptr || (*frame)->Format() != format ||
+      (*frame)->Width() != width || (*frame)->Height() != height) {
+    *frame = std::make_unique<ImageFrame>(format, width, height);
+  }
+  return frame->get();
+}
+
+absl::Status Copy(const FrameBuffer& input, FrameBuffer* output) {
+  RET_CHECK_EQ(input.plane_count(), 1);
+  RET_CHECK_EQ(output->plane_count(), 1);
+  RET_CHECK(input.format() == output->format());
+  RET_CHECK(input.dimension() == output->dimension());
+  const FrameBuffer::Plane& src = input.plane(0);
+  FrameBuffer::Plane dst = output->mutable_plane(0);
+  RET_CHECK_EQ(src.stride().pixel_stride_bytes,
+               dst.stride().pixel_stride_bytes);
+  const int row_bytes =
+      input.dimension().width * src.stride().pixel_stride_bytes;
+  for (int y = 0; y < input.dimension().height; ++y) {
+    std::memcpy(dst.mutable_buffer() + y * dst.stride().row_stride_bytes,
+                src.buffer() + y * src.stride().row_stride_bytes, row_bytes);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RotateAndFlip(const FrameBuffer& input, int rotation_degrees,
+                           bool flip_horizontally, bool flip_vertically,
+                           FrameBuffer* output,
+                           std::unique_ptr<ImageFrame>* scratch) {
+  RET_CHECK_EQ(rotation_degrees % 90, 0);
+  int angle = (rotation_degrees % 360 + 360) % 360;
+  // A vertical flip is a horizontal flip of the image rotated by 180 degrees,
+  // so every combination is a rotation followed by an optional horizontal
+  // flip.
+  if (flip_vertically) {
+    angle = (angle + 180) % 360;
+    flip_horizontally = !flip_horizontally;
+  }
+  if (!flip_horizontally) {
+    if (angle == 0) return Copy(input, output);
+    return frame_buffer::Rotate(input, angle, output);
+  }
+  if (angle == 0) return frame_buffer::FlipHorizontally(input, output);
+  if (angle == 180) return frame_buffer::FlipVertically(input, output);
+
+  // There is no transpose kernel, so a quarter turn plus a flip takes a
+  // rotation into the scratch frame and a flip out of it.
+  ImageFrame* rotated = GetOrAllocateFrame(
+      ToImageFormat(input.format()), output->dimension().width,
+      output->dimension().height, scratch);
+  std::unique_ptr<FrameBuffer> rotated_view = MakeView(*rotated);
+  MP_RETURN_IF_ERROR(frame_buffer::Rotate(input, angle, rotated_view.get()));
+  return frame_buffer::FlipHorizontally(*rotated_view, output);
+}
+
+}  // namespace frame_buffer_image
+}  // namespace mediapipe
@@ -0,0 +1,69 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Utilities for running the frame_buffer_util kernels directly on ImageFrame
+// memory, used by the CPU paths of the image calculators.
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_FRAME_BUFFER_IMAGE_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_FRAME_BUFFER_IMAGE_UTILS_H_
+
+#include <memory>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/formats/frame_buffer.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+
+namespace mediapipe {
+namespace frame_buffer_image {
+
+// Returns whether ImageFrames of `format` can be processed by the
+// frame_buffer_util kernels, i.e. whether it is SRGB, SRGBA or GRAY8.
+bool IsSupportedFormat(ImageFormat::Format format);
+
+// Returns a FrameBuffer aliasing the `width` x `height` rectangle of `frame`
+// whose top-left pixel is (`left`, `top`). No pixel data is copied, so the
+// view must not outlive `frame`. `frame` must have a supported format.
+std::unique_ptr<FrameBuffer> MakeView(const ImageFrame& frame, int left,
+                                      int top, int width, int height);
+
+// Returns a FrameBuffer aliasing all of `frame`.
+std::unique_ptr<FrameBuffer> MakeView(const ImageFrame& frame);
+
+// Returns `*frame` if it already is a `width` x `height` frame of `format`, and
+// replaces it with a newly allocated one otherwise. Used to keep intermediate
+// images alive across calls instead of allocating them for every frame.
+ImageFrame* GetOrAllocateFrame(ImageFormat::Format format, int width,
+                               int height, std::unique_ptr<ImageFrame>* frame);
+
+// Copies the pixels of `input` into `output`, which must have the same format
+// and dimensions.
+absl::Status Copy(const FrameBuffer& input, FrameBuffer* output);
+
+// Rotates `input` counterclockwise by `rotation_degrees`, a multiple of 90,
+// then flips it, and writes the result into `output`.
+//
+// The rotation and the flips are reduced to a single kernel call whenever the
+// combination is a plain rotation or flip; only a 90 or 270 degree rotation
+// combined with a single flip takes two passes, in which case the intermediate
+// image is kept in `scratch`, which is reallocated only when its size or format
+// has to change.
+absl::Status RotateAndFlip(const FrameBuffer& input, int rotation_degrees,
+                           bool flip_horizontally, bool flip_vertically,
+                           FrameBuffer* output,
+                           std::unique_ptr<ImageFrame>* scratch);
+
+}  // namespace frame_buffer_image
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_FRAME_BUFFER_IMAGE_UTILS_H_
@@ -0,0 +1,151 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/frame_buffer_image_utils.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "mediapipe/framework/formats/frame_buffer.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace frame_buffer_image {
+namespace {
+
+// Fills `frame` with pixels whose channels all hold a distinct value derived
+// from the pixel coordinates.
+void FillWithCoordinates(ImageFrame* frame) {
+  for (int y = 0; y < frame->Height(); ++y) {
+    uint8_t* row = frame->MutablePixelData() + y * frame->WidthStep();
+    for (int x = 0; x < frame->Width(); ++x) {
+      for (int c = 0; c < frame->NumberOfChannels(); ++c) {
+        row[x * frame->NumberOfChannels() + c] = y * 16 + x + c;
+      }
+    }
+  }
+}
+
+const uint8_t* Pixel(const ImageFrame& frame, int x, int y) {
+  return frame.PixelData() + y * frame.WidthStep() +
+         x * frame.NumberOfChannels();
+}
+
+// Returns the pixel of `input` that RotateAndFlip moves to (x, y) of an
+// `output_width` x `output_height` output.
+const uint8_t* ExpectedPixel(const ImageFrame& input, int rotation_degrees,
+                             bool flip_horizontally, bool flip_vertically,
+                             int output_width, int output_height, int x,
+                             int y) {
+  if (flip_horizontally) x = output_width - 1 - x;
+  if (flip_vertically) y = output_height - 1 - y;
+  const int width = input.Width();
+  const int height = input.Height();
+  switch (rotation_degrees) {
+    case 90:
+      return Pixel(input, width - 1 - y, x);
+    case 180:
+      return Pixel(input, width - 1 - x, height - 1 - y);
+    case 270:
+      return Pixel(input, y, height - 1 - x);
+    default:
+      return Pixel(input, x, y);
+  }
+}
+
+TEST(FrameBufferImageUtilsTest, SupportsEightBitInterleavedFormats) {
+  EXPECT_TRUE(IsSupportedFormat(ImageFormat::SRGB));
+  EXPECT_TRUE(IsSupportedFormat(ImageFormat::SRGBA));
+  EXPECT_TRUE(IsSupportedFormat(ImageFormat::GRAY8));
+  EXPECT_FALSE(IsSupportedFormat(ImageFormat::VEC32F1));
+  EXPECT_FALSE(IsSupportedFormat(ImageFormat::SRGB48));
+}
+
+TEST(FrameBufferImageUtilsTest, MakeViewAliasesRegion) {
+  ImageFrame frame(ImageFormat::SRGB, 8, 6);
+  std::unique_ptr<FrameBuffer> view = MakeView(frame, 2, 3, 4, 2);
+  EXPECT_EQ(view->format(), FrameBuffer::Format::kRGB);
+  EXPECT_EQ(view->dimension().width, 4);
+  EXPECT_EQ(view->dimension().height, 2);
+  ASSERT_EQ(view->plane_count(), 1);
+  EXPECT_EQ(view->plane(0).buffer(), Pixel(frame, 2, 3));
+  EXPECT_EQ(view->plane(0).stride().row_stride_bytes, frame.WidthStep());
+  EXPECT_EQ(view->plane(0).stride().pixel_stride_bytes, 3);
+}
+
+TEST(FrameBufferImageUtilsTest, GetOrAllocateFrameReusesMatchingFrame) {
+  std::unique_ptr<ImageFrame> frame;
+  ImageFrame* first = GetOrAllocateFrame(ImageFormat::SRGBA, 4, 2, &frame);
+  EXPECT_EQ(first, frame.get());
+  EXPECT_EQ(GetOrAllocateFrame(ImageFormat::SRGBA, 4, 2, &frame), first);
+  ImageFrame* resized = GetOrAllocateFrame(ImageFormat::SRGBA, 2, 4, &frame);
+  EXPECT_EQ(resized->Width(), 2);
+  EXPECT_EQ(resized->Height(), 4);
+}
+
+TEST(FrameBufferImageUtilsTest, CopiesIntoRegion) {
+  ImageFrame input(ImageFormat::GRAY8, 3, 2);
+  FillWithCoordinates(&input);
+  ImageFrame output(ImageFormat::GRAY8, 5, 4);
+  output.SetToZero();
+  std::unique_ptr<FrameBuffer> region = MakeView(output, 1, 1, 3, 2);
+  MP_ASSERT_OK(Copy(*MakeView(input), region.get()));
+  for (int y = 0; y < output.Height(); ++y) {
+    for (int x = 0; x < output.Width(); ++x) {
+      const bool inside = x >= 1 && x < 4 && y >= 1 && y < 3;
+      EXPECT_EQ(*Pixel(output, x, y), inside ? *Pixel(input, x - 1, y - 1) : 0)
+          << "at " << x << "," << y;
+    }
+  }
+}
+
+TEST(FrameBufferImageUtilsTest, RotatesAndFlipsAllCombinations) {
+  ImageFrame input(ImageFormat::SRGB, 5, 3);
+  FillWithCoordinates(&input);
+  std::unique_ptr<ImageFrame> scratch;
+  for (int rotation : {0, 90, 180, 270}) {
+    for (bool flip_horizontally : {false, true}) {
+      for (bool flip_vertically : {false, true}) {
+        const bool quarter_turn = rotation % 180 != 0;
+        ImageFrame output(ImageFormat::SRGB,
+                          quarter_turn ? input.Height() : input.Width(),
+                          quarter_turn ? input.Width() : input.Height());
+        MP_ASSERT_OK(RotateAndFlip(*MakeView(input), rotation,
+                                   flip_horizontally, flip_vertically,
+                                   MakeView(output).get(), &scratch));
+        for (int y = 0; y < output.Height(); ++y) {
+          for (int x = 0; x < output.Width(); ++x) {
+            const uint8_t* expected = ExpectedPixel(
+                input, rotation, flip_horizontally, flip_vertically,
+                output.Width(), output.Height(), x, y);
+            for (int c = 0; c < 3; ++c) {
+              ASSERT_EQ(Pixel(output, x, y)[c], expected[c])
+                  << "rotation " << rotation << " flip_horizontally "
+                  << flip_horizontally << " flip_vertically "
+                  << flip_vertically << " at " << x << "," << y;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace frame_buffer_image
+}  // namespace mediapipe
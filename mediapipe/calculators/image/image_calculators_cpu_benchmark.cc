@@ -0,0 +1,150 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Compares the frame_buffer_util and OpenCV CPU paths of
+// ImageTransformationCalculator and ImageCroppingCalculator.
+//
+// Benchmark arguments are {use_frame_buffer, input_width, input_height, op}.
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/substitute.h"
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+// ImageTransformationCalculator options for each op.
+constexpr const char* kTransformationOptions[] = {
+    // Quarter turn of a camera frame.
+    "rotation_mode: ROTATION_90",
+    // Mirrored front camera frame.
+    "flip_horizontally: true",
+    // Mirrored and letterboxed model input.
+    "output_width: 256 output_height: 256 scale_mode: FIT "
+    "flip_horizontally: true",
+    // Upscaled preview.
+    "output_width: $0 output_height: $1 scale_mode: STRETCH",
+};
+
+Packet MakeInputFrame(int width, int height) {
+  auto frame = std::make_unique<ImageFrame>(ImageFormat::SRGBA, width, height);
+  frame->SetToZero();
+  return Adopt(frame.release());
+}
+
+// Sends a frame through the single-node graph `node` per iteration.
+void RunGraph(benchmark::State& state, const std::string& node) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+      R"pb(
+        input_stream: "input"
+        node { $0 }
+      )pb",
+      node));
+  CalculatorGraph graph;
+  ABSL_CHECK_OK(graph.Initialize(config));
+  ABSL_CHECK_OK(graph.ObserveOutputStream(
+      "output", [](const Packet&) { return absl::OkStatus(); }));
+  ABSL_CHECK_OK(graph.StartRun({}));
+
+  const Packet frame = MakeInputFrame(state.range(1), state.range(2));
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    ABSL_CHECK_OK(
+        graph.AddPacketToInputStream("input", frame.At(Timestamp(timestamp))));
+    ++timestamp;
+    ABSL_CHECK_OK(graph.WaitUntilIdle());
+  }
+  ABSL_CHECK_OK(graph.CloseAllInputStreams());
+  ABSL_CHECK_OK(graph.WaitUntilDone());
+}
+
+void BM_ImageTransformation(benchmark::State& state) {
+  const std::string options = absl::Substitute(
+      kTransformationOptions[state.range(3)], state.range(1) * 2,
+      state.range(2) * 2);
+  RunGraph(state, absl::Substitute(
+                      R"pb(
+                        calculator: "ImageTransformationCalculator"
+                        input_stream: "IMAGE:input"
+                        output_stream: "IMAGE:output"
+                        options {
+                          [mediapipe.ImageTransformationCalculatorOptions.ext] {
+                            use_frame_buffer: $0 $1
+                          }
+                        }
+                      )pb",
+                      state.range(0) ? "true" : "false", options));
+}
+
+// Crops the central quarter of the frame, either at full resolution (op 0) or
+// scaled down to at most 256x256 (op 1).
+void BM_ImageCropping(benchmark::State& state) {
+  const int width = state.range(1) / 2;
+  const int height = state.range(2) / 2;
+  const std::string max_size =
+      state.range(3) ? "output_max_width: 256 output_max_height: 256" : "";
+  RunGraph(state, absl::Substitute(
+                      R"pb(
+                        calculator: "ImageCroppingCalculator"
+                        input_stream: "IMAGE:input"
+                        output_stream: "IMAGE:output"
+                        options {
+                          [mediapipe.ImageCroppingCalculatorOptions.ext] {
+                            use_frame_buffer: $0
+                            width: $1
+                            height: $2
+                            $3
+                          }
+                        }
+                      )pb",
+                      state.range(0) ? "true" : "false", width, height,
+                      max_size));
+}
+
+void Resolutions(benchmark::internal::Benchmark* benchmark, int num_ops) {
+  benchmark->ArgNames({"frame_buffer", "width", "height", "op"});
+  for (int op = 0; op < num_ops; ++op) {
+    for (const auto& [width, height] : {std::pair<int, int>{640, 480},
+                                        {1280, 720},
+                                        {1920, 1080},
+                                        {3840, 2160}}) {
+      for (int use_frame_buffer : {0, 1}) {
+        benchmark->Args({use_frame_buffer, width, height, op});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_ImageTransformation)
+    ->Apply([](benchmark::internal::Benchmark* benchmark) {
+      Resolutions(benchmark, std::size(kTransformationOptions));
+    })
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ImageCropping)
+    ->Apply([](benchmark::internal::Benchmark* benchmark) {
+      Resolutions(benchmark, 2);
+    })
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,9 +14,13 @@
 
 #include "mediapipe/calculators/image/image_cropping_calculator.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 
 #include "absl/log/absl_log.h"
+#include "mediapipe/calculators/image/frame_buffer_image_utils.h"
+#include "mediapipe/framework/formats/frame_buffer.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/rect.pb.h"
@@ -24,6 +28,8 @@
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/util/frame_buffer/frame_buffer_util.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_simple_shaders.h"
@@ -229,6 +235,37 @@ absl::Status ImageCroppingCalculator::RenderCpu(CalculatorContext* cc) {
   float rect_center_x = specs.center_x, rect_center_y = specs.center_y;
   float rotation = specs.rotation;
 
+  // An unrotated crop that lies within the image on pixel boundaries needs no
+  // border handling nor subpixel sampling, so frame_buffer_util can crop and
+  // scale it straight into the output frame in a single pass.
+  const float rect_left = rect_center_x - target_width / 2.f;
+  const float rect_top = rect_center_y - target_height / 2.f;
+  if (options_.use_frame_buffer() && rotation == 0.f &&
+      frame_buffer_image::IsSupportedFormat(input_img.Format()) &&
+      target_width > 0 && target_height > 0 &&
+      rect_left == std::floor(rect_left) && rect_top == std::floor(rect_top) &&
+      rect_left >= 0 && rect_top >= 0 &&
+      rect_left + target_width <= input_img.Width() &&
+      rect_top + target_height <= input_img.Height()) {
+    const float scale = std::min({1.0f, output_max_width_ / target_width,
+                                  output_max_height_ / target_height});
+    // Truncated like the cv::Size of the OpenCV path below.
+    const int output_width = target_width * scale;
+    const int output_height = target_height * scale;
+    const int x0 = rect_left;
+    const int y0 = rect_top;
+    auto output_frame = std::make_unique<ImageFrame>(
+        input_img.Format(), output_width, output_height);
+    std::unique_ptr<FrameBuffer> output_buffer =
+        frame_buffer_image::MakeView(*output_frame);
+    MP_RETURN_IF_ERROR(frame_buffer::Crop(
+        *frame_buffer_image::MakeView(input_img), x0, y0,
+        x0 + target_width - 1, y0 + target_height - 1, output_buffer.get()));
+    cc->Outputs().Tag(kImageTag).Add(output_frame.release(),
+                                     cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+
   // Get border mode and value for OpenCV.
   int border_mode;
   MP_RETURN_IF_ERROR(GetBorderModeForOpenCV(cc, &border_mode));
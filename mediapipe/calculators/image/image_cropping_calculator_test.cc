@@ -16,6 +16,7 @@
 
 #include <cmath>
 #include <memory>
+#include <string>
 
 #include "mediapipe/calculators/image/image_cropping_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -143,6 +144,66 @@ TEST(ImageCroppingCalculatorTest, IdentityFunctionCropWithOddSize) {
   EXPECT_EQ(max_diff, 0);
 }  // TEST
 
+// Crops `input_frame_packet` on CPU with the given calculator options, through
+// the frame_buffer_util path if `use_frame_buffer` is true or the OpenCV path
+// otherwise.
+cv::Mat RunCpuCrop(const std::string& options, bool use_frame_buffer,
+                   const mediapipe::Packet& input_frame_packet) {
+  mediapipe::CalculatorRunner runner(
+      ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          absl::Substitute(
+              R"pb(
+                calculator: "ImageCroppingCalculator"
+                input_stream: "IMAGE:input_frames"
+                output_stream: "IMAGE:cropped_output_frames"
+                options: {
+                  [mediapipe.ImageCroppingCalculatorOptions.ext] {
+                    $0
+                    use_frame_buffer: $1
+                  }
+                }
+              )pb",
+              options, use_frame_buffer)));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      input_frame_packet.At(mediapipe::Timestamp(1)));
+  MP_EXPECT_OK(runner.Run());
+  const auto& packets = runner.Outputs().Tag("IMAGE").packets;
+  if (packets.size() != 1) return cv::Mat();
+  return formats::MatView(&packets[0].Get<mediapipe::ImageFrame>()).clone();
+}
+
+// Test that the frame_buffer_util crop of an unrotated, pixel-aligned rect
+// within the image matches the OpenCV path.
+TEST(ImageCroppingCalculatorTest, FrameBufferCropMatchesOpenCv) {
+  // Channels grow by 2 per column and per row.
+  auto input_frame = std::make_unique<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGB, 40, 40);
+  cv::Mat input_mat = formats::MatView(input_frame.get());
+  for (int y = 0; y < input_mat.rows; ++y) {
+    for (int x = 0; x < input_mat.cols; ++x) {
+      input_mat.at<cv::Vec3b>(y, x) = cv::Vec3b(2 * (x + y), 2 * (x + y) + 1,
+                                                2 * (x + y) + 2);
+    }
+  }
+  auto input_frame_packet =
+      mediapipe::MakePacket<mediapipe::ImageFrame>(std::move(*input_frame));
+
+  const std::string crop = "width: 20 height: 20";
+  cv::Mat frame_buffer_mat = RunCpuCrop(crop, true, input_frame_packet);
+  cv::Mat opencv_mat = RunCpuCrop(crop, false, input_frame_packet);
+  ASSERT_EQ(frame_buffer_mat.size(), opencv_mat.size());
+  EXPECT_EQ(cv::norm(frame_buffer_mat, opencv_mat, cv::NORM_INF), 0);
+
+  // Scaling down samples pixel corners rather than pixel centers, which is at
+  // most half a pixel away in each direction, plus rounding.
+  const std::string scaled_crop =
+      "width: 20 height: 20 output_max_width: 10 output_max_height: 10";
+  frame_buffer_mat = RunCpuCrop(scaled_crop, true, input_frame_packet);
+  opencv_mat = RunCpuCrop(scaled_crop, false, input_frame_packet);
+  ASSERT_EQ(frame_buffer_mat.size(), opencv_mat.size());
+  EXPECT_LE(cv::norm(frame_buffer_mat, opencv_mat, cv::NORM_INF), 4);
+}
+
 // Test identity function on GPU, where cropping size is same as input size.
 TEST(ImageCroppingCalculatorTest, IdentityFunctionCropWithOriginalSizeGPU) {
   mediapipe::CalculatorGraphConfig config =
@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+
 #include "absl/status/status.h"
+#include "mediapipe/calculators/image/frame_buffer_image_utils.h"
 #include "mediapipe/calculators/image/image_transformation_calculator.pb.h"
 #include "mediapipe/calculators/image/rotation_mode.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -24,8 +27,10 @@
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/gpu/scale_mode.pb.h"
+#include "mediapipe/util/frame_buffer/frame_buffer_util.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_base.h"
@@ -178,6 +183,12 @@ mediapipe::ScaleMode_Mode ParseScaleMode(
 // Note: Input defines output, so only matchig types supported:
 // IMAGE -> IMAGE  or  IMAGE_GPU -> IMAGE_GPU
 //
+// Note: On CPU, SRGB, SRGBA and GRAY8 images are rotated, flipped and upscaled
+// with the Halide kernels of frame_buffer_util, writing straight into the
+// output frame, when use_frame_buffer is enabled. Other formats, replicated
+// FIT padding and rotations that OpenCV performs in place (explicit output
+// dimensions, or an output the same size as the input) go through OpenCV.
+//
 class ImageTransformationCalculator : public CalculatorBase {
  public:
   ImageTransformationCalculator() = default;
@@ -192,6 +203,12 @@ class ImageTransformationCalculator : public CalculatorBase {
  private:
   absl::Status RenderCpu(CalculatorContext* cc);
   absl::Status RenderGpu(CalculatorContext* cc);
+  bool CanRenderWithFrameBuffer(const ImageFrame& input) const;
+  absl::Status RenderFrameBuffer(CalculatorContext* cc,
+                                 const ImageFrame& input);
+  absl::Status Scale(const ImageFrame& input, int interpolation,
+                     ImageFrame* output, int left, int top, int width,
+                     int height);
   absl::Status GlSetup();
 
   void ComputeOutputDimensions(int input_width, int input_height,
@@ -211,6 +228,9 @@ class ImageTransformationCalculator : public CalculatorBase {
   bool use_gpu_ = false;
   cv::Scalar padding_color_;
   ImageTransformationCalculatorOptions::InterpolationMode interpolation_mode_;
+  // Intermediate images of the frame_buffer_util path, reused across frames.
+  std::unique_ptr<ImageFrame> intermediate_frame_;
+  std::unique_ptr<ImageFrame> rotation_scratch_frame_;
 
 #if !MEDIAPIPE_DISABLE_GPU
   GlCalculatorHelper gpu_helper_;
@@ -456,6 +476,9 @@ absl::Status ImageTransformationCalculator::RenderCpu(CalculatorContext* cc) {
   mediapipe::ImageFormat::Format format;
 
   const auto& input = cc->Inputs().Tag(kImageFrameTag).Get<ImageFrame>();
+  if (CanRenderWithFrameBuffer(input)) {
+    return RenderFrameBuffer(cc, input);
+  }
   input_mat = formats::MatView(&input);
   format = input.Format();
 
@@ -581,6 +604,158 @@ absl::Status ImageTransformationCalculator::RenderCpu(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+bool ImageTransformationCalculator::CanRenderWithFrameBuffer(
+    const ImageFrame& input) const {
+  if (!options_.use_frame_buffer() ||
+      !frame_buffer_image::IsSupportedFormat(input.Format())) {
+    return false;
+  }
+  const int angle = RotationModeToDegrees(rotation_);
+  if (output_width_ > 0 && output_height_ > 0) {
+    // With explicit output dimensions, RenderCpu rotates the scaled image in
+    // place, keeping the output dimensions.
+    if (angle != 0) return false;
+    return scale_mode_ != mediapipe::ScaleMode::FIT ||
+           options_.constant_padding();
+  }
+  // RenderCpu also rotates in place when the rotated image has the same
+  // dimensions as the input.
+  return angle == 0 || (angle != 180 && input.Width() != input.Height());
+}
+
+absl::Status ImageTransformationCalculator::RenderFrameBuffer(
+    CalculatorContext* cc, const ImageFrame& input) {
+  const int input_width = input.Width();
+  const int input_height = input.Height();
+  int output_width;
+  int output_height;
+  ComputeOutputDimensions(input_width, input_height, &output_width,
+                          &output_height);
+
+  // Without explicit output dimensions the input is only rotated and flipped
+  // into the whole output. Otherwise it is not rotated, and is scaled into the
+  // region of the output at (left, top) with the interpolation RenderCpu would
+  // use.
+  int left = 0;
+  int top = 0;
+  int scaled_width = input_width;
+  int scaled_height = input_height;
+  int interpolation = cv::INTER_LINEAR;
+  if (output_width_ > 0 && output_height_ > 0) {
+    bool downscale;
+    if (scale_mode_ == mediapipe::ScaleMode::STRETCH) {
+      scaled_width = output_width_;
+      scaled_height = output_height_;
+      downscale =
+          input_width > output_width_ && input_height > output_height_;
+    } else {
+      const float scale =
+          std::min(static_cast<float>(output_width_) / input_width,
+                   static_cast<float>(output_height_) / input_height);
+      scaled_width = std::round(input_width * scale);
+      scaled_height = std::round(input_height * scale);
+      downscale = scale < 1.0f;
+      if (scale_mode_ == mediapipe::ScaleMode::FIT) {
+        left = (output_width_ - scaled_width) / 2;
+        top = (output_height_ - scaled_height) / 2;
+      } else {
+        output_width = scaled_width;
+        output_height = scaled_height;
+      }
+    }
+    if (interpolation_mode_ == ImageTransformationCalculatorOptions::NEAREST) {
+      interpolation = cv::INTER_NEAREST;
+    } else if (downscale) {
+      interpolation = cv::INTER_AREA;
+    }
+  }
+
+  if (cc->Outputs().HasTag("LETTERBOX_PADDING")) {
+    auto padding = absl::make_unique<std::array<float, 4>>();
+    ComputeOutputLetterboxPadding(input_width, input_height, output_width,
+                                  output_height, padding.get());
+    cc->Outputs()
+        .Tag("LETTERBOX_PADDING")
+        .Add(padding.release(), cc->InputTimestamp());
+  }
+
+  auto output_frame = absl::make_unique<ImageFrame>(
+      input.Format(), output_width, output_height);
+  const bool scaled = output_width_ > 0 && output_height_ > 0;
+  const int region_width = scaled ? scaled_width : output_width;
+  const int region_height = scaled ? scaled_height : output_height;
+  if (region_width != output_width || region_height != output_height) {
+    // Only the FIT letterbox is padded, so the region is never overwritten.
+    cv::Mat output_mat = formats::MatView(output_frame.get());
+    const int right = left + region_width;
+    const int bottom = top + region_height;
+    output_mat.rowRange(0, top).setTo(padding_color_);
+    output_mat.rowRange(bottom, output_height).setTo(padding_color_);
+    output_mat(cv::Rect(0, top, left, region_height)).setTo(padding_color_);
+    output_mat(cv::Rect(right, top, output_width - right, region_height))
+        .setTo(padding_color_);
+  }
+  std::unique_ptr<FrameBuffer> region = frame_buffer_image::MakeView(
+      *output_frame, left, top, region_width, region_height);
+
+  const int angle = RotationModeToDegrees(rotation_);
+  if (scaled_width == input_width && scaled_height == input_height) {
+    MP_RETURN_IF_ERROR(frame_buffer_image::RotateAndFlip(
+        *frame_buffer_image::MakeView(input), angle, flip_horizontally_,
+        flip_vertically_, region.get(), &rotation_scratch_frame_));
+  } else if (!flip_horizontally_ && !flip_vertically_) {
+    MP_RETURN_IF_ERROR(Scale(input, interpolation, output_frame.get(), left,
+                             top, scaled_width, scaled_height));
+  } else if (interpolation == cv::INTER_NEAREST ||
+             scaled_width * scaled_height < input_width * input_height) {
+    // Flip the smaller of the input and the scaled image. Nearest neighbor
+    // scaling picks other pixels from a flipped input than RenderCpu does, so
+    // its output is always flipped after scaling.
+    ImageFrame* scaled_frame = frame_buffer_image::GetOrAllocateFrame(
+        input.Format(), scaled_width, scaled_height, &intermediate_frame_);
+    MP_RETURN_IF_ERROR(Scale(input, interpolation, scaled_frame, 0, 0,
+                             scaled_width, scaled_height));
+    MP_RETURN_IF_ERROR(frame_buffer_image::RotateAndFlip(
+        *frame_buffer_image::MakeView(*scaled_frame), /*rotation_degrees=*/0,
+        flip_horizontally_, flip_vertically_, region.get(),
+        &rotation_scratch_frame_));
+  } else {
+    ImageFrame* flipped_frame = frame_buffer_image::GetOrAllocateFrame(
+        input.Format(), input_width, input_height, &intermediate_frame_);
+    MP_RETURN_IF_ERROR(frame_buffer_image::RotateAndFlip(
+        *frame_buffer_image::MakeView(input), /*rotation_degrees=*/0,
+        flip_horizontally_, flip_vertically_,
+        frame_buffer_image::MakeView(*flipped_frame).get(),
+        &rotation_scratch_frame_));
+    MP_RETURN_IF_ERROR(Scale(*flipped_frame, interpolation, output_frame.get(),
+                             left, top, scaled_width, scaled_height));
+  }
+
+  cc->Outputs()
+      .Tag(kImageFrameTag)
+      .Add(output_frame.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+absl::Status ImageTransformationCalculator::Scale(const ImageFrame& input,
+                                                  int interpolation,
+                                                  ImageFrame* output, int left,
+                                                  int top, int width,
+                                                  int height) {
+  if (interpolation == cv::INTER_LINEAR) {
+    std::unique_ptr<FrameBuffer> region =
+        frame_buffer_image::MakeView(*output, left, top, width, height);
+    return frame_buffer::Resize(*frame_buffer_image::MakeView(input),
+                                region.get());
+  }
+  // frame_buffer_util only resizes bilinearly, so area and nearest neighbor
+  // scaling still use OpenCV, writing straight into the output region.
+  cv::Mat region = formats::MatView(output)(cv::Rect(left, top, width, height));
+  cv::resize(formats::MatView(&input), region, region.size(), 0, 0,
+             interpolation);
+  return absl::OkStatus();
+}
+
 absl::Status ImageTransformationCalculator::RenderGpu(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
   const auto& input = cc->Inputs().Tag(kGpuBufferTag).Get<GpuBuffer>();
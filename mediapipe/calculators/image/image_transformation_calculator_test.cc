@@ -6,6 +6,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/log/absl_check.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -42,6 +43,58 @@ absl::flat_hash_set<int> computeUniqueValues(const cv::Mat& mat) {
   return unique_values;
 }
 
+// Returns a SRGB image whose channels grow by 8 per column and 4 per row, so
+// that sampling half a pixel away changes them by at most 6.
+Packet MakeGradientImage(int width, int height) {
+  ImageFrame image(ImageFormat::SRGB, width, height);
+  cv::Mat mat = formats::MatView(&image);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      mat.at<cv::Vec3b>(y, x) = cv::Vec3b(8 * x + 4 * y, 8 * x + 4 * y + 1,
+                                           8 * x + 4 * y + 2);
+    }
+  }
+  return MakePacket<ImageFrame>(std::move(image));
+}
+
+// Transforms `input_image` on CPU with the given calculator options, through
+// the frame_buffer_util path if `use_frame_buffer` is true or the OpenCV path
+// otherwise.
+Packet RunCpuTransformation(const std::string& options, bool use_frame_buffer,
+                            const Packet& input_image) {
+  const std::string node_config = absl::Substitute(
+      R"pb(
+        calculator: "ImageTransformationCalculator"
+        input_stream: "IMAGE:input_image"
+        output_stream: "IMAGE:output_image"
+        options: {
+          [mediapipe.ImageTransformationCalculatorOptions.ext]: {
+            $0
+            use_frame_buffer: $1
+          }
+        })pb",
+      options, use_frame_buffer);
+  CalculatorRunner runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(node_config));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      input_image.At(Timestamp(0)));
+  ABSL_QCHECK_OK(runner.Run());
+  const std::vector<Packet>& packets = runner.Outputs().Tag("IMAGE").packets;
+  ABSL_QCHECK_EQ(packets.size(), 1);
+  return packets[0];
+}
+
+// Returns the largest difference between the channels of two images of the
+// same size.
+double MaxDifference(const Packet& image1, const Packet& image2) {
+  const auto& frame1 = image1.Get<ImageFrame>();
+  const auto& frame2 = image2.Get<ImageFrame>();
+  ABSL_QCHECK_EQ(frame1.Width(), frame2.Width());
+  ABSL_QCHECK_EQ(frame1.Height(), frame2.Height());
+  return cv::norm(formats::MatView(&frame1), formats::MatView(&frame2),
+                  cv::NORM_INF);
+}
+
 TEST(ImageTransformationCalculatorTest, NearestNeighborResizing) {
   cv::Mat input_mat;
   cv::cvtColor(cv::imread(file::JoinPath("./",
@@ -319,6 +372,56 @@ TEST(ImageTransformationCalculatorTest,
   }
 }
 
+TEST(ImageTransformationCalculatorTest,
+     FrameBufferMatchesOpenCvForFlipAndScale) {
+  const Packet input_image = MakeGradientImage(16, 8);
+  // Nearest neighbor upscaling and downscaling, and area downscaling, all run
+  // through cv::resize, so both paths must agree exactly.
+  const std::vector<std::string> scalings{
+      "output_width: 24 output_height: 20 interpolation_mode: NEAREST",
+      "output_width: 8 output_height: 4 interpolation_mode: NEAREST",
+      "output_width: 8 output_height: 4"};
+  for (const std::string& scaling : scalings) {
+    const std::string options = absl::StrCat(
+        "scale_mode: STRETCH flip_horizontally: true flip_vertically: true ",
+        scaling);
+    EXPECT_EQ(MaxDifference(RunCpuTransformation(options, true, input_image),
+                            RunCpuTransformation(options, false, input_image)),
+              0)
+        << options;
+  }
+}
+
+TEST(ImageTransformationCalculatorTest,
+     FrameBufferMatchesOpenCvForFitLetterbox) {
+  const Packet input_image = MakeGradientImage(16, 8);
+  // Area downscaling and nearest neighbor upscaling into the letterbox.
+  const std::vector<std::string> scalings{
+      "output_width: 12 output_height: 12",
+      "output_width: 32 output_height: 32 interpolation_mode: NEAREST"};
+  for (const std::string& scaling : scalings) {
+    const std::string options = absl::StrCat(
+        "scale_mode: FIT padding_color { red: 10 green: 20 blue: 30 } ",
+        scaling);
+    EXPECT_EQ(MaxDifference(RunCpuTransformation(options, true, input_image),
+                            RunCpuTransformation(options, false, input_image)),
+              0)
+        << options;
+  }
+}
+
+TEST(ImageTransformationCalculatorTest,
+     FrameBufferIsCloseToOpenCvForBilinearStretch) {
+  const Packet input_image = MakeGradientImage(16, 8);
+  const std::string options =
+      "scale_mode: STRETCH output_width: 24 output_height: 20";
+  // The Halide kernel samples pixel corners rather than pixel centers, which
+  // is at most half a pixel away, plus rounding.
+  EXPECT_LE(MaxDifference(RunCpuTransformation(options, true, input_image),
+                          RunCpuTransformation(options, false, input_image)),
+            8);
+}
+
 TEST(ImageTransformationCalculatorTest, FitScalingClearsBackground) {
   // Regression test for not clearing the background in FIT scaling mode.
   // First scale an all-red (=r) image from 8x4 to 8x4, so it's a plain copy:
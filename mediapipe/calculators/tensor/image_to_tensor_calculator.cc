@@ -16,9 +16,9 @@
 #include <memory>
 #include <vector>
 
-#include "absl/log/absl_log.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_cpu.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -26,6 +26,7 @@
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/yuv_image.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -33,12 +34,6 @@
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/gpu/gpu_origin.pb.h"
 
-#if !MEDIAPIPE_DISABLE_OPENCV
-#include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
-#elif MEDIAPIPE_ENABLE_HALIDE
-#include "mediapipe/calculators/tensor/image_to_tensor_converter_frame_buffer.h"
-#endif
-
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gpu_buffer.h"
 
@@ -67,14 +62,18 @@ namespace api2 {
 //           ImageFrame [ImageFormat::SRGB/SRGBA] (for backward compatibility
 //           with existing graphs that use IMAGE for ImageFrame input)
 //   IMAGE_GPU - GpuBuffer [GpuBufferFormat::kBGRA32]
+//   YUV_IMAGE - YUVImage [NV12 / NV21 / I420 / YV12]
 //     Image to extract from.
 //
 //   Note:
-//   - One and only one of IMAGE and IMAGE_GPU should be specified.
+//   - One and only one of IMAGE, IMAGE_GPU and YUV_IMAGE should be specified.
 //   - IMAGE input of type Image is processed on GPU if the data is already on
 //     GPU (i.e., Image::UsesGpu() returns true), or otherwise processed on CPU.
 //   - IMAGE input of type ImageFrame is always processed on CPU.
 //   - IMAGE_GPU input (of type GpuBuffer) is always processed on GPU.
+//   - YUV_IMAGE input is always processed on CPU. Only the pixels sampled from
+//     the ROI are converted to RGB, which is much cheaper than converting the
+//     whole frame with YuvToImageCalculator first.
 //
 //   NORM_RECT - NormalizedRect @Optional
 //     Describes region of image to extract.
@@ -82,7 +81,8 @@ namespace api2 {
 //
 // Outputs:
 //   TENSORS - std::vector<Tensor>
-//     Vector containing a single Tensor populated with an extracted RGB image.
+//     Vector containing a single Tensor populated with an extracted RGB image
+//     (or the luma of a YUV_IMAGE when yuv_output_channels is 1).
 //   MATRIX - std::array<float, 16> @Optional
 //     An std::array<float, 16> representing a 4x4 row-major-order matrix that
 //     maps a point on the input image to a point on the output tensor, and
@@ -125,6 +125,7 @@ class ImageToTensorCalculator : public Node {
   static constexpr Input<
       OneOf<mediapipe::Image, mediapipe::ImageFrame>>::Optional kIn{"IMAGE"};
   static constexpr Input<GpuBuffer>::Optional kInGpu{"IMAGE_GPU"};
+  static constexpr Input<YUVImage>::Optional kInYuv{"YUV_IMAGE"};
   static constexpr Input<mediapipe::NormalizedRect>::Optional kInNormRect{
       "NORM_RECT"};
   static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
@@ -132,7 +133,7 @@ class ImageToTensorCalculator : public Node {
       "LETTERBOX_PADDING"};
   static constexpr Output<std::array<float, 16>>::Optional kOutMatrix{"MATRIX"};
 
-  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInNormRect, kOutTensors,
+  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInYuv, kInNormRect, kOutTensors,
                           kOutLetterboxPadding, kOutMatrix);
 
   static absl::Status UpdateContract(CalculatorContract* cc) {
@@ -140,8 +141,14 @@ class ImageToTensorCalculator : public Node {
         cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
 
     RET_CHECK_OK(ValidateOptionOutputDims(options));
-    RET_CHECK(kIn(cc).IsConnected() ^ kInGpu(cc).IsConnected())
-        << "One and only one of IMAGE and IMAGE_GPU input is expected.";
+    RET_CHECK_EQ(kIn(cc).IsConnected() + kInGpu(cc).IsConnected() +
+                     kInYuv(cc).IsConnected(),
+                 1)
+        << "One and only one of IMAGE, IMAGE_GPU and YUV_IMAGE input is "
+           "expected.";
+    RET_CHECK(options.yuv_output_channels() == 1 ||
+              options.yuv_output_channels() == 3)
+        << "yuv_output_channels must be 1 or 3.";
 
 #if MEDIAPIPE_DISABLE_GPU
     if (kInGpu(cc).IsConnected()) {
@@ -167,7 +174,8 @@ class ImageToTensorCalculator : public Node {
 
   absl::Status Process(CalculatorContext* cc) {
     if ((kIn(cc).IsConnected() && kIn(cc).IsEmpty()) ||
-        (kInGpu(cc).IsConnected() && kInGpu(cc).IsEmpty())) {
+        (kInGpu(cc).IsConnected() && kInGpu(cc).IsEmpty()) ||
+        (kInYuv(cc).IsConnected() && kInYuv(cc).IsEmpty())) {
       // Timestamp bound update happens automatically.
       return absl::OkStatus();
     }
@@ -191,6 +199,10 @@ class ImageToTensorCalculator : public Node {
       }
     }
 
+    if (kInYuv(cc).IsConnected()) {
+      return ProcessYuvImage(cc, *kInYuv(cc), norm_rect);
+    }
+
 #if MEDIAPIPE_DISABLE_GPU
     MP_ASSIGN_OR_RETURN(auto image, GetInputImage(kIn(cc)));
 #else
@@ -199,22 +211,11 @@ class ImageToTensorCalculator : public Node {
                                                  : GetInputImage(kIn(cc)));
 #endif  // MEDIAPIPE_DISABLE_GPU
 
-    RotatedRect roi = GetRoi(image->width(), image->height(), norm_rect);
     const int tensor_width = params_.output_width.value_or(image->width());
     const int tensor_height = params_.output_height.value_or(image->height());
-    MP_ASSIGN_OR_RETURN(auto padding,
-                        PadRoi(tensor_width, tensor_height,
-                               options_.keep_aspect_ratio(), &roi));
-    if (kOutLetterboxPadding(cc).IsConnected()) {
-      kOutLetterboxPadding(cc).Send(padding);
-    }
-    if (kOutMatrix(cc).IsConnected()) {
-      std::array<float, 16> matrix;
-      GetRotatedSubRectToRectTransformMatrix(
-          roi, image->width(), image->height(),
-          /*flip_horizontally=*/false, &matrix);
-      kOutMatrix(cc).Send(std::move(matrix));
-    }
+    MP_ASSIGN_OR_RETURN(
+        RotatedRect roi,
+        GetPaddedRoi(cc, image->width(), image->height(), norm_rect));
 
     // Lazy initialization of the GPU or CPU converter.
     MP_RETURN_IF_ERROR(InitConverterIfNecessary(cc, *image.get()));
@@ -236,6 +237,60 @@ class ImageToTensorCalculator : public Node {
   }
 
  private:
+  // Returns the ROI to extract from an image of the given size, padded to the
+  // aspect ratio of the tensor if needed, and sends the LETTERBOX_PADDING and
+  // MATRIX outputs that describe it.
+  absl::StatusOr<RotatedRect> GetPaddedRoi(
+      CalculatorContext* cc, int image_width, int image_height,
+      const absl::optional<mediapipe::NormalizedRect>& norm_rect) {
+    RotatedRect roi = GetRoi(image_width, image_height, norm_rect);
+    const int tensor_width = params_.output_width.value_or(image_width);
+    const int tensor_height = params_.output_height.value_or(image_height);
+    MP_ASSIGN_OR_RETURN(auto padding,
+                        PadRoi(tensor_width, tensor_height,
+                               options_.keep_aspect_ratio(), &roi));
+    if (kOutLetterboxPadding(cc).IsConnected()) {
+      kOutLetterboxPadding(cc).Send(padding);
+    }
+    if (kOutMatrix(cc).IsConnected()) {
+      std::array<float, 16> matrix;
+      GetRotatedSubRectToRectTransformMatrix(roi, image_width, image_height,
+                                             /*flip_horizontally=*/false,
+                                             &matrix);
+      kOutMatrix(cc).Send(std::move(matrix));
+    }
+    return roi;
+  }
+
+  absl::Status ProcessYuvImage(
+      CalculatorContext* cc, const YUVImage& image,
+      const absl::optional<mediapipe::NormalizedRect>& norm_rect) {
+    const int tensor_width = params_.output_width.value_or(image.width());
+    const int tensor_height = params_.output_height.value_or(image.height());
+    MP_ASSIGN_OR_RETURN(
+        RotatedRect roi,
+        GetPaddedRoi(cc, image.width(), image.height(), norm_rect));
+
+    const Tensor::ElementType output_tensor_type =
+        GetOutputTensorType(/*uses_gpu=*/false, params_);
+    if (!yuv_converter_) {
+      MP_ASSIGN_OR_RETURN(
+          yuv_converter_,
+          CreateCpuYuvConverter(cc, GetBorderMode(options_.border_mode()),
+                                output_tensor_type));
+    }
+    Tensor tensor(output_tensor_type, {1, tensor_height, tensor_width,
+                                       options_.yuv_output_channels()});
+    MP_RETURN_IF_ERROR(yuv_converter_->Convert(
+        image, roi, params_.range_min, params_.range_max,
+        /*tensor_buffer_offset=*/0, tensor));
+
+    auto result = std::make_unique<std::vector<Tensor>>();
+    result->push_back(std::move(tensor));
+    kOutTensors(cc).Send(std::move(result));
+    return absl::OkStatus();
+  }
+
   absl::Status InitConverterIfNecessary(CalculatorContext* cc,
                                         const Image& image) {
     // Lazy initialization of the GPU or CPU converter.
@@ -272,26 +327,11 @@ class ImageToTensorCalculator : public Node {
       }
     } else {
       if (!cpu_converter_) {
-#if !MEDIAPIPE_DISABLE_OPENCV
         MP_ASSIGN_OR_RETURN(
             cpu_converter_,
-            CreateOpenCvConverter(
+            CreateCpuConverter(
                 cc, GetBorderMode(options_.border_mode()),
                 GetOutputTensorType(/*uses_gpu=*/false, params_)));
-// TODO: FrameBuffer-based converter needs to call GetGpuBuffer()
-// to get access to a FrameBuffer view. Investigate if GetGpuBuffer() can be
-// made available even with MEDIAPIPE_DISABLE_GPU set.
-#elif MEDIAPIPE_ENABLE_HALIDE
-        MP_ASSIGN_OR_RETURN(
-            cpu_converter_,
-            CreateFrameBufferConverter(
-                cc, GetBorderMode(options_.border_mode()),
-                GetOutputTensorType(/*uses_gpu=*/false, params_)));
-#else
-        ABSL_LOG(FATAL) << "Cannot create image to tensor CPU converter since "
-                           "MEDIAPIPE_DISABLE_OPENCV is defined and "
-                           "MEDIAPIPE_ENABLE_HALIDE is not defined.";
-#endif  // !MEDIAPIPE_DISABLE_HALIDE
       }
     }
     return absl::OkStatus();
@@ -299,6 +339,7 @@ class ImageToTensorCalculator : public Node {
 
   std::unique_ptr<ImageToTensorConverter> gpu_converter_;
   std::unique_ptr<ImageToTensorConverter> cpu_converter_;
+  std::unique_ptr<YuvImageToTensorConverter> yuv_converter_;
   mediapipe::ImageToTensorCalculatorOptions options_;
   OutputTensorParams params_;
 };
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -22,6 +24,7 @@
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
+#include "libyuv/video_common.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -33,6 +36,8 @@
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/yuv_image.h"
+#include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
@@ -543,6 +548,121 @@ TEST(ImageToTensorCalculatorTest, CanBeUsedWithoutGpuServiceSet) {
   MP_ASSERT_OK(graph.WaitUntilDone());
 }
 
+TEST(ImageToTensorCalculatorTest, ConvertsRoiOfYuvImage) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "ImageToTensorCalculator"
+        input_stream: "YUV_IMAGE:image"
+        input_stream: "NORM_RECT:roi"
+        output_stream: "TENSORS:tensor"
+        output_stream: "MATRIX:matrix"
+        options {
+          [mediapipe.ImageToTensorCalculatorOptions.ext] {
+            output_tensor_width: 2
+            output_tensor_height: 1
+            output_tensor_float_range { min: 0.0 max: 255.0 }
+          }
+        }
+      )pb"));
+
+  // A full range 4x2 NV12 image whose luma is 10 * x, without chroma.
+  constexpr int kWidth = 4;
+  constexpr int kHeight = 2;
+  auto y_data = std::make_unique<uint8[]>(kWidth * kHeight);
+  for (int i = 0; i < kWidth * kHeight; ++i) y_data[i] = 10 * (i % kWidth);
+  auto uv_data = std::make_unique<uint8[]>(kWidth * kHeight / 2);
+  std::fill_n(uv_data.get(), kWidth * kHeight / 2, 128);
+  auto yuv_image = std::make_unique<YUVImage>(
+      libyuv::FOURCC_NV12, std::move(y_data), kWidth, std::move(uv_data),
+      kWidth, nullptr, 0, kWidth, kHeight);
+  yuv_image->set_full_range(true);
+  runner.MutableInputs()->Tag("YUV_IMAGE").packets.push_back(
+      Adopt(yuv_image.release()).At(Timestamp(0)));
+
+  // Covers the two middle columns.
+  auto roi = std::make_unique<mediapipe::NormalizedRect>();
+  roi->set_x_center(0.5f);
+  roi->set_y_center(0.5f);
+  roi->set_width(0.5f);
+  roi->set_height(1.0f);
+  runner.MutableInputs()->Tag("NORM_RECT").packets.push_back(
+      Adopt(roi.release()).At(Timestamp(0)));
+
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& tensor_packets = runner.Outputs().Tag("TENSORS").packets;
+  ASSERT_EQ(tensor_packets.size(), 1);
+  const Tensor& tensor = tensor_packets[0].Get<std::vector<Tensor>>()[0];
+  EXPECT_EQ(tensor.shape().dims, std::vector<int>({1, 1, 2, 3}));
+  auto view = tensor.GetCpuReadView();
+  const float* values = view.buffer<float>();
+  EXPECT_THAT(std::vector<float>(values, values + 6),
+              testing::Pointwise(testing::FloatNear(1e-3),
+                                 std::vector<float>{10, 10, 10, 20, 20, 20}));
+  EXPECT_EQ(runner.Outputs().Tag("MATRIX").packets.size(), 1);
+}
+
+TEST(ImageToTensorCalculatorTest, ConvertsLumaOfYuvImage) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "ImageToTensorCalculator"
+        input_stream: "YUV_IMAGE:image"
+        output_stream: "TENSORS:tensor"
+        options {
+          [mediapipe.ImageToTensorCalculatorOptions.ext] {
+            output_tensor_width: 4
+            output_tensor_height: 2
+            output_tensor_float_range { min: 0.0 max: 255.0 }
+            yuv_output_channels: 1
+          }
+        }
+      )pb"));
+
+  // A 4x2 NV12 image whose luma is 10 * x, with a chroma that would tint an
+  // RGB output.
+  constexpr int kWidth = 4;
+  constexpr int kHeight = 2;
+  auto y_data = std::make_unique<uint8[]>(kWidth * kHeight);
+  for (int i = 0; i < kWidth * kHeight; ++i) y_data[i] = 10 * (i % kWidth);
+  auto uv_data = std::make_unique<uint8[]>(kWidth * kHeight / 2);
+  std::fill_n(uv_data.get(), kWidth * kHeight / 2, 200);
+  auto yuv_image = std::make_unique<YUVImage>(
+      libyuv::FOURCC_NV12, std::move(y_data), kWidth, std::move(uv_data),
+      kWidth, nullptr, 0, kWidth, kHeight);
+  yuv_image->set_full_range(true);
+  runner.MutableInputs()->Tag("YUV_IMAGE").packets.push_back(
+      Adopt(yuv_image.release()).At(Timestamp(0)));
+
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& tensor_packets = runner.Outputs().Tag("TENSORS").packets;
+  ASSERT_EQ(tensor_packets.size(), 1);
+  const Tensor& tensor = tensor_packets[0].Get<std::vector<Tensor>>()[0];
+  EXPECT_EQ(tensor.shape().dims, std::vector<int>({1, 2, 4, 1}));
+  auto view = tensor.GetCpuReadView();
+  const float* values = view.buffer<float>();
+  EXPECT_THAT(std::vector<float>(values, values + 8),
+              testing::Pointwise(testing::FloatNear(1e-3),
+                                 std::vector<float>{0, 10, 20, 30, 0, 10, 20,
+                                                    30}));
+}
+
+TEST(ImageToTensorCalculatorTest, RejectsInvalidYuvOutputChannels) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "ImageToTensorCalculator"
+        input_stream: "YUV_IMAGE:image"
+        output_stream: "TENSORS:tensor"
+        options {
+          [mediapipe.ImageToTensorCalculatorOptions.ext] {
+            output_tensor_float_range { min: 0.0 max: 255.0 }
+            yuv_output_channels: 4
+          }
+        }
+      )pb"));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
 #if !MEDIAPIPE_DISABLE_GPU && !MEDIAPIPE_METAL_ENABLED
 
 TEST(ImageToTensorCalculatorTest,
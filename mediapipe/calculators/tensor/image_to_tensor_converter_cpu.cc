@@ -0,0 +1,568 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_cpu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "libyuv/video_common.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/yuv_image.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The two source pixels that bilinear interpolation blends along one axis.
+struct Taps {
+  int index0;
+  int index1;
+  float weight0;
+  float weight1;
+};
+
+// Returns the taps of source coordinate "coord" along an axis of "size"
+// pixels. The indices are clamped into the image, which replicates the border
+// pixels. With "zero_border", taps outside the image get weight 0 instead.
+inline Taps GetTaps(float coord, int size, bool zero_border) {
+  // All taps beyond the border are clamped, so bounding the coordinate
+  // changes nothing but keeps the conversion to int defined.
+  coord = std::clamp(coord, -2.0f, static_cast<float>(size) + 1.0f);
+  const float floor_coord = std::floor(coord);
+  const int index0 = static_cast<int>(floor_coord);
+  const float weight1 = coord - floor_coord;
+  Taps taps = {index0, index0 + 1, 1.0f - weight1, weight1};
+  if (zero_border) {
+    if (index0 < 0 || index0 >= size) taps.weight0 = 0.0f;
+    if (index0 + 1 < 0 || index0 + 1 >= size) taps.weight1 = 0.0f;
+  }
+  taps.index0 = std::clamp(taps.index0, 0, size - 1);
+  taps.index1 = std::clamp(taps.index1, 0, size - 1);
+  return taps;
+}
+
+// Writes a normalized value to the tensor. Integer values are rounded and
+// saturated, as by cv::Mat::convertTo.
+inline void Store(float value, float* out) { *out = value; }
+inline void Store(float value, uint8_t* out) {
+  *out = static_cast<uint8_t>(std::clamp(std::nearbyint(value), 0.0f, 255.0f));
+}
+inline void Store(float value, int8_t* out) {
+  *out =
+      static_cast<int8_t>(std::clamp(std::nearbyint(value), -128.0f, 127.0f));
+}
+
+// Where and how to sample the source image.
+struct SamplingParams {
+  const uint8_t* src;
+  int src_width;
+  int src_height;
+  int src_step;
+  // Output pixel (x, y) samples the source at
+  // (origin_x + x * dx_x + y * dy_x, origin_y + x * dx_y + y * dy_y).
+  float origin_x;
+  float origin_y;
+  float dx_x;
+  float dx_y;
+  float dy_x;
+  float dy_y;
+  bool zero_border;
+  ValueTransformation transform;
+  int dst_width;
+  int dst_height;
+};
+
+// Samples an ROI which is not rotated: the source column only depends on the
+// output column and the source row only on the output row. Each output row
+// blends the two source rows it reads, over the columns the ROI covers, then
+// blends the columns of that row.
+//
+// A gray source fills all output channels, and alpha is dropped.
+template <int kSrcChannels, int kDstChannels, typename T>
+void SampleAxisAligned(const SamplingParams& p, std::vector<Taps>& column_taps,
+                       std::vector<float>& blended_row, T* dst) {
+  column_taps.resize(p.dst_width);
+  int first_column = p.src_width - 1;
+  int last_column = 0;
+  for (int x = 0; x < p.dst_width; ++x) {
+    const Taps taps =
+        GetTaps(p.origin_x + x * p.dx_x, p.src_width, p.zero_border);
+    first_column = std::min(first_column, taps.index0);
+    last_column = std::max(last_column, taps.index1);
+    column_taps[x] = taps;
+  }
+  for (Taps& taps : column_taps) {
+    taps.index0 = (taps.index0 - first_column) * kSrcChannels;
+    taps.index1 = (taps.index1 - first_column) * kSrcChannels;
+  }
+  const int row_size = (last_column - first_column + 1) * kSrcChannels;
+  blended_row.resize(row_size);
+
+  const float scale = p.transform.scale;
+  const float offset = p.transform.offset;
+  for (int y = 0; y < p.dst_height; ++y) {
+    const Taps row_taps =
+        GetTaps(p.origin_y + y * p.dy_y, p.src_height, p.zero_border);
+    const uint8_t* row0 = p.src + row_taps.index0 * p.src_step +
+                          first_column * kSrcChannels;
+    const uint8_t* row1 = p.src + row_taps.index1 * p.src_step +
+                          first_column * kSrcChannels;
+    float* blended = blended_row.data();
+    for (int i = 0; i < row_size; ++i) {
+      blended[i] = row0[i] * row_taps.weight0 + row1[i] * row_taps.weight1;
+    }
+    for (int x = 0; x < p.dst_width; ++x) {
+      const Taps& taps = column_taps[x];
+      const float* pixel0 = blended + taps.index0;
+      const float* pixel1 = blended + taps.index1;
+      for (int c = 0; c < kDstChannels; ++c) {
+        const int src_c = kSrcChannels == 1 ? 0 : c;
+        const float value =
+            pixel0[src_c] * taps.weight0 + pixel1[src_c] * taps.weight1;
+        Store(value * scale + offset, dst++);
+      }
+    }
+  }
+}
+
+// Samples a rotated ROI. The taps of a whole output row are computed before
+// the pixels are read, which keeps that loop free of gathers.
+template <int kSrcChannels, int kDstChannels, typename T>
+void SampleRotated(const SamplingParams& p, std::vector<Taps>& column_taps,
+                   std::vector<Taps>& row_taps, T* dst) {
+  column_taps.resize(p.dst_width);
+  row_taps.resize(p.dst_width);
+  const float scale = p.transform.scale;
+  const float offset = p.transform.offset;
+  for (int y = 0; y < p.dst_height; ++y) {
+    const float row_x = p.origin_x + y * p.dy_x;
+    const float row_y = p.origin_y + y * p.dy_y;
+    for (int x = 0; x < p.dst_width; ++x) {
+      column_taps[x] = GetTaps(row_x + x * p.dx_x, p.src_width, p.zero_border);
+      row_taps[x] = GetTaps(row_y + x * p.dx_y, p.src_height, p.zero_border);
+    }
+    for (int x = 0; x < p.dst_width; ++x) {
+      const Taps& cols = column_taps[x];
+      const Taps& rows = row_taps[x];
+      const uint8_t* row0 = p.src + rows.index0 * p.src_step;
+      const uint8_t* row1 = p.src + rows.index1 * p.src_step;
+      const int col0 = cols.index0 * kSrcChannels;
+      const int col1 = cols.index1 * kSrcChannels;
+      for (int c = 0; c < kDstChannels; ++c) {
+        const int src_c = kSrcChannels == 1 ? 0 : c;
+        const float top = row0[col0 + src_c] * cols.weight0 +
+                          row0[col1 + src_c] * cols.weight1;
+        const float bottom = row1[col0 + src_c] * cols.weight0 +
+                             row1[col1 + src_c] * cols.weight1;
+        const float value = top * rows.weight0 + bottom * rows.weight1;
+        Store(value * scale + offset, dst++);
+      }
+    }
+  }
+}
+
+// Planes of an 8-bit YUV 4:2:0 image. Pixel (x, y) reads its chroma at
+// (x / 2) * uv_pixel_step + (y / 2) * u_step (or v_step) in the U and V
+// planes.
+struct YuvPlanes {
+  const uint8_t* y;
+  const uint8_t* u;
+  const uint8_t* v;
+  int y_step;
+  int u_step;
+  int v_step;
+  int uv_pixel_step;
+};
+
+absl::StatusOr<YuvPlanes> GetYuvPlanes(const YUVImage& image) {
+  RET_CHECK_EQ(image.bit_depth(), 8) << "Only 8-bit YUV images are supported.";
+  switch (image.fourcc()) {
+    case libyuv::FOURCC_NV12:
+      return YuvPlanes{image.data(0), image.data(1), image.data(1) + 1,
+                       image.stride(0), image.stride(1), image.stride(1),
+                       /*uv_pixel_step=*/2};
+    case libyuv::FOURCC_NV21:
+      return YuvPlanes{image.data(0), image.data(1) + 1, image.data(1),
+                       image.stride(0), image.stride(1), image.stride(1),
+                       /*uv_pixel_step=*/2};
+    case libyuv::FOURCC_I420:
+      return YuvPlanes{image.data(0), image.data(1), image.data(2),
+                       image.stride(0), image.stride(1), image.stride(2),
+                       /*uv_pixel_step=*/1};
+    case libyuv::FOURCC_YV12:
+      return YuvPlanes{image.data(0), image.data(2), image.data(1),
+                       image.stride(0), image.stride(2), image.stride(1),
+                       /*uv_pixel_step=*/1};
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported YUV format: ",
+                       static_cast<uint32_t>(image.fourcc()),
+                       ". Only NV12, NV21, I420 and YV12 are supported."));
+  }
+}
+
+// Converts YUV to RGB as
+//   R = y_scale * (Y - y_offset) + v_to_r * (V - 128)
+//   G = y_scale * (Y - y_offset) + u_to_g * (U - 128) + v_to_g * (V - 128)
+//   B = y_scale * (Y - y_offset) + u_to_b * (U - 128)
+struct YuvToRgbCoefficients {
+  float y_scale;
+  float y_offset;
+  float v_to_r;
+  float u_to_g;
+  float v_to_g;
+  float u_to_b;
+};
+
+// Returns the coefficients for the luma weights "kr" and "kb" of a color
+// matrix. Limited range images have luma in [16, 235] and chroma in
+// [16, 240].
+YuvToRgbCoefficients GetYuvToRgbCoefficients(float kr, float kb,
+                                              bool full_range) {
+  const float kg = 1.0f - kr - kb;
+  const float uv_scale = full_range ? 1.0f : 255.0f / 224.0f;
+  return {/*y_scale=*/full_range ? 1.0f : 255.0f / 219.0f,
+          /*y_offset=*/full_range ? 0.0f : 16.0f,
+          /*v_to_r=*/2.0f * (1.0f - kr) * uv_scale,
+          /*u_to_g=*/-2.0f * (1.0f - kb) * kb / kg * uv_scale,
+          /*v_to_g=*/-2.0f * (1.0f - kr) * kr / kg * uv_scale,
+          /*u_to_b=*/2.0f * (1.0f - kb) * uv_scale};
+}
+
+absl::StatusOr<YuvToRgbCoefficients> GetYuvToRgbCoefficients(
+    const YUVImage& image) {
+  switch (image.matrix_coefficients()) {
+    case YUVImage::COLOR_MATRIX_COEFFICIENTS_UNSPECIFIED:
+    case YUVImage::COLOR_MATRIX_COEFFICIENTS_BT470BG:
+    case YUVImage::COLOR_MATRIX_COEFFICIENTS_SMPTE170M:
+      return GetYuvToRgbCoefficients(0.299f, 0.114f, image.full_range());
+    case YUVImage::COLOR_MATRIX_COEFFICIENTS_BT709:
+      return GetYuvToRgbCoefficients(0.2126f, 0.0722f, image.full_range());
+    case YUVImage::COLOR_MATRIX_COEFFICIENTS_BT2020_NCL:
+      return GetYuvToRgbCoefficients(0.2627f, 0.0593f, image.full_range());
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported YUV color matrix: ",
+                       static_cast<int>(image.matrix_coefficients())));
+  }
+}
+
+// Converts source pixel (x, y) to RGB, saturated as in an RGB image.
+inline void GetRgb(const YuvPlanes& planes, const YuvToRgbCoefficients& k,
+                   int x, int y, float* rgb) {
+  const float luma = k.y_scale * (planes.y[y * planes.y_step + x] - k.y_offset);
+  const int uv_x = (x / 2) * planes.uv_pixel_step;
+  const float u = planes.u[(y / 2) * planes.u_step + uv_x] - 128.0f;
+  const float v = planes.v[(y / 2) * planes.v_step + uv_x] - 128.0f;
+  rgb[0] = std::clamp(luma + k.v_to_r * v, 0.0f, 255.0f);
+  rgb[1] = std::clamp(luma + k.u_to_g * u + k.v_to_g * v, 0.0f, 255.0f);
+  rgb[2] = std::clamp(luma + k.u_to_b * u, 0.0f, 255.0f);
+}
+
+// Samples a YUV image into an RGB tensor. Only the four source pixels each
+// output pixel blends are converted to RGB, so the cost does not depend on
+// the size of the image. The result matches sampling the image converted to
+// RGB, up to the rounding of that RGB image.
+template <typename T>
+void SampleYuv(const SamplingParams& p, const YuvPlanes& planes,
+               const YuvToRgbCoefficients& k, std::vector<Taps>& column_taps,
+               std::vector<Taps>& row_taps, T* dst) {
+  column_taps.resize(p.dst_width);
+  row_taps.resize(p.dst_width);
+  const float scale = p.transform.scale;
+  const float offset = p.transform.offset;
+  for (int y = 0; y < p.dst_height; ++y) {
+    const float row_x = p.origin_x + y * p.dy_x;
+    const float row_y = p.origin_y + y * p.dy_y;
+    for (int x = 0; x < p.dst_width; ++x) {
+      column_taps[x] = GetTaps(row_x + x * p.dx_x, p.src_width, p.zero_border);
+      row_taps[x] = GetTaps(row_y + x * p.dx_y, p.src_height, p.zero_border);
+    }
+    for (int x = 0; x < p.dst_width; ++x) {
+      const Taps& cols = column_taps[x];
+      const Taps& rows = row_taps[x];
+      float rgb00[3], rgb01[3], rgb10[3], rgb11[3];
+      GetRgb(planes, k, cols.index0, rows.index0, rgb00);
+      GetRgb(planes, k, cols.index1, rows.index0, rgb01);
+      GetRgb(planes, k, cols.index0, rows.index1, rgb10);
+      GetRgb(planes, k, cols.index1, rows.index1, rgb11);
+      for (int c = 0; c < 3; ++c) {
+        const float top = rgb00[c] * cols.weight0 + rgb01[c] * cols.weight1;
+        const float bottom = rgb10[c] * cols.weight0 + rgb11[c] * cols.weight1;
+        const float value = top * rows.weight0 + bottom * rows.weight1;
+        Store(value * scale + offset, dst++);
+      }
+    }
+  }
+}
+
+absl::Status ValidateTensorShape(const Tensor::Shape& output_shape) {
+  RET_CHECK_EQ(output_shape.dims.size(), 4)
+      << "Wrong output dims size: " << output_shape.dims.size();
+  RET_CHECK_GE(output_shape.dims[0], 1)
+      << "The batch dimension needs to be equal or larger than 1.";
+  RET_CHECK(output_shape.dims[1] >= 1 && output_shape.dims[2] >= 1)
+      << "Wrong output size: " << output_shape.dims[2] << "x"
+      << output_shape.dims[1];
+  RET_CHECK(output_shape.dims[3] == 3 || output_shape.dims[3] == 1)
+      << "Wrong output channel: " << output_shape.dims[3];
+  return absl::OkStatus();
+}
+
+// Returns how to sample "roi" of a "src_width" x "src_height" image into a
+// tensor of "output_shape". The source pointer is left to the caller.
+absl::StatusOr<SamplingParams> GetSamplingParams(
+    const RotatedRect& roi, int src_width, int src_height,
+    const Tensor::Shape& output_shape, BorderMode border_mode, float range_min,
+    float range_max) {
+  constexpr float kInputImageRangeMin = 0.0f;
+  constexpr float kInputImageRangeMax = 255.0f;
+  MP_ASSIGN_OR_RETURN(
+      const ValueTransformation transform,
+      GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
+                                  range_min, range_max));
+
+  // Maps the corners of the output to the corners of the ROI, as
+  // cv::getPerspectiveTransform does for the OpenCV converter.
+  const int output_height = output_shape.dims[1];
+  const int output_width = output_shape.dims[2];
+  const float cos_r = std::cos(roi.rotation);
+  const float sin_r = std::sin(roi.rotation);
+  SamplingParams params;
+  params.src = nullptr;
+  params.src_width = src_width;
+  params.src_height = src_height;
+  params.src_step = 0;
+  params.origin_x =
+      roi.center_x - 0.5f * (roi.width * cos_r - roi.height * sin_r);
+  params.origin_y =
+      roi.center_y - 0.5f * (roi.width * sin_r + roi.height * cos_r);
+  params.dx_x = roi.width * cos_r / output_width;
+  params.dx_y = roi.width * sin_r / output_width;
+  params.dy_x = -roi.height * sin_r / output_height;
+  params.dy_y = roi.height * cos_r / output_height;
+  params.zero_border = border_mode == BorderMode::kZero;
+  params.transform = transform;
+  params.dst_width = output_width;
+  params.dst_height = output_height;
+  return params;
+}
+
+// Calls "sample" with the element at byte "tensor_buffer_offset" of the
+// tensor, as a pointer to "tensor_type", after checking that "num_values"
+// values fit from there on.
+template <typename SampleFn>
+absl::Status SampleIntoTensor(Tensor::ElementType tensor_type,
+                              int tensor_buffer_offset, int num_values,
+                              Tensor& output_tensor, SampleFn sample) {
+  RET_CHECK_GE(tensor_buffer_offset, 0)
+      << "The input tensor_buffer_offset needs to be non-negative.";
+  const int num_elements = output_tensor.shape().num_elements();
+  auto buffer_view = output_tensor.GetCpuWriteView();
+  auto sample_at = [&](auto* buffer) -> absl::Status {
+    const int offset = tensor_buffer_offset / sizeof(*buffer);
+    RET_CHECK_GE(num_elements, offset + num_values)
+        << "The buffer offset + the input image size is larger than the "
+           "allocated tensor buffer.";
+    return sample(buffer + offset);
+  };
+  switch (tensor_type) {
+    case Tensor::ElementType::kFloat32:
+      return sample_at(buffer_view.buffer<float>());
+    case Tensor::ElementType::kUInt8:
+      return sample_at(buffer_view.buffer<uint8_t>());
+    case Tensor::ElementType::kInt8:
+      return sample_at(buffer_view.buffer<int8_t>());
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported tensor type: ", tensor_type));
+  }
+}
+
+// Scratch buffers of the samplers, kept to avoid allocations per frame.
+struct SamplingBuffers {
+  std::vector<Taps> column_taps;
+  std::vector<Taps> row_taps;
+  std::vector<float> blended_row;
+};
+
+template <int kSrcChannels, int kDstChannels, typename T>
+void SampleChannels(const SamplingParams& params, SamplingBuffers& buffers,
+                    T* dst) {
+  if (params.dx_y == 0.0f && params.dy_x == 0.0f) {
+    SampleAxisAligned<kSrcChannels, kDstChannels>(params, buffers.column_taps,
+                                                  buffers.blended_row, dst);
+  } else {
+    SampleRotated<kSrcChannels, kDstChannels>(params, buffers.column_taps,
+                                              buffers.row_taps, dst);
+  }
+}
+
+template <typename T>
+absl::Status Sample(const SamplingParams& params, int src_channels,
+                    int dst_channels, SamplingBuffers& buffers, T* dst) {
+  if (src_channels == 1 && dst_channels == 1) {
+    SampleChannels<1, 1>(params, buffers, dst);
+  } else if (src_channels == 1 && dst_channels == 3) {
+    SampleChannels<1, 3>(params, buffers, dst);
+  } else if (src_channels == 3 && dst_channels == 3) {
+    SampleChannels<3, 3>(params, buffers, dst);
+  } else if (src_channels == 4 && dst_channels == 3) {
+    SampleChannels<4, 3>(params, buffers, dst);
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported conversion from ", src_channels, " to ",
+                     dst_channels, " channels."));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ValidateTensorType(Tensor::ElementType tensor_type) {
+  if (tensor_type != Tensor::ElementType::kInt8 &&
+      tensor_type != Tensor::ElementType::kFloat32 &&
+      tensor_type != Tensor::ElementType::kUInt8) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Tensor type is currently not supported by CpuProcessor, type: ",
+        tensor_type));
+  }
+  return absl::OkStatus();
+}
+
+// Implementation of ImageToTensorConverter which fuses all steps of the
+// conversion into one pass.
+class CpuProcessor : public ImageToTensorConverter {
+ public:
+  CpuProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
+      : border_mode_(border_mode), tensor_type_(tensor_type) {}
+
+  absl::Status Convert(const mediapipe::Image& input, const RotatedRect& roi,
+                       float range_min, float range_max,
+                       int tensor_buffer_offset,
+                       Tensor& output_tensor) override {
+    const bool is_supported_format =
+        input.image_format() == mediapipe::ImageFormat::SRGB ||
+        input.image_format() == mediapipe::ImageFormat::SRGBA ||
+        input.image_format() == mediapipe::ImageFormat::GRAY8;
+    if (!is_supported_format) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unsupported format: ", static_cast<uint32_t>(input.image_format())));
+    }
+
+    const auto& output_shape = output_tensor.shape();
+    MP_RETURN_IF_ERROR(ValidateTensorShape(output_shape));
+    const int output_channels = output_shape.dims[3];
+    const int src_channels = input.channels();
+    RET_CHECK(output_channels == 3 || src_channels == 1)
+        << "Cannot convert a " << src_channels
+        << "-channel image to a 1-channel tensor.";
+
+    const ImageFrameSharedPtr frame = input.GetImageFrameSharedPtr();
+    MP_ASSIGN_OR_RETURN(
+        SamplingParams params,
+        GetSamplingParams(roi, frame->Width(), frame->Height(), output_shape,
+                          border_mode_, range_min, range_max));
+    params.src = frame->PixelData();
+    params.src_step = frame->WidthStep();
+
+    return SampleIntoTensor(
+        tensor_type_, tensor_buffer_offset,
+        params.dst_height * params.dst_width * output_channels, output_tensor,
+        [&](auto* dst) {
+          return Sample(params, src_channels, output_channels, buffers_, dst);
+        });
+  }
+
+ private:
+  BorderMode border_mode_;
+  Tensor::ElementType tensor_type_;
+  SamplingBuffers buffers_;
+};
+
+// Implementation of YuvImageToTensorConverter on the same samplers.
+class YuvCpuProcessor : public YuvImageToTensorConverter {
+ public:
+  YuvCpuProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
+      : border_mode_(border_mode), tensor_type_(tensor_type) {}
+
+  absl::Status Convert(const YUVImage& input, const RotatedRect& roi,
+                       float range_min, float range_max,
+                       int tensor_buffer_offset,
+                       Tensor& output_tensor) override {
+    MP_ASSIGN_OR_RETURN(const YuvPlanes planes, GetYuvPlanes(input));
+    MP_ASSIGN_OR_RETURN(const YuvToRgbCoefficients coefficients,
+                        GetYuvToRgbCoefficients(input));
+
+    const auto& output_shape = output_tensor.shape();
+    MP_RETURN_IF_ERROR(ValidateTensorShape(output_shape));
+    const int output_channels = output_shape.dims[3];
+    MP_ASSIGN_OR_RETURN(
+        SamplingParams params,
+        GetSamplingParams(roi, input.width(), input.height(), output_shape,
+                          border_mode_, range_min, range_max));
+    params.src = planes.y;
+    params.src_step = planes.y_step;
+
+    return SampleIntoTensor(
+        tensor_type_, tensor_buffer_offset,
+        params.dst_height * params.dst_width * output_channels, output_tensor,
+        [&](auto* dst) {
+          if (output_channels == 1) {
+            // A 1-channel tensor gets the luma, as a gray image.
+            return Sample(params, /*src_channels=*/1, /*dst_channels=*/1,
+                          buffers_, dst);
+          }
+          SampleYuv(params, planes, coefficients, buffers_.column_taps,
+                    buffers_.row_taps, dst);
+          return absl::OkStatus();
+        });
+  }
+
+ private:
+  BorderMode border_mode_;
+  Tensor::ElementType tensor_type_;
+  SamplingBuffers buffers_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateCpuConverter(
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type) {
+  MP_RETURN_IF_ERROR(ValidateTensorType(tensor_type));
+  return std::make_unique<CpuProcessor>(border_mode, tensor_type);
+}
+
+absl::StatusOr<std::unique_ptr<YuvImageToTensorConverter>>
+CreateCpuYuvConverter(CalculatorContext* cc, BorderMode border_mode,
+                      Tensor::ElementType tensor_type) {
+  MP_RETURN_IF_ERROR(ValidateTensorType(tensor_type));
+  return std::make_unique<YuvCpuProcessor>(border_mode, tensor_type);
+}
+
+}  // namespace mediapipe
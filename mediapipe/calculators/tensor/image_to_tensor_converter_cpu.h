@@ -0,0 +1,67 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CONVERTER_CPU_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CONVERTER_CPU_H_
+
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/yuv_image.h"
+
+namespace mediapipe {
+
+// Creates a CPU image-to-tensor converter that samples the ROI, interpolates
+// bilinearly, selects the channels and normalizes the values in a single pass
+// over the output tensor, without intermediate images. Axis-aligned ROIs take
+// a separable fast path.
+//
+// Supports SRGB, SRGBA and GRAY8 images, and tensors of 1 or 3 channels of
+// type kFloat32, kUInt8 or kInt8. Sampling matches the OpenCV converter.
+// Needs neither OpenCV nor Halide.
+absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateCpuConverter(
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type);
+
+// Converts the ROI of a YUV image into a tensor.
+class YuvImageToTensorConverter {
+ public:
+  virtual ~YuvImageToTensorConverter() = default;
+
+  // Same as ImageToTensorConverter::Convert, for a YUV image.
+  virtual absl::Status Convert(const YUVImage& input, const RotatedRect& roi,
+                               float range_min, float range_max,
+                               int tensor_buffer_offset,
+                               Tensor& output_tensor) = 0;
+};
+
+// Creates a CPU converter like the one above which reads the planes of a YUV
+// image directly. Only the pixels that are sampled get converted to RGB, so
+// small ROIs of large frames no longer pay for a full frame conversion.
+//
+// Supports 8-bit NV12, NV21, I420 and YV12 images. The conversion follows the
+// color matrix (BT.601 unless BT.709 or BT.2020 is set) and the range of the
+// image, so the default limited range BT.601 images convert like they do in
+// YuvToImageCalculator. 1-channel tensors get the luma.
+absl::StatusOr<std::unique_ptr<YuvImageToTensorConverter>>
+CreateCpuYuvConverter(CalculatorContext* cc, BorderMode border_mode,
+                      Tensor::ElementType tensor_type);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CONVERTER_CPU_H_
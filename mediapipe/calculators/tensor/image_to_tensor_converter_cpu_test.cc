@@ -0,0 +1,333 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_cpu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "libyuv/video_common.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/yuv_image.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+// Returns an image whose channel "c" of pixel ("x", "y") is value(x, y, c).
+Image MakeImage(ImageFormat::Format format, int width, int height,
+                std::function<uint8_t(int x, int y, int c)> value) {
+  auto frame = std::make_shared<ImageFrame>(format, width, height);
+  const int channels = frame->NumberOfChannels();
+  for (int y = 0; y < height; ++y) {
+    uint8_t* row = frame->MutablePixelData() + y * frame->WidthStep();
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < channels; ++c) {
+        row[x * channels + c] = value(x, y, c);
+      }
+    }
+  }
+  return Image(std::move(frame));
+}
+
+template <typename T>
+std::vector<T> GetValues(const Tensor& tensor) {
+  auto view = tensor.GetCpuReadView();
+  const T* data = view.buffer<T>();
+  return std::vector<T>(data, data + tensor.shape().num_elements());
+}
+
+// Converts "image" into a float tensor of values in [0, 255].
+std::vector<float> Convert(const Image& image, const RotatedRect& roi,
+                           BorderMode border_mode, int width, int height,
+                           int channels) {
+  auto converter =
+      CreateCpuConverter(nullptr, border_mode, Tensor::ElementType::kFloat32);
+  ABSL_CHECK_OK(converter);
+  Tensor tensor(Tensor::ElementType::kFloat32, {1, height, width, channels});
+  ABSL_CHECK_OK((*converter)->Convert(image, roi, 0.0f, 255.0f,
+                                      /*tensor_buffer_offset=*/0, tensor));
+  return GetValues<float>(tensor);
+}
+
+TEST(ImageToTensorConverterCpuTest, CopiesPixelsOfFullImage) {
+  const Image image = MakeImage(
+      ImageFormat::SRGB, 5, 4,
+      [](int x, int y, int c) { return (y * 5 + x) * 3 + c; });
+  const std::vector<float> values =
+      Convert(image, {/*center_x=*/2.5f, /*center_y=*/2.0f, /*width=*/5.0f,
+                      /*height=*/4.0f, /*rotation=*/0.0f},
+              BorderMode::kReplicate, 5, 4, 3);
+  std::vector<float> expected(5 * 4 * 3);
+  for (int i = 0; i < expected.size(); ++i) expected[i] = i;
+  EXPECT_THAT(values, ElementsAreArray(expected));
+}
+
+TEST(ImageToTensorConverterCpuTest, RotatesRoi) {
+  const Image image =
+      MakeImage(ImageFormat::GRAY8, 3, 3,
+                [](int x, int y, int) { return 10 * y + x + 1; });
+  const RotatedRect roi = {1.5f, 1.5f, 3.0f, 3.0f, static_cast<float>(M_PI_2)};
+  // Output pixel (x, y) samples source pixel (3 - y, x), so the first row
+  // samples beyond the right border.
+  EXPECT_THAT(Convert(image, roi, BorderMode::kZero, 3, 3, 1),
+              Pointwise(FloatNear(1e-3), std::vector<float>{
+                                             0, 0, 0,     //
+                                             3, 13, 23,   //
+                                             2, 12, 22}));
+  EXPECT_THAT(Convert(image, roi, BorderMode::kReplicate, 3, 3, 1),
+              Pointwise(FloatNear(1e-3), std::vector<float>{
+                                             3, 13, 23,   //
+                                             3, 13, 23,   //
+                                             2, 12, 22}));
+}
+
+TEST(ImageToTensorConverterCpuTest, AxisAlignedRoiMatchesRotatedRoi) {
+  const Image image =
+      MakeImage(ImageFormat::SRGBA, 17, 13, [](int x, int y, int c) {
+        return (x * 37 + y * 91 + c * 53) % 256;
+      });
+  // The second ROI reaches beyond the top left corner of the image.
+  const RotatedRect rois[] = {{7.3f, 6.1f, 11.7f, 9.2f, 0.0f},
+                              {2.0f, 3.0f, 12.0f, 10.0f, 0.0f}};
+  for (BorderMode border_mode : {BorderMode::kZero, BorderMode::kReplicate}) {
+    for (const RotatedRect& roi : rois) {
+      RotatedRect turned_roi = roi;
+      // Turns the ROI once around, which samples through the rotated path.
+      turned_roi.rotation = 2 * M_PI;
+      EXPECT_THAT(Convert(image, roi, border_mode, 8, 6, 3),
+                  Pointwise(FloatNear(1e-2),
+                            Convert(image, turned_roi, border_mode, 8, 6, 3)));
+    }
+  }
+}
+
+TEST(ImageToTensorConverterCpuTest, ReplicatesGrayChannel) {
+  const Image image = MakeImage(ImageFormat::GRAY8, 2, 1,
+                                [](int x, int, int) { return x + 1; });
+  EXPECT_THAT(Convert(image, {1.0f, 0.5f, 2.0f, 1.0f, 0.0f},
+                      BorderMode::kReplicate, 2, 1, 3),
+              ElementsAre(1, 1, 1, 2, 2, 2));
+}
+
+TEST(ImageToTensorConverterCpuTest, RoundsAndSaturatesIntegers) {
+  const Image image = MakeImage(ImageFormat::GRAY8, 3, 1, [](int x, int, int) {
+    return std::vector<uint8_t>{0, 100, 200}[x];
+  });
+  const RotatedRect roi = {1.5f, 0.5f, 3.0f, 1.0f, 0.0f};
+
+  auto uint8_converter = CreateCpuConverter(nullptr, BorderMode::kReplicate,
+                                            Tensor::ElementType::kUInt8);
+  MP_ASSERT_OK(uint8_converter);
+  Tensor uint8_tensor(Tensor::ElementType::kUInt8, {1, 1, 3, 1});
+  MP_ASSERT_OK((*uint8_converter)
+                   ->Convert(image, roi, 0.0f, 510.0f,
+                             /*tensor_buffer_offset=*/0, uint8_tensor));
+  EXPECT_THAT(GetValues<uint8_t>(uint8_tensor), ElementsAre(0, 200, 255));
+
+  auto int8_converter = CreateCpuConverter(nullptr, BorderMode::kReplicate,
+                                           Tensor::ElementType::kInt8);
+  MP_ASSERT_OK(int8_converter);
+  Tensor int8_tensor(Tensor::ElementType::kInt8, {1, 1, 3, 1});
+  MP_ASSERT_OK((*int8_converter)
+                   ->Convert(image, roi, -128.0f, 127.0f,
+                             /*tensor_buffer_offset=*/0, int8_tensor));
+  EXPECT_THAT(GetValues<int8_t>(int8_tensor), ElementsAre(-128, -28, 72));
+}
+
+TEST(ImageToTensorConverterCpuTest, WritesAtBufferOffset) {
+  const Image image =
+      MakeImage(ImageFormat::GRAY8, 2, 2, [](int, int, int) { return 7; });
+  const RotatedRect roi = {1.0f, 1.0f, 2.0f, 2.0f, 0.0f};
+  auto converter = CreateCpuConverter(nullptr, BorderMode::kReplicate,
+                                      Tensor::ElementType::kFloat32);
+  MP_ASSERT_OK(converter);
+  Tensor tensor(Tensor::ElementType::kFloat32, {2, 2, 2, 1});
+  {
+    auto view = tensor.GetCpuWriteView();
+    std::fill_n(view.buffer<float>(), 8, 0.0f);
+  }
+  MP_ASSERT_OK((*converter)->Convert(image, roi, 0.0f, 255.0f,
+                                     /*tensor_buffer_offset=*/4 * sizeof(float),
+                                     tensor));
+  EXPECT_THAT(GetValues<float>(tensor), ElementsAre(0, 0, 0, 0, 7, 7, 7, 7));
+  EXPECT_FALSE((*converter)
+                   ->Convert(image, roi, 0.0f, 255.0f,
+                             /*tensor_buffer_offset=*/5 * sizeof(float), tensor)
+                   .ok());
+}
+
+TEST(ImageToTensorConverterCpuTest, RejectsColorImageForGrayTensor) {
+  const Image image =
+      MakeImage(ImageFormat::SRGB, 2, 2, [](int, int, int) { return 0; });
+  auto converter = CreateCpuConverter(nullptr, BorderMode::kReplicate,
+                                      Tensor::ElementType::kFloat32);
+  MP_ASSERT_OK(converter);
+  Tensor tensor(Tensor::ElementType::kFloat32, {1, 2, 2, 1});
+  EXPECT_FALSE((*converter)
+                   ->Convert(image, {1.0f, 1.0f, 2.0f, 2.0f, 0.0f}, 0.0f,
+                             255.0f, /*tensor_buffer_offset=*/0, tensor)
+                   .ok());
+}
+
+using Chroma = std::pair<uint8_t, uint8_t>;
+
+// Returns a 4:2:0 image in "fourcc" whose pixel (x, y) has luma luma(x, y),
+// and whose chroma sample (x, y) has U and V chroma(x, y). Rows are padded.
+std::unique_ptr<YUVImage> MakeYuvImage(
+    libyuv::FourCC fourcc, int width, int height,
+    std::function<uint8_t(int x, int y)> luma,
+    std::function<Chroma(int x, int y)> chroma) {
+  const int y_stride = width + 3;
+  auto y_data = std::make_unique<uint8_t[]>(y_stride * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) y_data[y * y_stride + x] = luma(x, y);
+  }
+  const int chroma_width = (width + 1) / 2;
+  const int chroma_height = (height + 1) / 2;
+  if (fourcc == libyuv::FOURCC_NV12 || fourcc == libyuv::FOURCC_NV21) {
+    const int uv_stride = 2 * chroma_width + 2;
+    auto uv_data = std::make_unique<uint8_t[]>(uv_stride * chroma_height);
+    for (int y = 0; y < chroma_height; ++y) {
+      for (int x = 0; x < chroma_width; ++x) {
+        auto [u, v] = chroma(x, y);
+        if (fourcc == libyuv::FOURCC_NV21) std::swap(u, v);
+        uv_data[y * uv_stride + 2 * x] = u;
+        uv_data[y * uv_stride + 2 * x + 1] = v;
+      }
+    }
+    return std::make_unique<YUVImage>(fourcc, std::move(y_data), y_stride,
+                                      std::move(uv_data), uv_stride, nullptr,
+                                      0, width, height);
+  }
+  const int uv_stride = chroma_width + 1;
+  auto u_data = std::make_unique<uint8_t[]>(uv_stride * chroma_height);
+  auto v_data = std::make_unique<uint8_t[]>(uv_stride * chroma_height);
+  for (int y = 0; y < chroma_height; ++y) {
+    for (int x = 0; x < chroma_width; ++x) {
+      std::tie(u_data[y * uv_stride + x], v_data[y * uv_stride + x]) =
+          chroma(x, y);
+    }
+  }
+  if (fourcc == libyuv::FOURCC_YV12) std::swap(u_data, v_data);
+  return std::make_unique<YUVImage>(fourcc, std::move(y_data), y_stride,
+                                    std::move(u_data), uv_stride,
+                                    std::move(v_data), uv_stride, width,
+                                    height);
+}
+
+// Converts "yuv_image" into a float tensor of values in [0, 255].
+std::vector<float> ConvertYuv(const YUVImage& yuv_image,
+                              const RotatedRect& roi, BorderMode border_mode,
+                              int width, int height, int channels) {
+  auto converter = CreateCpuYuvConverter(nullptr, border_mode,
+                                         Tensor::ElementType::kFloat32);
+  ABSL_CHECK_OK(converter);
+  Tensor tensor(Tensor::ElementType::kFloat32, {1, height, width, channels});
+  ABSL_CHECK_OK((*converter)->Convert(yuv_image, roi, 0.0f, 255.0f,
+                                      /*tensor_buffer_offset=*/0, tensor));
+  return GetValues<float>(tensor);
+}
+
+TEST(ImageToTensorConverterCpuTest, YuvMatchesConvertedRgbImage) {
+  constexpr int kWidth = 13;
+  constexpr int kHeight = 9;
+  auto luma = [](int x, int y) -> uint8_t {
+    return 16 + (x * 29 + y * 47) % 220;
+  };
+  auto chroma = [](int x, int y) -> Chroma {
+    return {16 + (x * 71 + y * 13) % 225, 16 + (x * 37 + y * 89) % 225};
+  };
+  // Converts with the limited range BT.601 coefficients of libyuv.
+  const Image rgb_image =
+      MakeImage(ImageFormat::SRGB, kWidth, kHeight, [&](int x, int y, int c) {
+        const float l = 1.164f * (luma(x, y) - 16);
+        const auto [u, v] = chroma(x / 2, y / 2);
+        const float values[] = {l + 1.596f * (v - 128),
+                                l - 0.391f * (u - 128) - 0.813f * (v - 128),
+                                l + 2.018f * (u - 128)};
+        return std::clamp(std::round(values[c]), 0.0f, 255.0f);
+      });
+  const RotatedRect rois[] = {{6.5f, 4.5f, 13.0f, 9.0f, 0.0f},
+                              {5.2f, 3.9f, 7.5f, 6.3f, 0.0f},
+                              {6.0f, 4.0f, 9.0f, 8.0f, 0.7f}};
+  for (libyuv::FourCC fourcc : {libyuv::FOURCC_NV12, libyuv::FOURCC_NV21,
+                                libyuv::FOURCC_I420, libyuv::FOURCC_YV12}) {
+    const auto yuv_image = MakeYuvImage(fourcc, kWidth, kHeight, luma, chroma);
+    for (BorderMode border_mode : {BorderMode::kZero, BorderMode::kReplicate}) {
+      for (const RotatedRect& roi : rois) {
+        EXPECT_THAT(ConvertYuv(*yuv_image, roi, border_mode, 7, 5, 3),
+                    Pointwise(FloatNear(1.0f),
+                              Convert(rgb_image, roi, border_mode, 7, 5, 3)));
+      }
+    }
+  }
+}
+
+TEST(ImageToTensorConverterCpuTest, ConvertsFullRangeYuv) {
+  auto yuv_image = MakeYuvImage(
+      libyuv::FOURCC_NV12, 2, 2, [](int, int) { return 100; },
+      [](int, int) { return Chroma{128, 128}; });
+  const RotatedRect roi = {1.0f, 1.0f, 2.0f, 2.0f, 0.0f};
+  EXPECT_THAT(ConvertYuv(*yuv_image, roi, BorderMode::kReplicate, 1, 1, 3),
+              Pointwise(FloatNear(0.5f), std::vector<float>{98, 98, 98}));
+  yuv_image->set_full_range(true);
+  EXPECT_THAT(ConvertYuv(*yuv_image, roi, BorderMode::kReplicate, 1, 1, 3),
+              Pointwise(FloatNear(1e-3), std::vector<float>{100, 100, 100}));
+}
+
+TEST(ImageToTensorConverterCpuTest, ConvertsYuvLumaToGrayTensor) {
+  const auto yuv_image = MakeYuvImage(
+      libyuv::FOURCC_I420, 3, 2, [](int x, int y) { return 10 * y + x; },
+      [](int, int) { return Chroma{0, 255}; });
+  EXPECT_THAT(ConvertYuv(*yuv_image, {1.5f, 1.0f, 3.0f, 2.0f, 0.0f},
+                         BorderMode::kReplicate, 3, 2, 1),
+              ElementsAre(0, 1, 2, 10, 11, 12));
+}
+
+TEST(ImageToTensorConverterCpuTest, RejectsUnsupportedYuvFormat) {
+  auto yuv_image = MakeYuvImage(
+      libyuv::FOURCC_NV12, 2, 2, [](int, int) { return 0; },
+      [](int, int) { return Chroma{128, 128}; });
+  yuv_image->set_fourcc(libyuv::FOURCC_YUY2);
+  auto converter = CreateCpuYuvConverter(nullptr, BorderMode::kReplicate,
+                                         Tensor::ElementType::kFloat32);
+  MP_ASSERT_OK(converter);
+  Tensor tensor(Tensor::ElementType::kFloat32, {1, 2, 2, 3});
+  EXPECT_FALSE((*converter)
+                   ->Convert(*yuv_image, {1.0f, 1.0f, 2.0f, 2.0f, 0.0f}, 0.0f,
+                             255.0f, /*tensor_buffer_offset=*/0, tensor)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
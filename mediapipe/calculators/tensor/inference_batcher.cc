@@ -0,0 +1,55 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_batcher.h"
+
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+bool InferenceBatcher::Add(api2::Packet<std::vector<Tensor>> input) {
+  pending_.push_back(std::move(input));
+  if (static_cast<int>(pending_.size()) >= max_batch_size_) {
+    return true;
+  }
+  return max_batch_latency_us_ > 0 &&
+         (pending_.back().timestamp() - pending_.front().timestamp())
+                 .Value() >= max_batch_latency_us_;
+}
+
+absl::StatusOr<std::vector<InferenceBatcher::Output>> InferenceBatcher::Run(
+    CalculatorContext* cc, InferenceRunner& runner) {
+  std::vector<api2::Packet<std::vector<Tensor>>> batch;
+  batch.swap(pending_);
+  std::vector<const std::vector<Tensor>*> inputs;
+  inputs.reserve(batch.size());
+  for (const auto& input : batch) {
+    inputs.push_back(&input.Get());
+  }
+  MP_ASSIGN_OR_RETURN(std::vector<std::vector<Tensor>> batch_outputs,
+                      runner.RunBatch(cc, inputs));
+  RET_CHECK_EQ(batch_outputs.size(), batch.size());
+  std::vector<Output> outputs;
+  outputs.reserve(batch.size());
+  for (int i = 0; i < batch.size(); ++i) {
+    outputs.push_back({batch[i].timestamp(), std::move(batch_outputs[i])});
+  }
+  return outputs;
+}
+
+}  // namespace mediapipe
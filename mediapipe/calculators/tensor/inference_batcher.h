@@ -0,0 +1,70 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// Collects the input tensors of consecutive timestamps and runs them as one
+// batch, as configured by InferenceCalculatorOptions.batching.
+class InferenceBatcher {
+ public:
+  // The outputs of one timestamp.
+  struct Output {
+    Timestamp timestamp;
+    std::vector<Tensor> tensors;
+  };
+
+  // Returns true if "options" enable batching.
+  static bool IsEnabled(const InferenceCalculatorOptions& options) {
+    return options.batching().max_batch_size() > 1;
+  }
+
+  explicit InferenceBatcher(const InferenceCalculatorOptions::Batching& options)
+      : max_batch_size_(options.max_batch_size()),
+        max_batch_latency_us_(options.max_batch_latency_us()) {}
+
+  // Queues the input tensors of one timestamp. Returns true if the queued
+  // inputs should now be run: the batch is full, or the latency limit is
+  // reached.
+  bool Add(api2::Packet<std::vector<Tensor>> input);
+
+  bool empty() const { return pending_.empty(); }
+
+  // Runs the queued inputs with InferenceRunner::RunBatch and empties the
+  // queue. Returns the outputs in timestamp order.
+  absl::StatusOr<std::vector<Output>> Run(CalculatorContext* cc,
+                                          InferenceRunner& runner);
+
+ private:
+  const int max_batch_size_;
+  const int64_t max_batch_latency_us_;
+  std::vector<api2::Packet<std::vector<Tensor>>> pending_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
@@ -0,0 +1,122 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_batcher.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace {
+
+// Doubles the single float of its single input tensor and records the batch
+// sizes it was called with.
+class DoublingRunner : public InferenceRunner {
+ public:
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc, const std::vector<Tensor>& inputs) override {
+    return absl::UnimplementedError("Only batches are expected.");
+  }
+
+  absl::StatusOr<std::vector<std::vector<Tensor>>> RunBatch(
+      CalculatorContext* cc,
+      absl::Span<const std::vector<Tensor>* const> inputs) override {
+    batch_sizes.push_back(inputs.size());
+    std::vector<std::vector<Tensor>> outputs;
+    for (const std::vector<Tensor>* input : inputs) {
+      Tensor output(Tensor::ElementType::kFloat32, Tensor::Shape({1}));
+      output.GetCpuWriteView().buffer<float>()[0] =
+          2 * (*input)[0].GetCpuReadView().buffer<float>()[0];
+      outputs.emplace_back();
+      outputs.back().push_back(std::move(output));
+    }
+    return outputs;
+  }
+
+  std::vector<int> batch_sizes;
+};
+
+api2::Packet<std::vector<Tensor>> MakeInput(float value, int64_t timestamp) {
+  std::vector<Tensor> tensors;
+  tensors.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape({1}));
+  tensors.back().GetCpuWriteView().buffer<float>()[0] = value;
+  return api2::MakePacket<std::vector<Tensor>>(std::move(tensors))
+      .At(Timestamp(timestamp));
+}
+
+float OutputValue(const InferenceBatcher::Output& output) {
+  return output.tensors[0].GetCpuReadView().buffer<float>()[0];
+}
+
+TEST(InferenceBatcherTest, IsEnabled) {
+  InferenceCalculatorOptions options;
+  EXPECT_FALSE(InferenceBatcher::IsEnabled(options));
+  options.mutable_batching()->set_max_batch_size(1);
+  EXPECT_FALSE(InferenceBatcher::IsEnabled(options));
+  options.mutable_batching()->set_max_batch_size(4);
+  EXPECT_TRUE(InferenceBatcher::IsEnabled(options));
+}
+
+TEST(InferenceBatcherTest, RunsFullBatches) {
+  InferenceCalculatorOptions::Batching options;
+  options.set_max_batch_size(3);
+  InferenceBatcher batcher(options);
+  DoublingRunner runner;
+
+  EXPECT_TRUE(batcher.empty());
+  EXPECT_FALSE(batcher.Add(MakeInput(1, 10)));
+  EXPECT_FALSE(batcher.Add(MakeInput(2, 20)));
+  EXPECT_TRUE(batcher.Add(MakeInput(3, 30)));
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<InferenceBatcher::Output> outputs,
+                          batcher.Run(/*cc=*/nullptr, runner));
+  EXPECT_TRUE(batcher.empty());
+  ASSERT_EQ(outputs.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(outputs[i].timestamp, Timestamp(10 * (i + 1)));
+    EXPECT_EQ(OutputValue(outputs[i]), 2.0f * (i + 1));
+  }
+
+  // A partial batch, as flushed on Close().
+  EXPECT_FALSE(batcher.Add(MakeInput(4, 40)));
+  MP_ASSERT_OK_AND_ASSIGN(outputs, batcher.Run(/*cc=*/nullptr, runner));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs[0].timestamp, Timestamp(40));
+  EXPECT_EQ(OutputValue(outputs[0]), 8.0f);
+  EXPECT_THAT(runner.batch_sizes, testing::ElementsAre(3, 1));
+}
+
+TEST(InferenceBatcherTest, RunsBatchAtLatencyLimit) {
+  InferenceCalculatorOptions::Batching options;
+  options.set_max_batch_size(8);
+  options.set_max_batch_latency_us(100);
+  InferenceBatcher batcher(options);
+
+  EXPECT_FALSE(batcher.Add(MakeInput(1, 1000)));
+  EXPECT_FALSE(batcher.Add(MakeInput(2, 1050)));
+  EXPECT_TRUE(batcher.Add(MakeInput(3, 1100)));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -15,15 +15,18 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/inference_batcher.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 #include "mediapipe/calculators/tensor/inference_calculator_utils.h"
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 #include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/xnnpack_weights_cache.h"
 #include "tensorflow/lite/interpreter.h"
 #if defined(MEDIAPIPE_ANDROID)
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
@@ -45,9 +48,24 @@ class InferenceCalculatorCpuImpl
  private:
   absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunner(
       CalculatorContext* cc);
-  absl::StatusOr<TfLiteDelegatePtr> MaybeCreateDelegate(CalculatorContext* cc);
-
+  // Runs the inputs queued in batcher_ and sends their outputs.
+  absl::Status RunBatch(CalculatorContext* cc);
+  // XNNPACK delegate settings for interpreters that share packed weights.
+  struct CachedXnnpackDelegate {
+    TfLiteXNNPackDelegateOptions options;
+    std::string weights_cache_file_path;
+  };
+  // Returns nullptr if no delegate is needed, or if "cached_xnnpack" is set,
+  // in which case the delegate is created by weights_cache_.
+  absl::StatusOr<TfLiteDelegatePtr> MaybeCreateDelegate(
+      CalculatorContext* cc,
+      std::optional<CachedXnnpackDelegate>* cached_xnnpack);
+
+  // Set if the packed weights are cached. Must outlive inference_runner_.
+  std::shared_ptr<XnnpackWeightsCache> weights_cache_;
   std::unique_ptr<InferenceRunner> inference_runner_;
+  // Set if batching is enabled.
+  std::unique_ptr<InferenceBatcher> batcher_;
 };
 
 absl::Status InferenceCalculatorCpuImpl::UpdateContract(
@@ -55,12 +73,20 @@ absl::Status InferenceCalculatorCpuImpl::UpdateContract(
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  if (InferenceBatcher::IsEnabled(options)) {
+    // Outputs are sent after later inputs have arrived.
+    cc->SetTimestampOffset(TimestampDiff::Unset());
+  }
 
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Open(CalculatorContext* cc) {
   MP_ASSIGN_OR_RETURN(inference_runner_, CreateInferenceRunner(cc));
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  if (InferenceBatcher::IsEnabled(options)) {
+    batcher_ = std::make_unique<InferenceBatcher>(options.batching());
+  }
   return absl::OkStatus();
 }
 
@@ -71,6 +97,13 @@ absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
 
+  if (batcher_) {
+    if (batcher_->Add(kInTensors(cc))) {
+      MP_RETURN_IF_ERROR(RunBatch(cc));
+    }
+    return absl::OkStatus();
+  }
+
   MP_ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
                       inference_runner_->Run(cc, input_tensors));
   kOutTensors(cc).Send(std::move(output_tensors));
@@ -78,7 +111,20 @@ absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
 }
 
 absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
+  if (batcher_ && !batcher_->empty()) {
+    MP_RETURN_IF_ERROR(RunBatch(cc));
+  }
   inference_runner_ = nullptr;
+  weights_cache_ = nullptr;
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::RunBatch(CalculatorContext* cc) {
+  MP_ASSIGN_OR_RETURN(std::vector<InferenceBatcher::Output> outputs,
+                      batcher_->Run(cc, *inference_runner_));
+  for (InferenceBatcher::Output& output : outputs) {
+    kOutTensors(cc).Send(std::move(output.tensors), output.timestamp);
+  }
   return absl::OkStatus();
 }
 
@@ -88,14 +134,30 @@ InferenceCalculatorCpuImpl::CreateInferenceRunner(CalculatorContext* cc) {
   MP_ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
   const int interpreter_num_threads =
       cc->Options<mediapipe::InferenceCalculatorOptions>().cpu_num_thread();
-  MP_ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, MaybeCreateDelegate(cc));
+  std::optional<CachedXnnpackDelegate> cached_xnnpack;
+  MP_ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate,
+                      MaybeCreateDelegate(cc, &cached_xnnpack));
+  if (cached_xnnpack.has_value()) {
+    MP_ASSIGN_OR_RETURN(
+        weights_cache_,
+        XnnpackWeightsCache::Get(*model_packet.Get(),
+                                 cached_xnnpack->weights_cache_file_path));
+    return weights_cache_->CreateRunner(
+        cached_xnnpack->options, [&](TfLiteDelegatePtr delegate) {
+          return CreateInferenceInterpreterDelegateRunner(
+              model_packet, op_resolver_packet, std::move(delegate),
+              interpreter_num_threads);
+        });
+  }
   return CreateInferenceInterpreterDelegateRunner(
       std::move(model_packet), std::move(op_resolver_packet),
       std::move(delegate), interpreter_num_threads);
 }
 
 absl::StatusOr<TfLiteDelegatePtr>
-InferenceCalculatorCpuImpl::MaybeCreateDelegate(CalculatorContext* cc) {
+InferenceCalculatorCpuImpl::MaybeCreateDelegate(
+    CalculatorContext* cc,
+    std::optional<CachedXnnpackDelegate>* cached_xnnpack) {
   const auto& calculator_opts =
       cc->Options<mediapipe::InferenceCalculatorOptions>();
   auto opts_delegate = calculator_opts.delegate();
@@ -151,6 +213,13 @@ InferenceCalculatorCpuImpl::MaybeCreateDelegate(CalculatorContext* cc) {
     auto xnnpack_opts = TfLiteXNNPackDelegateOptionsDefault();
     xnnpack_opts.num_threads =
         GetXnnpackNumThreads(opts_has_delegate, opts_delegate);
+    const std::string& weights_cache_file_path =
+        opts_delegate.xnnpack().weights_cache_file_path();
+    if (!weights_cache_file_path.empty()) {
+      *cached_xnnpack = CachedXnnpackDelegate{xnnpack_opts,
+                                              weights_cache_file_path};
+      return nullptr;
+    }
     return TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&xnnpack_opts),
                              &TfLiteXNNPackDelegateDelete);
   }
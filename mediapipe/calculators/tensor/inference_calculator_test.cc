@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "absl/log/absl_check.h"
+#include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
@@ -100,6 +101,22 @@ constexpr char kGraphWithModelAsInputSidePacket[] = R"(
     }
   )";
 
+constexpr char kGraphWithBatching[] = R"(
+    input_stream: "tensor_in"
+    node {
+      calculator: "InferenceCalculator"
+      input_stream: "TENSORS:tensor_in"
+      output_stream: "TENSORS:tensor_out"
+      options {
+        [mediapipe.InferenceCalculatorOptions.ext] {
+          model_path: "mediapipe/calculators/tensor/testdata/add_dynamic_batch.bin"
+          delegate { tflite {} }
+          batching { max_batch_size: 2 }
+        }
+      }
+    }
+  )";
+
 std::vector<Tensor> CreateInputs() {
   std::vector<Tensor> input_vec;
   // Prepare input tensor.
@@ -176,10 +193,143 @@ TEST(InferenceCalculatorTest, SmokeTest) {
       {{"$delegate", "delegate { xnnpack { num_threads: 10 } }"}}));
 }
 
+TEST(InferenceCalculatorTest, XnnpackWeightsCacheSmokeTest) {
+  const std::string delegate = absl::StrCat(
+      "delegate { xnnpack { weights_cache_file_path: \"",
+      file::JoinPath(getenv("TEST_TMPDIR"), "add.xnnpack_cache"), "\" } }");
+  // Where supported, the second run maps the weights written by the first.
+  for (int run = 0; run < 2; ++run) {
+    DoSmokeTest(absl::StrReplaceAll(kGraphWithModelPathInOption,
+                                    {{"$delegate", delegate}}));
+  }
+}
+
 TEST(InferenceCalculatorTest, ModelAsInputSidePacketSmokeTest) {
   DoSmokeTest(kGraphWithModelAsInputSidePacket);
 }
 
+// Runs "model_path" on inputs of three timestamps, each filled with a
+// different ramp, and returns the output tensors.
+std::vector<Packet> RunModelOnRamps(const std::string& model_path) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(absl::StrReplaceAll(
+          kGraphWithModelPathInOption,
+          {{"mediapipe/calculators/tensor/testdata/add.bin", model_path},
+           {"$delegate", "delegate { tflite {} }"}}));
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  ABSL_CHECK_OK(graph.StartRun({}));
+  for (int t = 0; t < 3; ++t) {
+    std::vector<Tensor> input_vec = CreateInputs();
+    {
+      auto view = input_vec[0].GetCpuWriteView();
+      float* buffer = view.buffer<float>();
+      for (int i = 0; i < input_vec[0].shape().num_elements(); ++i) {
+        buffer[i] = 0.5f * i - t;
+      }
+    }
+    ABSL_CHECK_OK(graph.AddPacketToInputStream(
+        "tensor_in", MakePacket<std::vector<Tensor>>(std::move(input_vec))
+                         .At(Timestamp(t))));
+  }
+  ABSL_CHECK_OK(graph.CloseInputStream("tensor_in"));
+  ABSL_CHECK_OK(graph.WaitUntilDone());
+  return output_packets;
+}
+
+// add.bin has static input shapes, so the runner binds the Tensor buffers to
+// the interpreter. The dynamic batch dimension of add_dynamic_batch.bin
+// disables binding and makes the runner copy the same inputs and outputs.
+TEST(InferenceCalculatorTest, BoundAndCopiedBuffersGiveSameOutputs) {
+  const std::vector<Packet> bound =
+      RunModelOnRamps("mediapipe/calculators/tensor/testdata/add.bin");
+  const std::vector<Packet> copied = RunModelOnRamps(
+      "mediapipe/calculators/tensor/testdata/add_dynamic_batch.bin");
+  ASSERT_EQ(bound.size(), 3);
+  ASSERT_EQ(copied.size(), 3);
+  for (int t = 0; t < 3; ++t) {
+    EXPECT_EQ(bound[t].Timestamp(), copied[t].Timestamp());
+    const Tensor& bound_result = bound[t].Get<std::vector<Tensor>>()[0];
+    const Tensor& copied_result = copied[t].Get<std::vector<Tensor>>()[0];
+    ASSERT_EQ(bound_result.shape().dims, copied_result.shape().dims);
+    auto bound_view = bound_result.GetCpuReadView();
+    auto copied_view = copied_result.GetCpuReadView();
+    const float* bound_buffer = bound_view.buffer<float>();
+    const float* copied_buffer = copied_view.buffer<float>();
+    for (int i = 0; i < bound_result.shape().num_elements(); ++i) {
+      ASSERT_EQ(bound_buffer[i], 3 * (0.5f * i - t));
+      ASSERT_EQ(bound_buffer[i], copied_buffer[i]);
+    }
+  }
+}
+
+// Tests batching with a model that triples its input and has a dynamic batch
+// dimension. The first two inputs run as one batch, the last one runs alone
+// when the graph is closed.
+TEST(InferenceCalculatorTest, BatchingSendsOutputsAtInputTimestamps) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(kGraphWithBatching);
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  for (int t = 0; t < 3; ++t) {
+    std::vector<Tensor> input_vec = CreateInputs();
+    {
+      auto view = input_vec[0].GetCpuWriteView();
+      float* buffer = view.buffer<float>();
+      for (int i = 0; i < input_vec[0].shape().num_elements(); ++i) {
+        buffer[i] = t + 1;
+      }
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", MakePacket<std::vector<Tensor>>(std::move(input_vec))
+                         .At(Timestamp(t))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(output_packets.size(), 3);
+  for (int t = 0; t < 3; ++t) {
+    EXPECT_EQ(output_packets[t].Timestamp(), Timestamp(t));
+    const std::vector<Tensor>& result_vec =
+        output_packets[t].Get<std::vector<Tensor>>();
+    ASSERT_EQ(result_vec.size(), 1);
+    const Tensor& result = result_vec[0];
+    EXPECT_EQ(result.shape().dims,
+              std::vector<int>({1, kTensorHeight, kTensorWidth,
+                                kTensorChannels}));
+    auto view = result.GetCpuReadView();
+    const float* result_buffer = view.buffer<float>();
+    for (int i = 0; i < result.shape().num_elements(); ++i) {
+      ASSERT_EQ(result_buffer[i], 3 * (t + 1));
+    }
+  }
+}
+
+TEST(InferenceCalculatorTest, BatchingFailsOnMismatchedElementType) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(kGraphWithBatching);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  for (int t = 0; t < 2; ++t) {
+    std::vector<Tensor> input_vec;
+    input_vec.emplace_back(
+        Tensor::ElementType::kInt32,
+        Tensor::Shape{1, kTensorHeight, kTensorWidth, kTensorChannels});
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", MakePacket<std::vector<Tensor>>(std::move(input_vec))
+                         .At(Timestamp(t))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  absl::Status status = graph.WaitUntilDone();
+  EXPECT_THAT(status.message(),
+              testing::HasSubstr("element type of the model"));
+}
+
 void BM_InitializeCalculator(benchmark::State& state) {
   mediapipe::InferenceCalculatorOptions::Delegate delegate;
   delegate.mutable_tflite();
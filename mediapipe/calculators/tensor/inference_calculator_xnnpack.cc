@@ -20,10 +20,12 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/inference_batcher.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 #include "mediapipe/calculators/tensor/inference_calculator_utils.h"
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 #include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/xnnpack_weights_cache.h"
 #include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
 #include "tensorflow/lite/interpreter.h"
 
@@ -43,9 +45,18 @@ class InferenceCalculatorXnnpackImpl
  private:
   absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunner(
       CalculatorContext* cc);
-  absl::StatusOr<TfLiteDelegatePtr> CreateDelegate(CalculatorContext* cc);
-
+  // Runs the inputs queued in batcher_ and sends their outputs.
+  absl::Status RunBatch(CalculatorContext* cc);
+  // Returns the XNNPACK delegate options, and the path of the weights cache
+  // file in "weights_cache_file_path" if one is configured.
+  absl::StatusOr<TfLiteXNNPackDelegateOptions> GetDelegateOptions(
+      CalculatorContext* cc, std::string* weights_cache_file_path);
+
+  // Set if the packed weights are cached. Must outlive inference_runner_.
+  std::shared_ptr<XnnpackWeightsCache> weights_cache_;
   std::unique_ptr<InferenceRunner> inference_runner_;
+  // Set if batching is enabled.
+  std::unique_ptr<InferenceBatcher> batcher_;
 };
 
 absl::Status InferenceCalculatorXnnpackImpl::UpdateContract(
@@ -53,12 +64,20 @@ absl::Status InferenceCalculatorXnnpackImpl::UpdateContract(
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  if (InferenceBatcher::IsEnabled(options)) {
+    // Outputs are sent after later inputs have arrived.
+    cc->SetTimestampOffset(TimestampDiff::Unset());
+  }
 
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorXnnpackImpl::Open(CalculatorContext* cc) {
   MP_ASSIGN_OR_RETURN(inference_runner_, CreateInferenceRunner(cc));
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  if (InferenceBatcher::IsEnabled(options)) {
+    batcher_ = std::make_unique<InferenceBatcher>(options.batching());
+  }
   return absl::OkStatus();
 }
 
@@ -69,6 +88,13 @@ absl::Status InferenceCalculatorXnnpackImpl::Process(CalculatorContext* cc) {
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
 
+  if (batcher_) {
+    if (batcher_->Add(kInTensors(cc))) {
+      MP_RETURN_IF_ERROR(RunBatch(cc));
+    }
+    return absl::OkStatus();
+  }
+
   MP_ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
                       inference_runner_->Run(cc, input_tensors));
   kOutTensors(cc).Send(std::move(output_tensors));
@@ -76,7 +102,20 @@ absl::Status InferenceCalculatorXnnpackImpl::Process(CalculatorContext* cc) {
 }
 
 absl::Status InferenceCalculatorXnnpackImpl::Close(CalculatorContext* cc) {
+  if (batcher_ && !batcher_->empty()) {
+    MP_RETURN_IF_ERROR(RunBatch(cc));
+  }
   inference_runner_ = nullptr;
+  weights_cache_ = nullptr;
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorXnnpackImpl::RunBatch(CalculatorContext* cc) {
+  MP_ASSIGN_OR_RETURN(std::vector<InferenceBatcher::Output> outputs,
+                      batcher_->Run(cc, *inference_runner_));
+  for (InferenceBatcher::Output& output : outputs) {
+    kOutTensors(cc).Send(std::move(output.tensors), output.timestamp);
+  }
   return absl::OkStatus();
 }
 
@@ -86,14 +125,30 @@ InferenceCalculatorXnnpackImpl::CreateInferenceRunner(CalculatorContext* cc) {
   MP_ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
   const int interpreter_num_threads =
       cc->Options<mediapipe::InferenceCalculatorOptions>().cpu_num_thread();
-  MP_ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, CreateDelegate(cc));
+  std::string weights_cache_file_path;
+  MP_ASSIGN_OR_RETURN(TfLiteXNNPackDelegateOptions xnnpack_opts,
+                      GetDelegateOptions(cc, &weights_cache_file_path));
+  if (!weights_cache_file_path.empty()) {
+    MP_ASSIGN_OR_RETURN(weights_cache_,
+                        XnnpackWeightsCache::Get(*model_packet.Get(),
+                                                 weights_cache_file_path));
+    return weights_cache_->CreateRunner(
+        xnnpack_opts, [&](TfLiteDelegatePtr delegate) {
+          return CreateInferenceInterpreterDelegateRunner(
+              model_packet, op_resolver_packet, std::move(delegate),
+              interpreter_num_threads);
+        });
+  }
   return CreateInferenceInterpreterDelegateRunner(
       std::move(model_packet), std::move(op_resolver_packet),
-      std::move(delegate), interpreter_num_threads);
+      TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&xnnpack_opts),
+                        &TfLiteXNNPackDelegateDelete),
+      interpreter_num_threads);
 }
 
-absl::StatusOr<TfLiteDelegatePtr>
-InferenceCalculatorXnnpackImpl::CreateDelegate(CalculatorContext* cc) {
+absl::StatusOr<TfLiteXNNPackDelegateOptions>
+InferenceCalculatorXnnpackImpl::GetDelegateOptions(
+    CalculatorContext* cc, std::string* weights_cache_file_path) {
   const auto& calculator_opts =
       cc->Options<mediapipe::InferenceCalculatorOptions>();
   auto opts_delegate = calculator_opts.delegate();
@@ -114,8 +169,8 @@ InferenceCalculatorXnnpackImpl::CreateDelegate(CalculatorContext* cc) {
   auto xnnpack_opts = TfLiteXNNPackDelegateOptionsDefault();
   xnnpack_opts.num_threads =
       GetXnnpackNumThreads(opts_has_delegate, opts_delegate);
-  return TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&xnnpack_opts),
-                           &TfLiteXNNPackDelegateDelete);
+  *weights_cache_file_path = opts_delegate.xnnpack().weights_cache_file_path();
+  return xnnpack_opts;
 }
 
 }  // namespace api2
@@ -14,18 +14,29 @@
 
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
+#include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/interpreter_builder.h"
 #include "tensorflow/lite/string_util.h"
+#include "tensorflow/lite/util.h"
 
 #define PERFETTO_TRACK_EVENT_NAMESPACE mediapipe
 
@@ -72,6 +83,83 @@ void CopyTensorBufferFromInterpreter(Interpreter* interpreter,
               output_tensor->bytes());
 }
 
+// Creates a CPU Tensor of the given shape with the element type and
+// quantization parameters of "tensor".
+absl::StatusOr<Tensor> CreateTensorLike(const TfLiteTensor& tensor,
+                                        Tensor::Shape shape) {
+  switch (tensor.type) {
+    case TfLiteType::kTfLiteFloat32:
+      return Tensor(Tensor::ElementType::kFloat32, std::move(shape));
+    case TfLiteType::kTfLiteUInt8:
+      return Tensor(Tensor::ElementType::kUInt8, std::move(shape),
+                    Tensor::QuantizationParameters{tensor.params.scale,
+                                                   tensor.params.zero_point});
+    case TfLiteType::kTfLiteInt8:
+      return Tensor(Tensor::ElementType::kInt8, std::move(shape),
+                    Tensor::QuantizationParameters{tensor.params.scale,
+                                                   tensor.params.zero_point});
+    case TfLiteType::kTfLiteInt32:
+      return Tensor(Tensor::ElementType::kInt32, std::move(shape));
+    case TfLiteType::kTfLiteBool:
+      return Tensor(Tensor::ElementType::kBool, std::move(shape),
+                    Tensor::QuantizationParameters{1.0f, 0});
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported tensor type:",
+                       TfLiteTypeGetName(tensor.type)));
+  }
+}
+
+// Returns the Tensor element type that holds the data of "type" unconverted.
+absl::StatusOr<Tensor::ElementType> ElementTypeOf(TfLiteType type) {
+  switch (type) {
+    case TfLiteType::kTfLiteFloat32:
+      return Tensor::ElementType::kFloat32;
+    case TfLiteType::kTfLiteUInt8:
+      return Tensor::ElementType::kUInt8;
+    case TfLiteType::kTfLiteInt8:
+      return Tensor::ElementType::kInt8;
+    case TfLiteType::kTfLiteInt32:
+      return Tensor::ElementType::kInt32;
+    case TfLiteType::kTfLiteBool:
+      return Tensor::ElementType::kBool;
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unsupported tensor type:", TfLiteTypeGetName(type)));
+  }
+}
+
+// Returns true if no input of the model has a dynamic dimension.
+bool HasStaticInputShapes(const Interpreter& interpreter) {
+  for (int tensor_index : interpreter.inputs()) {
+    const TfLiteIntArray* dims_signature =
+        interpreter.tensor(tensor_index)->dims_signature;
+    if (dims_signature == nullptr) continue;
+    for (int i = 0; i < dims_signature->size; ++i) {
+      if (dims_signature->data[i] < 0) return false;
+    }
+  }
+  return true;
+}
+
+static_assert(Tensor::kCpuBufferAlignment % tflite::kDefaultTensorAlignment ==
+                  0,
+              "Tensor CPU buffers must be aligned for TfLite.");
+
+// Returns true if "data" can be set as the custom allocation of "tensor".
+bool CanBindBuffer(const TfLiteTensor& tensor, const void* data,
+                   size_t bytes) {
+  return (tensor.allocation_type == kTfLiteArenaRw ||
+          tensor.allocation_type == kTfLiteCustom) &&
+         tensor.type != kTfLiteString && tensor.bytes == bytes &&
+         reinterpret_cast<uintptr_t>(data) % tflite::kDefaultTensorAlignment ==
+             0;
+}
+
+struct AlignedFreeDeleter {
+  void operator()(void* ptr) const { aligned_free(ptr); }
+};
+
 }  // namespace
 
 class InferenceInterpreterDelegateRunner : public InferenceRunner {
@@ -81,17 +169,70 @@ class InferenceInterpreterDelegateRunner : public InferenceRunner {
                                      TfLiteDelegatePtr delegate)
       : model_(std::move(model)),
         interpreter_(std::move(interpreter)),
-        delegate_(std::move(delegate)) {}
+        delegate_(std::move(delegate)),
+        bind_tensor_buffers_(HasStaticInputShapes(*interpreter_)) {}
 
   absl::StatusOr<std::vector<Tensor>> Run(
       CalculatorContext* cc, const std::vector<Tensor>& input_tensors) override;
 
+  // Stacks the inputs along their first dimension, which must be a batch
+  // dimension of size 1, and invokes the interpreter once. The model inputs
+  // are resized with ResizeInputTensorStrict(), so the model must declare a
+  // dynamic batch dimension.
+  absl::StatusOr<std::vector<std::vector<Tensor>>> RunBatch(
+      CalculatorContext* cc,
+      absl::Span<const std::vector<Tensor>* const> inputs) override;
+
  private:
+  // Makes the interpreter tensor "tensor_index" use "data" as its memory.
+  // Returns true if the tensor was not bound to external memory before.
+  absl::StatusOr<bool> BindBuffer(int tensor_index, void* data, size_t bytes);
+  // Makes a tensor bound by BindBuffer() in an earlier run use memory owned by
+  // the runner again, so that it can be copied to or from.
+  absl::Status UnbindBuffer(int tensor_index);
+
   api2::Packet<TfLiteModelPtr> model_;
   std::unique_ptr<Interpreter> interpreter_;
   TfLiteDelegatePtr delegate_;
+  // If set, the CPU buffers of the input and output Tensors are bound to the
+  // interpreter directly instead of being copied, when their size and
+  // alignment permit. This requires tensor sizes that don't change between
+  // runs, as interpreter tensors keep pointing to the previous run's buffers.
+  const bool bind_tensor_buffers_;
+  // Buffers of tensors that were bound to Tensor memory by an earlier run and
+  // can't be bound in the current one, by interpreter tensor index.
+  absl::flat_hash_map<int, std::unique_ptr<void, AlignedFreeDeleter>>
+      unbound_buffers_;
 };
 
+absl::StatusOr<bool> InferenceInterpreterDelegateRunner::BindBuffer(
+    int tensor_index, void* data, size_t bytes) {
+  const bool newly_bound =
+      interpreter_->tensor(tensor_index)->allocation_type != kTfLiteCustom;
+  RET_CHECK_EQ(
+      interpreter_->SetCustomAllocationForTensor(tensor_index, {data, bytes}),
+      kTfLiteOk);
+  return newly_bound;
+}
+
+absl::Status InferenceInterpreterDelegateRunner::UnbindBuffer(
+    int tensor_index) {
+  const TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+  if (tensor->allocation_type != kTfLiteCustom) {
+    return absl::OkStatus();
+  }
+  auto& buffer = unbound_buffers_[tensor_index];
+  if (!buffer) {
+    buffer.reset(
+        aligned_malloc(tensor->bytes, tflite::kDefaultTensorAlignment));
+    RET_CHECK(buffer != nullptr);
+  }
+  RET_CHECK_EQ(interpreter_->SetCustomAllocationForTensor(
+                   tensor_index, {buffer.get(), tensor->bytes}),
+               kTfLiteOk);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::vector<Tensor>> InferenceInterpreterDelegateRunner::Run(
     CalculatorContext* cc, const std::vector<Tensor>& input_tensors) {
   // Read CPU input into tensors.
@@ -109,9 +250,30 @@ absl::StatusOr<std::vector<Tensor>> InferenceInterpreterDelegateRunner::Run(
   // Reallocation is needed for memory sanity.
   if (resized_tensor_shapes) interpreter_->AllocateTensors();
 
+  // Keeps the Tensor memory bound to the interpreter locked until inference is
+  // done.
+  std::vector<Tensor::CpuReadView> input_views;
+  std::vector<Tensor::CpuWriteView> output_views;
+  bool bound_new_buffers = false;
+
   for (int i = 0; i < input_tensors.size(); ++i) {
+    const int tensor_index = interpreter_->inputs()[i];
+    if (bind_tensor_buffers_) {
+      auto view = input_tensors[i].GetCpuReadView();
+      if (CanBindBuffer(*interpreter_->tensor(tensor_index),
+                        view.buffer<void>(), input_tensors[i].bytes())) {
+        MP_ASSIGN_OR_RETURN(
+            bool newly_bound,
+            BindBuffer(tensor_index, const_cast<void*>(view.buffer<void>()),
+                       input_tensors[i].bytes()));
+        bound_new_buffers |= newly_bound;
+        input_views.push_back(std::move(view));
+        continue;
+      }
+    }
+    MP_RETURN_IF_ERROR(UnbindBuffer(tensor_index));
     const TfLiteType input_tensor_type =
-        interpreter_->tensor(interpreter_->inputs()[i])->type;
+        interpreter_->tensor(tensor_index)->type;
     switch (input_tensor_type) {
       case TfLiteType::kTfLiteFloat16:
       case TfLiteType::kTfLiteFloat32: {
@@ -148,16 +310,64 @@ absl::StatusOr<std::vector<Tensor>> InferenceInterpreterDelegateRunner::Run(
     }
   }
 
+  // Creates the output Tensors up front and lets the interpreter write into
+  // them. Outputs that also appear elsewhere in the inputs or outputs of the
+  // model are copied.
+  const auto& tensor_indexes = interpreter_->outputs();
+  std::vector<std::optional<Tensor>> bound_output_tensors(
+      tensor_indexes.size());
+  for (int i = 0; i < tensor_indexes.size(); ++i) {
+    const int tensor_index = tensor_indexes[i];
+    const TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+    if (bind_tensor_buffers_ &&
+        absl::c_count(tensor_indexes, tensor_index) == 1 &&
+        !absl::c_linear_search(interpreter_->inputs(), tensor_index)) {
+      absl::StatusOr<Tensor> output_tensor = CreateTensorLike(
+          *tensor, Tensor::Shape{std::vector<int>{
+                       tensor->dims->data,
+                       tensor->dims->data + tensor->dims->size}});
+      if (output_tensor.ok()) {
+        std::optional<Tensor>& bound_tensor = bound_output_tensors[i];
+        bound_tensor.emplace(std::move(*output_tensor));
+        {
+          auto view = bound_tensor->GetCpuWriteView();
+          if (CanBindBuffer(*tensor, view.buffer<void>(),
+                            bound_tensor->bytes())) {
+            MP_ASSIGN_OR_RETURN(bool newly_bound,
+                                BindBuffer(tensor_index, view.buffer<void>(),
+                                           bound_tensor->bytes()));
+            bound_new_buffers |= newly_bound;
+            output_views.push_back(std::move(view));
+            continue;
+          }
+        }
+        bound_tensor.reset();
+      }
+    }
+    MP_RETURN_IF_ERROR(UnbindBuffer(tensor_index));
+  }
+  // The interpreter requires AllocateTensors() once tensors start using
+  // custom allocations. Later rebinding only swaps the pointers.
+  if (bound_new_buffers) {
+    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+
   // Run inference.
   {
     MEDIAPIPE_PROFILING(CPU_TASK_INVOKE, cc);
     RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
   }
+  input_views.clear();
+  output_views.clear();
+
   // Output result tensors (CPU).
-  const auto& tensor_indexes = interpreter_->outputs();
   std::vector<Tensor> output_tensors;
   output_tensors.reserve(tensor_indexes.size());
   for (int i = 0; i < tensor_indexes.size(); ++i) {
+    if (bound_output_tensors[i].has_value()) {
+      output_tensors.push_back(std::move(*bound_output_tensors[i]));
+      continue;
+    }
     TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
     Tensor::Shape shape{std::vector<int>{
         tensor->dims->data, tensor->dims->data + tensor->dims->size}};
@@ -207,6 +417,112 @@ absl::StatusOr<std::vector<Tensor>> InferenceInterpreterDelegateRunner::Run(
   return output_tensors;
 }
 
+absl::StatusOr<std::vector<std::vector<Tensor>>>
+InferenceInterpreterDelegateRunner::RunBatch(
+    CalculatorContext* cc,
+    absl::Span<const std::vector<Tensor>* const> inputs) {
+  // Batches of one also take this path, so that the model inputs are resized
+  // back after a larger batch.
+  if (inputs.empty()) {
+    return std::vector<std::vector<Tensor>>();
+  }
+  if (bind_tensor_buffers_) {
+    // Models without dynamic input dimensions can't be resized to larger
+    // batches, and Run() keeps track of the bound buffers.
+    RET_CHECK_EQ(inputs.size(), 1)
+        << "The model doesn't have a dynamic batch dimension.";
+    MP_ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
+                        Run(cc, *inputs[0]));
+    std::vector<std::vector<Tensor>> outputs;
+    outputs.push_back(std::move(output_tensors));
+    return outputs;
+  }
+  const int batch_size = inputs.size();
+  const int num_inputs = interpreter_->inputs().size();
+  for (const std::vector<Tensor>* input_tensors : inputs) {
+    RET_CHECK_EQ(input_tensors->size(), num_inputs);
+  }
+
+  // Resizes the model inputs to the batch size, if they aren't already.
+  bool resized_tensor_shapes = false;
+  for (int i = 0; i < num_inputs; ++i) {
+    const std::vector<int>& dims = (*inputs[0])[i].shape().dims;
+    RET_CHECK(!dims.empty() && dims[0] == 1)
+        << "Batched input tensors must have a leading batch dimension of 1.";
+    for (const std::vector<Tensor>* input_tensors : inputs) {
+      RET_CHECK((*input_tensors)[i].shape().dims == dims)
+          << "All input tensors in a batch must have the same shape.";
+    }
+    std::vector<int> batch_dims = dims;
+    batch_dims[0] = batch_size;
+    const TfLiteTensor* tensor = interpreter_->input_tensor(i);
+    if (!TfLiteIntArrayEqualsArray(tensor->dims, batch_dims.size(),
+                                   batch_dims.data())) {
+      RET_CHECK_EQ(interpreter_->ResizeInputTensorStrict(
+                       interpreter_->inputs()[i], batch_dims),
+                   kTfLiteOk)
+          << "The model doesn't support a batch size of " << batch_size
+          << " on input " << i << ".";
+      resized_tensor_shapes = true;
+    }
+  }
+  if (resized_tensor_shapes) {
+    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+
+  for (int i = 0; i < num_inputs; ++i) {
+    TfLiteTensor* tensor = interpreter_->input_tensor(i);
+    RET_CHECK_NE(tensor->type, kTfLiteString)
+        << "String inputs can't be batched.";
+    // The inputs are copied as raw bytes, so their element types must match
+    // the model exactly.
+    MP_ASSIGN_OR_RETURN(const Tensor::ElementType element_type,
+                        ElementTypeOf(tensor->type));
+    for (const std::vector<Tensor>* input_tensors : inputs) {
+      RET_CHECK((*input_tensors)[i].element_type() == element_type)
+          << "Input " << i << " doesn't have the element type of the model: "
+          << TfLiteTypeGetName(tensor->type) << ".";
+    }
+    RET_CHECK_EQ(tensor->bytes,
+                 static_cast<size_t>((*inputs[0])[i].bytes()) * batch_size);
+    char* batch_buffer = tensor->data.raw;
+    for (const std::vector<Tensor>* input_tensors : inputs) {
+      const Tensor& input_tensor = (*input_tensors)[i];
+      std::memcpy(batch_buffer,
+                  input_tensor.GetCpuReadView().buffer<char>(),
+                  input_tensor.bytes());
+      batch_buffer += input_tensor.bytes();
+    }
+  }
+
+  // Run inference.
+  {
+    MEDIAPIPE_PROFILING(CPU_TASK_INVOKE, cc);
+    RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+  }
+
+  // Splits the outputs along the batch dimension.
+  std::vector<std::vector<Tensor>> outputs(batch_size);
+  for (int i = 0; i < interpreter_->outputs().size(); ++i) {
+    const TfLiteTensor* tensor = interpreter_->output_tensor(i);
+    RET_CHECK(tensor->dims->size > 0 && tensor->dims->data[0] == batch_size)
+        << "Output " << i << " doesn't have a leading batch dimension.";
+    std::vector<int> dims(tensor->dims->data,
+                          tensor->dims->data + tensor->dims->size);
+    dims[0] = 1;
+    const size_t slice_bytes = tensor->bytes / batch_size;
+    for (int b = 0; b < batch_size; ++b) {
+      MP_ASSIGN_OR_RETURN(Tensor output_tensor,
+                          CreateTensorLike(*tensor, Tensor::Shape(dims)));
+      RET_CHECK_EQ(output_tensor.bytes(), slice_bytes);
+      std::memcpy(output_tensor.GetCpuWriteView().buffer<char>(),
+                  tensor->data.raw + b * slice_bytes, slice_bytes);
+      outputs[b].push_back(std::move(output_tensor));
+    }
+  }
+  return outputs;
+}
+
 absl::StatusOr<std::unique_ptr<InferenceRunner>>
 CreateInferenceInterpreterDelegateRunner(
     api2::Packet<TfLiteModelPtr> model,
@@ -1,9 +1,14 @@
 #ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_H_
 #define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_H_
 
+#include <utility>
+#include <vector>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/status_macros.h"
 
 namespace mediapipe {
 
@@ -13,6 +18,25 @@ class InferenceRunner {
   virtual ~InferenceRunner() = default;
   virtual absl::StatusOr<std::vector<Tensor>> Run(
       CalculatorContext* cc, const std::vector<Tensor>& inputs) = 0;
+
+  // Runs inference on the inputs of several timestamps and returns the
+  // outputs for each of them, in the same order. Each element of "inputs" is
+  // what Run() would receive for that timestamp.
+  //
+  // Runners that can stack the inputs along the batch dimension and invoke the
+  // model once should override this. The default implementation calls Run()
+  // for each input.
+  virtual absl::StatusOr<std::vector<std::vector<Tensor>>> RunBatch(
+      CalculatorContext* cc,
+      absl::Span<const std::vector<Tensor>* const> inputs) {
+    std::vector<std::vector<Tensor>> outputs;
+    outputs.reserve(inputs.size());
+    for (const std::vector<Tensor>* input : inputs) {
+      MP_ASSIGN_OR_RETURN(std::vector<Tensor> output, Run(cc, *input));
+      outputs.push_back(std::move(output));
+    }
+    return outputs;
+  }
 };
 
 }  // namespace mediapipe
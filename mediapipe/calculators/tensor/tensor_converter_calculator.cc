@@ -118,7 +118,9 @@ namespace mediapipe {
 // as a pre-processing step for calculator inputs.
 //
 // IMAGE and IMAGE_GPU inputs are normalized to [-1,1] (default) or [0,1],
-// specified by options (unless outputting a quantized tensor).
+// specified by options (unless outputting a quantized tensor). IMAGE inputs
+// can also be quantized to kUInt8 or kInt8 tensors, and laid out as NCHW
+// instead of NHWC, in the same pass.
 //
 // Input:
 //  One of the following tags:
@@ -182,6 +184,7 @@ class TensorConverterCalculator : public CalculatorBase {
   bool flip_vertically_ = false;
   bool row_major_matrix_ = false;
   int max_num_channels_ = 3;
+  ImageTensorFormat image_tensor_format_;
 };
 REGISTER_CALCULATOR(TensorConverterCalculator);
 
@@ -283,7 +286,8 @@ absl::Status TensorConverterCalculator::ProcessCPU(CalculatorContext* cc) {
                             image_frame,
                             output_range_.has_value() ? output_range_.value()
                                                       : kDefaultOutputRange,
-                            flip_vertically_, max_num_channels_));
+                            flip_vertically_, max_num_channels_,
+                            image_tensor_format_));
     output_tensors->emplace_back(std::move(output));
   } else if (cc->Inputs().HasTag(kMatrixTag)) {
     if (cc->Inputs().Tag(kMatrixTag).IsEmpty()) {
@@ -629,6 +633,34 @@ absl::Status TensorConverterCalculator::LoadOptions(CalculatorContext* cc,
         -options.custom_sub() + 255.0 / options.custom_div()));
   }
 
+  // Get the quantization and layout of image tensors.
+  RET_CHECK(!options.use_quantized_tensors() ||
+            !options.has_output_tensor_quantization())
+      << "Cannot specify both use_quantized_tensors and "
+         "output_tensor_quantization options";
+  if (options.use_quantized_tensors()) {
+    // Outputs the pixel values as they are.
+    output_range_.emplace(0.0f, 255.0f);
+    image_tensor_format_.element_type = Tensor::ElementType::kUInt8;
+  }
+  if (options.has_output_tensor_quantization()) {
+    const auto& quantization = options.output_tensor_quantization();
+    RET_CHECK_GT(quantization.scale(), 0.0f);
+    image_tensor_format_.element_type =
+        quantization.element_type() ==
+                TensorConverterCalculatorOptions::TensorQuantization::INT8
+            ? Tensor::ElementType::kInt8
+            : Tensor::ElementType::kUInt8;
+    image_tensor_format_.quantization = {quantization.scale(),
+                                         quantization.zero_point()};
+  }
+  image_tensor_format_.planar =
+      options.tensor_layout() == TensorConverterCalculatorOptions::NCHW;
+  RET_CHECK(!use_gpu || (image_tensor_format_.element_type ==
+                             Tensor::ElementType::kFloat32 &&
+                         !image_tensor_format_.planar))
+      << "Quantized and NCHW tensors are only supported for IMAGE inputs";
+
   // Get y-flip mode.
   MP_ASSIGN_OR_RETURN(flip_vertically_, ShouldFlipVertically(options, use_gpu));
 
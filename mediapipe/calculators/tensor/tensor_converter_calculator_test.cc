@@ -259,6 +259,171 @@ TEST_F(TensorConverterCalculatorTest, CustomDivAndSub) {
   MP_ASSERT_OK(graph.WaitUntilDone());
 }
 
+TEST_F(TensorConverterCalculatorTest, QuantizeToInt8) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input_image"
+        node {
+          calculator: "TensorConverterCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.TensorConverterCalculatorOptions.ext] {
+              zero_center: true
+              output_tensor_quantization {
+                element_type: INT8
+                scale: 0.0078125
+                zero_point: 0
+              }
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+
+  // Run the graph.
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  auto input_image = std::make_unique<ImageFrame>(ImageFormat::GRAY8, 2, 1);
+  cv::Mat mat = mediapipe::formats::MatView(input_image.get());
+  mat.at<uint8_t>(0, 0) = 200;
+  mat.at<uint8_t>(0, 1) = 0;
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input_image", Adopt(input_image.release()).At(Timestamp(0))));
+
+  // Wait until the calculator finishes processing.
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_EQ(output_packets.size(), 1);
+
+  // Get and process results.
+  const std::vector<Tensor>& tensor_vec =
+      output_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(tensor_vec.size(), 1);
+
+  const Tensor* tensor = &tensor_vec[0];
+  EXPECT_EQ(tensor->element_type(), Tensor::ElementType::kInt8);
+  EXPECT_FLOAT_EQ(tensor->quantization_parameters().scale, 0.0078125f);
+  EXPECT_EQ(tensor->quantization_parameters().zero_point, 0);
+  auto view = tensor->GetCpuReadView();
+  // 200 is normalized to 0.5686, quantized to round(0.5686 * 128), and 0 to
+  // -1, quantized to -128.
+  EXPECT_EQ(view.buffer<int8_t>()[0], 73);
+  EXPECT_EQ(view.buffer<int8_t>()[1], -128);
+
+  // Fully close graph at end, otherwise calculator+tensors are destroyed
+  // after calling WaitUntilDone().
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST_F(TensorConverterCalculatorTest, UseQuantizedTensors) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input_image"
+        node {
+          calculator: "TensorConverterCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.TensorConverterCalculatorOptions.ext] {
+              use_quantized_tensors: true
+              output_tensor_float_range { min: -1 max: 1 }
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+
+  // Run the graph.
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  auto input_image = std::make_unique<ImageFrame>(ImageFormat::GRAY8, 2, 1);
+  cv::Mat mat = mediapipe::formats::MatView(input_image.get());
+  mat.at<uint8_t>(0, 0) = 200;
+  mat.at<uint8_t>(0, 1) = 0;
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input_image", Adopt(input_image.release()).At(Timestamp(0))));
+
+  // Wait until the calculator finishes processing.
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_EQ(output_packets.size(), 1);
+
+  // Get and process results.
+  const std::vector<Tensor>& tensor_vec =
+      output_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(tensor_vec.size(), 1);
+
+  // The pixel values are kept as they are, ignoring the float range.
+  const Tensor* tensor = &tensor_vec[0];
+  EXPECT_EQ(tensor->element_type(), Tensor::ElementType::kUInt8);
+  EXPECT_EQ(tensor->shape().dims, std::vector<int>({1, 1, 2, 1}));
+  auto view = tensor->GetCpuReadView();
+  EXPECT_EQ(view.buffer<uint8_t>()[0], 200);
+  EXPECT_EQ(view.buffer<uint8_t>()[1], 0);
+
+  // Fully close graph at end, otherwise calculator+tensors are destroyed
+  // after calling WaitUntilDone().
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST_F(TensorConverterCalculatorTest, OutputNchwLayout) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input_image"
+        node {
+          calculator: "TensorConverterCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.TensorConverterCalculatorOptions.ext] {
+              output_tensor_float_range { min: 0 max: 255 }
+              tensor_layout: NCHW
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+
+  // Run the graph.
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  auto input_image = std::make_unique<ImageFrame>(ImageFormat::SRGBA, 2, 1);
+  cv::Mat mat = mediapipe::formats::MatView(input_image.get());
+  mat.at<cv::Vec4b>(0, 0) = cv::Vec4b(1, 2, 3, 4);
+  mat.at<cv::Vec4b>(0, 1) = cv::Vec4b(5, 6, 7, 8);
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input_image", Adopt(input_image.release()).At(Timestamp(0))));
+
+  // Wait until the calculator finishes processing.
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_EQ(output_packets.size(), 1);
+
+  // Get and process results.
+  const std::vector<Tensor>& tensor_vec =
+      output_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(tensor_vec.size(), 1);
+
+  const Tensor* tensor = &tensor_vec[0];
+  EXPECT_EQ(tensor->shape().dims, std::vector<int>({1, 3, 1, 2}));
+  auto view = tensor->GetCpuReadView();
+  const float* dataf = view.buffer<float>();
+  // Alpha is dropped, and each channel is a plane.
+  EXPECT_THAT(std::vector<float>(dataf, dataf + 6),
+              testing::ElementsAre(1, 5, 2, 6, 3, 7));
+
+  // Fully close graph at end, otherwise calculator+tensors are destroyed
+  // after calling WaitUntilDone().
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 TEST_F(TensorConverterCalculatorTest, SetOutputRange) {
   std::vector<std::pair<float, float>> range_values = {
       std::make_pair(0.0, 1.0), std::make_pair(-1.0, 1.0),
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 #include "absl/status/status.h"
@@ -34,34 +35,153 @@ typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
 typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>
     ColMajorMatrixXf;
 
-template <class T>
-absl::Status NormalizeImage(const ImageFrame& image_frame, bool flip_vertically,
-                            const std::pair<float, float>& output_range,
-                            int max_num_channels, float* tensor_ptr) {
+// Writes "value" to a tensor element. Integer values are rounded and
+// saturated.
+inline void Store(float value, float* out) { *out = value; }
+inline void Store(float value, uint8_t* out) {
+  *out = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+}
+inline void Store(float value, int8_t* out) {
+  *out = static_cast<int8_t>(
+      static_cast<int>(std::clamp(value, -128.0f, 127.0f) + 128.5f) - 128);
+}
+
+// Writes the first kDstChannels of the kSrcChannels of each pixel as
+// value * scale + bias. Each row is converted in one pass, with loops the
+// compiler can vectorize: a row is contiguous in the tensor when no channel is
+// dropped, and each channel of a row is contiguous in planar tensors.
+template <class T, class U, int kSrcChannels, int kDstChannels>
+void NormalizeRows(const ImageFrame& image_frame, bool flip_vertically,
+                   bool planar, float scale, float bias, U* tensor_ptr) {
+  const int height = image_frame.Height();
+  const int width = image_frame.Width();
+  const int plane_size = height * width;
+  for (int y = 0; y < height; ++y) {
+    const T* src = reinterpret_cast<const T*>(
+        image_frame.PixelData() +
+        (flip_vertically ? height - 1 - y : y) * image_frame.WidthStep());
+    if (planar) {
+      for (int c = 0; c < kDstChannels; ++c) {
+        U* dst = tensor_ptr + c * plane_size + y * width;
+        for (int x = 0; x < width; ++x) {
+          Store(src[x * kSrcChannels + c] * scale + bias, &dst[x]);
+        }
+      }
+    } else if (kSrcChannels == kDstChannels) {
+      U* dst = tensor_ptr + y * width * kDstChannels;
+      for (int i = 0; i < width * kDstChannels; ++i) {
+        Store(src[i] * scale + bias, &dst[i]);
+      }
+    } else {
+      U* dst = tensor_ptr + y * width * kDstChannels;
+      for (int x = 0; x < width; ++x) {
+        for (int c = 0; c < kDstChannels; ++c) {
+          Store(src[x * kSrcChannels + c] * scale + bias,
+                &dst[x * kDstChannels + c]);
+        }
+      }
+    }
+  }
+}
+
+// Like NormalizeRows, for the channel counts that have no specialization.
+template <class T, class U>
+void NormalizePixels(const ImageFrame& image_frame, int src_channels,
+                     int dst_channels, bool flip_vertically, bool planar,
+                     float scale, float bias, U* tensor_ptr) {
   const int height = image_frame.Height();
   const int width = image_frame.Width();
+  const int plane_size = height * width;
+  for (int y = 0; y < height; ++y) {
+    const T* src = reinterpret_cast<const T*>(
+        image_frame.PixelData() +
+        (flip_vertically ? height - 1 - y : y) * image_frame.WidthStep());
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < dst_channels; ++c) {
+        U* dst = planar ? &tensor_ptr[c * plane_size + y * width + x]
+                        : &tensor_ptr[(y * width + x) * dst_channels + c];
+        Store(src[x * src_channels + c] * scale + bias, dst);
+      }
+    }
+  }
+}
+
+template <class T, class U>
+absl::Status NormalizeImage(const ImageFrame& image_frame, bool flip_vertically,
+                            const std::pair<float, float>& output_range,
+                            int max_num_channels, bool planar,
+                            const Tensor::QuantizationParameters& quantization,
+                            U* tensor_ptr) {
   const int channels = image_frame.NumberOfChannels();
   const int channels_preserved = std::min(channels, max_num_channels);
-  const int channels_ignored = channels - channels_preserved;
 
   RET_CHECK_NE(output_range.first, output_range.second);
-  const float scale = (output_range.second - output_range.first) / 255.0f;
-  const float bias = output_range.first;
+  float scale = (output_range.second - output_range.first) / 255.0f;
+  float bias = output_range.first;
+  if (!std::is_same_v<U, float>) {
+    RET_CHECK_GT(quantization.scale, 0.0f);
+    scale /= quantization.scale;
+    bias = bias / quantization.scale + quantization.zero_point;
+  }
 
-  for (int i = 0; i < height; ++i) {
-    const T* image_ptr = reinterpret_cast<const T*>(
-        image_frame.PixelData() +
-        (flip_vertically ? height - 1 - i : i) * image_frame.WidthStep());
-    for (int j = 0; j < width; ++j) {
-      for (int c = 0; c < channels_preserved; ++c) {
-        *tensor_ptr++ = *image_ptr++ * scale + bias;
-      }
-      image_ptr += channels_ignored;
-    }
+  switch (channels * 10 + channels_preserved) {
+    case 11:
+      NormalizeRows<T, U, 1, 1>(image_frame, flip_vertically, planar, scale,
+                                bias, tensor_ptr);
+      break;
+    case 31:
+      NormalizeRows<T, U, 3, 1>(image_frame, flip_vertically, planar, scale,
+                                bias, tensor_ptr);
+      break;
+    case 33:
+      NormalizeRows<T, U, 3, 3>(image_frame, flip_vertically, planar, scale,
+                                bias, tensor_ptr);
+      break;
+    case 41:
+      NormalizeRows<T, U, 4, 1>(image_frame, flip_vertically, planar, scale,
+                                bias, tensor_ptr);
+      break;
+    case 43:
+      NormalizeRows<T, U, 4, 3>(image_frame, flip_vertically, planar, scale,
+                                bias, tensor_ptr);
+      break;
+    case 44:
+      NormalizeRows<T, U, 4, 4>(image_frame, flip_vertically, planar, scale,
+                                bias, tensor_ptr);
+      break;
+    default:
+      RET_CHECK_GT(channels_preserved, 0);
+      NormalizePixels<T, U>(image_frame, channels, channels_preserved,
+                            flip_vertically, planar, scale, bias, tensor_ptr);
   }
   return absl::OkStatus();
 }
 
+template <class T>
+absl::Status NormalizeImage(const ImageFrame& image_frame, bool flip_vertically,
+                            const std::pair<float, float>& output_range,
+                            int max_num_channels,
+                            const ImageTensorFormat& format, Tensor& tensor) {
+  auto cpu_view = tensor.GetCpuWriteView();
+  switch (format.element_type) {
+    case Tensor::ElementType::kFloat32:
+      return NormalizeImage<T>(image_frame, flip_vertically, output_range,
+                               max_num_channels, format.planar,
+                               format.quantization, cpu_view.buffer<float>());
+    case Tensor::ElementType::kUInt8:
+      return NormalizeImage<T>(image_frame, flip_vertically, output_range,
+                               max_num_channels, format.planar,
+                               format.quantization, cpu_view.buffer<uint8_t>());
+    case Tensor::ElementType::kInt8:
+      return NormalizeImage<T>(image_frame, flip_vertically, output_range,
+                               max_num_channels, format.planar,
+                               format.quantization, cpu_view.buffer<int8_t>());
+    default:
+      RET_CHECK_FAIL() << "Unsupported tensor element type: "
+                       << static_cast<int>(format.element_type);
+  }
+}
+
 }  // namespace
 
 absl::Status NormalizeUInt8Image(const ImageFrame& image_frame,
@@ -69,7 +189,8 @@ absl::Status NormalizeUInt8Image(const ImageFrame& image_frame,
                                  const std::pair<float, float>& output_range,
                                  int max_num_channels, float* tensor_ptr) {
   return NormalizeImage<uint8_t>(image_frame, flip_vertically, output_range,
-                                 max_num_channels, tensor_ptr);
+                                 max_num_channels, /*planar=*/false,
+                                 /*quantization=*/{}, tensor_ptr);
 }
 
 absl::Status NormalizeFloatImage(const ImageFrame& image_frame,
@@ -77,7 +198,8 @@ absl::Status NormalizeFloatImage(const ImageFrame& image_frame,
                                  const std::pair<float, float>& output_range,
                                  int max_num_channels, float* tensor_ptr) {
   return NormalizeImage<float>(image_frame, flip_vertically, output_range,
-                               max_num_channels, tensor_ptr);
+                               max_num_channels, /*planar=*/false,
+                               /*quantization=*/{}, tensor_ptr);
 }
 
 absl::Status CopyMatrixToTensor(const Matrix& matrix, bool is_row_major_matrix,
@@ -97,31 +219,42 @@ absl::Status CopyMatrixToTensor(const Matrix& matrix, bool is_row_major_matrix,
 absl::StatusOr<Tensor> ConvertImageFrameToTensorOnCpu(
     const ImageFrame& image_frame, const std::pair<float, float>& output_range,
     bool flip_vertically, int max_num_channels) {
+  return ConvertImageFrameToTensorOnCpu(image_frame, output_range,
+                                        flip_vertically, max_num_channels,
+                                        ImageTensorFormat());
+}
+
+absl::StatusOr<Tensor> ConvertImageFrameToTensorOnCpu(
+    const ImageFrame& image_frame, const std::pair<float, float>& output_range,
+    bool flip_vertically, int max_num_channels,
+    const ImageTensorFormat& format) {
   const int height = image_frame.Height();
   const int width = image_frame.Width();
   const int channels = image_frame.NumberOfChannels();
   const int channels_preserved = std::min(channels, max_num_channels);
-  const mediapipe::ImageFormat::Format format = image_frame.Format();
+  const mediapipe::ImageFormat::Format image_format = image_frame.Format();
 
-  if (!(format == mediapipe::ImageFormat::SRGBA ||
-        format == mediapipe::ImageFormat::SRGB ||
-        format == mediapipe::ImageFormat::GRAY8 ||
-        format == mediapipe::ImageFormat::VEC32F1))
+  if (!(image_format == mediapipe::ImageFormat::SRGBA ||
+        image_format == mediapipe::ImageFormat::SRGB ||
+        image_format == mediapipe::ImageFormat::GRAY8 ||
+        image_format == mediapipe::ImageFormat::VEC32F1))
     RET_CHECK_FAIL() << "Unsupported CPU input format.";
 
-  Tensor output_tensor(Tensor::ElementType::kFloat32,
-                       Tensor::Shape{1, height, width, channels_preserved});
-  auto cpu_view = output_tensor.GetCpuWriteView();
+  Tensor output_tensor(
+      format.element_type,
+      format.planar ? Tensor::Shape{1, channels_preserved, height, width}
+                    : Tensor::Shape{1, height, width, channels_preserved},
+      format.quantization);
 
   // Copy image data into tensor.
   if (image_frame.ByteDepth() == 1) {
-    MP_RETURN_IF_ERROR(NormalizeUInt8Image(image_frame, flip_vertically,
-                                           output_range, max_num_channels,
-                                           cpu_view.buffer<float>()));
+    MP_RETURN_IF_ERROR(NormalizeImage<uint8_t>(image_frame, flip_vertically,
+                                               output_range, max_num_channels,
+                                               format, output_tensor));
   } else if (image_frame.ByteDepth() == 4) {
-    MP_RETURN_IF_ERROR(NormalizeFloatImage(image_frame, flip_vertically,
-                                           output_range, max_num_channels,
-                                           cpu_view.buffer<float>()));
+    MP_RETURN_IF_ERROR(NormalizeImage<float>(image_frame, flip_vertically,
+                                             output_range, max_num_channels,
+                                             format, output_tensor));
   } else {
     return absl::InternalError(
         "Only byte-based (8 bit) and float (32 bit) images supported.");
@@ -25,6 +25,20 @@
 
 namespace mediapipe {
 
+// Layout and element type of a tensor converted from an image.
+struct ImageTensorFormat {
+  // Stores each channel in its own plane, in a tensor of shape
+  // {1, channels, height, width}, instead of interleaving the channels in a
+  // tensor of shape {1, height, width, channels}.
+  bool planar = false;
+
+  // kFloat32, kUInt8 or kInt8. Integer tensors hold the normalized values v
+  // quantized as round(v / quantization.scale) + quantization.zero_point,
+  // saturated to the element type.
+  Tensor::ElementType element_type = Tensor::ElementType::kFloat32;
+  Tensor::QuantizationParameters quantization;
+};
+
 // Converts an ImageFrame to a vector of Tensors.
 // @flip_vertically enables to flip the image during conversion.
 // @max_num_channels can be used to reserve extra channels in the output
@@ -34,6 +48,13 @@ absl::StatusOr<Tensor> ConvertImageFrameToTensorOnCpu(
     const ImageFrame& image_frame, const std::pair<float, float>& output_range,
     bool flip_vertically, int max_num_channels);
 
+// Like above, but converts to a tensor of "format". Flipping, dropping
+// channels, normalizing and quantizing take a single pass over the image.
+absl::StatusOr<Tensor> ConvertImageFrameToTensorOnCpu(
+    const ImageFrame& image_frame, const std::pair<float, float>& output_range,
+    bool flip_vertically, int max_num_channels,
+    const ImageTensorFormat& format);
+
 // Converts a Matrix to a vector of Tensors.
 // @row_major_matrix defines the ordering in the input matrix.
 // @max_num_channels can be used to reserve extra channels in the output
@@ -14,10 +14,13 @@
 
 #include "mediapipe/calculators/tensor/tensor_converter_cpu.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <utility>
 #include <vector>
 
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/gmock.h"
@@ -38,6 +41,19 @@ Matrix CreateTestMatrix(int num_rows, int num_columns) {
   return matrix;
 }
 
+// Returns an SRGBA image whose channel c of pixel (x, y) is
+// (y * width + x) * 4 + c.
+ImageFrame CreateTestSrgbaImageFrame(int width, int height) {
+  ImageFrame image_frame(ImageFormat::SRGBA, width, height);
+  for (int y = 0; y < height; ++y) {
+    uint8_t* row = image_frame.MutablePixelData() + y * image_frame.WidthStep();
+    for (int i = 0; i < width * 4; ++i) {
+      row[i] = y * width * 4 + i;
+    }
+  }
+  return image_frame;
+}
+
 TEST(TensorConverterCpuTest, ShouldCopyMatrixInRowMajorFormatToTensor) {
   auto test_matrix = CreateTestMatrix(/* num_rows=*/3, /*num_columns=*/4);
   std::vector<float> tensor_data(test_matrix.size(), 0.0f);
@@ -156,6 +172,138 @@ TEST(TensorConverterCpuTest, ConvertImageFrameToTensorOnCpu) {
   }
 }
 
+TEST(TensorConverterCpuTest, ShouldDropAlphaAndFlip) {
+  auto rgba_image_frame = CreateTestSrgbaImageFrame(/*width=*/3, /*height=*/2);
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      Tensor output, ConvertImageFrameToTensorOnCpu(rgba_image_frame,
+                                                    {0.0f, 255.0f},
+                                                    /*flip_vertically=*/true,
+                                                    /*max_num_channels=*/3));
+
+  EXPECT_EQ(output.shape().dims, std::vector<int>({1, 2, 3, 3}));
+  const auto cpu_read_view = output.GetCpuReadView();
+  const float* tensor_ptr = cpu_read_view.buffer<float>();
+  for (int y = 0; y < 2; ++y) {
+    for (int x = 0; x < 3; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_FLOAT_EQ(*tensor_ptr++, ((1 - y) * 3 + x) * 4 + c);
+      }
+    }
+  }
+}
+
+TEST(TensorConverterCpuTest, ShouldConvertToPlanarLayout) {
+  auto rgba_image_frame = CreateTestSrgbaImageFrame(/*width=*/3, /*height=*/2);
+  ImageTensorFormat format;
+  format.planar = true;
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      Tensor output,
+      ConvertImageFrameToTensorOnCpu(rgba_image_frame, {0.0f, 255.0f},
+                                     /*flip_vertically=*/false,
+                                     /*max_num_channels=*/3, format));
+
+  EXPECT_EQ(output.shape().dims, std::vector<int>({1, 3, 2, 3}));
+  const auto cpu_read_view = output.GetCpuReadView();
+  const float* tensor_ptr = cpu_read_view.buffer<float>();
+  for (int c = 0; c < 3; ++c) {
+    for (int y = 0; y < 2; ++y) {
+      for (int x = 0; x < 3; ++x) {
+        EXPECT_FLOAT_EQ(*tensor_ptr++, (y * 3 + x) * 4 + c);
+      }
+    }
+  }
+}
+
+TEST(TensorConverterCpuTest, ShouldKeepTwoOfFourChannels) {
+  auto rgba_image_frame = CreateTestSrgbaImageFrame(/*width=*/3, /*height=*/2);
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      Tensor output, ConvertImageFrameToTensorOnCpu(rgba_image_frame,
+                                                    {0.0f, 255.0f},
+                                                    /*flip_vertically=*/false,
+                                                    /*max_num_channels=*/2));
+
+  EXPECT_EQ(output.shape().dims, std::vector<int>({1, 2, 3, 2}));
+  const auto cpu_read_view = output.GetCpuReadView();
+  const float* tensor_ptr = cpu_read_view.buffer<float>();
+  for (int y = 0; y < 2; ++y) {
+    for (int x = 0; x < 3; ++x) {
+      for (int c = 0; c < 2; ++c) {
+        EXPECT_FLOAT_EQ(*tensor_ptr++, (y * 3 + x) * 4 + c);
+      }
+    }
+  }
+}
+
+TEST(TensorConverterCpuTest, ShouldKeepTwoOfThreeChannels) {
+  ImageFrame rgb_image_frame(ImageFormat::SRGB, /*width=*/3, /*height=*/2);
+  for (int y = 0; y < 2; ++y) {
+    uint8_t* row =
+        rgb_image_frame.MutablePixelData() + y * rgb_image_frame.WidthStep();
+    for (int i = 0; i < 3 * 3; ++i) {
+      row[i] = y * 3 * 3 + i;
+    }
+  }
+  std::vector<float> tensor(2 * 3 * 2);
+
+  MP_ASSERT_OK(NormalizeUInt8Image(rgb_image_frame, /*flip_vertically=*/true,
+                                   {0.0f, 255.0f}, /*max_num_channels=*/2,
+                                   tensor.data()));
+
+  const float* tensor_ptr = tensor.data();
+  for (int y = 0; y < 2; ++y) {
+    for (int x = 0; x < 3; ++x) {
+      for (int c = 0; c < 2; ++c) {
+        EXPECT_FLOAT_EQ(*tensor_ptr++, ((1 - y) * 3 + x) * 3 + c);
+      }
+    }
+  }
+}
+
+TEST(TensorConverterCpuTest, ShouldQuantizeToInt8) {
+  auto grey8_image_frame = CreateTestGrey8ImageFrame(/*width=*/3, /*height=*/4);
+  ImageTensorFormat format;
+  format.element_type = Tensor::ElementType::kInt8;
+  format.quantization = {1.0f / 255.0f, -128};
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      Tensor output,
+      ConvertImageFrameToTensorOnCpu(grey8_image_frame, {0.0f, 1.0f},
+                                     /*flip_vertically=*/false,
+                                     /*max_num_channels=*/1, format));
+
+  EXPECT_EQ(output.element_type(), Tensor::ElementType::kInt8);
+  EXPECT_FLOAT_EQ(output.quantization_parameters().scale, 1.0f / 255.0f);
+  EXPECT_EQ(output.quantization_parameters().zero_point, -128);
+  const auto cpu_read_view = output.GetCpuReadView();
+  const int8_t* tensor_ptr = cpu_read_view.buffer<int8_t>();
+  for (int i = 0; i < grey8_image_frame.Width() * grey8_image_frame.Height();
+       ++i) {
+    EXPECT_EQ(tensor_ptr[i], grey8_image_frame.PixelData()[i] - 128);
+  }
+}
+
+TEST(TensorConverterCpuTest, ShouldSaturateQuantizedValues) {
+  auto rgba_image_frame = CreateTestSrgbaImageFrame(/*width=*/40, /*height=*/1);
+  ImageTensorFormat format;
+  format.element_type = Tensor::ElementType::kUInt8;
+  format.quantization = {0.5f, 0};
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      Tensor output,
+      ConvertImageFrameToTensorOnCpu(rgba_image_frame, {0.0f, 255.0f},
+                                     /*flip_vertically=*/false,
+                                     /*max_num_channels=*/4, format));
+
+  const auto cpu_read_view = output.GetCpuReadView();
+  const uint8_t* tensor_ptr = cpu_read_view.buffer<uint8_t>();
+  for (int i = 0; i < 40 * 4; ++i) {
+    EXPECT_EQ(tensor_ptr[i], std::min(i * 2, 255));
+  }
+}
+
 TEST(TensorConverterCpuTest, ConvertMatrixToTensorOnCpu) {
   auto test_matrix = CreateTestMatrix(/*num_rows=*/3, /*num_columns=*/4);
 
@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -22,10 +25,14 @@
 #include "absl/strings/str_cat.h"
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_converter.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_converter_cpu.h"
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/executor_service.h"
 #include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -39,10 +46,6 @@
 #include "mediapipe/gpu/shader_util.h"
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
-#if !MEDIAPIPE_DISABLE_OPENCV
-#include "mediapipe/calculators/tensor/tensors_to_segmentation_converter_opencv.h"
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
-
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 #include "tensorflow/lite/delegates/gpu/gl/converters/util.h"
 #include "tensorflow/lite/delegates/gpu/gl/gl_program.h"
@@ -67,10 +70,38 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 
 constexpr char kTensorsTag[] = "TENSORS";
 constexpr char kOutputSizeTag[] = "OUTPUT_SIZE";
+constexpr char kRoiTag[] = "ROI";
 constexpr char kMaskTag[] = "MASK";
 }  // namespace
 
 namespace mediapipe {
+namespace {
+
+// Returns the pixels of a `width` x `height` mask covered by `roi`, or
+// std::nullopt if it covers none of them.
+absl::StatusOr<std::optional<MaskRect>> GetMaskRoi(const NormalizedRect& roi,
+                                                   int width, int height) {
+  RET_CHECK_EQ(roi.rotation(), 0.0f) << "Rotated ROIs are not supported.";
+  const int left = std::clamp(
+      static_cast<int>(std::floor((roi.x_center() - roi.width() / 2) * width)),
+      0, width);
+  const int right = std::clamp(
+      static_cast<int>(std::ceil((roi.x_center() + roi.width() / 2) * width)),
+      0, width);
+  const int top = std::clamp(
+      static_cast<int>(
+          std::floor((roi.y_center() - roi.height() / 2) * height)),
+      0, height);
+  const int bottom = std::clamp(
+      static_cast<int>(
+          std::ceil((roi.y_center() + roi.height() / 2) * height)),
+      0, height);
+  if (left >= right || top >= bottom) return std::nullopt;
+  return MaskRect{
+      .left = left, .top = top, .width = right - left, .height = bottom - top};
+}
+
+}  // namespace
 
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 using ::tflite::gpu::gl::GlProgram;
@@ -80,7 +111,8 @@ using ::tflite::gpu::gl::GlShader;
 // Converts Tensors from a tflite segmentation model to an image mask.
 //
 // Performs optional upscale to OUTPUT_SIZE dimensions if provided,
-// otherwise the mask is the same size as input tensor.
+// otherwise the mask is the same size as input tensor. The output_scale option
+// scales that size further down, or up.
 //
 // If at least one input tensor is already on GPU, processing happens on GPU and
 // the output mask is also stored on GPU. Otherwise, processing and the output
@@ -88,6 +120,8 @@ using ::tflite::gpu::gl::GlShader;
 //
 // On GPU, the mask is an RGBA image, in both the R & A channels, scaled 0-1.
 // On CPU, the mask is a ImageFormat::VEC32F1 image, with values scaled 0-1.
+// The activation is applied while the mask is upsampled, in tiles of rows
+// which run in parallel on the graph's default executor.
 //
 //
 // Inputs:
@@ -97,6 +131,10 @@ using ::tflite::gpu::gl::GlShader;
 //            options.
 //   OUTPUT_SIZE(optional): std::pair<int, int>,
 //                          If provided, the size to upscale mask to.
+//   ROI(optional): NormalizedRect, CPU only. If provided, only the region of
+//                  the mask it covers is computed and output, which is then
+//                  smaller than the size above. Must not be rotated. No mask
+//                  is output for a ROI outside of the mask.
 //
 // Output:
 //   MASK: An Image output mask, RGBA(GPU) / VEC32F1(CPU).
@@ -140,14 +178,15 @@ class TensorsToSegmentationCalculator : public CalculatorBase {
   bool DoesGpuTextureStartAtBottom() {
     return options_.gpu_origin() != mediapipe::GpuOrigin_Mode_TOP_LEFT;
   }
-  absl::Status InitConverterIfNecessary() {
-#if !MEDIAPIPE_DISABLE_OPENCV
+  absl::Status InitConverterIfNecessary(CalculatorContext* cc) {
     if (!cpu_converter_) {
-      MP_ASSIGN_OR_RETURN(cpu_converter_, CreateOpenCvConverter(options_));
+      auto executor_service = cc->Service(kDefaultExecutorService);
+      Executor* executor = executor_service.IsAvailable()
+                               ? &executor_service.GetObject()
+                               : nullptr;
+      MP_ASSIGN_OR_RETURN(cpu_converter_,
+                          CreateCpuConverter(options_, executor));
     }
-#else
-    RET_CHECK_FAIL() << "OpenCV processing disabled.";
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
     return absl::OkStatus();
   }
 
@@ -185,10 +224,15 @@ absl::Status TensorsToSegmentationCalculator::GetContract(
   if (cc->Inputs().HasTag(kOutputSizeTag)) {
     cc->Inputs().Tag(kOutputSizeTag).Set<std::pair<int, int>>();
   }
+  if (cc->Inputs().HasTag(kRoiTag)) {
+    cc->Inputs().Tag(kRoiTag).Set<NormalizedRect>();
+  }
 
   // Outputs.
   cc->Outputs().Tag(kMaskTag).Set<Image>();
 
+  cc->UseService(kDefaultExecutorService).Optional();
+
   if (CanUseGpu()) {
 #if !MEDIAPIPE_DISABLE_GPU
     MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(
@@ -269,6 +313,25 @@ absl::Status TensorsToSegmentationCalculator::Process(CalculatorContext* cc) {
     output_width = size.first;
     output_height = size.second;
   }
+  if (const float scale = options_.output_scale(); scale != 1.0f) {
+    RET_CHECK_GT(scale, 0.0f);
+    output_width =
+        std::max(1, static_cast<int>(std::round(output_width * scale)));
+    output_height =
+        std::max(1, static_cast<int>(std::round(output_height * scale)));
+  }
+  std::optional<MaskRect> roi;
+  if (cc->Inputs().HasTag(kRoiTag) && !cc->Inputs().Tag(kRoiTag).IsEmpty()) {
+    RET_CHECK(!use_gpu) << "ROI is only supported on CPU.";
+    MP_ASSIGN_OR_RETURN(
+        roi, GetMaskRoi(cc->Inputs().Tag(kRoiTag).Get<NormalizedRect>(),
+                        output_width, output_height));
+    if (!roi.has_value()) {
+      // The ROI left the frame, e.g. a tracked object that went out of view.
+      // Timestamp bound update happens automatically. (See Open().)
+      return absl::OkStatus();
+    }
+  }
 
   if (use_gpu) {
 #if !MEDIAPIPE_DISABLE_GPU
@@ -292,17 +355,20 @@ absl::Status TensorsToSegmentationCalculator::Process(CalculatorContext* cc) {
     RET_CHECK_FAIL() << "GPU processing disabled.";
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
-#if !MEDIAPIPE_DISABLE_OPENCV
     // Lazily initialize converter.
-    MP_RETURN_IF_ERROR(InitConverterIfNecessary());
-    MP_ASSIGN_OR_RETURN(
-        std::unique_ptr<Image> output_mask,
-        cpu_converter_->Convert(input_tensors, output_width, output_height));
+    MP_RETURN_IF_ERROR(InitConverterIfNecessary(cc));
+    std::unique_ptr<Image> output_mask;
+    if (roi.has_value()) {
+      MP_ASSIGN_OR_RETURN(output_mask,
+                          cpu_converter_->Convert(input_tensors, output_width,
+                                                  output_height, *roi));
+    } else {
+      MP_ASSIGN_OR_RETURN(output_mask, cpu_converter_->Convert(
+                                           input_tensors, output_width,
+                                           output_height));
+    }
     cc->Outputs().Tag(kMaskTag).Add(output_mask.release(),
                                     cc->InputTimestamp());
-#else
-    RET_CHECK_FAIL() << "OpenCV processing disabled.";
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
   }
 
   return absl::OkStatus();
@@ -17,23 +17,31 @@
 #include <utility>
 #include <vector>
 
+#include "absl/status/statusor.h"
+#include "absl/strings/substitute.h"
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_calculator_test_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_opencv.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/framework/timestamp.h"
+#include "mediapipe/framework/tool/sink.h"
 
 namespace mediapipe {
 namespace {
 
+using ::testing::HasSubstr;
 using ::testing::SizeIs;
 using ::testing::TestWithParam;
 using Options = mediapipe::TensorsToSegmentationCalculatorOptions;
@@ -204,5 +212,128 @@ INSTANTIATE_TEST_SUITE_P(
       return info.param.test_name;
     });
 
+// Runs a CPU graph on a 4x4 tensor holding 1 to 16 with an OUTPUT_SIZE of
+// `width` x `height`, an optional `roi` and the given `options`, and returns
+// the mask, or nullptr if none was output.
+absl::StatusOr<std::shared_ptr<const ImageFrame>> RunWithTensor4x4(
+    const std::string& options, int width, int height,
+    const NormalizedRect* roi) {
+  auto graph_config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      absl::Substitute(R"pb(
+                         input_stream: "tensors"
+                         input_stream: "size"
+                         input_stream: "roi"
+                         node {
+                           calculator: "TensorsToSegmentationCalculator"
+                           input_stream: "TENSORS:tensors"
+                           input_stream: "OUTPUT_SIZE:size"
+                           input_stream: "ROI:roi"
+                           output_stream: "MASK:mask"
+                           options {
+                             [mediapipe.TensorsToSegmentationCalculatorOptions
+                                  .ext] { $0 }
+                           }
+                         }
+                       )pb",
+                       options));
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("mask", &graph_config, &output_packets);
+  CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(graph_config));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+
+  auto tensors = std::make_unique<std::vector<Tensor>>();
+  tensors->emplace_back(Tensor::ElementType::kFloat32,
+                        Tensor::Shape{1, 4, 4, 1});
+  {
+    auto view = tensors->back().GetCpuWriteView();
+    for (int i = 0; i < 16; ++i) view.buffer<float>()[i] = i + 1;
+  }
+  MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+      "tensors", Adopt(tensors.release()).At(Timestamp(0))));
+  MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+      "size",
+      MakePacket<std::pair<int, int>>(width, height).At(Timestamp(0))));
+  if (roi != nullptr) {
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        "roi", MakePacket<NormalizedRect>(*roi).At(Timestamp(0))));
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  RET_CHECK_LE(output_packets.size(), 1);
+  if (output_packets.empty()) return nullptr;
+  return output_packets[0].Get<Image>().GetImageFrameSharedPtr();
+}
+
+float MaskValue(const ImageFrame& mask, int x, int y) {
+  return reinterpret_cast<const float*>(mask.PixelData() +
+                                        y * mask.WidthStep())[x];
+}
+
+TEST(TensorsToSegmentationCalculatorRoiTest, OutputsRegionOfMask) {
+  // Upsampled 4x4 tensor of the OutputResizeOnly test case.
+  constexpr float kMask[5][6] = {
+      {1, 1.5, 2.166667, 2.833333, 3.5, 4},
+      {3.8, 4.3, 4.966667, 5.633333, 6.3, 6.8},
+      {7, 7.5, 8.166667, 8.833333, 9.5, 10},
+      {10.2, 10.7, 11.366667, 12.033333, 12.7, 13.2},
+      {13, 13.5, 14.166667, 14.833333, 15.5, 16}};
+  NormalizedRect roi;
+  roi.set_x_center(0.5f);
+  roi.set_y_center(0.5f);
+  roi.set_width(0.5f);
+  roi.set_height(0.4f);
+  // The ROI covers x in [1.5, 4.5] and y in [1.5, 3.5], so the mask is made
+  // of the pixels (1, 1) to (4, 3).
+  MP_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ImageFrame> mask,
+                          RunWithTensor4x4("", 6, 5, &roi));
+  EXPECT_EQ(mask->Format(), ImageFormat::VEC32F1);
+  ASSERT_EQ(mask->Width(), 4);
+  ASSERT_EQ(mask->Height(), 3);
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      EXPECT_NEAR(MaskValue(*mask, x, y), kMask[y + 1][x + 1], 1e-5)
+          << "at " << x << "," << y;
+    }
+  }
+}
+
+TEST(TensorsToSegmentationCalculatorRoiTest, RejectsRotatedRoi) {
+  NormalizedRect roi;
+  roi.set_x_center(0.5f);
+  roi.set_y_center(0.5f);
+  roi.set_width(0.5f);
+  roi.set_height(0.5f);
+  roi.set_rotation(0.1f);
+  EXPECT_THAT(RunWithTensor4x4("", 6, 5, &roi).status().message(),
+              HasSubstr("Rotated ROIs are not supported"));
+}
+
+TEST(TensorsToSegmentationCalculatorRoiTest, SkipsRoiOutsideOfMask) {
+  NormalizedRect roi;
+  roi.set_x_center(1.5f);
+  roi.set_y_center(0.5f);
+  roi.set_width(0.5f);
+  roi.set_height(0.5f);
+  MP_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ImageFrame> mask,
+                          RunWithTensor4x4("", 6, 5, &roi));
+  EXPECT_EQ(mask, nullptr);
+}
+
+TEST(TensorsToSegmentationCalculatorRoiTest, ScalesOutputSize) {
+  // Scaling the 8x8 output size by 0.5 gives back the tensor size, so the mask
+  // holds the tensor values.
+  MP_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ImageFrame> mask,
+                          RunWithTensor4x4("output_scale: 0.5", 8, 8,
+                                           /*roi=*/nullptr));
+  ASSERT_EQ(mask->Width(), 4);
+  ASSERT_EQ(mask->Height(), 4);
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      EXPECT_EQ(MaskValue(*mask, x, y), y * 4 + x + 1);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
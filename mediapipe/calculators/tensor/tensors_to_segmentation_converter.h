@@ -18,7 +18,9 @@
 #include <memory>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/tensor.h"
 
@@ -36,6 +38,15 @@ class TensorsToSegmentationConverter {
   virtual absl::StatusOr<std::unique_ptr<Image>> Convert(
       const std::vector<Tensor>& input_tensors, int output_width,
       int output_height) = 0;
+
+  // Same as above, but only produces the @roi region of the
+  // @output_width x @output_height mask, as a @roi.width x @roi.height image.
+  virtual absl::StatusOr<std::unique_ptr<Image>> Convert(
+      const std::vector<Tensor>& input_tensors, int output_width,
+      int output_height, const MaskRect& roi) {
+    return absl::UnimplementedError(
+        "This converter cannot produce a region of the mask.");
+  }
 };
 
 }  // namespace mediapipe
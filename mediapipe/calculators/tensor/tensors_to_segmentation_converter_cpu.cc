@@ -0,0 +1,107 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_converter_cpu.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_converter.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+namespace {
+
+using Options = ::mediapipe::TensorsToSegmentationCalculatorOptions;
+
+SegmentationActivation ToSegmentationActivation(
+    Options::Activation activation) {
+  switch (activation) {
+    case Options::SIGMOID:
+      return SegmentationActivation::kSigmoid;
+    case Options::SOFTMAX:
+      return SegmentationActivation::kSoftmax;
+    default:
+      return SegmentationActivation::kNone;
+  }
+}
+
+class CpuProcessor : public TensorsToSegmentationConverter {
+ public:
+  CpuProcessor(const Options& options, Executor* executor)
+      : options_(options), executor_(executor) {}
+
+  absl::StatusOr<std::unique_ptr<Image>> Convert(
+      const std::vector<Tensor>& input_tensors, int output_width,
+      int output_height) override {
+    return Convert(input_tensors, output_width, output_height,
+                   {.left = 0,
+                    .top = 0,
+                    .width = output_width,
+                    .height = output_height});
+  }
+
+  absl::StatusOr<std::unique_ptr<Image>> Convert(
+      const std::vector<Tensor>& input_tensors, int output_width,
+      int output_height, const MaskRect& roi) override;
+
+ private:
+  Options options_;
+  Executor* executor_;
+};
+
+absl::StatusOr<std::unique_ptr<Image>> CpuProcessor::Convert(
+    const std::vector<Tensor>& input_tensors, int output_width,
+    int output_height, const MaskRect& roi) {
+  RET_CHECK(!input_tensors.empty());
+  RET_CHECK(input_tensors[0].element_type() == Tensor::ElementType::kFloat32);
+  MP_ASSIGN_OR_RETURN(auto hwc, GetHwcFromDims(input_tensors[0].shape().dims));
+  auto [tensor_height, tensor_width, tensor_channels] = hwc;
+  RET_CHECK(tensor_channels == 1 || tensor_channels == 2)
+      << "Unsupported number of tensor channels " << tensor_channels;
+
+  auto mask_frame = std::make_shared<ImageFrame>(ImageFormat::VEC32F1,
+                                                 roi.width, roi.height);
+  auto input_view = input_tensors[0].GetCpuReadView();
+  MP_RETURN_IF_ERROR(ActivateAndResizeMask(
+      {.data = input_view.buffer<float>(),
+       .width = tensor_width,
+       .height = tensor_height,
+       .channels = tensor_channels},
+      ToSegmentationActivation(options_.activation()),
+      options_.output_layer_index(), output_width, output_height, roi,
+      reinterpret_cast<float*>(mask_frame->MutablePixelData()),
+      mask_frame->WidthStep() / sizeof(float), executor_));
+  return std::make_unique<Image>(std::move(mask_frame));
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<TensorsToSegmentationConverter>>
+CreateCpuConverter(const Options& options, Executor* executor) {
+  return std::make_unique<CpuProcessor>(options, executor);
+}
+
+}  // namespace mediapipe
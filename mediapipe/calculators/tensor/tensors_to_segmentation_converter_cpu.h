@@ -0,0 +1,39 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_CONVERTER_CPU_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_CONVERTER_CPU_H_
+
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_converter.h"
+#include "mediapipe/framework/executor.h"
+
+namespace mediapipe {
+
+// Creates a CPU tensors-to-segmentation converter which applies the activation
+// while it upsamples the mask, see ActivateAndResizeMask. The result matches
+// the OpenCV converter, but the mask rows are computed in tiles that run in
+// parallel on `executor` when it is not null, and a region of the mask can be
+// produced without computing the rest of it. Needs no OpenCV.
+absl::StatusOr<std::unique_ptr<TensorsToSegmentationConverter>>
+CreateCpuConverter(
+    const mediapipe::TensorsToSegmentationCalculatorOptions& options,
+    Executor* executor);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_CONVERTER_CPU_H_
@@ -43,6 +43,8 @@ class OpenCvProcessor : public TensorsToSegmentationConverter {
     return absl::OkStatus();
   }
 
+  // Keeps the region overload visible; it is not supported by this converter.
+  using TensorsToSegmentationConverter::Convert;
   absl::StatusOr<std::unique_ptr<Image>> Convert(
       const std::vector<Tensor>& input_tensors, int output_width,
       int output_height) override;
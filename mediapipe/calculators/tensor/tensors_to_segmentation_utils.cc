@@ -14,14 +14,131 @@
 
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <memory>
 #include <tuple>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/cpu_util.h"
 
 namespace mediapipe {
+namespace {
+
+// Number of mask rows interpolated by each task of ActivateAndResizeMask.
+constexpr int kRowsPerTile = 32;
+
+// Tiles shared between the caller of RunTilesInParallel and its helper tasks,
+// which may outlive the call when they start after all tiles are claimed.
+class TileQueue {
+ public:
+  TileQueue(Executor* executor, int max_helpers, int num_tiles,
+            const std::function<void(int)>* run_tile)
+      : executor_(executor),
+        max_helpers_(max_helpers),
+        num_tiles_(num_tiles),
+        run_tile_(run_tile),
+        pending_(num_tiles) {}
+
+  // Schedules a helper task on `executor_` while tiles remain, up to
+  // `max_helpers_` of them. Each helper schedules the next one when it starts,
+  // so at most one helper waits for an executor thread at a time, and helpers
+  // never outnumber the threads that actually pick them up. Only the caller
+  // and helpers running on `executor_` call this, so `executor_` is alive.
+  static void ScheduleHelper(const std::shared_ptr<TileQueue>& queue) {
+    if (queue->next_tile_ >= queue->num_tiles_ ||
+        queue->num_helpers_++ >= queue->max_helpers_) {
+      return;
+    }
+    queue->executor_->Schedule([queue] {
+      ScheduleHelper(queue);
+      queue->RunTiles();
+    });
+  }
+
+  // Runs tiles until all of them are claimed. `run_tile_` is only used while
+  // a tile is pending, i.e. while the caller is still waiting.
+  void RunTiles() {
+    for (int tile = next_tile_++; tile < num_tiles_; tile = next_tile_++) {
+      (*run_tile_)(tile);
+      pending_.DecrementCount();
+    }
+  }
+
+  void WaitUntilDone() { pending_.Wait(); }
+
+ private:
+  Executor* const executor_;
+  const int max_helpers_;
+  const int num_tiles_;
+  const std::function<void(int)>* run_tile_;
+  std::atomic<int> num_helpers_{0};
+  std::atomic<int> next_tile_{0};
+  absl::BlockingCounter pending_;
+};
+
+// Source index and weight of the second source sample for each destination
+// coordinate, computed as cv::resize does for INTER_LINEAR.
+struct LinearTaps {
+  int index;
+  float weight;
+};
+
+LinearTaps GetLinearTaps(int dst, double scale, int src_size) {
+  float f = static_cast<float>((dst + 0.5) * scale - 0.5);
+  int index = static_cast<int>(std::floor(f));
+  f -= index;
+  if (index < 0) {
+    index = 0;
+    f = 0;
+  }
+  if (index >= src_size - 1) {
+    index = src_size - 1;
+    f = 0;
+  }
+  return {index, f};
+}
+
+// Writes the activated values of tensor columns [begin, end) of `row` to
+// `output`, indexed by column.
+void ActivateRow(const float* row, int channels,
+                 SegmentationActivation activation, int output_layer_index,
+                 int begin, int end, float* output) {
+  switch (activation) {
+    case SegmentationActivation::kNone:
+      for (int x = begin; x < end; ++x) {
+        output[x] = row[x * channels];
+      }
+      break;
+    case SegmentationActivation::kSigmoid:
+      for (int x = begin; x < end; ++x) {
+        output[x] = 1.0 / (std::exp(-row[x * channels]) + 1.0);
+      }
+      break;
+    case SegmentationActivation::kSoftmax:
+      for (int x = begin; x < end; ++x) {
+        const float pixel0 = row[x * channels];
+        const float pixel1 = row[x * channels + 1];
+        const float max_pixel = std::max(pixel0, pixel1);
+        const float min_pixel = std::min(pixel0, pixel1);
+        const float softmax_denom = 1.0f + std::exp(min_pixel - max_pixel);
+        output[x] =
+            std::exp(row[x * channels + output_layer_index] - max_pixel) /
+            softmax_denom;
+      }
+      break;
+  }
+}
+
+}  // namespace
 
 int NumGroups(int size, int group_size) {
   return (size + group_size - 1) / group_size;
@@ -49,4 +166,102 @@ absl::StatusOr<std::tuple<int, int, int>> GetHwcFromDims(
     RET_CHECK(false) << "Invalid shape for segmentation tensor " << dims.size();
   }
 }
+
+void RunTilesInParallel(Executor* executor, int num_tiles,
+                        const std::function<void(int)>& run_tile) {
+  const int num_helpers =
+      executor ? std::min(num_tiles, NumCPUCores()) - 1 : 0;
+  if (num_helpers <= 0) {
+    for (int tile = 0; tile < num_tiles; ++tile) run_tile(tile);
+    return;
+  }
+  auto queue =
+      std::make_shared<TileQueue>(executor, num_helpers, num_tiles, &run_tile);
+  TileQueue::ScheduleHelper(queue);
+  queue->RunTiles();
+  queue->WaitUntilDone();
+}
+
+absl::Status ActivateAndResizeMask(const SegmentationTensor& tensor,
+                                   SegmentationActivation activation,
+                                   int output_layer_index, int mask_width,
+                                   int mask_height, const MaskRect& rect,
+                                   float* output, int output_row_stride,
+                                   Executor* executor) {
+  RET_CHECK(tensor.data != nullptr);
+  RET_CHECK(tensor.width > 0 && tensor.height > 0);
+  RET_CHECK(mask_width > 0 && mask_height > 0);
+  RET_CHECK(rect.left >= 0 && rect.top >= 0 && rect.width > 0 &&
+            rect.height > 0 && rect.left + rect.width <= mask_width &&
+            rect.top + rect.height <= mask_height)
+      << "Mask region is out of bounds.";
+  RET_CHECK_GE(output_row_stride, rect.width);
+  switch (activation) {
+    case SegmentationActivation::kNone:
+    case SegmentationActivation::kSigmoid:
+      RET_CHECK_GE(tensor.channels, 1);
+      break;
+    case SegmentationActivation::kSoftmax:
+      RET_CHECK_EQ(tensor.channels, 2) << "SOFTMAX requires 2 channels.";
+      RET_CHECK(output_layer_index == 0 || output_layer_index == 1);
+      break;
+  }
+
+  const double scale_x = 1.0 / (static_cast<double>(mask_width) / tensor.width);
+  const double scale_y =
+      1.0 / (static_cast<double>(mask_height) / tensor.height);
+  std::vector<LinearTaps> x_taps(rect.width);
+  for (int x = 0; x < rect.width; ++x) {
+    x_taps[x] = GetLinearTaps(rect.left + x, scale_x, tensor.width);
+  }
+  // Only the tensor columns under `rect` are activated.
+  const int first_column = x_taps.front().index;
+  const int end_column = std::min(x_taps.back().index + 2, tensor.width);
+
+  const auto run_tile = [&](int tile) {
+    // Activated tensor row, indexed by tensor column.
+    std::vector<float> activated(tensor.width);
+    // The two most recently used tensor rows, activated and resized
+    // horizontally to the width of `rect`.
+    std::vector<float> resized[2] = {std::vector<float>(rect.width),
+                                     std::vector<float>(rect.width)};
+    int resized_row[2] = {-1, -1};
+    const auto get_resized_row = [&](int y, int keep_y) -> const float* {
+      for (int i = 0; i < 2; ++i) {
+        if (resized_row[i] == y) return resized[i].data();
+      }
+      const int slot = resized_row[0] == keep_y ? 1 : 0;
+      ActivateRow(tensor.data + y * tensor.width * tensor.channels,
+                  tensor.channels, activation, output_layer_index,
+                  first_column, end_column, activated.data());
+      float* row = resized[slot].data();
+      for (int x = 0; x < rect.width; ++x) {
+        const LinearTaps& taps = x_taps[x];
+        const int next = std::min(taps.index + 1, tensor.width - 1);
+        row[x] = activated[taps.index] * (1.0f - taps.weight) +
+                 activated[next] * taps.weight;
+      }
+      resized_row[slot] = y;
+      return row;
+    };
+
+    const int begin = tile * kRowsPerTile;
+    const int end = std::min(begin + kRowsPerTile, rect.height);
+    for (int y = begin; y < end; ++y) {
+      const LinearTaps taps =
+          GetLinearTaps(rect.top + y, scale_y, tensor.height);
+      const int next = std::min(taps.index + 1, tensor.height - 1);
+      const float* row0 = get_resized_row(taps.index, next);
+      const float* row1 = get_resized_row(next, taps.index);
+      float* dst = output + y * output_row_stride;
+      for (int x = 0; x < rect.width; ++x) {
+        dst[x] = row0[x] * (1.0f - taps.weight) + row1[x] * taps.weight;
+      }
+    }
+  };
+  RunTilesInParallel(executor, NumGroups(rect.height, kRowsPerTile),
+                     run_tile);
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
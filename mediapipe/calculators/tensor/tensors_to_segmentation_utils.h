@@ -15,10 +15,13 @@
 #ifndef MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_UTILS_H_
 #define MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_UTILS_H_
 
+#include <functional>
 #include <tuple>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "mediapipe/framework/executor.h"
 
 namespace mediapipe {
 
@@ -29,6 +32,51 @@ bool CanUseGpu();
 
 absl::StatusOr<std::tuple<int, int, int>> GetHwcFromDims(
     const std::vector<int>& dims);
+
+// Calls `run_tile` for every tile in [0, num_tiles) and returns once all calls
+// have finished. Tiles are claimed in order by the calling thread and by up to
+// one task per additional CPU core scheduled on `executor`. Each task is only
+// scheduled once the previous one runs and while tiles remain, so the tiles
+// run serially when `executor` is null or has no idle thread, and a busy
+// executor is left with at most one task that finds no tile to run.
+void RunTilesInParallel(Executor* executor, int num_tiles,
+                        const std::function<void(int)>& run_tile);
+
+// Activation applied to the segmentation tensor, see
+// TensorsToSegmentationCalculatorOptions::Activation.
+enum class SegmentationActivation { kNone, kSigmoid, kSoftmax };
+
+// A `width` x `height` segmentation tensor of `channels` interleaved floats.
+struct SegmentationTensor {
+  const float* data = nullptr;
+  int width = 0;
+  int height = 0;
+  int channels = 0;
+};
+
+// Rectangle of a mask, in pixels.
+struct MaskRect {
+  int left = 0;
+  int top = 0;
+  int width = 0;
+  int height = 0;
+};
+
+// Applies `activation` to `tensor` and resizes the result to a `mask_width` x
+// `mask_height` mask with bilinear interpolation matching cv::resize with
+// INTER_LINEAR. Only the `rect` region of the mask is computed; it is written
+// to `output`, whose rows are `output_row_stride` floats apart.
+//
+// Activation and interpolation are fused: the rows of `rect` are split into
+// tiles, run with RunTilesInParallel on `executor`, and each tile activates
+// only the tensor elements its rows interpolate between.
+absl::Status ActivateAndResizeMask(const SegmentationTensor& tensor,
+                                   SegmentationActivation activation,
+                                   int output_layer_index, int mask_width,
+                                   int mask_height, const MaskRect& rect,
+                                   float* output, int output_row_stride,
+                                   Executor* executor);
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_UTILS_H_
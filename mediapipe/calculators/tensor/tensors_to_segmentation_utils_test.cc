@@ -14,18 +14,37 @@
 
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
 
+#include <atomic>
+#include <functional>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/thread_pool_executor.h"
 
 namespace mediapipe {
 namespace {
 
+using ::testing::Each;
+using ::testing::ElementsAreArray;
+using ::testing::FloatNear;
 using ::testing::HasSubstr;
+using ::testing::Pointwise;
+
+// 4x4 tensor and its bilinear upsampling to 6x5, as computed by cv::resize.
+constexpr float kTensor[] = {1.0,  2.0,  3.0,  4.0,  5.0,  6.0,  7.0,  8.0,
+                             9.0,  10.0, 11.0, 12.0, 13.0, 14.0, 15.0, 16.0};
+constexpr float kResizedTensor[] = {
+    1,         1.5,      2.166667, 2.833333, 3.5,  4,         3.8,
+    4.3,       4.966667, 5.633333, 6.3,      6.8,  7,         7.5,
+    8.166667,  8.833333, 9.5,      10,       10.2, 10.7,      11.366667,
+    12.033333, 12.7,     13.2,     13,       13.5, 14.166667, 14.833333,
+    15.5,      16};
 
 TEST(TensorsToSegmentationUtilsTest, NumGroupsWorksProperly) {
   EXPECT_EQ(NumGroups(13, 4), 4);
@@ -59,5 +78,133 @@ TEST(TensorsToSegmentationUtilsTest, GetHwcFromDimsInvalidShape) {
               HasSubstr("Invalid shape for segmentation tensor"));
 }
 
+TEST(TensorsToSegmentationUtilsTest, RunTilesInParallelRunsEachTileOnce) {
+  ThreadPoolExecutor executor(/*num_threads=*/3);
+  for (Executor* tile_executor : {static_cast<Executor*>(nullptr),
+                                  static_cast<Executor*>(&executor)}) {
+    std::vector<std::atomic<int>> runs(100);
+    RunTilesInParallel(tile_executor, runs.size(),
+                       [&runs](int tile) { ++runs[tile]; });
+    for (const auto& tile_runs : runs) {
+      EXPECT_EQ(tile_runs, 1);
+    }
+  }
+}
+
+// Executor whose tasks only run when the test asks for it.
+class DeferredExecutor : public Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    tasks_.push_back(std::move(task));
+    ++num_scheduled_;
+  }
+
+  // Runs the tasks scheduled so far.
+  void RunScheduledTasks() {
+    std::vector<std::function<void()>> tasks = std::move(tasks_);
+    tasks_.clear();
+    for (auto& task : tasks) task();
+  }
+
+  int num_scheduled() const { return num_scheduled_; }
+
+ private:
+  std::vector<std::function<void()>> tasks_;
+  int num_scheduled_ = 0;
+};
+
+TEST(TensorsToSegmentationUtilsTest,
+     RunTilesInParallelSchedulesHelpersOnlyWhileTilesRemain) {
+  DeferredExecutor executor;
+  std::vector<int> runs(100);
+  RunTilesInParallel(&executor, runs.size(),
+                     [&runs](int tile) { ++runs[tile]; });
+  // The caller ran every tile while at most one helper waited for a thread.
+  EXPECT_THAT(runs, Each(1));
+  EXPECT_LE(executor.num_scheduled(), 1);
+
+  // A late helper finds no tile left and schedules no other helper.
+  executor.RunScheduledTasks();
+  EXPECT_THAT(runs, Each(1));
+  EXPECT_LE(executor.num_scheduled(), 1);
+}
+
+TEST(TensorsToSegmentationUtilsTest, ActivateAndResizeMaskMatchesOpenCv) {
+  std::vector<float> mask(6 * 5);
+  MP_ASSERT_OK(ActivateAndResizeMask(
+      {.data = kTensor, .width = 4, .height = 4, .channels = 1},
+      SegmentationActivation::kNone, /*output_layer_index=*/0,
+      /*mask_width=*/6, /*mask_height=*/5,
+      {.left = 0, .top = 0, .width = 6, .height = 5}, mask.data(),
+      /*output_row_stride=*/6, /*executor=*/nullptr));
+  EXPECT_THAT(mask, Pointwise(FloatNear(1e-5), kResizedTensor));
+}
+
+TEST(TensorsToSegmentationUtilsTest, ActivateAndResizeMaskWritesRegion) {
+  // Region of 3x2 pixels at (2, 1), written with a row stride of 4.
+  std::vector<float> mask(4 * 2, -1.0f);
+  MP_ASSERT_OK(ActivateAndResizeMask(
+      {.data = kTensor, .width = 4, .height = 4, .channels = 1},
+      SegmentationActivation::kNone, /*output_layer_index=*/0,
+      /*mask_width=*/6, /*mask_height=*/5,
+      {.left = 2, .top = 1, .width = 3, .height = 2}, mask.data(),
+      /*output_row_stride=*/4, /*executor=*/nullptr));
+  for (int y = 0; y < 2; ++y) {
+    for (int x = 0; x < 3; ++x) {
+      EXPECT_NEAR(mask[y * 4 + x], kResizedTensor[(y + 1) * 6 + x + 2], 1e-5);
+    }
+    EXPECT_EQ(mask[y * 4 + 3], -1.0f);
+  }
+}
+
+TEST(TensorsToSegmentationUtilsTest, ActivateAndResizeMaskAppliesSoftmax) {
+  // Both channels of every element are equal, so softmax yields 0.5.
+  std::vector<float> tensor(4 * 3 * 2);
+  for (int i = 0; i < tensor.size(); ++i) tensor[i] = i / 2;
+  std::vector<float> mask(8 * 6);
+  MP_ASSERT_OK(ActivateAndResizeMask(
+      {.data = tensor.data(), .width = 4, .height = 3, .channels = 2},
+      SegmentationActivation::kSoftmax, /*output_layer_index=*/1,
+      /*mask_width=*/8, /*mask_height=*/6,
+      {.left = 0, .top = 0, .width = 8, .height = 6}, mask.data(),
+      /*output_row_stride=*/8, /*executor=*/nullptr));
+  EXPECT_THAT(mask, Each(FloatNear(0.5f, 1e-6)));
+}
+
+TEST(TensorsToSegmentationUtilsTest,
+     ActivateAndResizeMaskIsIndependentOfExecutor) {
+  constexpr int kWidth = 64;
+  constexpr int kHeight = 48;
+  std::vector<float> tensor(kWidth * kHeight);
+  for (int i = 0; i < tensor.size(); ++i) tensor[i] = (i % 37) * 0.25f - 4.0f;
+  const MaskRect rect = {.left = 10, .top = 5, .width = 500, .height = 300};
+  ThreadPoolExecutor executor(/*num_threads=*/3);
+  std::vector<float> serial(rect.width * rect.height);
+  std::vector<float> parallel(rect.width * rect.height);
+  for (auto [output, tile_executor] :
+       {std::make_pair(&serial, static_cast<Executor*>(nullptr)),
+        std::make_pair(&parallel, static_cast<Executor*>(&executor))}) {
+    MP_ASSERT_OK(ActivateAndResizeMask(
+        {.data = tensor.data(), .width = kWidth, .height = kHeight,
+         .channels = 1},
+        SegmentationActivation::kSigmoid, /*output_layer_index=*/0,
+        /*mask_width=*/640, /*mask_height=*/480, rect, output->data(),
+        rect.width, tile_executor));
+  }
+  EXPECT_THAT(parallel, ElementsAreArray(serial));
+}
+
+TEST(TensorsToSegmentationUtilsTest, ActivateAndResizeMaskChecksRegion) {
+  std::vector<float> mask(6 * 5);
+  EXPECT_THAT(ActivateAndResizeMask(
+                  {.data = kTensor, .width = 4, .height = 4, .channels = 1},
+                  SegmentationActivation::kNone, /*output_layer_index=*/0,
+                  /*mask_width=*/6, /*mask_height=*/5,
+                  {.left = 1, .top = 0, .width = 6, .height = 5}, mask.data(),
+                  /*output_row_stride=*/6, /*executor=*/nullptr)
+                  .message(),
+              HasSubstr("Mask region is out of bounds"));
+}
+
 }  // namespace
 }  // namespace mediapipe
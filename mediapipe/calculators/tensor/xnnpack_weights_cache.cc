@@ -0,0 +1,253 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/xnnpack_weights_cache.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "tensorflow/lite/allocation.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Sets the file-backed weight cache of "options" to "path", on versions of
+// the XNNPACK delegate that support them. The int argument makes this
+// overload preferred over the fallback below.
+template <typename Options>
+auto SetWeightCacheFilePath(Options& options, const char* path, int)
+    -> decltype(options.weight_cache_file_path = path, true) {
+  options.weight_cache_file_path = path;
+  return true;
+}
+
+template <typename Options>
+bool SetWeightCacheFilePath(Options& /*options*/, const char* /*path*/, ...) {
+  return false;
+}
+
+// Returns "<path>.fingerprint", which records the model "path" was written
+// for.
+std::string FingerprintPath(const std::string& path) {
+  return absl::StrCat(path, ".fingerprint");
+}
+
+std::string FingerprintString(uint64_t fingerprint) {
+  return absl::StrCat(absl::Hex(fingerprint, absl::kZeroPad16));
+}
+
+// Deletes "path" if it exists.
+absl::Status RemoveIfExists(const std::string& path) {
+  if (file::Exists(path).ok()) {
+    RET_CHECK_EQ(std::remove(path.c_str()), 0)
+        << "Failed to delete " << path << ": " << std::strerror(errno);
+  }
+  return absl::OkStatus();
+}
+
+// Writes "contents" to a temporary file and moves it to "path", so that
+// "path" is either missing or complete.
+absl::Status SetContentsAtomically(const std::string& path,
+                                   absl::string_view contents) {
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  MP_RETURN_IF_ERROR(file::SetContents(temp_path, contents));
+  RET_CHECK_EQ(std::rename(temp_path.c_str(), path.c_str()), 0)
+      << "Failed to replace " << path << ": " << std::strerror(errno);
+  return absl::OkStatus();
+}
+
+// Returns true if the weights cache in "path" is complete and was written for
+// the model with "fingerprint". Otherwise, deletes any leftovers, so that a
+// fingerprint is never paired with a cache file it wasn't written with.
+absl::StatusOr<bool> ValidateWeightsCacheFile(const std::string& path,
+                                              uint64_t fingerprint) {
+  const std::string fingerprint_path = FingerprintPath(path);
+  std::string recorded;
+  if (file::Exists(path).ok() && file::Exists(fingerprint_path).ok() &&
+      file::GetContents(fingerprint_path, &recorded).ok() &&
+      recorded == FingerprintString(fingerprint)) {
+    return true;
+  }
+  if (file::Exists(path).ok()) {
+    ABSL_LOG(INFO) << "Discarding the XNNPACK weights cache " << path
+                   << ", which is incomplete or for another model.";
+  }
+  MP_RETURN_IF_ERROR(RemoveIfExists(fingerprint_path));
+  MP_RETURN_IF_ERROR(RemoveIfExists(path));
+  return false;
+}
+
+// Weights caches in use, by model fingerprint and file path.
+class WeightsCacheRegistry {
+ public:
+  static WeightsCacheRegistry& Get() {
+    static NoDestructor<WeightsCacheRegistry> registry;
+    return *registry;
+  }
+
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::pair<uint64_t, std::string>,
+                      std::weak_ptr<XnnpackWeightsCache>>
+      caches ABSL_GUARDED_BY(mutex);
+};
+
+}  // namespace
+
+uint64_t GetModelFingerprint(const tflite::FlatBufferModel& model) {
+  const tflite::Allocation* allocation = model.allocation();
+  const char* data = static_cast<const char*>(allocation->base());
+  const size_t size = allocation->bytes();
+  // FNV-1a over 8-byte words, with an extra shift so that the high bits of
+  // each word reach the low bits of the hash.
+  constexpr uint64_t kPrime = 0x100000001b3ull;
+  uint64_t hash = 0xcbf29ce484222325ull ^ size;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+    hash ^= hash >> 29;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * kPrime;
+  }
+  return hash;
+}
+
+bool XnnpackWeightsCache::SupportsFileBackedWeights() {
+  TfLiteXNNPackDelegateOptions options = TfLiteXNNPackDelegateOptionsDefault();
+  return SetWeightCacheFilePath(options, "", 0);
+}
+
+absl::StatusOr<std::shared_ptr<XnnpackWeightsCache>> XnnpackWeightsCache::Get(
+    const tflite::FlatBufferModel& model, const std::string& file_path) {
+  std::string cache_file_path;
+  if (!file_path.empty()) {
+    if (SupportsFileBackedWeights()) {
+      cache_file_path = file_path;
+    } else {
+      ABSL_LOG_FIRST_N(WARNING, 1)
+          << "The XNNPACK delegate of this TfLite version doesn't support "
+             "file-backed weight caches. Weights are only cached in memory "
+             "and weights_cache_file_path \""
+          << file_path << "\" is ignored.";
+    }
+  }
+  const uint64_t fingerprint = GetModelFingerprint(model);
+
+  WeightsCacheRegistry& registry = WeightsCacheRegistry::Get();
+  absl::MutexLock lock(&registry.mutex);
+  std::weak_ptr<XnnpackWeightsCache>& slot =
+      registry.caches[{fingerprint, cache_file_path}];
+  std::shared_ptr<XnnpackWeightsCache> cache = slot.lock();
+  if (cache) return cache;
+
+  bool file_complete = false;
+  if (!cache_file_path.empty()) {
+    MP_ASSIGN_OR_RETURN(file_complete,
+                        ValidateWeightsCacheFile(cache_file_path, fingerprint));
+  }
+  cache.reset(new XnnpackWeightsCache(std::move(cache_file_path), fingerprint,
+                                      file_complete));
+  slot = cache;
+  absl::erase_if(registry.caches,
+                 [](const auto& entry) { return entry.second.expired(); });
+  return cache;
+}
+
+XnnpackWeightsCache::XnnpackWeightsCache(std::string file_path,
+                                         uint64_t fingerprint,
+                                         bool file_complete)
+    : file_path_(std::move(file_path)),
+      fingerprint_(fingerprint),
+      file_complete_(file_complete) {}
+
+XnnpackWeightsCache::~XnnpackWeightsCache() {
+  absl::MutexLock lock(&mutex_);
+  if (weights_cache_ != nullptr) {
+    TfLiteXNNPackDelegateWeightsCacheDelete(weights_cache_);
+  }
+}
+
+absl::StatusOr<std::unique_ptr<InferenceRunner>>
+XnnpackWeightsCache::CreateRunner(TfLiteXNNPackDelegateOptions options,
+                                  RunnerFactory create_runner) {
+  absl::MutexLock lock(&mutex_);
+  // Until the file is complete, the delegate writes it under a temporary name.
+  const std::string temp_file_path = absl::StrCat(file_path_, ".tmp");
+  if (is_file_backed()) {
+    if (file_complete_) {
+      SetWeightCacheFilePath(options, file_path_.c_str(), 0);
+    } else {
+      MP_RETURN_IF_ERROR(RemoveIfExists(temp_file_path));
+      SetWeightCacheFilePath(options, temp_file_path.c_str(), 0);
+    }
+  } else {
+    if (weights_cache_ == nullptr) {
+      weights_cache_ = TfLiteXNNPackDelegateWeightsCacheCreate();
+      RET_CHECK(weights_cache_ != nullptr)
+          << "Failed to create the XNNPACK weights cache.";
+    }
+    options.weights_cache = weights_cache_;
+  }
+  TfLiteDelegatePtr delegate(TfLiteXNNPackDelegateCreate(&options),
+                             &TfLiteXNNPackDelegateDelete);
+  RET_CHECK(delegate != nullptr) << "Failed to create the XNNPACK delegate.";
+  MP_ASSIGN_OR_RETURN(std::unique_ptr<InferenceRunner> runner,
+                      create_runner(std::move(delegate)));
+  if (is_file_backed() && !file_complete_) {
+    // The delegate has written the packed weights while the interpreter was
+    // prepared. The file is moved into place before its fingerprint is
+    // recorded, so a run that is interrupted leaves no valid pair behind.
+    // Open mappings of the file survive the rename.
+    if (file::Exists(temp_file_path).ok()) {
+      RET_CHECK_EQ(std::rename(temp_file_path.c_str(), file_path_.c_str()), 0)
+          << "Failed to replace " << file_path_ << ": "
+          << std::strerror(errno);
+      MP_RETURN_IF_ERROR(SetContentsAtomically(
+          FingerprintPath(file_path_), FingerprintString(fingerprint_)));
+      file_complete_ = true;
+    } else {
+      VLOG(1) << "The XNNPACK delegate didn't write a weights cache to "
+              << temp_file_path;
+    }
+  }
+  if (weights_cache_ != nullptr && !finalized_) {
+    // The cache must be finalized before inference. Soft finalization leaves
+    // room for the interpreters created later, which find their packed
+    // weights in the cache instead of adding them.
+    RET_CHECK(TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(weights_cache_))
+        << "Failed to finalize the XNNPACK weights cache.";
+    finalized_ = true;
+  }
+  return runner;
+}
+
+}  // namespace mediapipe
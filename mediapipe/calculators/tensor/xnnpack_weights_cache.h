@@ -0,0 +1,105 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_XNNPACK_WEIGHTS_CACHE_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_XNNPACK_WEIGHTS_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/tflite_delegate_ptr.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/model.h"
+
+namespace mediapipe {
+
+// Returns a fingerprint of the flatbuffer of "model". Unlike absl::Hash, it
+// is the same in every process, so it can validate files written by earlier
+// runs.
+uint64_t GetModelFingerprint(const tflite::FlatBufferModel& model);
+
+// The weights packed by the XNNPACK delegate for one model.
+//
+// Packing the weights dominates interpreter creation for large models.
+// Interpreters created through the same XnnpackWeightsCache share one copy of
+// the packed weights, so only the first of them packs the weights. If the
+// TfLite XNNPACK delegate supports file-backed weight caches, the packed
+// weights are also written to a file, which later runs memory-map instead of
+// packing the weights again.
+class XnnpackWeightsCache {
+ public:
+  using RunnerFactory =
+      absl::FunctionRef<absl::StatusOr<std::unique_ptr<InferenceRunner>>(
+          TfLiteDelegatePtr delegate)>;
+
+  // Returns the weights cache for "model", which is shared by all graphs of
+  // the process that use the same model and "file_path".
+  //
+  // "file_path" is validated against the fingerprint of the model, which is
+  // stored in "<file_path>.fingerprint". A file written for another model, or
+  // without a fingerprint, is deleted, to be rewritten by the first
+  // interpreter. That interpreter writes it to "<file_path>.tmp", which is
+  // moved to "file_path" once it is complete, and only then is the
+  // fingerprint recorded.
+  //
+  // If the XNNPACK delegate doesn't support file-backed weight caches,
+  // "file_path" is ignored, which is logged once per process.
+  static absl::StatusOr<std::shared_ptr<XnnpackWeightsCache>> Get(
+      const tflite::FlatBufferModel& model, const std::string& file_path);
+
+  ~XnnpackWeightsCache();
+  XnnpackWeightsCache(const XnnpackWeightsCache&) = delete;
+  XnnpackWeightsCache& operator=(const XnnpackWeightsCache&) = delete;
+
+  // Creates an XNNPACK delegate with "options" set up to use this cache and
+  // passes it to "create_runner", which is expected to apply it to an
+  // interpreter. The cache must outlive the runner.
+  absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateRunner(
+      TfLiteXNNPackDelegateOptions options, RunnerFactory create_runner);
+
+  // Returns true if the packed weights are persisted in a file.
+  bool is_file_backed() const { return !file_path_.empty(); }
+
+  // Returns true if the TfLite XNNPACK delegate supports file-backed weight
+  // caches.
+  static bool SupportsFileBackedWeights();
+
+ private:
+  XnnpackWeightsCache(std::string file_path, uint64_t fingerprint,
+                      bool file_complete);
+
+  // Empty if the weights are only cached in memory.
+  const std::string file_path_;
+  // The fingerprint of the model.
+  const uint64_t fingerprint_;
+  // Serializes interpreter creation, so that the cache is finalized after the
+  // first interpreter has packed the weights and before any interpreter runs.
+  absl::Mutex mutex_;
+  TfLiteXNNPackDelegateWeightsCache* weights_cache_ ABSL_GUARDED_BY(mutex_) =
+      nullptr;
+  bool finalized_ ABSL_GUARDED_BY(mutex_) = false;
+  // Set once "file_path_" holds the packed weights and its fingerprint is
+  // recorded.
+  bool file_complete_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_XNNPACK_WEIGHTS_CACHE_H_
@@ -0,0 +1,166 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/xnnpack_weights_cache.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/tflite_delegate_ptr.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/util/tflite/tflite_model_loader.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/kernels/register.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kModelPath[] = "mediapipe/calculators/tensor/testdata/add.bin";
+constexpr char kOtherModelPath[] =
+    "mediapipe/calculators/tensor/testdata/add_dynamic_batch.bin";
+
+class XnnpackWeightsCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    MP_ASSERT_OK_AND_ASSIGN(model_, TfLiteModelLoader::LoadFromPath(
+                                        kModelPath, /*try_mmap=*/false));
+    op_resolver_ = api2::PacketAdopting<tflite::OpResolver>(
+        std::make_unique<tflite::ops::builtin::BuiltinOpResolver>());
+    cache_path_ = file::JoinPath(
+        std::getenv("TEST_TMPDIR"),
+        absl::StrCat(::testing::UnitTest::GetInstance()
+                         ->current_test_info()
+                         ->name(),
+                     ".xnnpack_cache"));
+  }
+
+  // Creates an interpreter that uses "cache".
+  absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateRunner(
+      XnnpackWeightsCache& cache) {
+    return cache.CreateRunner(
+        TfLiteXNNPackDelegateOptionsDefault(),
+        [this](TfLiteDelegatePtr delegate) {
+          return CreateInferenceInterpreterDelegateRunner(
+              model_, op_resolver_, std::move(delegate),
+              /*interpreter_num_threads=*/1);
+        });
+  }
+
+  api2::Packet<TfLiteModelPtr> model_;
+  api2::Packet<tflite::OpResolver> op_resolver_;
+  std::string cache_path_;
+};
+
+TEST_F(XnnpackWeightsCacheTest, FingerprintDependsOnContents) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      api2::Packet<TfLiteModelPtr> same_model,
+      TfLiteModelLoader::LoadFromPath(kModelPath, /*try_mmap=*/true));
+  MP_ASSERT_OK_AND_ASSIGN(
+      api2::Packet<TfLiteModelPtr> other_model,
+      TfLiteModelLoader::LoadFromPath(kOtherModelPath, /*try_mmap=*/false));
+  EXPECT_EQ(GetModelFingerprint(*model_.Get()),
+            GetModelFingerprint(*same_model.Get()));
+  EXPECT_NE(GetModelFingerprint(*model_.Get()),
+            GetModelFingerprint(*other_model.Get()));
+}
+
+TEST_F(XnnpackWeightsCacheTest, SharesCacheWhileInUse) {
+  MP_ASSERT_OK_AND_ASSIGN(std::shared_ptr<XnnpackWeightsCache> cache1,
+                          XnnpackWeightsCache::Get(*model_.Get(), ""));
+  MP_ASSERT_OK_AND_ASSIGN(std::shared_ptr<XnnpackWeightsCache> cache2,
+                          XnnpackWeightsCache::Get(*model_.Get(), ""));
+  EXPECT_EQ(cache1, cache2);
+  EXPECT_FALSE(cache1->is_file_backed());
+  MP_ASSERT_OK_AND_ASSIGN(auto runner1, CreateRunner(*cache1));
+  MP_ASSERT_OK_AND_ASSIGN(auto runner2, CreateRunner(*cache2));
+}
+
+TEST_F(XnnpackWeightsCacheTest, RoundTripsCacheFile) {
+  const std::string fingerprint_path =
+      absl::StrCat(cache_path_, ".fingerprint");
+  std::string written;
+  {
+    MP_ASSERT_OK_AND_ASSIGN(
+        std::shared_ptr<XnnpackWeightsCache> cache,
+        XnnpackWeightsCache::Get(*model_.Get(), cache_path_));
+    EXPECT_EQ(cache->is_file_backed(),
+              XnnpackWeightsCache::SupportsFileBackedWeights());
+    MP_ASSERT_OK_AND_ASSIGN(auto runner, CreateRunner(*cache));
+    // Interpreters created later use the file written by the first one.
+    MP_ASSERT_OK_AND_ASSIGN(auto runner2, CreateRunner(*cache));
+  }
+  if (!XnnpackWeightsCache::SupportsFileBackedWeights()) {
+    EXPECT_FALSE(file::Exists(cache_path_).ok());
+    GTEST_SKIP() << "The XNNPACK delegate doesn't persist weights.";
+  }
+  // The temporary file is gone, and the cache file and its fingerprint exist
+  // together or not at all.
+  EXPECT_FALSE(file::Exists(absl::StrCat(cache_path_, ".tmp")).ok());
+  EXPECT_EQ(file::Exists(cache_path_).ok(),
+            file::Exists(fingerprint_path).ok());
+  if (!file::Exists(cache_path_).ok()) {
+    GTEST_SKIP() << "The XNNPACK delegate packed no weights for the model.";
+  }
+  MP_ASSERT_OK(file::GetContents(cache_path_, &written));
+
+  // A later run reuses the file instead of rewriting it.
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<XnnpackWeightsCache> cache,
+      XnnpackWeightsCache::Get(*model_.Get(), cache_path_));
+  MP_ASSERT_OK_AND_ASSIGN(auto runner, CreateRunner(*cache));
+  std::string reused;
+  MP_ASSERT_OK(file::GetContents(cache_path_, &reused));
+  EXPECT_EQ(reused, written);
+}
+
+TEST_F(XnnpackWeightsCacheTest, DiscardsCacheFileOfAnotherModel) {
+  if (!XnnpackWeightsCache::SupportsFileBackedWeights()) {
+    GTEST_SKIP() << "The XNNPACK delegate doesn't persist weights.";
+  }
+  MP_ASSERT_OK(file::SetContents(cache_path_, "stale"));
+  MP_ASSERT_OK(file::SetContents(absl::StrCat(cache_path_, ".fingerprint"),
+                                 "0000000000000000"));
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<XnnpackWeightsCache> cache,
+      XnnpackWeightsCache::Get(*model_.Get(), cache_path_));
+  EXPECT_FALSE(file::Exists(cache_path_).ok());
+  EXPECT_FALSE(
+      file::Exists(absl::StrCat(cache_path_, ".fingerprint")).ok());
+}
+
+TEST_F(XnnpackWeightsCacheTest, DiscardsCacheFileWithoutFingerprint) {
+  if (!XnnpackWeightsCache::SupportsFileBackedWeights()) {
+    GTEST_SKIP() << "The XNNPACK delegate doesn't persist weights.";
+  }
+  // E.g. left behind by a run that stopped before recording the fingerprint.
+  MP_ASSERT_OK(file::SetContents(cache_path_, "partial"));
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<XnnpackWeightsCache> cache,
+      XnnpackWeightsCache::Get(*model_.Get(), cache_path_));
+  EXPECT_FALSE(file::Exists(cache_path_).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
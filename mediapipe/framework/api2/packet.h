@@ -451,8 +451,8 @@ inline Packet<internal::Generic> Packet<internal::Generic>::At(
 
 template <typename T, typename... Args>
 Packet<T> MakePacket(Args&&... args) {
-  return Packet<T>(std::make_shared<packet_internal::Holder<T>>(
-      new T(std::forward<Args>(args)...)));
+  return Packet<T>(
+      packet_internal::MakeHolder<T>(std::forward<Args>(args)...));
 }
 
 template <typename T>
@@ -138,6 +138,15 @@ class CalculatorContract {
   void SetTimestampOffset(TimestampDiff offset) { timestamp_offset_ = offset; }
   TimestampDiff GetTimestampOffset() const { return timestamp_offset_; }
 
+  // Declares that Process keeps no state across invocations and is safe to
+  // call concurrently, so that the framework may process several input
+  // timestamps of the node at once.  Open and Close still run alone.  Unless
+  // the node sets "max_in_flight", up to one invocation per CPU core runs at
+  // a time, and the default executor adds threads for them.  The default
+  // InOrderOutputStreamHandler delivers the outputs in timestamp order.
+  void SetStateless(bool stateless) { stateless_ = stateless; }
+  bool GetStateless() const { return stateless_; }
+
   class GraphServiceRequest {
    public:
     // APIs that should be used by calculators.
@@ -210,6 +219,7 @@ class CalculatorContract {
   ServiceReqMap service_requests_;
   bool process_timestamps_ = false;
   TimestampDiff timestamp_offset_ = TimestampDiff::Unset();
+  bool stateless_ = false;
 
   friend class CalculatorNode;
 };
@@ -42,6 +42,7 @@
 #include "mediapipe/framework/counter_factory.h"
 #include "mediapipe/framework/delegating_executor.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/executor_service.h"
 #include "mediapipe/framework/graph_output_stream.h"
 #include "mediapipe/framework/graph_service_manager.h"
 #include "mediapipe/framework/input_stream_manager.h"
@@ -413,11 +414,19 @@ absl::Status CalculatorGraph::InitializeDefaultExecutor(
 
   // If the default (0 or -1) was specified, pick a suitable number of threads
   // depending on the number of processors in this system and the number of
-  // calculators and packet generators in the calculator graph.
+  // calculators and packet generators in the calculator graph.  A stateless
+  // calculator counts once for each invocation it may run at a time.
   if (num_threads == 0 || num_threads == -1) {
+    int num_invocations = validated_graph_->Config().node().size();
+    for (int i = 0; i < validated_graph_->Config().node().size(); ++i) {
+      if (validated_graph_->CalculatorInfos()[i].Contract().GetStateless() &&
+          validated_graph_->Config().node(i).max_in_flight() == 0) {
+        num_invocations += mediapipe::NumCPUCores() - 1;
+      }
+    }
     num_threads = std::min(
         mediapipe::NumCPUCores(),
-        std::max({validated_graph_->Config().node().size(),
+        std::max({num_invocations,
                   validated_graph_->Config().packet_generator().size(), 1}));
   }
   MP_RETURN_IF_ERROR(
@@ -440,6 +449,9 @@ absl::Status CalculatorGraph::Initialize(
   MP_RETURN_IF_ERROR(InitializePacketGeneratorGraph(side_packets));
   MP_RETURN_IF_ERROR(InitializeStreams());
   MP_RETURN_IF_ERROR(InitializeCalculatorNodes());
+  if (validated_graph_->Config().sharded_scheduler_queue()) {
+    scheduler_.EnableShardedQueues(validated_graph_->CalculatorInfos().size());
+  }
 #ifdef MEDIAPIPE_PROFILER_AVAILABLE
   MP_RETURN_IF_ERROR(InitializeProfiler());
 #endif
@@ -653,6 +665,11 @@ absl::Status CalculatorGraph::PrepareServices() {
     for (const auto& [key, request] : node->Contract().ServiceRequests()) {
       auto packet = service_manager_.GetServicePacket(request.Service());
       if (!packet.IsEmpty()) continue;
+      if (&request.Service() == &kDefaultExecutorService) {
+        MP_RETURN_IF_ERROR(service_manager_.SetServiceObject(
+            kDefaultExecutorService, executors_[""]));
+        continue;
+      }
       absl::StatusOr<Packet> packet_or;
       if (allow_service_default_initialization_) {
         packet_or = request.Service().CreateDefaultObject();
@@ -1146,6 +1163,54 @@ void CalculatorGraph::CallStatusHandlers(GraphRunState graph_run_state,
 
 int CalculatorGraph::GetMaxInputStreamQueueSize() { return max_queue_size_; }
 
+std::vector<CalculatorGraph::InputStreamQueueState>
+CalculatorGraph::GetInputStreamQueueStates() {
+  std::vector<InputStreamQueueState> states;
+  if (!initialized_) {
+    return states;
+  }
+  const std::vector<EdgeInfo>& infos = validated_graph_->InputStreamInfos();
+  states.reserve(infos.size());
+  for (int index = 0; index < infos.size(); ++index) {
+    const InputStreamManager& stream = input_stream_managers_[index];
+    InputStreamQueueState& state = states.emplace_back();
+    state.node_name = nodes_[infos[index].parent_node.index]->DebugName();
+    state.stream_name = stream.Name();
+    state.queue_size = stream.QueueSize();
+    state.max_queue_size = stream.MaxQueueSize();
+    state.num_packets_added = stream.NumPacketsAdded();
+  }
+  return states;
+}
+
+std::vector<CalculatorGraph::SourceThrottleState>
+CalculatorGraph::GetSourceThrottleStates() {
+  std::vector<SourceThrottleState> states;
+  if (!initialized_) {
+    return states;
+  }
+  absl::MutexLock lock(&full_input_streams_mutex_);
+  // full_input_streams_ is empty until the first run starts.
+  auto is_throttled = [this](int node_id) {
+    return max_queue_size_ != -1 && node_id < full_input_streams_.size() &&
+           !full_input_streams_[node_id].empty();
+  };
+  // Skips the nodes appended to run packet generators.
+  const int num_calculators = validated_graph_->CalculatorInfos().size();
+  for (int node_id = 0; node_id < num_calculators; ++node_id) {
+    if (nodes_[node_id]->IsSource()) {
+      states.push_back({nodes_[node_id]->DebugName(),
+                        /*is_graph_input_stream=*/false,
+                        is_throttled(node_id)});
+    }
+  }
+  for (const auto& [stream_name, node_id] : graph_input_stream_node_ids_) {
+    states.push_back(
+        {stream_name, /*is_graph_input_stream=*/true, is_throttled(node_id)});
+  }
+  return states;
+}
+
 void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
                                            bool* stream_was_full) {
   // TODO Change the throttling code to use the index directly
@@ -19,6 +19,7 @@
 #define MEDIAPIPE_FRAMEWORK_CALCULATOR_GRAPH_H_
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -114,6 +115,27 @@ class CalculatorGraph {
     ADD_IF_NOT_FULL
   };
 
+  // The state of a calculator input stream queue, for monitoring.
+  struct InputStreamQueueState {
+    // The name of the calculator that reads the stream.
+    std::string node_name;
+    std::string stream_name;
+    int queue_size = 0;
+    // -1 if the queue size is not limited.
+    int max_queue_size = -1;
+    // The number of packets added to the stream in the current run.
+    int64_t num_packets_added = 0;
+  };
+
+  // The throttling state of a source node or graph input stream.
+  struct SourceThrottleState {
+    // The name of the source calculator or graph input stream.
+    std::string name;
+    bool is_graph_input_stream = false;
+    // True if an input stream fed by the source is full.
+    bool throttled = false;
+  };
+
   // Creates an uninitialized graph.
   CalculatorGraph();
   CalculatorGraph(const CalculatorGraph&) = delete;
@@ -328,6 +350,17 @@ class CalculatorGraph {
   // Returns the maximum input stream queue size.
   int GetMaxInputStreamQueueSize();
 
+  // Returns the queue state of each calculator input stream. May be called at
+  // any time after the graph has been initialized. The queue sizes are read
+  // without locking, but the packet counts briefly take the mutex of each
+  // input stream, so poll this at a monitoring interval rather than per packet.
+  std::vector<InputStreamQueueState> GetInputStreamQueueStates();
+
+  // Returns the throttling state of each source node and graph input stream.
+  // May be called at any time after the graph has been initialized.
+  std::vector<SourceThrottleState> GetSourceThrottleStates()
+      ABSL_LOCKS_EXCLUDED(full_input_streams_mutex_);
+
   // Get the mode for adding packets to an input stream.
   GraphInputStreamAddMode GetGraphInputStreamAddMode() const;
 
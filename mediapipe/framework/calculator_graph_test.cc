@@ -1647,8 +1647,9 @@ TEST(CalculatorGraph, TypeMismatch) {
   graph.reset(nullptr);
 }
 
-TEST(CalculatorGraph, LayerOrdering) {
+void TestLayerOrdering(bool sharded_scheduler_queue) {
   CalculatorGraphConfig config;
+  config.set_sharded_scheduler_queue(sharded_scheduler_queue);
   CalculatorGraphConfig::Node* node;
   node = config.add_node();
   node->set_calculator("GlobalCountSourceCalculator");
@@ -1732,6 +1733,12 @@ TEST(CalculatorGraph, LayerOrdering) {
       input_side_packets["global_counter"].Get<std::atomic<int>*>()->load());
 }
 
+TEST(CalculatorGraph, LayerOrdering) { TestLayerOrdering(false); }
+
+TEST(CalculatorGraph, LayerOrderingWithShardedSchedulerQueue) {
+  TestLayerOrdering(true);
+}
+
 // Tests for status handler input verification.
 TEST(CalculatorGraph, StatusHandlerInputVerification) {
   // Status handlers with all inputs present should be OK.
@@ -4648,6 +4655,58 @@ TEST(CalculatorGraph, TestPollPacketsFromMultipleStreams) {
   EXPECT_EQ(kDefaultMaxCount, num_packets2);
 }
 
+TEST(CalculatorGraph, TestPollPacketsFromMultipleStreamsWithNotifyCallback) {
+  CalculatorGraphConfig config;
+  CalculatorGraphConfig::Node* node1 = config.add_node();
+  node1->set_calculator("CountingSourceCalculator");
+  node1->add_output_stream("stream1");
+  node1->add_input_side_packet("MAX_COUNT:max_count");
+  CalculatorGraphConfig::Node* node2 = config.add_node();
+  node2->set_calculator("PassThroughCalculator");
+  node2->add_input_stream("stream1");
+  node2->add_output_stream("stream2");
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  std::vector<OutputStreamPoller> pollers;
+  for (const char* stream : {"stream1", "stream2"}) {
+    MP_ASSERT_OK_AND_ASSIGN(OutputStreamPoller poller,
+                            graph.AddOutputStreamPoller(stream));
+    pollers.push_back(std::move(poller));
+  }
+  absl::Mutex mutex;
+  int pending_notifications = 0;
+  for (OutputStreamPoller& poller : pollers) {
+    poller.SetNotifyCallback([&] {
+      absl::MutexLock lock(&mutex);
+      ++pending_notifications;
+    });
+  }
+  MP_ASSERT_OK(
+      graph.StartRun({{"max_count", MakePacket<int>(kDefaultMaxCount)}}));
+  // Waits for a notification from either poller, then drains both without
+  // blocking.
+  std::vector<int> num_packets(pollers.size(), 0);
+  while (num_packets[0] < kDefaultMaxCount ||
+         num_packets[1] < kDefaultMaxCount) {
+    {
+      absl::MutexLock lock(&mutex);
+      mutex.Await(absl::Condition(
+          +[](int* pending) { return *pending > 0; }, &pending_notifications));
+      pending_notifications = 0;
+    }
+    for (int i = 0; i < pollers.size(); ++i) {
+      for (int n = pollers[i].QueueSize(); n > 0; --n) {
+        Packet packet;
+        ASSERT_TRUE(pollers[i].Next(&packet));
+        EXPECT_EQ(num_packets[i]++, packet.Get<int>());
+      }
+    }
+  }
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 class TimestampBoundTestCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
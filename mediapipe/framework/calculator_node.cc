@@ -48,6 +48,7 @@
 #include "mediapipe/framework/tool/status_util.h"
 #include "mediapipe/framework/tool/tag_map.h"
 #include "mediapipe/framework/tool/validate_name.h"
+#include "mediapipe/util/cpu_util.h"
 
 namespace mediapipe {
 
@@ -147,15 +148,17 @@ absl::Status CalculatorNode::Initialize(
         "node_ref is not a calculator or packet generator");
   }
 
+  const CalculatorContract& contract = node_type_info_->Contract();
+
   max_in_flight_ = node_config->max_in_flight();
-  max_in_flight_ = max_in_flight_ ? max_in_flight_ : 1;
+  if (max_in_flight_ == 0) {
+    max_in_flight_ = contract.GetStateless() ? NumCPUCores() : 1;
+  }
   if (!node_config->executor().empty()) {
     executor_ = node_config->executor();
   }
   source_layer_ = node_config->source_layer();
 
-  const CalculatorContract& contract = node_type_info_->Contract();
-
   // TODO Propagate types between calculators when SetAny is used.
 
   MP_RETURN_IF_ERROR(InitializeOutputSidePackets(
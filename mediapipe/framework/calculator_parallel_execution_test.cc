@@ -19,6 +19,8 @@
 //
 // TODO: Add more tests to verify the correctness of parallel execution.
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <random>
 #include <string>
@@ -35,6 +37,7 @@
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/util/cpu_util.h"
 
 namespace mediapipe {
 
@@ -77,7 +80,40 @@ class SlowPlusOneCalculator : public CalculatorBase {
 
 REGISTER_CALCULATOR(SlowPlusOneCalculator);
 
-class ParallelExecutionTest : public testing::Test {
+// Counts the invocations of StatelessSlowCalculator::Process running at once.
+std::atomic<int> stateless_in_flight(0);
+std::atomic<int> stateless_max_in_flight(0);
+
+// Declares itself stateless instead of relying on the node's max_in_flight.
+class StatelessSlowCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    cc->SetTimestampOffset(0);
+    cc->SetStateless(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    const int in_flight = ++stateless_in_flight;
+    int max_in_flight = stateless_max_in_flight;
+    while (in_flight > max_in_flight &&
+           !stateless_max_in_flight.compare_exchange_weak(max_in_flight,
+                                                          in_flight)) {
+    }
+    absl::SleepFor(absl::Milliseconds(20));
+    --stateless_in_flight;
+    cc->Outputs().Index(0).Add(new int(cc->Inputs().Index(0).Get<int>()),
+                               cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+};
+
+REGISTER_CALCULATOR(StatelessSlowCalculator);
+
+// The test parameter selects CalculatorGraphConfig.sharded_scheduler_queue.
+class ParallelExecutionTest : public testing::TestWithParam<bool> {
  public:
   void AddThreadSafeVectorSink(const Packet& packet) {
     absl::WriterMutexLock lock(&output_packets_mutex_);
@@ -89,7 +125,7 @@ class ParallelExecutionTest : public testing::Test {
   absl::Mutex output_packets_mutex_;
 };
 
-TEST_F(ParallelExecutionTest, SlowPlusOneCalculatorsTest) {
+TEST_P(ParallelExecutionTest, SlowPlusOneCalculatorsTest) {
   CalculatorGraphConfig graph_config =
       mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
         input_stream: "input"
@@ -112,6 +148,7 @@ TEST_F(ParallelExecutionTest, SlowPlusOneCalculatorsTest) {
         }
         num_threads: 5
       )pb");
+  graph_config.set_sharded_scheduler_queue(GetParam());
 
   // Starts MediaPipe graph.
   CalculatorGraph graph(graph_config);
@@ -153,5 +190,52 @@ TEST_F(ParallelExecutionTest, SlowPlusOneCalculatorsTest) {
   }
 }
 
+// Shows that a stateless calculator processes several timestamps at once, up
+// to one per CPU core, and that its outputs stay in timestamp order.
+TEST_P(ParallelExecutionTest, StatelessCalculatorTest) {
+  CalculatorGraphConfig graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "StatelessSlowCalculator"
+          input_stream: "input"
+          output_stream: "output"
+        }
+        node {
+          calculator: "CallbackCalculator"
+          input_stream: "output"
+          input_side_packet: "CALLBACK:callback"
+        }
+        num_threads: 4
+      )pb");
+  graph_config.set_sharded_scheduler_queue(GetParam());
+  stateless_max_in_flight = 0;
+
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun(
+      {{"callback", MakePacket<std::function<void(const Packet&)>>(std::bind(
+                        &ParallelExecutionTest::AddThreadSafeVectorSink, this,
+                        std::placeholders::_1))}}));
+  const int kTotalNums = 40;
+  for (int i = 0; i < kTotalNums; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", Adopt(new int(i)).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("input"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  EXPECT_LE(stateless_max_in_flight, NumCPUCores());
+  EXPECT_GE(stateless_max_in_flight, std::min(NumCPUCores(), 2));
+  absl::ReaderMutexLock lock(&output_packets_mutex_);
+  ASSERT_EQ(output_packets_.size(), kTotalNums);
+  for (int i = 0; i < kTotalNums; ++i) {
+    EXPECT_EQ(output_packets_[i].Get<int>(), i);
+    EXPECT_EQ(output_packets_[i].Timestamp(), Timestamp(i));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ShardedSchedulerQueue, ParallelExecutionTest,
+                         testing::Bool());
+
 }  // namespace
 }  // namespace mediapipe
@@ -0,0 +1,220 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_FREELIST_ALLOCATOR_H_
+#define MEDIAPIPE_DEPS_FREELIST_ALLOCATOR_H_
+
+#include <cstddef>
+#include <new>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+
+namespace mediapipe {
+
+// Blocks larger than this are not pooled.
+constexpr size_t kMaxFreelistBlockSize = 256;
+
+namespace freelist_internal {
+
+// Block sizes are rounded up to a multiple of this.
+constexpr size_t kSizeClassGranularity = 32;
+// Number of blocks moved between a thread cache and the central freelist at
+// a time.
+constexpr int kTransferBatchSize = 32;
+// A thread cache holding more blocks than this returns a batch to the central
+// freelist. This bounds the memory parked on threads that free more blocks
+// than they allocate, e.g. the consumer end of a pipeline.
+constexpr int kMaxThreadCacheBlocks = 4 * kTransferBatchSize;
+
+constexpr size_t SizeClass(size_t size) {
+  return (size + kSizeClassGranularity - 1) / kSizeClassGranularity *
+         kSizeClassGranularity;
+}
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+// Process-wide list of free blocks of one size class.
+template <size_t kBlockSize>
+class CentralFreelist {
+ public:
+  static CentralFreelist& Get() {
+    static NoDestructor<CentralFreelist> freelist;
+    return *freelist;
+  }
+
+  // Moves up to kTransferBatchSize blocks to the front of *head. Returns the
+  // number of blocks moved.
+  int TakeBatch(FreeBlock** head) {
+    absl::MutexLock lock(&mutex_);
+    int count = 0;
+    while (head_ != nullptr && count < kTransferBatchSize) {
+      FreeBlock* block = head_;
+      head_ = block->next;
+      block->next = *head;
+      *head = block;
+      ++count;
+    }
+    return count;
+  }
+
+  // Takes ownership of the list of blocks from "first" to "last".
+  void PutList(FreeBlock* first, FreeBlock* last) {
+    absl::MutexLock lock(&mutex_);
+    last->next = head_;
+    head_ = first;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  FreeBlock* head_ ABSL_GUARDED_BY(mutex_) = nullptr;
+};
+
+// Per-thread cache in front of a CentralFreelist. Kept trivially destructible
+// so that it stays usable while other thread_local objects are destroyed;
+// ThreadCacheFlusher hands its blocks back when the thread exits.
+struct ThreadCache {
+  FreeBlock* head;
+  int size;
+  bool registered;
+  bool shut_down;
+};
+
+template <size_t kBlockSize>
+ThreadCache& GetThreadCache() {
+  static thread_local ThreadCache cache;
+  return cache;
+}
+
+template <size_t kBlockSize>
+struct ThreadCacheFlusher {
+  ~ThreadCacheFlusher() {
+    ThreadCache& cache = GetThreadCache<kBlockSize>();
+    if (cache.head != nullptr) {
+      FreeBlock* last = cache.head;
+      while (last->next != nullptr) last = last->next;
+      CentralFreelist<kBlockSize>::Get().PutList(cache.head, last);
+    }
+    cache.head = nullptr;
+    cache.size = 0;
+    cache.shut_down = true;
+  }
+};
+
+template <size_t kBlockSize>
+void RegisterThreadCache(ThreadCache& cache) {
+  static thread_local ThreadCacheFlusher<kBlockSize> flusher;
+  (void)flusher;
+  cache.registered = true;
+}
+
+// Allocation and deallocation of blocks of one size class.
+template <size_t kBlockSize>
+class Freelist {
+ public:
+  static void* Allocate() {
+    ThreadCache& cache = GetThreadCache<kBlockSize>();
+    if (cache.head == nullptr && !cache.shut_down) {
+      if (!cache.registered) RegisterThreadCache<kBlockSize>(cache);
+      cache.size += CentralFreelist<kBlockSize>::Get().TakeBatch(&cache.head);
+    }
+    if (cache.head != nullptr) {
+      FreeBlock* block = cache.head;
+      cache.head = block->next;
+      --cache.size;
+      return block;
+    }
+    return ::operator new(kBlockSize);
+  }
+
+  static void Deallocate(void* ptr) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    ThreadCache& cache = GetThreadCache<kBlockSize>();
+    if (cache.shut_down) {
+      CentralFreelist<kBlockSize>::Get().PutList(block, block);
+      return;
+    }
+    if (!cache.registered) RegisterThreadCache<kBlockSize>(cache);
+    block->next = cache.head;
+    cache.head = block;
+    if (++cache.size > kMaxThreadCacheBlocks) {
+      FreeBlock* first = cache.head;
+      FreeBlock* last = first;
+      for (int i = 1; i < kTransferBatchSize; ++i) last = last->next;
+      cache.head = last->next;
+      cache.size -= kTransferBatchSize;
+      CentralFreelist<kBlockSize>::Get().PutList(first, last);
+    }
+  }
+};
+
+}  // namespace freelist_internal
+
+// A stateless allocator that recycles single-object allocations of up to
+// kMaxFreelistBlockSize bytes through per-size-class freelists instead of
+// returning them to the heap. Each thread allocates from and frees into its
+// own cache, so the steady state takes no locks and makes no malloc calls;
+// the caches exchange blocks in batches through a process-wide freelist.
+//
+// Memory held by the freelists is never returned to the heap, so this is
+// meant for small objects that are allocated and freed at a high rate, such
+// as packet payloads.
+template <typename T>
+class FreelistAllocator {
+ public:
+  using value_type = T;
+
+  FreelistAllocator() = default;
+  template <typename U>
+  FreelistAllocator(const FreelistAllocator<U>&) {}  // NOLINT
+
+  T* allocate(size_t n) {
+    if (kPooled && n == 1) {
+      return static_cast<T*>(Pool::Allocate());
+    }
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    if (kPooled && n == 1) {
+      Pool::Deallocate(ptr);
+      return;
+    }
+    ::operator delete(ptr);
+  }
+
+ private:
+  // Blocks come from ::operator new, so over-aligned types are not pooled.
+  static constexpr bool kPooled = sizeof(T) <= kMaxFreelistBlockSize &&
+                                  alignof(T) <= alignof(std::max_align_t);
+  using Pool =
+      freelist_internal::Freelist<freelist_internal::SizeClass(sizeof(T))>;
+};
+
+template <typename T, typename U>
+bool operator==(const FreelistAllocator<T>&, const FreelistAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const FreelistAllocator<T>&, const FreelistAllocator<U>&) {
+  return false;
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_FREELIST_ALLOCATOR_H_
@@ -0,0 +1,99 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/freelist_allocator.h"
+
+#include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+struct Small {
+  int64_t values[4];
+};
+
+struct Large {
+  char bytes[kMaxFreelistBlockSize + 1];
+};
+
+TEST(FreelistAllocatorTest, ReusesFreedBlocks) {
+  FreelistAllocator<Small> allocator;
+  Small* first = allocator.allocate(1);
+  allocator.deallocate(first, 1);
+  Small* second = allocator.allocate(1);
+  EXPECT_EQ(first, second);
+  allocator.deallocate(second, 1);
+}
+
+TEST(FreelistAllocatorTest, SharesSizeClassAcrossTypes) {
+  FreelistAllocator<Small> small_allocator;
+  FreelistAllocator<int64_t[3]> other_allocator;
+  Small* small = small_allocator.allocate(1);
+  small_allocator.deallocate(small, 1);
+  int64_t(*other)[3] = other_allocator.allocate(1);
+  EXPECT_EQ(static_cast<void*>(small), static_cast<void*>(other));
+  other_allocator.deallocate(other, 1);
+}
+
+TEST(FreelistAllocatorTest, HandlesArraysAndLargeObjects) {
+  FreelistAllocator<Small> small_allocator;
+  Small* array = small_allocator.allocate(10);
+  array[9].values[3] = 1;
+  small_allocator.deallocate(array, 10);
+
+  FreelistAllocator<Large> large_allocator;
+  Large* large = large_allocator.allocate(1);
+  large->bytes[kMaxFreelistBlockSize] = 1;
+  large_allocator.deallocate(large, 1);
+}
+
+TEST(FreelistAllocatorTest, WorksWithAllocateShared) {
+  std::vector<std::shared_ptr<Small>> ptrs;
+  for (int i = 0; i < 1000; ++i) {
+    ptrs.push_back(std::allocate_shared<Small>(FreelistAllocator<Small>(),
+                                               Small{{i, i, i, i}}));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(ptrs[i]->values[2], i);
+  }
+}
+
+TEST(FreelistAllocatorTest, FreesBlocksAllocatedOnOtherThreads) {
+  constexpr int kNumBlocks = 10000;
+  FreelistAllocator<Small> allocator;
+  std::vector<Small*> blocks;
+  for (int round = 0; round < 3; ++round) {
+    // Allocated here, freed on another thread which then exits.
+    for (int i = 0; i < kNumBlocks; ++i) {
+      blocks.push_back(allocator.allocate(1));
+      blocks.back()->values[0] = i;
+    }
+    std::thread consumer([&blocks, &allocator] {
+      for (int i = 0; i < kNumBlocks; ++i) {
+        EXPECT_EQ(blocks[i]->values[0], i);
+        allocator.deallocate(blocks[i], 1);
+      }
+    });
+    consumer.join();
+    blocks.clear();
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,121 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_RING_BUFFER_H_
+#define MEDIAPIPE_DEPS_RING_BUFFER_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+
+namespace mediapipe {
+
+// A FIFO queue stored in a contiguous circular buffer.
+//
+// Unlike std::deque, a RingBuffer never releases memory while it is in use:
+// pushing and popping at a steady size does not allocate, and capacity can be
+// set up front with reserve(). When full, the buffer doubles its capacity.
+//
+// Popped slots are reset to T(), so T must be default constructible and
+// movable.
+template <typename T>
+class RingBuffer {
+ public:
+  RingBuffer() = default;
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return slots_.size(); }
+
+  // Returns the i-th element from the front.
+  const T& operator[](size_t i) const {
+    ABSL_DCHECK_LT(i, size_);
+    return slots_[Index(i)];
+  }
+  T& operator[](size_t i) {
+    ABSL_DCHECK_LT(i, size_);
+    return slots_[Index(i)];
+  }
+  const T& front() const { return (*this)[0]; }
+  T& front() { return (*this)[0]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+  T& back() { return (*this)[size_ - 1]; }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ == slots_.size()) {
+      Grow(size_ + 1);
+    }
+    T& slot = slots_[Index(size_)];
+    slot = T(std::forward<Args>(args)...);
+    ++size_;
+    return slot;
+  }
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  void pop_front() {
+    ABSL_DCHECK(!empty());
+    slots_[head_] = T();
+    head_ = (head_ + 1) & mask_;
+    --size_;
+  }
+
+  // Removes all elements and keeps the capacity.
+  void clear() {
+    while (!empty()) pop_front();
+    head_ = 0;
+  }
+
+  // Makes room for at least "capacity" elements.
+  void reserve(size_t capacity) {
+    if (capacity > slots_.size()) {
+      Grow(capacity);
+    }
+  }
+
+ private:
+  size_t Index(size_t i) const { return (head_ + i) & mask_; }
+
+  // Reallocates the buffer to the next power of two >= min_capacity, moving
+  // the elements to the start of the new buffer.
+  void Grow(size_t min_capacity) {
+    size_t capacity = slots_.empty() ? kMinCapacity : slots_.size();
+    while (capacity < min_capacity) capacity *= 2;
+    std::vector<T> slots(capacity);
+    for (size_t i = 0; i < size_; ++i) {
+      slots[i] = std::move(slots_[Index(i)]);
+    }
+    slots_.swap(slots);
+    head_ = 0;
+    mask_ = capacity - 1;
+  }
+
+  static constexpr size_t kMinCapacity = 4;
+
+  // The capacity is always a power of two, or zero before the first
+  // allocation.
+  std::vector<T> slots_;
+  size_t mask_ = 0;
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_RING_BUFFER_H_
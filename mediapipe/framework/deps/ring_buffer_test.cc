@@ -0,0 +1,95 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/ring_buffer.h"
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(RingBufferTest, PushAndPopInFifoOrder) {
+  RingBuffer<int> buffer;
+  EXPECT_TRUE(buffer.empty());
+  for (int i = 0; i < 10; ++i) buffer.push_back(i);
+  EXPECT_EQ(buffer.size(), 10);
+  EXPECT_EQ(buffer.front(), 0);
+  EXPECT_EQ(buffer.back(), 9);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(buffer[i], i);
+  }
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(buffer.front(), i);
+    buffer.pop_front();
+  }
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(RingBufferTest, WrapsAroundWithoutGrowing) {
+  RingBuffer<int> buffer;
+  buffer.reserve(8);
+  const size_t capacity = buffer.capacity();
+  EXPECT_EQ(capacity, 8);
+  int next_push = 0;
+  int next_pop = 0;
+  for (int round = 0; round < 100; ++round) {
+    while (buffer.size() < 5) buffer.push_back(next_push++);
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_EQ(buffer.front(), next_pop++);
+      buffer.pop_front();
+    }
+  }
+  EXPECT_EQ(buffer.capacity(), capacity);
+  EXPECT_EQ(buffer.back(), next_push - 1);
+}
+
+TEST(RingBufferTest, GrowsWhenWrappedAround) {
+  RingBuffer<std::string> buffer;
+  buffer.reserve(4);
+  buffer.push_back("a");
+  buffer.push_back("b");
+  buffer.push_back("c");
+  buffer.pop_front();
+  buffer.pop_front();
+  // The contents now wrap around the end of the buffer when it grows.
+  for (int i = 0; i < 10; ++i) buffer.push_back(std::string(1, 'd' + i));
+  ASSERT_EQ(buffer.size(), 11);
+  EXPECT_GE(buffer.capacity(), 11);
+  std::string contents;
+  while (!buffer.empty()) {
+    contents += buffer.front();
+    buffer.pop_front();
+  }
+  EXPECT_EQ(contents, "cdefghijklm");
+}
+
+TEST(RingBufferTest, PopAndClearReleaseElements) {
+  auto value = std::make_shared<int>(1);
+  RingBuffer<std::shared_ptr<int>> buffer;
+  buffer.push_back(value);
+  buffer.push_back(value);
+  EXPECT_EQ(value.use_count(), 3);
+  buffer.pop_front();
+  EXPECT_EQ(value.use_count(), 2);
+  buffer.clear();
+  EXPECT_EQ(value.use_count(), 1);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_GT(buffer.capacity(), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,150 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_WORK_STEALING_DEQUE_H_
+#define MEDIAPIPE_DEPS_WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mediapipe {
+
+// A lock-free single-owner, multi-thief deque of pointers (Chase-Lev).
+//
+// The owner thread calls Push() and Pop() on the bottom end; any thread may
+// call Steal() on the top end. Pop() is LIFO for the owner and Steal() is
+// FIFO for thieves. The deque grows when full; retired buffers are kept until
+// the deque is destroyed, since a concurrent thief may still be reading them.
+//
+// The deque does not own the pointed-to elements.
+//
+// Based on "Correct and Efficient Work-Stealing for Weak Memory Models",
+// Lê et al., PPoPP 2013.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(int64_t initial_capacity = 64)
+      : top_(0), bottom_(0) {
+    int64_t capacity = 1;
+    while (capacity < initial_capacity) capacity <<= 1;
+    buffers_.push_back(std::make_unique<Buffer>(capacity));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+  }
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // Pushes "item" onto the bottom of the deque. Owner thread only.
+  void Push(T* item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    if (b - t > buffer->capacity() - 1) {
+      buffer = Grow(buffer, t, b);
+    }
+    buffer->Put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Pops an item from the bottom of the deque, or returns nullptr if the
+  // deque is empty. Owner thread only.
+  T* Pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      // Empty.
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = buffer->Get(b);
+    if (t == b) {
+      // Last item: race against thieves.
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Steals an item from the top of the deque. Returns nullptr if the deque is
+  // empty or if another thread won the race for the top item. Any thread.
+  T* Steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    Buffer* buffer = buffer_.load(std::memory_order_acquire);
+    T* item = buffer->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // Returns an estimate of the number of items. Exact only when quiescent.
+  int64_t SizeEstimate() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+  }
+
+ private:
+  class Buffer {
+   public:
+    explicit Buffer(int64_t capacity)
+        : mask_(capacity - 1), slots_(new std::atomic<T*>[capacity]) {}
+
+    int64_t capacity() const { return mask_ + 1; }
+    T* Get(int64_t i) const {
+      return slots_[i & mask_].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t i, T* item) {
+      slots_[i & mask_].store(item, std::memory_order_relaxed);
+    }
+
+   private:
+    const int64_t mask_;
+    std::unique_ptr<std::atomic<T*>[]> slots_;
+  };
+
+  Buffer* Grow(Buffer* old_buffer, int64_t top, int64_t bottom) {
+    auto new_buffer = std::make_unique<Buffer>(old_buffer->capacity() * 2);
+    for (int64_t i = top; i < bottom; ++i) {
+      new_buffer->Put(i, old_buffer->Get(i));
+    }
+    Buffer* result = new_buffer.get();
+    // Only the owner touches buffers_, so no synchronization is needed here.
+    buffers_.push_back(std::move(new_buffer));
+    buffer_.store(result, std::memory_order_release);
+    return result;
+  }
+
+  alignas(64) std::atomic<int64_t> top_;
+  alignas(64) std::atomic<int64_t> bottom_;
+  std::atomic<Buffer*> buffer_;
+  // All buffers ever allocated, owned by the deque.
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_WORK_STEALING_DEQUE_H_
@@ -0,0 +1,95 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/work_stealing_deque.h"
+
+#include <atomic>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(WorkStealingDequeTest, OwnerPopsInLifoOrder) {
+  WorkStealingDeque<int> deque(4);
+  std::vector<int> values = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  for (int& v : values) deque.Push(&v);
+  EXPECT_EQ(deque.SizeEstimate(), 10);
+  for (int i = 9; i >= 0; --i) {
+    int* v = deque.Pop();
+    ASSERT_NE(v, nullptr);
+    EXPECT_EQ(*v, i);
+  }
+  EXPECT_EQ(deque.Pop(), nullptr);
+}
+
+TEST(WorkStealingDequeTest, ThiefStealsInFifoOrder) {
+  WorkStealingDeque<int> deque(2);
+  std::vector<int> values = {0, 1, 2, 3, 4};
+  for (int& v : values) deque.Push(&v);
+  for (int i = 0; i < 5; ++i) {
+    int* v = deque.Steal();
+    ASSERT_NE(v, nullptr);
+    EXPECT_EQ(*v, i);
+  }
+  EXPECT_EQ(deque.Steal(), nullptr);
+}
+
+TEST(WorkStealingDequeTest, EveryItemIsTakenExactlyOnce) {
+  constexpr int kNumItems = 100000;
+  constexpr int kNumThieves = 4;
+  std::vector<int> values(kNumItems);
+  std::vector<std::atomic<int>> taken(kNumItems);
+  for (int i = 0; i < kNumItems; ++i) values[i] = i;
+
+  WorkStealingDeque<int> deque;
+  std::atomic<bool> done(false);
+  std::atomic<int> num_taken(0);
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < kNumThieves; ++t) {
+    thieves.emplace_back([&] {
+      while (!done.load() || deque.SizeEstimate() > 0) {
+        if (int* v = deque.Steal()) {
+          taken[*v].fetch_add(1);
+          num_taken.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (int i = 0; i < kNumItems; ++i) {
+    deque.Push(&values[i]);
+    if (i % 3 == 0) {
+      if (int* v = deque.Pop()) {
+        taken[*v].fetch_add(1);
+        num_taken.fetch_add(1);
+      }
+    }
+  }
+  while (int* v = deque.Pop()) {
+    taken[*v].fetch_add(1);
+    num_taken.fetch_add(1);
+  }
+  done.store(true);
+  for (auto& thief : thieves) thief.join();
+
+  EXPECT_EQ(num_taken.load(), kNumItems);
+  for (int i = 0; i < kNumItems; ++i) {
+    EXPECT_EQ(taken[i].load(), 1) << "item " << i;
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
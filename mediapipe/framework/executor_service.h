@@ -0,0 +1,37 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_EXECUTOR_SERVICE_H_
+#define MEDIAPIPE_FRAMEWORK_EXECUTOR_SERVICE_H_
+
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+
+// Gives calculators access to the graph's default executor, so that they can
+// split the work of a single Process call into tasks running on the graph's
+// threads. CalculatorGraph provides it to every node that requests it, unless
+// it has been set explicitly with `SetServiceObject`.
+//
+// Tasks must not block waiting on other tasks scheduled this way: the executor
+// may have a single thread, or run tasks on the application thread once the
+// current one returns. Calculators should therefore also work on the tasks
+// themselves and only wait for the ones already started.
+inline constexpr GraphService<Executor> kDefaultExecutorService(
+    "mediapipe::DefaultExecutorService");
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_EXECUTOR_SERVICE_H_
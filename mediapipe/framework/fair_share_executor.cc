@@ -0,0 +1,144 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/framework/fair_share_executor.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+class FairShareExecutor::Client : public Executor {
+ public:
+  Client(FairShareExecutor* owner, std::shared_ptr<Lane> lane)
+      : owner_(owner), lane_(std::move(lane)) {}
+  ~Client() override { owner_->RemoveLane(lane_); }
+
+  void Schedule(std::function<void()> task) override {
+    owner_->Schedule(lane_, std::move(task));
+  }
+
+ private:
+  FairShareExecutor* const owner_;
+  const std::shared_ptr<Lane> lane_;
+};
+
+FairShareExecutor::FairShareExecutor(int num_threads)
+    : FairShareExecutor(ThreadOptions(), num_threads) {}
+
+FairShareExecutor::FairShareExecutor(const ThreadOptions& thread_options,
+                                     int num_threads)
+    : num_threads_(num_threads <= 0 ? 1 : num_threads) {
+  thread_pool_ = std::make_unique<ThreadPool>(
+      thread_options,
+      thread_options.name_prefix().empty() ? "mediapipe"
+                                           : thread_options.name_prefix(),
+      num_threads_);
+  thread_pool_->StartWorkers();
+  // Each worker loop occupies one pool thread until the executor is stopped.
+  for (int i = 0; i < num_threads_; ++i) {
+    thread_pool_->Schedule([this] { RunWorker(); });
+  }
+  VLOG(2) << "Started fair-share executor with " << num_threads_
+          << " threads.";
+}
+
+FairShareExecutor::~FairShareExecutor() {
+  VLOG(2) << "Terminating fair-share executor.";
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+  }
+  // Waits for the worker loops, which drain all pending tasks before exiting.
+  thread_pool_.reset();
+}
+
+std::shared_ptr<Executor> FairShareExecutor::AddClient(int weight) {
+  ABSL_CHECK_GT(weight, 0);
+  auto lane = std::make_shared<Lane>(weight);
+  {
+    absl::MutexLock lock(&mutex_);
+    lanes_.push_back(lane);
+  }
+  return std::make_shared<Client>(this, std::move(lane));
+}
+
+void FairShareExecutor::Schedule(const std::shared_ptr<Lane>& lane,
+                                 Task task) {
+  absl::MutexLock lock(&mutex_);
+  if (lane->tasks.empty()) {
+    // An idle client doesn't get to catch up on the time it didn't use.
+    lane->virtual_time = std::max(lane->virtual_time, virtual_time_);
+  }
+  lane->tasks.push_back(std::move(task));
+  ++pending_tasks_;
+}
+
+void FairShareExecutor::RemoveLane(const std::shared_ptr<Lane>& lane) {
+  absl::MutexLock lock(&mutex_);
+  lane->removed = true;
+  if (lane->tasks.empty()) {
+    lanes_.erase(std::find(lanes_.begin(), lanes_.end(), lane));
+  }
+}
+
+std::shared_ptr<FairShareExecutor::Lane> FairShareExecutor::TakeTask(
+    Task* task) {
+  auto next = lanes_.end();
+  for (auto it = lanes_.begin(); it != lanes_.end(); ++it) {
+    if (!(*it)->tasks.empty() &&
+        (next == lanes_.end() || (*it)->virtual_time < (*next)->virtual_time)) {
+      next = it;
+    }
+  }
+  ABSL_CHECK(next != lanes_.end());
+  std::shared_ptr<Lane> lane = *next;
+  *task = std::move(lane->tasks.front());
+  lane->tasks.pop_front();
+  --pending_tasks_;
+  virtual_time_ = std::max(virtual_time_, lane->virtual_time);
+  if (lane->removed && lane->tasks.empty()) {
+    lanes_.erase(next);
+  }
+  return lane;
+}
+
+void FairShareExecutor::RunWorker() {
+  while (true) {
+    Task task;
+    std::shared_ptr<Lane> lane;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(
+          absl::Condition(this, &FairShareExecutor::HasTaskOrStopped));
+      if (pending_tasks_ == 0) {
+        return;
+      }
+      lane = TakeTask(&task);
+    }
+    const absl::Time start = absl::Now();
+    task();
+    const int64_t elapsed = absl::ToInt64Nanoseconds(absl::Now() - start);
+    absl::MutexLock lock(&mutex_);
+    lane->virtual_time += elapsed / lane->weight;
+  }
+}
+
+}  // namespace mediapipe
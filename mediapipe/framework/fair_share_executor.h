@@ -0,0 +1,105 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MEDIAPIPE_FRAMEWORK_FAIR_SHARE_EXECUTOR_H_
+#define MEDIAPIPE_FRAMEWORK_FAIR_SHARE_EXECUTOR_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/thread_options.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// Runs the tasks of several clients, typically the default executors of many
+// CalculatorGraphs, on one set of worker threads, so that N graphs don't
+// start N thread pools and oversubscribe the CPU.
+//
+// Each client has a weight. An idle worker takes the next task of the client
+// that has used the least CPU time relative to its weight, among the clients
+// with queued tasks. So when the workers are saturated, a client with weight
+// 2 gets twice the CPU time of a client with weight 1, and a busy client
+// cannot starve the others. Clients don't accumulate credit while idle.
+// Tasks of one client run in FIFO order.
+//
+// Example:
+//   FairShareExecutor executor(NumCPUCores());
+//   CalculatorGraph graph;
+//   MP_RETURN_IF_ERROR(graph.SetExecutor("", executor.AddClient(2)));
+class FairShareExecutor {
+ public:
+  explicit FairShareExecutor(int num_threads);
+  FairShareExecutor(const ThreadOptions& thread_options, int num_threads);
+  // Runs the tasks that are still queued before returning.
+  ~FairShareExecutor();
+  FairShareExecutor(const FairShareExecutor&) = delete;
+  FairShareExecutor& operator=(const FairShareExecutor&) = delete;
+
+  // Returns an executor whose tasks run on this executor's threads, with the
+  // given weight, which must be positive. The client must not outlive this
+  // executor.
+  std::shared_ptr<Executor> AddClient(int weight);
+
+  int num_threads() const { return num_threads_; }
+
+ private:
+  using Task = std::function<void()>;
+  struct Lane {
+    explicit Lane(int weight) : weight(weight) {}
+    const int weight;
+    std::deque<Task> tasks;
+    // CPU time used by the client divided by its weight, in nanoseconds.
+    int64_t virtual_time = 0;
+    // Set when the client is destroyed. The lane is dropped once empty.
+    bool removed = false;
+  };
+  class Client;
+
+  void Schedule(const std::shared_ptr<Lane>& lane, Task task);
+  void RemoveLane(const std::shared_ptr<Lane>& lane);
+  // Body of the worker threads. Returns when the executor is stopped and no
+  // tasks remain.
+  void RunWorker();
+  // Pops the next task to run into "task", and returns its lane.
+  std::shared_ptr<Lane> TakeTask(Task* task)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool HasTaskOrStopped() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return pending_tasks_ > 0 || stopped_;
+  }
+
+  const int num_threads_;
+
+  absl::Mutex mutex_;
+  std::vector<std::shared_ptr<Lane>> lanes_ ABSL_GUARDED_BY(mutex_);
+  int64_t pending_tasks_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The virtual time of the last lane that a task was taken from. Lanes that
+  // become busy start from it.
+  int64_t virtual_time_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // Hosts the worker loops.
+  std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FAIR_SHARE_EXECUTOR_H_
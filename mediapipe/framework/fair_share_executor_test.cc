@@ -0,0 +1,133 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/framework/fair_share_executor.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Busy-waits for "duration", so that the task uses CPU time.
+void Spin(absl::Duration duration) {
+  const absl::Time end = absl::Now() + duration;
+  while (absl::Now() < end) {
+  }
+}
+
+TEST(FairShareExecutorTest, RunsAllTasksBeforeDestruction) {
+  std::atomic<int> count(0);
+  {
+    FairShareExecutor executor(4);
+    std::shared_ptr<Executor> first = executor.AddClient(1);
+    std::shared_ptr<Executor> second = executor.AddClient(2);
+    for (int i = 0; i < 1000; ++i) {
+      first->Schedule([&count] { count.fetch_add(1); });
+      second->Schedule([&count] { count.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(count.load(), 2000);
+}
+
+TEST(FairShareExecutorTest, SharesThreadsByWeight) {
+  FairShareExecutor executor(1);
+  std::shared_ptr<Executor> light = executor.AddClient(1);
+  std::shared_ptr<Executor> heavy = executor.AddClient(3);
+  // Holds the only worker until both clients have queued their tasks.
+  std::shared_ptr<Executor> gate = executor.AddClient(1);
+  absl::Notification queued;
+  gate->Schedule([&queued] { queued.WaitForNotification(); });
+
+  absl::Mutex mutex;
+  std::vector<int> order;
+  constexpr int kTasks = 100;
+  for (int i = 0; i < kTasks; ++i) {
+    for (int client : {0, 1}) {
+      (client == 0 ? light : heavy)->Schedule([&mutex, &order, client] {
+        Spin(absl::Microseconds(200));
+        absl::MutexLock lock(&mutex);
+        order.push_back(client);
+      });
+    }
+  }
+  queued.Notify();
+  absl::MutexLock lock(&mutex);
+  mutex.Await(absl::Condition(
+      +[](std::vector<int>* order) { return order->size() == 2 * kTasks; },
+      &order));
+  // While both clients have queued tasks, the heavy one gets about 3/4 of
+  // the runs.
+  int heavy_runs = 0;
+  for (int i = 0; i < 80; ++i) {
+    heavy_runs += order[i];
+  }
+  EXPECT_GE(heavy_runs, 50);
+  EXPECT_LE(heavy_runs, 70);
+}
+
+TEST(FairShareExecutorTest, RunsGraphsOnSharedThreads) {
+  FairShareExecutor executor(2);
+  constexpr int kNumGraphs = 3;
+  constexpr int kNumPackets = 50;
+  std::vector<std::unique_ptr<CalculatorGraph>> graphs;
+  std::atomic<int> num_outputs(0);
+  for (int i = 0; i < kNumGraphs; ++i) {
+    auto graph = std::make_unique<CalculatorGraph>();
+    MP_ASSERT_OK(graph->SetExecutor("", executor.AddClient(i + 1)));
+    MP_ASSERT_OK(
+        graph->Initialize(ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+          input_stream: "in"
+          output_stream: "out"
+          node {
+            calculator: "PassThroughCalculator"
+            input_stream: "in"
+            output_stream: "out"
+          }
+        )pb")));
+    MP_ASSERT_OK(graph->ObserveOutputStream("out", [&num_outputs](
+                                                       const Packet&) {
+      num_outputs.fetch_add(1);
+      return absl::OkStatus();
+    }));
+    MP_ASSERT_OK(graph->StartRun({}));
+    graphs.push_back(std::move(graph));
+  }
+  for (int t = 0; t < kNumPackets; ++t) {
+    for (auto& graph : graphs) {
+      MP_ASSERT_OK(graph->AddPacketToInputStream(
+          "in", MakePacket<int>(t).At(Timestamp(t))));
+    }
+  }
+  for (auto& graph : graphs) {
+    MP_ASSERT_OK(graph->CloseAllInputStreams());
+    MP_ASSERT_OK(graph->WaitUntilDone());
+  }
+  graphs.clear();
+  EXPECT_EQ(num_outputs.load(), kNumGraphs * kNumPackets);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -35,7 +35,7 @@
 
 #include "mediapipe/framework/formats/tensor_mtl_buffer_view.h"
 #else
-#include <cstdlib>
+#include "mediapipe/framework/formats/tensor_cpu_buffer_pool.h"
 #endif  // MEDIAPIPE_METAL_ENABLED
 
 namespace mediapipe {
@@ -530,7 +530,7 @@ void Tensor::Invalidate() {
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 
   if (cpu_buffer_) {
-    free(cpu_buffer_);
+    TensorCpuBufferPool::Get().Deallocate(cpu_buffer_, bytes());
   }
   cpu_buffer_ = nullptr;
 }
@@ -648,7 +648,9 @@ void Tensor::AllocateCpuBuffer() const {
 #if MEDIAPIPE_METAL_ENABLED
     cpu_buffer_ = AllocateVirtualMemory(bytes());
 #else
-    cpu_buffer_ = malloc(bytes());
+    static_assert(TensorCpuBufferPool::kAlignment % kCpuBufferAlignment == 0,
+                  "Pooled buffers must satisfy the CPU view alignment.");
+    cpu_buffer_ = TensorCpuBufferPool::Get().Allocate(bytes());
 #endif  // MEDIAPIPE_METAL_ENABLED
   }
 }
@@ -146,6 +146,11 @@ class Tensor {
     int zero_point = 0;
   };
 
+  // Alignment of the buffer returned by the CPU views. It matches the
+  // alignment TfLite requires for custom tensor allocations, so the buffer can
+  // be handed to an interpreter without a copy.
+  static constexpr int kCpuBufferAlignment = 64;
+
   Tensor(ElementType element_type, const Shape& shape);
   Tensor(ElementType element_type, const Shape& shape,
          const QuantizationParameters& quantization_parameters);
@@ -11,6 +11,7 @@
 #include "absl/log/absl_log.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/formats/hardware_buffer.h"
+#include "mediapipe/framework/formats/tensor_cpu_buffer_pool.h"
 #include "mediapipe/gpu/gl_base.h"
 #endif  // MEDIAPIPE_TENSOR_USE_AHWB
 
@@ -320,7 +321,7 @@ void Tensor::MoveCpuOrSsboToAhwb() const {
   if (valid_ & kValidCpu) {
     std::memcpy(*dest, cpu_buffer_, bytes());
     // Free CPU memory because next time AHWB is mapped instead.
-    free(cpu_buffer_);
+    TensorCpuBufferPool::Get().Deallocate(cpu_buffer_, bytes());
     cpu_buffer_ = nullptr;
     valid_ &= ~kValidCpu;
   } else if (valid_ & kValidOpenGlBuffer) {
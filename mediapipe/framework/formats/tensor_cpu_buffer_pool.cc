@@ -0,0 +1,138 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_cpu_buffer_pool.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/port/aligned_malloc_and_free.h"
+#include "mediapipe/util/cpu_util.h"
+
+namespace mediapipe {
+
+TensorCpuBufferPool& TensorCpuBufferPool::Get() {
+  static NoDestructor<TensorCpuBufferPool> pool;
+  return *pool;
+}
+
+TensorCpuBufferPool::TensorCpuBufferPool(size_t max_retained_bytes)
+    : numa_aware_(NumNumaNodes() > 1),
+      max_retained_bytes_(max_retained_bytes) {}
+
+TensorCpuBufferPool::~TensorCpuBufferPool() {
+  absl::MutexLock lock(&mutex_);
+  TrimTo(0);
+}
+
+size_t TensorCpuBufferPool::SizeClass(size_t bytes) {
+  if (bytes <= kAlignment) return kAlignment;
+  // Rounds up to the next multiple of a quarter of the power of two below
+  // "bytes", which wastes at most 25% of a buffer.
+  int log2 = 0;
+  while ((bytes - 1) >> (log2 + 1)) ++log2;
+  const int shift = log2 - 2;
+  return (((bytes - 1) >> shift) + 1) << shift;
+}
+
+void* TensorCpuBufferPool::Allocate(size_t bytes) {
+  const size_t size = SizeClass(bytes);
+  const int node = numa_aware_ ? CurrentNumaNode() : 0;
+  {
+    absl::MutexLock lock(&mutex_);
+    stats_.bytes_in_use += size;
+    auto it = free_buffers_.find({node, size});
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      void* buffer = it->second.back();
+      it->second.pop_back();
+      stats_.bytes_retained -= size;
+      ++stats_.hits;
+      return buffer;
+    }
+    ++stats_.misses;
+  }
+  void* buffer = aligned_malloc(size, kAlignment);
+  if (buffer == nullptr || numa_aware_) {
+    absl::MutexLock lock(&mutex_);
+    if (buffer == nullptr) {
+      stats_.bytes_in_use -= size;
+    } else {
+      buffer_nodes_[buffer] = node;
+    }
+  }
+  return buffer;
+}
+
+void TensorCpuBufferPool::Deallocate(void* buffer, size_t bytes) {
+  if (buffer == nullptr) return;
+  const size_t size = SizeClass(bytes);
+  {
+    absl::MutexLock lock(&mutex_);
+    stats_.bytes_in_use -= size;
+    if (static_cast<size_t>(stats_.bytes_retained) + size <=
+        max_retained_bytes_) {
+      const int node = numa_aware_ ? buffer_nodes_[buffer] : 0;
+      free_buffers_[{node, size}].push_back(buffer);
+      stats_.bytes_retained += size;
+      return;
+    }
+    if (numa_aware_) buffer_nodes_.erase(buffer);
+  }
+  aligned_free(buffer);
+}
+
+TensorCpuBufferPool::Stats TensorCpuBufferPool::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+size_t TensorCpuBufferPool::max_retained_bytes() const {
+  absl::MutexLock lock(&mutex_);
+  return max_retained_bytes_;
+}
+
+void TensorCpuBufferPool::SetMaxRetainedBytes(size_t max_retained_bytes) {
+  absl::MutexLock lock(&mutex_);
+  max_retained_bytes_ = max_retained_bytes;
+  TrimTo(max_retained_bytes);
+}
+
+void TensorCpuBufferPool::Clear() {
+  absl::MutexLock lock(&mutex_);
+  TrimTo(0);
+}
+
+void TensorCpuBufferPool::TrimTo(size_t max_bytes) {
+  // Releases the largest buffers first, which frees the most memory for the
+  // fewest future misses.
+  while (static_cast<size_t>(stats_.bytes_retained) > max_bytes) {
+    auto largest = free_buffers_.end();
+    for (auto it = free_buffers_.begin(); it != free_buffers_.end(); ++it) {
+      if (!it->second.empty() && (largest == free_buffers_.end() ||
+                                  it->first.second > largest->first.second)) {
+        largest = it;
+      }
+    }
+    if (largest == free_buffers_.end()) break;
+    void* buffer = largest->second.back();
+    largest->second.pop_back();
+    if (numa_aware_) buffer_nodes_.erase(buffer);
+    aligned_free(buffer);
+    stats_.bytes_retained -= largest->first.second;
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,114 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_CPU_BUFFER_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_CPU_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace mediapipe {
+
+// A process-wide pool of aligned CPU buffers, used for the CPU memory of
+// Tensors.
+//
+// Pipelines create new input and output tensors for every frame, usually of
+// the same few sizes. Buffers are grouped into size classes, four per power of
+// two, and released buffers are kept for reuse, so that in the steady state
+// tensor allocation doesn't reach the heap. The memory retained by free
+// buffers is bounded by max_retained_bytes().
+//
+// On machines with several NUMA nodes, free buffers are kept per node, and
+// handed out only to threads running on the node that first allocated them,
+// so that the pages of a buffer, placed on first touch, stay local to the
+// executor that reuses it (see ThreadPoolExecutorOptions::numa_node).
+class TensorCpuBufferPool {
+ public:
+  // Alignment of all buffers returned by Allocate().
+  static constexpr size_t kAlignment = 64;
+  static constexpr size_t kDefaultMaxRetainedBytes = 64 << 20;
+
+  struct Stats {
+    // Allocations served with a retained buffer.
+    int64_t hits = 0;
+    // Allocations that allocated a new buffer.
+    int64_t misses = 0;
+    // Bytes held by retained buffers, waiting to be reused.
+    int64_t bytes_retained = 0;
+    // Bytes held by buffers handed out by Allocate(), counted by size class.
+    int64_t bytes_in_use = 0;
+
+    double hit_rate() const {
+      const int64_t allocations = hits + misses;
+      return allocations == 0 ? 0.0 : static_cast<double>(hits) / allocations;
+    }
+  };
+
+  // Returns the pool used by Tensor.
+  static TensorCpuBufferPool& Get();
+
+  explicit TensorCpuBufferPool(
+      size_t max_retained_bytes = kDefaultMaxRetainedBytes);
+  ~TensorCpuBufferPool();
+  TensorCpuBufferPool(const TensorCpuBufferPool&) = delete;
+  TensorCpuBufferPool& operator=(const TensorCpuBufferPool&) = delete;
+
+  // Returns a buffer of at least "bytes" bytes, aligned to kAlignment, or
+  // nullptr if the allocation fails.
+  void* Allocate(size_t bytes);
+
+  // Releases a buffer returned by Allocate(). "bytes" must be the size it was
+  // allocated with.
+  void Deallocate(void* buffer, size_t bytes);
+
+  Stats GetStats() const;
+
+  size_t max_retained_bytes() const;
+  // Sets the limit on the memory retained by free buffers, releasing retained
+  // buffers as needed. Zero disables pooling.
+  void SetMaxRetainedBytes(size_t max_retained_bytes);
+
+  // Releases all retained buffers.
+  void Clear();
+
+  // Returns the size of the buffers used for allocations of "bytes" bytes.
+  static size_t SizeClass(size_t bytes);
+
+ private:
+  // Releases retained buffers until at most "max_bytes" are retained.
+  void TrimTo(size_t max_bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Whether free buffers are kept per NUMA node.
+  const bool numa_aware_;
+
+  mutable absl::Mutex mutex_;
+  size_t max_retained_bytes_ ABSL_GUARDED_BY(mutex_);
+  // Free buffers by NUMA node and size class. The node is always 0 unless
+  // "numa_aware_".
+  absl::flat_hash_map<std::pair<int, size_t>, std::vector<void*>>
+      free_buffers_ ABSL_GUARDED_BY(mutex_);
+  // The NUMA node of each buffer, if "numa_aware_".
+  absl::flat_hash_map<void*, int> buffer_nodes_ ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_CPU_BUFFER_POOL_H_
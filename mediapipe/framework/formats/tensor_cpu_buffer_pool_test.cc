@@ -0,0 +1,94 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_cpu_buffer_pool.h"
+
+#include <cstdint>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(TensorCpuBufferPoolTest, SizeClass) {
+  EXPECT_EQ(TensorCpuBufferPool::SizeClass(0), 64);
+  EXPECT_EQ(TensorCpuBufferPool::SizeClass(1), 64);
+  EXPECT_EQ(TensorCpuBufferPool::SizeClass(64), 64);
+  EXPECT_EQ(TensorCpuBufferPool::SizeClass(65), 80);
+  EXPECT_EQ(TensorCpuBufferPool::SizeClass(128), 128);
+  EXPECT_EQ(TensorCpuBufferPool::SizeClass(129), 160);
+  EXPECT_EQ(TensorCpuBufferPool::SizeClass(1000), 1024);
+  EXPECT_EQ(TensorCpuBufferPool::SizeClass(1025), 1280);
+  for (size_t bytes = 1; bytes < 100000; bytes = bytes * 3 / 2 + 1) {
+    const size_t size = TensorCpuBufferPool::SizeClass(bytes);
+    EXPECT_GE(size, bytes);
+    EXPECT_LE(size, bytes * 5 / 4 + 64);
+  }
+}
+
+TEST(TensorCpuBufferPoolTest, ReusesBuffers) {
+  TensorCpuBufferPool pool;
+  void* buffer = pool.Allocate(1000);
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) %
+                TensorCpuBufferPool::kAlignment,
+            0);
+  pool.Deallocate(buffer, 1000);
+  // Same size class.
+  EXPECT_EQ(pool.Allocate(1010), buffer);
+  pool.Deallocate(buffer, 1010);
+  // Different size class.
+  void* other = pool.Allocate(2000);
+  EXPECT_NE(other, buffer);
+  pool.Deallocate(other, 2000);
+
+  const TensorCpuBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.bytes_retained, 1024 + 2048);
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 1.0 / 3);
+}
+
+TEST(TensorCpuBufferPoolTest, LimitsRetainedBytes) {
+  TensorCpuBufferPool pool(/*max_retained_bytes=*/4096);
+  void* a = pool.Allocate(2048);
+  void* b = pool.Allocate(2048);
+  void* c = pool.Allocate(2048);
+  EXPECT_EQ(pool.GetStats().bytes_in_use, 3 * 2048);
+  pool.Deallocate(a, 2048);
+  pool.Deallocate(b, 2048);
+  pool.Deallocate(c, 2048);
+  EXPECT_EQ(pool.GetStats().bytes_retained, 4096);
+
+  pool.SetMaxRetainedBytes(2048);
+  EXPECT_EQ(pool.GetStats().bytes_retained, 2048);
+  pool.Clear();
+  EXPECT_EQ(pool.GetStats().bytes_retained, 0);
+  EXPECT_EQ(pool.max_retained_bytes(), 2048);
+}
+
+TEST(TensorCpuBufferPoolTest, ZeroLimitDisablesPooling) {
+  TensorCpuBufferPool pool(/*max_retained_bytes=*/0);
+  pool.Deallocate(pool.Allocate(100), 100);
+  pool.Deallocate(pool.Allocate(100), 100);
+  const TensorCpuBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.bytes_retained, 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -1,5 +1,6 @@
 #include "mediapipe/framework/formats/tensor.h"
 
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -53,6 +54,26 @@ TEST(Cpu, TestMemoryAllocation) {
   EXPECT_NE(f1, nullptr);
 }
 
+TEST(Cpu, TestMemoryAlignment) {
+  for (int size : {1, 3, 17, 1000, 100000}) {
+    Tensor t(Tensor::ElementType::kUInt8, Tensor::Shape{size});
+    auto view = t.GetCpuWriteView();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.buffer<uint8_t>()) %
+                  Tensor::kCpuBufferAlignment,
+              0);
+  }
+}
+
+TEST(Cpu, TestBufferReuse) {
+  const void* buffer;
+  {
+    Tensor t(Tensor::ElementType::kFloat32, Tensor::Shape{1, 224, 224, 3});
+    buffer = t.GetCpuWriteView().buffer<float>();
+  }
+  Tensor t(Tensor::ElementType::kFloat32, Tensor::Shape{1, 224, 224, 3});
+  EXPECT_EQ(t.GetCpuWriteView().buffer<float>(), buffer);
+}
+
 TEST(Cpu, TestTensorMove) {
   Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{4, 3, 2, 3},
             Tensor::QuantizationParameters(0.5, 127));
@@ -14,6 +14,9 @@
 
 #include "mediapipe/framework/graph_output_stream.h"
 
+#include <functional>
+#include <utility>
+
 #include "absl/log/absl_check.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/status.h"
@@ -161,10 +164,19 @@ void OutputStreamPollerImpl::SetMaxQueueSize(int queue_size) {
 
 int OutputStreamPollerImpl::QueueSize() { return input_stream_->QueueSize(); }
 
+void OutputStreamPollerImpl::SetNotifyCallback(
+    std::function<void()> notify_callback) {
+  mutex_.Lock();
+  notify_callback_ = std::move(notify_callback);
+  mutex_.Unlock();
+}
+
 absl::Status OutputStreamPollerImpl::Notify() {
   mutex_.Lock();
   handler_condvar_.Signal();
+  std::function<void()> notify_callback = notify_callback_;
   mutex_.Unlock();
+  if (notify_callback) notify_callback();
   return absl::OkStatus();
 }
 
@@ -172,7 +184,9 @@ void OutputStreamPollerImpl::NotifyError() {
   mutex_.Lock();
   graph_has_error_ = true;
   handler_condvar_.Signal();
+  std::function<void()> notify_callback = notify_callback_;
   mutex_.Unlock();
+  if (notify_callback) notify_callback();
 }
 
 bool OutputStreamPollerImpl::Next(Packet* packet) {
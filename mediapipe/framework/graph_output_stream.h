@@ -157,6 +157,9 @@ class OutputStreamPollerImpl : public GraphOutputStream {
   // Returns the number of packets in the queue.
   int QueueSize();
 
+  // Sets a callback run after each notification of new packets or errors.
+  void SetNotifyCallback(std::function<void()> notify_callback);
+
   // Notifies the poller of new packets emitted by the output stream.
   absl::Status Notify() override;
 
@@ -172,6 +175,7 @@ class OutputStreamPollerImpl : public GraphOutputStream {
   absl::CondVar handler_condvar_ ABSL_GUARDED_BY(mutex_);
   bool graph_has_error_ ABSL_GUARDED_BY(mutex_);
   Timestamp output_timestamp_ ABSL_GUARDED_BY(mutex_) = Timestamp::Min();
+  std::function<void()> notify_callback_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace internal
@@ -16,8 +16,10 @@
 
 #include <type_traits>
 
+#include "absl/synchronization/notification.h"
 #include "mediapipe/framework/calculator_contract.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/executor_service.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -349,6 +351,52 @@ TEST(DisallowDefaultInitializationGraphServiceTest,
                        HasSubstr("was not provided and cannot be created")));
 }
 
+class ScheduleOnDefaultExecutorCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->InputSidePackets().Index(0).Set<absl::Notification*>();
+    cc->UseService(kDefaultExecutorService);
+    return absl::OkStatus();
+  }
+  // Does not wait for the task: it may only run once Open returns.
+  absl::Status Open(CalculatorContext* cc) final {
+    RET_CHECK(cc->Service(kDefaultExecutorService).IsAvailable());
+    absl::Notification* done =
+        cc->InputSidePackets().Index(0).Get<absl::Notification*>();
+    cc->Service(kDefaultExecutorService).GetObject().Schedule([done] {
+      done->Notify();
+    });
+    return absl::OkStatus();
+  }
+  absl::Status Process(CalculatorContext* cc) final { return absl::OkStatus(); }
+};
+REGISTER_CALCULATOR(ScheduleOnDefaultExecutorCalculator);
+
+// The default executor is provided to the nodes requesting it even though
+// the service disallows default initialization.
+TEST(DefaultExecutorServiceTest, ProvidesDefaultExecutor) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        num_threads: 2
+        input_side_packet: 'done'
+        node {
+          calculator: 'ScheduleOnDefaultExecutorCalculator'
+          input_side_packet: 'done'
+        }
+      )pb");
+
+  absl::Notification done;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(
+      graph.StartRun({{"done", MakePacket<absl::Notification*>(&done)}}));
+  done.WaitForNotification();
+  MP_EXPECT_OK(graph.WaitUntilIdle());
+  EXPECT_NE(graph.GetServiceObject(kDefaultExecutorService), nullptr);
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_EXPECT_OK(graph.WaitUntilDone());
+}
+
 TEST(ServiceBindingTest, CrashesWhenGettingNullServiceObject) {
   ASSERT_DEATH(
       {
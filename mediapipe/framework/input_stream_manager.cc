@@ -14,9 +14,11 @@
 
 #include "mediapipe/framework/input_stream_manager.h"
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/log/absl_check.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
@@ -28,6 +30,14 @@
 
 namespace mediapipe {
 
+namespace {
+
+// Upper bound on the number of packet slots preallocated for a bounded stream.
+// A larger max_queue_size is allowed, but the queue then grows on demand.
+constexpr int kMaxPreallocatedQueueSize = 1024;
+
+}  // namespace
+
 absl::Status InputStreamManager::Initialize(const std::string& name,
                                             const PacketType* packet_type,
                                             bool back_edge) {
@@ -50,6 +60,7 @@ void InputStreamManager::SetQueueSizeCallbacks(
 void InputStreamManager::PrepareForRun() {
   absl::MutexLock stream_lock(&stream_mutex_);
   queue_.clear();
+  UpdateQueueSize();
   last_reported_stream_full_ = false;
   num_packets_added_ = 0;
   next_timestamp_bound_ = Timestamp::PreStream();
@@ -59,8 +70,7 @@ void InputStreamManager::PrepareForRun() {
 }
 
 bool InputStreamManager::IsEmpty() const {
-  absl::MutexLock stream_lock(&stream_mutex_);
-  return queue_.empty();
+  return queue_size_.load(std::memory_order_relaxed) == 0;
 }
 
 Packet InputStreamManager::QueueHead() const {
@@ -108,6 +118,12 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
         (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
     // Check if the queue becomes non-empty.
     queue_became_non_empty = queue_.empty() && !container.empty();
+    // The packets before an invalid one stay in the queue, so its size has to
+    // be published on the error paths too.
+    absl::Cleanup update_queue_size = [this] {
+      stream_mutex_.AssertHeld();
+      UpdateQueueSize();
+    };
     for (auto& packet : container) {
       absl::Status result = packet_type_->Validate(packet);
       if (!result.ok()) {
@@ -163,6 +179,7 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
         queue_.emplace_back(std::move(packet));
       }
     }
+    std::move(update_queue_size).Invoke();
     queue_became_full = (!was_queue_full && max_queue_size_ != -1 &&
                          queue_.size() >= max_queue_size_);
     if (queue_.size() > 1) {
@@ -279,6 +296,7 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
       current_timestamp = packet.Timestamp();
       ++(*num_packets_dropped);
     }
+    UpdateQueueSize();
     // Clear value_ if it doesn't have exactly the right timestamp.
     if (current_timestamp != timestamp) {
       // The timestamp bound reported when no packet is sent.
@@ -316,6 +334,7 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
     if (!queue_.empty()) {
       packet = std::move(queue_.front());
       queue_.pop_front();
+      UpdateQueueSize();
     } else {
       packet = Packet();
     }
@@ -338,13 +357,11 @@ int InputStreamManager::NumPacketsAdded() const {
 }
 
 int InputStreamManager::QueueSize() const {
-  absl::MutexLock lock(&stream_mutex_);
-  return static_cast<int>(queue_.size());
+  return queue_size_.load(std::memory_order_relaxed);
 }
 
 int InputStreamManager::MaxQueueSize() const {
-  absl::MutexLock lock(&stream_mutex_);
-  return max_queue_size_;
+  return max_queue_size_.load(std::memory_order_relaxed);
 }
 
 void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
@@ -355,6 +372,9 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
     was_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
     max_queue_size_ = max_queue_size;
     is_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    if (max_queue_size > 0) {
+      queue_.reserve(std::min(max_queue_size, kMaxPreallocatedQueueSize));
+    }
   }
 
   // QueueSizeCallback is called with no mutexes held.
@@ -368,8 +388,9 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
 }
 
 bool InputStreamManager::IsFull() const {
-  absl::MutexLock lock(&stream_mutex_);
-  return max_queue_size_ != -1 && queue_.size() >= max_queue_size_;
+  const int max_queue_size = max_queue_size_.load(std::memory_order_relaxed);
+  return max_queue_size != -1 &&
+         queue_size_.load(std::memory_order_relaxed) >= max_queue_size;
 }
 
 Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
@@ -377,7 +398,8 @@ Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
   if (queue_.empty()) {
     return Timestamp::Unset();
   }
-  return (queue_.cend() - std::min((size_t)n, queue_.size()))->Timestamp();
+  return queue_[queue_.size() - std::min((size_t)n, queue_.size())]
+      .Timestamp();
 }
 
 void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
@@ -391,6 +413,7 @@ void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
     while (!queue_.empty() && queue_.front().Timestamp() < timestamp) {
       queue_.pop_front();
     }
+    UpdateQueueSize();
 
     VLOG(3) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
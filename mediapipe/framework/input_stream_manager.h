@@ -15,13 +15,14 @@
 #ifndef MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 #define MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 
-#include <deque>
+#include <atomic>
 #include <functional>
 #include <list>
 #include <string>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/ring_buffer.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port.h"
@@ -43,6 +44,13 @@ namespace mediapipe {
 // An input stream is written to by exactly one output stream and is read by a
 // single node. None of its methods should hold a lock when they invoke a
 // callback in the scheduler.
+//
+// Packets are queued in a ring buffer, which is preallocated to the maximum
+// queue size when one is set, so a bounded stream does not allocate in the
+// steady state. The queue size and the maximum queue size are mirrored in
+// atomics, so that the size queries (IsEmpty(), QueueSize(), IsFull() and
+// MaxQueueSize()) polled by the scheduler and the input stream handlers do not
+// take stream_mutex_.
 class InputStreamManager {
  public:
   // Function type for becomes_full_callback and becomes_not_full_callback.
@@ -118,7 +126,7 @@ class InputStreamManager {
   void DisableTimestamps();
 
   // Returns true iff the queue is empty.
-  bool IsEmpty() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
+  bool IsEmpty() const;
 
   // If the queue is not empty, returns the packet at the front of the queue.
   // Otherwise, returns an empty packet.
@@ -146,13 +154,13 @@ class InputStreamManager {
   int NumPacketsAdded() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
   // Returns the number of packets in the queue.
-  int QueueSize() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
+  int QueueSize() const;
 
   // Returns true iff the queue is full.
-  bool IsFull() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
+  bool IsFull() const;
 
   // Returns the max queue size. -1 indicates that there is no maximum.
-  int MaxQueueSize() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
+  int MaxQueueSize() const;
 
   // Sets the maximum queue size for the stream. Used to determine when the
   // callbacks for becomes_full and becomes_not_full should be invoked. A value
@@ -195,8 +203,17 @@ class InputStreamManager {
   // Returns the smallest timestamp at which this stream might see an input.
   Timestamp MinTimestampOrBoundHelper() const;
 
+  // Publishes queue_.size() to queue_size_. Must be called after every change
+  // to queue_.
+  void UpdateQueueSize() ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_) {
+    queue_size_.store(static_cast<int>(queue_.size()),
+                      std::memory_order_relaxed);
+  }
+
   mutable absl::Mutex stream_mutex_;
-  std::deque<Packet> queue_ ABSL_GUARDED_BY(stream_mutex_);
+  RingBuffer<Packet> queue_ ABSL_GUARDED_BY(stream_mutex_);
+  // Mirrors queue_.size(), for reading without stream_mutex_.
+  std::atomic<int> queue_size_{0};
   // The number of packets added to queue_.  Used to verify a packet at
   // Timestamp::PostStream() is the only Packet in the stream.
   int64 num_packets_added_ ABSL_GUARDED_BY(stream_mutex_);
@@ -213,8 +230,9 @@ class InputStreamManager {
   // The header packet of the input stream.
   Packet header_;
 
-  // The maximum queue size for this stream if set.
-  int max_queue_size_ ABSL_GUARDED_BY(stream_mutex_) = -1;
+  // The maximum queue size for this stream if set. Only written while holding
+  // stream_mutex_.
+  std::atomic<int> max_queue_size_{-1};
 
   // Callback to notify the framework that we have hit the maximum queue size.
   QueueSizeCallback becomes_full_callback_;
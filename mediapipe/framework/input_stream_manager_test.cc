@@ -404,6 +404,27 @@ TEST_F(InputStreamManagerTest, BadPacketType) {
   EXPECT_FALSE(notify_);
 }
 
+TEST_F(InputStreamManagerTest, BadPacketAfterGoodPacketKeepsQueueSize) {
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
+  packets.push_back(MakePacket<int>(20).At(Timestamp(20)));
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+
+  absl::Status result = input_stream_manager_->AddPackets(packets, &notify_);
+  ASSERT_THAT(result.message(), testing::HasSubstr("Packet type mismatch"));
+  // The first packet was queued before the second one was rejected.
+  EXPECT_FALSE(input_stream_manager_->IsEmpty());
+  EXPECT_EQ(1, input_stream_manager_->QueueSize());
+
+  packets.clear();
+  packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(30)));
+  packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(20)));
+  result = input_stream_manager_->AddPackets(packets, &notify_);
+  ASSERT_THAT(result.message(),
+              testing::HasSubstr("Packet timestamp mismatch"));
+  EXPECT_EQ(2, input_stream_manager_->QueueSize());
+}
+
 TEST_F(InputStreamManagerTest, Close) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
@@ -783,6 +804,55 @@ TEST_F(InputStreamManagerTest, QueueSizeTest) {
   expected_queue_becomes_not_full_count_ = 1;
 }
 
+TEST_F(InputStreamManagerTest, QueueWrapsAroundAndGrowsPastMaxQueueSize) {
+  input_stream_manager_->SetMaxQueueSize(3);
+  int64_t next_added = 1;
+  int64_t next_popped = 1;
+  // Keeps the queue at 2 to 3 packets, so that it wraps around the
+  // preallocated buffer several times.
+  for (int round = 0; round < 10; ++round) {
+    std::list<Packet> packets;
+    while (packets.size() + input_stream_manager_->QueueSize() < 3) {
+      packets.push_back(MakePacket<std::string>("packet").At(
+          Timestamp(10 * next_added++)));
+    }
+    MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+    EXPECT_EQ(3, input_stream_manager_->QueueSize());
+    EXPECT_TRUE(input_stream_manager_->IsFull());
+    EXPECT_EQ(Timestamp(10 * (next_added - 2)),
+              input_stream_manager_->GetMinTimestampAmongNLatest(2));
+    popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+        Timestamp(10 * next_popped++), &num_packets_dropped_,
+        &stream_is_done_);
+    EXPECT_EQ(Timestamp(10 * (next_popped - 1)), popped_packet_.Timestamp());
+    EXPECT_EQ(0, num_packets_dropped_);
+    EXPECT_FALSE(input_stream_manager_->IsFull());
+  }
+
+  // Exceeding the maximum queue size is allowed; the queue grows.
+  std::list<Packet> packets;
+  for (int i = 0; i < 100; ++i) {
+    packets.push_back(
+        MakePacket<std::string>("packet").At(Timestamp(10 * next_added++)));
+  }
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  EXPECT_EQ(102, input_stream_manager_->QueueSize());
+  EXPECT_EQ(Timestamp(10 * next_popped), input_stream_manager_->QueueHead()
+                                             .Timestamp());
+  EXPECT_EQ(Timestamp(10 * (next_added - 1)),
+            input_stream_manager_->GetMinTimestampAmongNLatest(1));
+  while (next_popped < next_added) {
+    popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+        Timestamp(10 * next_popped), &num_packets_dropped_, &stream_is_done_);
+    ASSERT_EQ(Timestamp(10 * next_popped), popped_packet_.Timestamp());
+    ++next_popped;
+  }
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+
+  expected_queue_becomes_full_count_ = 11;
+  expected_queue_becomes_not_full_count_ = 11;
+}
+
 TEST_F(InputStreamManagerTest, InputReleaseTest) {
   packet_type_.Set<LifetimeTracker::Object>();
   input_stream_manager_ = absl::make_unique<InputStreamManager>();
@@ -15,7 +15,9 @@
 #ifndef MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
 #define MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
 
+#include <functional>
 #include <memory>
+#include <utility>
 
 #include "absl/log/absl_check.h"
 #include "mediapipe/framework/graph_output_stream.h"
@@ -62,6 +64,15 @@ class OutputStreamPoller {
     return poller->QueueSize();
   }
 
+  // Sets a callback that the graph runs whenever it adds packets to the queue
+  // or fails, so that one thread can wait for several pollers. The callback
+  // runs on a graph thread and must not block or call Next().
+  void SetNotifyCallback(std::function<void()> notify_callback) {
+    auto poller = internal_poller_impl_.lock();
+    ABSL_CHECK(poller) << "OutputStreamPollerImpl is already destroyed.";
+    poller->SetNotifyCallback(std::move(notify_callback));
+  }
+
  private:
   OutputStreamPoller(
       std::shared_ptr<internal::OutputStreamPollerImpl> internal_poller_impl)
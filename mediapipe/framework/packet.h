@@ -20,6 +20,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <new>
 #include <ostream>
 #include <string>
 #include <type_traits>
@@ -31,6 +32,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/freelist_allocator.h"
 #include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/deps/registration.h"
 #include "mediapipe/framework/port.h"
@@ -58,6 +60,8 @@ Packet Create(std::shared_ptr<HolderBase> holder, Timestamp timestamp);
 const HolderBase* GetHolder(const Packet& packet);
 const std::shared_ptr<HolderBase>& GetHolderShared(const Packet& packet);
 std::shared_ptr<HolderBase> GetHolderShared(Packet&& packet);
+template <typename T, typename... Args>
+std::shared_ptr<HolderBase> MakeHolder(Args&&... args);
 absl::StatusOr<Packet> PacketFromDynamicProto(const std::string& type_name,
                                               const std::string& serialized);
 }  // namespace packet_internal
@@ -328,12 +332,18 @@ Packet AdoptAsSyncedPacket(const T* ptr) {
 // provided arguments. Similar to MakeUnique. Especially convenient for arrays,
 // since it ensures the packet gets the right type (see below).
 //
+// Small payloads are stored in the same pooled allocation as the holder and
+// its reference count, so creating and destroying them does not touch the
+// heap in the steady state.
+//
 // Version for scalars.
 template <typename T,
           typename std::enable_if<!std::is_array<T>::value>::type* = nullptr,
           typename... Args>
 Packet MakePacket(Args&&... args) {  // NOLINT(build/c++11)
-  return Adopt(new T(std::forward<Args>(args)...));
+  return packet_internal::Create(
+      packet_internal::MakeHolder<T>(std::forward<Args>(args)...),
+      Timestamp::Unset());
 }
 
 // Version for arrays. We have to use reinterpret_cast because new T[N]
@@ -421,6 +431,9 @@ class HolderBase {
   GetVectorOfProtoMessageLite() const = 0;
 
   virtual bool HasForeignOwner() const { return false; }
+
+  // Returns true if the payload is stored inside the holder itself.
+  virtual bool HasInlinePayload() const { return false; }
 };
 
 // Two helper functions to get the proto base pointers.
@@ -523,6 +536,16 @@ class Holder : public HolderBase, private HolderPayloadRegistrator<T> {
       return InternalError(
           "Foreign holder can't release data ptr without ownership.");
     }
+    if (HasInlinePayload()) {
+      // The payload shares its allocation with the holder, so it is moved
+      // into a new object instead. The moved-from payload is destroyed with
+      // the holder.
+      if constexpr (std::is_move_constructible<T>::value) {
+        return std::make_unique<T>(std::move(*const_cast<T*>(ptr_)));
+      } else {
+        return InternalError("Inline payload can't be moved out.");
+      }
+    }
     // Casts away constness to make the data mutable after the release.
     std::unique_ptr<T> data_ptr(const_cast<T*>(ptr_));
     ptr_ = nullptr;
@@ -599,6 +622,49 @@ class ForeignHolder : public Holder<T> {
   bool HasForeignOwner() const final { return true; }
 };
 
+// Payloads up to this size may be stored inline in their holder.
+constexpr size_t kMaxInlinePayloadSize = 128;
+
+template <typename T>
+constexpr bool kUseInlineHolder =
+    !std::is_array<T>::value && std::is_move_constructible<T>::value &&
+    sizeof(T) <= kMaxInlinePayloadSize &&
+    alignof(T) <= alignof(std::max_align_t);
+
+// Like Holder, but constructs the data inside the holder object. MakeHolder
+// creates it with std::allocate_shared, so the data, the holder and the
+// reference count share a single FreelistAllocator block.
+template <typename T>
+class InlineHolder : public Holder<T> {
+ public:
+  template <typename... Args>
+  explicit InlineHolder(Args&&... args) : Holder<T>(nullptr) {
+    this->ptr_ = new (&storage_) T(std::forward<Args>(args)...);
+  }
+  ~InlineHolder() override {
+    // Destroys the data in place and nulls out ptr_ so it doesn't get deleted
+    // by ~Holder.
+    if (this->ptr_ != nullptr) this->ptr_->~T();
+    this->ptr_ = nullptr;
+  }
+  bool HasInlinePayload() const final { return true; }
+
+ private:
+  alignas(T) unsigned char storage_[sizeof(T)];
+};
+
+// Returns a holder owning a new T constructed from "args". Arrays are
+// handled by the MakePacket overload for arrays.
+template <typename T, typename... Args>
+std::shared_ptr<HolderBase> MakeHolder(Args&&... args) {
+  if constexpr (kUseInlineHolder<T>) {
+    return std::allocate_shared<InlineHolder<T>>(
+        FreelistAllocator<InlineHolder<T>>(), std::forward<Args>(args)...);
+  } else {
+    return std::make_shared<Holder<T>>(new T(std::forward<Args>(args)...));
+  }
+}
+
 template <typename T>
 Holder<T>* HolderBase::As() {
   if (PayloadIsOfType<T>()) {
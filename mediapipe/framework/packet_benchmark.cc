@@ -0,0 +1,108 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Measures packet create/copy/destroy throughput.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace {
+
+// Creates and destroys packets with an inline payload.
+static void BM_MakePacketInt(benchmark::State& state) {
+  int64_t i = 0;
+  for (auto _ : state) {
+    Packet packet = MakePacket<int>(i++).At(Timestamp(i));
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MakePacketInt);
+
+static void BM_MakePacketString(benchmark::State& state) {
+  for (auto _ : state) {
+    Packet packet = MakePacket<std::string>("short");
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MakePacketString);
+
+// Same as BM_MakePacketInt, with a payload too large to be stored inline.
+static void BM_MakePacketLargeStruct(benchmark::State& state) {
+  struct Large {
+    char bytes[1024];
+  };
+  for (auto _ : state) {
+    Packet packet = MakePacket<Large>();
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MakePacketLargeStruct);
+
+// Baseline: the pre-pooling representation, with separately allocated
+// payload, holder and reference count.
+static void BM_AdoptInt(benchmark::State& state) {
+  int64_t i = 0;
+  for (auto _ : state) {
+    Packet packet = Adopt(new int(i++)).At(Timestamp(i));
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AdoptInt);
+
+static void BM_CopyPacket(benchmark::State& state) {
+  Packet packet = MakePacket<int>(1);
+  for (auto _ : state) {
+    Packet copy = packet;
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CopyPacket);
+
+// Creates a batch of packets, copies each of them to a second queue (as an
+// output stream fanning out to a consumer does) and destroys both batches.
+// The batch size is given by the argument.
+static void BM_PacketQueueRoundTrip(benchmark::State& state) {
+  const int batch_size = state.range(0);
+  std::vector<Packet> produced;
+  std::vector<Packet> consumed;
+  produced.reserve(batch_size);
+  consumed.reserve(batch_size);
+  int64_t ts = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < batch_size; ++i) {
+      produced.push_back(MakePacket<float>(i).At(Timestamp(++ts)));
+    }
+    for (const Packet& packet : produced) {
+      consumed.push_back(packet);
+    }
+    produced.clear();
+    consumed.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_PacketQueueRoundTrip)->Arg(1)->Arg(64)->Arg(1024);
+
+}  // namespace
+}  // namespace mediapipe
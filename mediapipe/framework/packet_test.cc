@@ -380,6 +380,65 @@ TEST(PacketTest, TestConsumeForeignHolder) {
   EXPECT_EQ(33, packet.Get<int>());
 }
 
+// Counts live instances, to check that inline payloads are destroyed exactly
+// once.
+class LiveCounter {
+ public:
+  explicit LiveCounter(int* live) : live_(live) { ++*live_; }
+  LiveCounter(const LiveCounter& other) : live_(other.live_) { ++*live_; }
+  ~LiveCounter() { --*live_; }
+
+ private:
+  int* live_;
+};
+
+TEST(PacketTest, TestInlinePayloadLifetime) {
+  int live = 0;
+  {
+    Packet packet1 = MakePacket<LiveCounter>(&live);
+    Packet packet2 = packet1;
+    EXPECT_EQ(live, 1);
+    packet1 = Packet();
+    EXPECT_EQ(live, 1);
+  }
+  EXPECT_EQ(live, 0);
+
+  Packet packet = MakePacket<LiveCounter>(&live);
+  absl::StatusOr<std::unique_ptr<LiveCounter>> result =
+      packet.Consume<LiveCounter>();
+  MP_ASSERT_OK(result);
+  EXPECT_TRUE(packet.IsEmpty());
+  EXPECT_EQ(live, 1);
+  result->reset();
+  EXPECT_EQ(live, 0);
+}
+
+TEST(PacketTest, TestConsumeMoveOnlyInlinePayload) {
+  Packet packet = MakePacket<std::unique_ptr<int>>(new int(7));
+  absl::StatusOr<std::unique_ptr<std::unique_ptr<int>>> result =
+      packet.Consume<std::unique_ptr<int>>();
+  MP_ASSERT_OK(result);
+  ASSERT_NE(**result, nullptr);
+  EXPECT_EQ(***result, 7);
+  EXPECT_TRUE(packet.IsEmpty());
+}
+
+TEST(PacketTest, TestLargePayload) {
+  struct Large {
+    int values[1024];
+  };
+  Packet packet = MakePacket<Large>();
+  const_cast<Large&>(packet.Get<Large>()).values[1023] = 5;
+  Packet copy = packet;
+  EXPECT_EQ(copy.Get<Large>().values[1023], 5);
+  absl::StatusOr<std::unique_ptr<Large>> result = copy.Consume<Large>();
+  EXPECT_FALSE(result.ok());
+  packet = Packet();
+  result = copy.Consume<Large>();
+  MP_ASSERT_OK(result);
+  EXPECT_EQ((*result)->values[1023], 5);
+}
+
 TEST(PacketTest, TestForeignHolderConsumeOrCopy) {
   std::unique_ptr<int> data1(new int(42));
   Packet packet1 = PointToForeign(data1.get());
@@ -0,0 +1,159 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Returns "value" as a quoted JSON string.
+std::string JsonString(absl::string_view value) {
+  std::string result = "\"";
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppend(&result, "\\u00", absl::Hex(c, absl::kZeroPad2));
+        } else {
+          result += c;
+        }
+    }
+  }
+  result += "\"";
+  return result;
+}
+
+// Returns the flow id connecting the slice that sent a packet to the slice of
+// "consumer_node_id" that received it. The consumer tells apart the arrows of
+// a packet sent to several nodes.
+std::string FlowId(int stream_id, int64_t packet_timestamp,
+                   int consumer_node_id) {
+  return JsonString(
+      absl::StrCat(stream_id, ":", packet_timestamp, ":", consumer_node_id));
+}
+
+}  // namespace
+
+ChromeTraceWriter::ChromeTraceWriter(uint64_t process_id,
+                                     std::string process_name,
+                                     std::vector<std::string> node_names,
+                                     StreamConsumers stream_consumers)
+    : process_id_(process_id),
+      process_name_(std::move(process_name)),
+      node_names_(std::move(node_names)),
+      stream_consumers_(std::move(stream_consumers)) {}
+
+std::string ChromeTraceWriter::BeginFile() {
+  named_threads_.clear();
+  return absl::StrCat(
+      "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":", process_id_,
+      ",\"args\":{\"name\":", JsonString(process_name_), "}},\n");
+}
+
+void ChromeTraceWriter::MaybeAppendThreadName(int thread_id,
+                                              std::string* output) {
+  if (!named_threads_.insert(thread_id).second) return;
+  absl::StrAppend(output, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":",
+                  process_id_, ",\"tid\":", thread_id,
+                  ",\"args\":{\"name\":\"thread ", thread_id, "\"}},\n");
+}
+
+void ChromeTraceWriter::AppendEvents(const GraphTrace& trace,
+                                     std::string* output) {
+  auto stream_name = [&](int stream_id) -> absl::string_view {
+    return stream_id >= 0 && stream_id < trace.stream_name_size()
+               ? absl::string_view(trace.stream_name(stream_id))
+               : absl::string_view("unknown");
+  };
+  for (const GraphTrace::CalculatorTrace& event : trace.calculator_trace()) {
+    MaybeAppendThreadName(event.thread_id(), output);
+    const int node_id = event.node_id();
+    const std::string name =
+        node_id >= 0 && node_id < static_cast<int>(node_names_.size())
+            ? node_names_[node_id]
+            : absl::StrCat("node_", node_id);
+    const bool is_slice = event.has_start_time() && event.has_finish_time();
+    const int64_t time = trace.base_time() + (event.has_start_time()
+                                                  ? event.start_time()
+                                                  : event.finish_time());
+    const std::string track =
+        absl::StrCat(",\"pid\":", process_id_, ",\"tid\":", event.thread_id(),
+                     ",\"ts\":", time);
+
+    absl::StrAppend(output, "{\"name\":", JsonString(name), ",\"cat\":",
+                    JsonString(GraphTrace::EventType_Name(event.event_type())),
+                    track);
+    if (is_slice) {
+      absl::StrAppend(output, ",\"ph\":\"X\",\"dur\":",
+                      event.finish_time() - event.start_time());
+    } else {
+      absl::StrAppend(output, ",\"ph\":\"i\",\"s\":\"t\"");
+    }
+    if (event.has_input_timestamp()) {
+      absl::StrAppend(output, ",\"args\":{\"input_timestamp\":",
+                      trace.base_timestamp() + event.input_timestamp(), "}");
+    }
+    absl::StrAppend(output, "},\n");
+
+    // Flow events bind to the slice enclosing them on the same track.
+    if (!is_slice) continue;
+    for (const GraphTrace::StreamTrace& input : event.input_trace()) {
+      if (!input.has_start_time()) continue;  // The sender isn't traced.
+      const int64_t packet_timestamp =
+          trace.base_timestamp() + input.packet_timestamp();
+      absl::StrAppend(output, "{\"name\":",
+                      JsonString(stream_name(input.stream_id())),
+                      ",\"cat\":\"packet\",\"ph\":\"f\",\"bp\":\"e\",\"id\":",
+                      FlowId(input.stream_id(), packet_timestamp, node_id),
+                      track,
+                      ",\"args\":{\"packet_timestamp\":", packet_timestamp,
+                      "}},\n");
+    }
+    for (const GraphTrace::StreamTrace& output_trace : event.output_trace()) {
+      const absl::string_view name = stream_name(output_trace.stream_id());
+      auto consumers = stream_consumers_.find(name);
+      if (consumers == stream_consumers_.end()) continue;
+      const int64_t packet_timestamp =
+          trace.base_timestamp() + output_trace.packet_timestamp();
+      for (int consumer_node_id : consumers->second) {
+        absl::StrAppend(output, "{\"name\":", JsonString(name),
+                        ",\"cat\":\"packet\",\"ph\":\"s\",\"id\":",
+                        FlowId(output_trace.stream_id(), packet_timestamp,
+                               consumer_node_id),
+                        track, ",\"args\":{\"packet_timestamp\":",
+                        packet_timestamp, "}},\n");
+      }
+    }
+  }
+}
+
+}  // namespace mediapipe
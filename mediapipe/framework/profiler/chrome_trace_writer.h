@@ -0,0 +1,72 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+
+namespace mediapipe {
+
+// Converts GraphTraces to Chrome trace events, in the JSON array format that
+// chrome://tracing and the Perfetto UI open directly.
+//
+// Each calculator invocation becomes a slice on the track of the thread that
+// ran it, with its input timestamp as an argument. Each packet that is traced
+// from an output stream to an input stream becomes a flow arrow between the
+// two slices. A packet sent to several nodes gets one arrow per node.
+//
+// The JSON array is never closed, which the format allows, so that a trace
+// file can be extended by appending the events of each GraphTrace as it is
+// captured, without keeping earlier events in memory.
+class ChromeTraceWriter {
+ public:
+  // The ids of the nodes that read each stream, by stream name.
+  using StreamConsumers = absl::flat_hash_map<std::string, std::vector<int>>;
+
+  // "process_id" identifies the graph in the trace. "node_names" are the
+  // calculator node names, indexed by node id. Flow arrows start only from
+  // streams listed in "stream_consumers".
+  ChromeTraceWriter(uint64_t process_id, std::string process_name,
+                    std::vector<std::string> node_names,
+                    StreamConsumers stream_consumers);
+
+  // Returns the start of a new trace file.
+  std::string BeginFile();
+
+  // Appends the events of "trace" to "output".
+  void AppendEvents(const GraphTrace& trace, std::string* output);
+
+ private:
+  // Appends the metadata event naming the track of "thread_id", once per
+  // file.
+  void MaybeAppendThreadName(int thread_id, std::string* output);
+
+  const uint64_t process_id_;
+  const std::string process_name_;
+  const std::vector<std::string> node_names_;
+  const StreamConsumers stream_consumers_;
+  // Threads named in the current file.
+  absl::flat_hash_set<int> named_threads_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
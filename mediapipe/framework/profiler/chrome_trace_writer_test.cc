@@ -0,0 +1,150 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <string>
+
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::StartsWith;
+
+// A packet sent by "source" on thread 1 and processed by "sink" on thread 2.
+GraphTrace TwoNodeTrace() {
+  return ParseTextProtoOrDie<GraphTrace>(R"pb(
+    base_time: 1000000
+    base_timestamp: 5000
+    stream_name: ""
+    stream_name: "frames"
+    calculator_trace {
+      node_id: 0
+      input_timestamp: 0
+      event_type: PROCESS
+      start_time: 10
+      finish_time: 30
+      thread_id: 1
+      output_trace { packet_timestamp: 0 stream_id: 1 }
+    }
+    calculator_trace {
+      node_id: 1
+      input_timestamp: 0
+      event_type: PROCESS
+      start_time: 40
+      finish_time: 45
+      thread_id: 2
+      input_trace {
+        start_time: 30
+        finish_time: 40
+        packet_timestamp: 0
+        stream_id: 1
+      }
+    }
+  )pb");
+}
+
+TEST(ChromeTraceWriterTest, WritesSlicesAndFlows) {
+  ChromeTraceWriter writer(7, "my_graph", {"source", "sink"},
+                           {{"frames", {1}}});
+  std::string json = writer.BeginFile();
+  writer.AppendEvents(TwoNodeTrace(), &json);
+
+  EXPECT_THAT(json, StartsWith("[\n"));
+  EXPECT_THAT(json, HasSubstr(R"("name":"process_name","ph":"M","pid":7,)"
+                              R"("args":{"name":"my_graph"})"));
+  EXPECT_THAT(json, HasSubstr(R"("name":"thread_name","ph":"M","pid":7,)"
+                              R"("tid":2,"args":{"name":"thread 2"})"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"source","cat":"PROCESS","pid":7,)"
+                              R"("tid":1,"ts":1000010,"ph":"X","dur":20,)"
+                              R"("args":{"input_timestamp":5000}})"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"sink","cat":"PROCESS","pid":7,)"
+                              R"("tid":2,"ts":1000040,"ph":"X","dur":5,)"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"frames","cat":"packet","ph":"s",)"
+                              R"("id":"1:5000:1","pid":7,"tid":1,)"
+                              R"("ts":1000010,)"));
+  EXPECT_THAT(json,
+              HasSubstr(R"({"name":"frames","cat":"packet","ph":"f",)"
+                        R"("bp":"e","id":"1:5000:1","pid":7,"tid":2,)"
+                        R"("ts":1000040,"args":{"packet_timestamp":5000}})"));
+}
+
+TEST(ChromeTraceWriterTest, WritesFlowPerConsumer) {
+  ChromeTraceWriter writer(1, "graph", {"source", "sink", "other_sink"},
+                           {{"frames", {1, 2}}});
+  GraphTrace trace = TwoNodeTrace();
+  GraphTrace::CalculatorTrace* other_sink = trace.add_calculator_trace();
+  *other_sink = trace.calculator_trace(1);
+  other_sink->set_node_id(2);
+  other_sink->set_thread_id(3);
+  std::string json;
+  writer.AppendEvents(trace, &json);
+
+  // The packet sent to both sinks starts two flows, each ending at one sink.
+  EXPECT_THAT(json, HasSubstr(R"("ph":"s","id":"1:5000:1","pid":1,"tid":1,)"));
+  EXPECT_THAT(json, HasSubstr(R"("ph":"s","id":"1:5000:2","pid":1,"tid":1,)"));
+  EXPECT_THAT(json, HasSubstr(R"("ph":"f","bp":"e","id":"1:5000:1","pid":1,)"
+                              R"("tid":2,)"));
+  EXPECT_THAT(json, HasSubstr(R"("ph":"f","bp":"e","id":"1:5000:2","pid":1,)"
+                              R"("tid":3,)"));
+}
+
+TEST(ChromeTraceWriterTest, SkipsFlowsOfStreamsWithoutConsumers) {
+  ChromeTraceWriter writer(1, "graph", {"source", "sink"}, {});
+  GraphTrace trace = TwoNodeTrace();
+  trace.mutable_calculator_trace()->RemoveLast();
+  std::string json;
+  writer.AppendEvents(trace, &json);
+  EXPECT_THAT(json, HasSubstr(R"("name":"source")"));
+  EXPECT_THAT(json, Not(HasSubstr(R"("cat":"packet")")));
+}
+
+TEST(ChromeTraceWriterTest, NamesThreadsOncePerFile) {
+  ChromeTraceWriter writer(1, "graph", {"source", "sink"},
+                           {{"frames", {1}}});
+  std::string json = writer.BeginFile();
+  writer.AppendEvents(TwoNodeTrace(), &json);
+  std::string appended;
+  writer.AppendEvents(TwoNodeTrace(), &appended);
+  EXPECT_THAT(appended, Not(HasSubstr("thread_name")));
+  EXPECT_THAT(appended, HasSubstr(R"("name":"source")"));
+
+  std::string next_file = writer.BeginFile();
+  writer.AppendEvents(TwoNodeTrace(), &next_file);
+  EXPECT_THAT(next_file, HasSubstr("thread_name"));
+}
+
+TEST(ChromeTraceWriterTest, WritesInstantEvents) {
+  ChromeTraceWriter writer(1, "graph", {"node\"1"}, {});
+  GraphTrace trace = ParseTextProtoOrDie<GraphTrace>(R"pb(
+    base_time: 100
+    calculator_trace { node_id: 0 event_type: OPEN start_time: 5 thread_id: 3 }
+    calculator_trace { node_id: 4 event_type: CLOSE finish_time: 9 }
+  )pb");
+  std::string json;
+  writer.AppendEvents(trace, &json);
+  EXPECT_THAT(json, HasSubstr(R"({"name":"node\"1","cat":"OPEN","pid":1,)"
+                              R"("tid":3,"ts":105,"ph":"i","s":"t"},)"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"node_4","cat":"CLOSE","pid":1,)"
+                              R"("tid":0,"ts":109,"ph":"i","s":"t"},)"));
+}
+
+}  // namespace
+}  // namespace mediapipe
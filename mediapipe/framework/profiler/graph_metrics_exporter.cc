@@ -0,0 +1,307 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/graph_metrics_exporter.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include "absl/container/btree_map.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/counter_factory.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Appends "value" as a quoted label value.
+void AppendLabelValue(absl::string_view value, std::string* output) {
+  output->push_back('"');
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        output->append("\\\\");
+        break;
+      case '"':
+        output->append("\\\"");
+        break;
+      case '\n':
+        output->append("\\n");
+        break;
+      default:
+        output->push_back(c);
+    }
+  }
+  output->push_back('"');
+}
+
+// Builds the metrics of one graph in the Prometheus text format.
+class MetricsBuilder {
+ public:
+  explicit MetricsBuilder(absl::string_view graph_name)
+      : graph_name_(graph_name) {}
+
+  // Starts the samples of the metric "name".
+  void Family(absl::string_view name, absl::string_view type,
+              absl::string_view help) {
+    absl::StrAppend(&output_, "# HELP ", name, " ", help, "\n# TYPE ", name,
+                    " ", type, "\n");
+  }
+
+  // Appends a sample of the metric "name", labeled by the graph and by
+  // "labels".
+  void Sample(
+      absl::string_view name,
+      std::initializer_list<std::pair<absl::string_view, absl::string_view>>
+          labels,
+      int64_t value) {
+    absl::StrAppend(&output_, name, "{graph=");
+    AppendLabelValue(graph_name_, &output_);
+    for (const auto& [label, label_value] : labels) {
+      absl::StrAppend(&output_, ",", label, "=");
+      AppendLabelValue(label_value, &output_);
+    }
+    absl::StrAppend(&output_, "} ", value, "\n");
+  }
+
+  // Appends the percentiles of "histogram" as samples of "name".
+  void Percentiles(absl::string_view name, absl::string_view calculator,
+                   const TimeHistogram& histogram) {
+    if (!histogram.has_log_linear()) return;
+    const LogLinearHistogram& log_linear = histogram.log_linear();
+    const std::pair<absl::string_view, int64_t> quantiles[] = {
+        {"0.5", log_linear.p50_usec()},
+        {"0.9", log_linear.p90_usec()},
+        {"0.99", log_linear.p99_usec()},
+        {"0.999", log_linear.p999_usec()}};
+    for (const auto& [quantile, value] : quantiles) {
+      Sample(name, {{"calculator", calculator}, {"quantile", quantile}},
+             value);
+    }
+  }
+
+  std::string Finish() { return std::move(output_); }
+
+ private:
+  const absl::string_view graph_name_;
+  std::string output_;
+};
+
+}  // namespace
+
+GraphMetricsExporter::GraphMetricsExporter(CalculatorGraph* graph,
+                                           std::string graph_name)
+    : graph_(graph), graph_name_(std::move(graph_name)) {}
+
+GraphMetricsExporter::~GraphMetricsExporter() { StopServer(); }
+
+std::string GraphMetricsExporter::Snapshot() {
+  MetricsBuilder metrics(graph_name_);
+
+  const std::vector<CalculatorGraph::InputStreamQueueState> streams =
+      graph_->GetInputStreamQueueStates();
+  metrics.Family("mediapipe_input_stream_queue_size", "gauge",
+                 "Packets queued in a calculator input stream.");
+  for (const auto& stream : streams) {
+    metrics.Sample("mediapipe_input_stream_queue_size",
+                   {{"calculator", stream.node_name},
+                    {"stream", stream.stream_name}},
+                   stream.queue_size);
+  }
+  metrics.Family("mediapipe_input_stream_max_queue_size", "gauge",
+                 "Limit of a calculator input stream queue, if any.");
+  for (const auto& stream : streams) {
+    if (stream.max_queue_size < 0) continue;
+    metrics.Sample("mediapipe_input_stream_max_queue_size",
+                   {{"calculator", stream.node_name},
+                    {"stream", stream.stream_name}},
+                   stream.max_queue_size);
+  }
+  metrics.Family("mediapipe_input_stream_packets_total", "counter",
+                 "Packets added to a calculator input stream in this run.");
+  absl::btree_map<absl::string_view, int64_t> calculator_packets;
+  for (const auto& stream : streams) {
+    metrics.Sample("mediapipe_input_stream_packets_total",
+                   {{"calculator", stream.node_name},
+                    {"stream", stream.stream_name}},
+                   stream.num_packets_added);
+    calculator_packets[stream.node_name] += stream.num_packets_added;
+  }
+  metrics.Family("mediapipe_calculator_input_packets_total", "counter",
+                 "Packets added to the input streams of a calculator in this "
+                 "run.");
+  for (const auto& [calculator, packets] : calculator_packets) {
+    metrics.Sample("mediapipe_calculator_input_packets_total",
+                   {{"calculator", calculator}}, packets);
+  }
+
+  metrics.Family("mediapipe_source_throttled", "gauge",
+                 "1 if a source calculator or graph input stream waits for a "
+                 "full input stream.");
+  for (const auto& source : graph_->GetSourceThrottleStates()) {
+    metrics.Sample(
+        "mediapipe_source_throttled",
+        {{"source", source.name},
+         {"kind", source.is_graph_input_stream ? "graph_input_stream"
+                                               : "calculator"}},
+        source.throttled ? 1 : 0);
+  }
+
+  metrics.Family("mediapipe_counter", "untyped",
+                 "A counter of the graph's CounterFactory.");
+  for (const auto& [name, value] :
+       graph_->GetCounterFactory()->GetCounterSet()->GetCountersValues()) {
+    metrics.Sample("mediapipe_counter", {{"name", name}}, value);
+  }
+
+  std::vector<CalculatorProfile> profiles;
+  if (graph_->profiler() != nullptr &&
+      graph_->profiler()->GetCalculatorProfiles(&profiles).ok()) {
+    metrics.Family("mediapipe_calculator_process_runtime_usec", "gauge",
+                   "Percentiles of the Process() runtime of a calculator "
+                   "since the last profile was captured.");
+    for (const CalculatorProfile& profile : profiles) {
+      metrics.Percentiles("mediapipe_calculator_process_runtime_usec",
+                          profile.name(), profile.process_runtime());
+    }
+    metrics.Family("mediapipe_calculator_input_latency_usec", "gauge",
+                   "Percentiles of the latency from the source to the "
+                   "Process() call of a calculator since the last profile "
+                   "was captured.");
+    for (const CalculatorProfile& profile : profiles) {
+      metrics.Percentiles("mediapipe_calculator_input_latency_usec",
+                          profile.name(), profile.process_input_latency());
+    }
+  }
+  return metrics.Finish();
+}
+
+absl::Status GraphMetricsExporter::WriteSnapshot(const std::string& path) {
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  MP_RETURN_IF_ERROR(file::SetContents(temp_path, Snapshot()));
+  RET_CHECK_EQ(std::rename(temp_path.c_str(), path.c_str()), 0)
+      << "Failed to replace " << path << ": " << std::strerror(errno);
+  return absl::OkStatus();
+}
+
+#ifndef _WIN32
+
+absl::StatusOr<int> GraphMetricsExporter::StartServer(int port) {
+  RET_CHECK_LT(server_fd_, 0) << "The metrics server is already running.";
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  RET_CHECK_GE(fd, 0) << "socket() failed: " << std::strerror(errno);
+  const int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  socklen_t address_size = sizeof(address);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), address_size) != 0 ||
+      listen(fd, /*backlog=*/8) != 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_size) !=
+          0) {
+    const int error = errno;
+    close(fd);
+    return absl::UnavailableError(absl::StrCat(
+        "Failed to listen on port ", port, ": ", std::strerror(error)));
+  }
+  server_fd_ = fd;
+  stop_server_ = false;
+  server_thread_ = std::thread([this] { Serve(); });
+  return ntohs(address.sin_port);
+}
+
+void GraphMetricsExporter::StopServer() {
+  if (server_fd_ < 0) return;
+  stop_server_ = true;
+  server_thread_.join();
+  close(server_fd_);
+  server_fd_ = -1;
+}
+
+void GraphMetricsExporter::Serve() {
+  // Polling with a timeout bounds the time StopServer() waits.
+  constexpr int kPollTimeoutMs = 100;
+  while (!stop_server_) {
+    pollfd server = {server_fd_, POLLIN, 0};
+    if (poll(&server, 1, kPollTimeoutMs) <= 0) continue;
+    const int client = accept(server_fd_, nullptr, nullptr);
+    if (client < 0) continue;
+    // Every request is answered with the metrics, so it is read only to let
+    // the client finish sending it.
+    pollfd request = {client, POLLIN, 0};
+    if (poll(&request, 1, kPollTimeoutMs) > 0) {
+      char buffer[1024];
+      recv(client, buffer, sizeof(buffer), 0);
+    }
+    const std::string body = Snapshot();
+    const std::string response = absl::StrCat(
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: ",
+        body.size(), "\r\n\r\n", body);
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags = MSG_NOSIGNAL;
+#endif  // MSG_NOSIGNAL
+    for (size_t sent = 0; sent < response.size();) {
+      const ssize_t n =
+          send(client, response.data() + sent, response.size() - sent, flags);
+      if (n <= 0) {
+        ABSL_LOG_FIRST_N(WARNING, 1)
+            << "Failed to send metrics: " << std::strerror(errno);
+        break;
+      }
+      sent += n;
+    }
+    close(client);
+  }
+}
+
+#else  // _WIN32
+
+absl::StatusOr<int> GraphMetricsExporter::StartServer(int port) {
+  return absl::UnimplementedError(
+      "The metrics server is not supported on Windows, use WriteSnapshot().");
+}
+
+void GraphMetricsExporter::StopServer() {}
+
+void GraphMetricsExporter::Serve() {}
+
+#endif  // _WIN32
+
+}  // namespace mediapipe
@@ -0,0 +1,83 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_METRICS_EXPORTER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_METRICS_EXPORTER_H_
+
+#include <atomic>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/calculator_framework.h"
+
+namespace mediapipe {
+
+// Exports the live state of a CalculatorGraph as metrics in the Prometheus
+// text exposition format, for a monitoring system to pull while the graph
+// runs.
+//
+// A snapshot includes, labeled by calculator and stream:
+// - the size and limit of each input stream queue,
+// - the packets added to each input stream, and per calculator, from which
+//   the monitoring system derives throughput,
+// - whether each source node and graph input stream is throttled,
+// - the values of the counters of the graph's CounterFactory,
+// - the Process() runtime and input latency percentiles, if the profiler
+//   records log-linear histograms (see ProfilerConfig).
+//
+// Taking a snapshot costs the same however many packets the graph processes.
+// It doesn't wait for the graph, but it briefly takes the mutex of each input
+// stream, to read its packet count, and the graph's throttling mutex, so
+// snapshots should be taken at a monitoring interval rather than per packet.
+class GraphMetricsExporter {
+ public:
+  // "graph" must be initialized, and must outlive the exporter. "graph_name"
+  // is the value of the "graph" label of all metrics.
+  GraphMetricsExporter(CalculatorGraph* graph, std::string graph_name);
+  ~GraphMetricsExporter();
+  GraphMetricsExporter(const GraphMetricsExporter&) = delete;
+  GraphMetricsExporter& operator=(const GraphMetricsExporter&) = delete;
+
+  // Returns the current metrics.
+  std::string Snapshot();
+
+  // Writes the current metrics to "path", replacing the file atomically, as
+  // expected by e.g. the textfile collector of the Prometheus node exporter.
+  absl::Status WriteSnapshot(const std::string& path);
+
+  // Serves the current metrics over HTTP on 127.0.0.1:"port" from a
+  // background thread, until StopServer() or destruction. If "port" is 0, a
+  // free port is chosen. Returns the port. Not supported on Windows.
+  absl::StatusOr<int> StartServer(int port);
+
+  // Stops the server, if it is running.
+  void StopServer();
+
+ private:
+  // Answers requests until "stop_server_" is set.
+  void Serve();
+
+  CalculatorGraph* const graph_;
+  const std::string graph_name_;
+
+  int server_fd_ = -1;
+  std::atomic<bool> stop_server_ = false;
+  std::thread server_thread_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_METRICS_EXPORTER_H_
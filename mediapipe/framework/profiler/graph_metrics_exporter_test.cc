@@ -0,0 +1,223 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/graph_metrics_exporter.h"
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+
+class GraphMetricsExporterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    MP_ASSERT_OK(graph_.Initialize(
+        ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+          input_stream: "input"
+          max_queue_size: 4
+          profiler_config {
+            enable_profiler: true
+            enable_log_linear_histograms: true
+          }
+          node {
+            calculator: "PassThroughCalculator"
+            name: "pass"
+            input_stream: "input"
+            output_stream: "output"
+          }
+        )pb")));
+  }
+
+  // Sends "count" packets through the graph.
+  void RunGraph(int count) {
+    MP_ASSERT_OK(graph_.StartRun({}));
+    for (int i = 0; i < count; ++i) {
+      MP_ASSERT_OK(graph_.AddPacketToInputStream(
+          "input", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    MP_ASSERT_OK(graph_.CloseAllInputStreams());
+    MP_ASSERT_OK(graph_.WaitUntilDone());
+  }
+
+  CalculatorGraph graph_;
+};
+
+TEST_F(GraphMetricsExporterTest, ExportsQueuesAndCounters) {
+  graph_.GetCounterFactory()->GetCounter("pass-frames")->IncrementBy(3);
+  RunGraph(5);
+
+  GraphMetricsExporter exporter(&graph_, "my_graph");
+  const std::string metrics = exporter.Snapshot();
+  EXPECT_THAT(metrics,
+              HasSubstr("# TYPE mediapipe_input_stream_queue_size gauge\n"
+                        "mediapipe_input_stream_queue_size{graph=\"my_graph\","
+                        "calculator=\"pass\",stream=\"input\"} 0\n"));
+  EXPECT_THAT(metrics, HasSubstr("mediapipe_input_stream_max_queue_size{"
+                                 "graph=\"my_graph\",calculator=\"pass\","
+                                 "stream=\"input\"} 4\n"));
+  EXPECT_THAT(metrics, HasSubstr("mediapipe_input_stream_packets_total{"
+                                 "graph=\"my_graph\",calculator=\"pass\","
+                                 "stream=\"input\"} 5\n"));
+  EXPECT_THAT(metrics,
+              HasSubstr("mediapipe_calculator_input_packets_total{"
+                        "graph=\"my_graph\",calculator=\"pass\"} 5\n"));
+  EXPECT_THAT(metrics, HasSubstr("mediapipe_source_throttled{"
+                                 "graph=\"my_graph\",source=\"input\","
+                                 "kind=\"graph_input_stream\"} 0\n"));
+  EXPECT_THAT(metrics, HasSubstr("mediapipe_counter{graph=\"my_graph\","
+                                 "name=\"pass-frames\"} 3\n"));
+  EXPECT_THAT(metrics, HasSubstr("mediapipe_calculator_process_runtime_usec{"
+                                 "graph=\"my_graph\",calculator=\"pass\","
+                                 "quantile=\"0.99\"} "));
+}
+
+TEST_F(GraphMetricsExporterTest, EscapesLabelValues) {
+  GraphMetricsExporter exporter(&graph_, "a \"quoted\"\\name");
+  EXPECT_THAT(exporter.Snapshot(),
+              HasSubstr("{graph=\"a \\\"quoted\\\"\\\\name\","));
+}
+
+TEST_F(GraphMetricsExporterTest, WritesSnapshot) {
+  RunGraph(2);
+  GraphMetricsExporter exporter(&graph_, "my_graph");
+  const std::string path = absl::StrCat(::testing::TempDir(), "/metrics.prom");
+  MP_ASSERT_OK(exporter.WriteSnapshot(path));
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(path, &contents));
+  EXPECT_THAT(contents, HasSubstr("mediapipe_input_stream_packets_total{"
+                                  "graph=\"my_graph\",calculator=\"pass\","
+                                  "stream=\"input\"} 2\n"));
+}
+
+// Notifies "STARTED" and then blocks in Process() until "RELEASE" is
+// notified.
+class BlockingCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->InputSidePackets().Tag("STARTED").Set<absl::Notification*>();
+    cc->InputSidePackets().Tag("RELEASE").Set<absl::Notification*>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    absl::Notification* started =
+        cc->InputSidePackets().Tag("STARTED").Get<absl::Notification*>();
+    if (!started->HasBeenNotified()) {
+      started->Notify();
+    }
+    cc->InputSidePackets()
+        .Tag("RELEASE")
+        .Get<absl::Notification*>()
+        ->WaitForNotification();
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(BlockingCalculator);
+
+TEST(GraphMetricsExporterThrottlingTest, ExportsThrottledInputStream) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        max_queue_size: 2
+        node {
+          calculator: "BlockingCalculator"
+          name: "blocking"
+          input_stream: "input"
+          input_side_packet: "STARTED:started"
+          input_side_packet: "RELEASE:release"
+        }
+      )pb")));
+  absl::Notification started;
+  absl::Notification release;
+  MP_ASSERT_OK(
+      graph.StartRun({{"started", MakePacket<absl::Notification*>(&started)},
+                      {"release", MakePacket<absl::Notification*>(&release)}}));
+  // While the calculator is blocked on the first packet, the next two fill
+  // the queue of "input" and throttle the graph input stream.
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", MakePacket<int>(0).At(Timestamp(0))));
+  started.WaitForNotification();
+  for (int i = 1; i <= 2; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i).At(Timestamp(i))));
+  }
+
+  GraphMetricsExporter exporter(&graph, "my_graph");
+  const std::string metrics = exporter.Snapshot();
+  EXPECT_THAT(metrics, HasSubstr("mediapipe_input_stream_queue_size{"
+                                 "graph=\"my_graph\",calculator=\"blocking\","
+                                 "stream=\"input\"} 2\n"));
+  EXPECT_THAT(metrics, HasSubstr("mediapipe_source_throttled{"
+                                 "graph=\"my_graph\",source=\"input\","
+                                 "kind=\"graph_input_stream\"} 1\n"));
+
+  release.Notify();
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+#ifndef _WIN32
+TEST_F(GraphMetricsExporterTest, ServesSnapshots) {
+  RunGraph(1);
+  GraphMetricsExporter exporter(&graph_, "my_graph");
+  MP_ASSERT_OK_AND_ASSIGN(int port, exporter.StartServer(0));
+
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_GE(fd, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)),
+            0);
+  const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+  ASSERT_EQ(send(fd, request.data(), request.size(), 0), request.size());
+  std::string response;
+  char buffer[4096];
+  for (ssize_t n; (n = recv(fd, buffer, sizeof(buffer), 0)) > 0;) {
+    response.append(buffer, n);
+  }
+  close(fd);
+  exporter.StopServer();
+
+  EXPECT_THAT(response, HasSubstr("HTTP/1.0 200 OK\r\n"));
+  EXPECT_THAT(response, HasSubstr("mediapipe_input_stream_packets_total{"
+                                  "graph=\"my_graph\",calculator=\"pass\","
+                                  "stream=\"input\"} 1\n"));
+}
+#endif  // _WIN32
+
+}  // namespace
+}  // namespace mediapipe
@@ -189,6 +189,10 @@ void GraphProfiler::Initialize(
       InitializeInputStreams(node_config, interval_size_usec, num_intervals,
                              &profile);
     }
+    if (profiler_config_.enable_log_linear_histograms()) {
+      log_linear_histograms_[node_name] = std::make_unique<LogLinearHistograms>(
+          profile.input_stream_profiles_size());
+    }
 
     auto iter = calculator_profiles_.insert({node_name, profile});
     ABSL_CHECK(iter.second) << absl::Substitute(
@@ -237,6 +241,15 @@ void GraphProfiler::Reset() {
       ResetTimeHistogram(input_stream_profile.mutable_latency());
     }
   }
+  for (auto& entry : log_linear_histograms_) {
+    LogLinearHistograms& histograms = *entry.second;
+    histograms.process_runtime.Reset();
+    histograms.process_input_latency.Reset();
+    histograms.process_output_latency.Reset();
+    for (auto& input_stream_latency : histograms.input_stream_latency) {
+      input_stream_latency.Reset();
+    }
+  }
 }
 
 // Begins profiling for a single graph run.
@@ -338,6 +351,26 @@ absl::Status GraphProfiler::GetCalculatorProfiles(
       << "GetCalculatorProfiles can only be called after Initialize()";
   for (auto& entry : calculator_profiles_) {
     profiles->push_back(entry.second);
+    auto histograms_iter = log_linear_histograms_.find(entry.first);
+    if (histograms_iter == log_linear_histograms_.end()) {
+      continue;
+    }
+    const LogLinearHistograms& histograms = *histograms_iter->second;
+    CalculatorProfile& profile = profiles->back();
+    histograms.process_runtime.Get(
+        profile.mutable_process_runtime()->mutable_log_linear());
+    if (profiler_config_.enable_stream_latency()) {
+      histograms.process_input_latency.Get(
+          profile.mutable_process_input_latency()->mutable_log_linear());
+      histograms.process_output_latency.Get(
+          profile.mutable_process_output_latency()->mutable_log_linear());
+      for (int i = 0; i < profile.input_stream_profiles_size(); ++i) {
+        histograms.input_stream_latency[i].Get(
+            profile.mutable_input_stream_profiles(i)
+                ->mutable_latency()
+                ->mutable_log_linear());
+      }
+    }
   }
   return absl::OkStatus();
 }
@@ -425,10 +458,12 @@ void GraphProfiler::AddPacketInfoForOutputPackets(
 
 int64 GraphProfiler::AddStreamLatencies(
     const CalculatorContext& calculator_context, int64 start_time_usec,
-    int64 end_time_usec, CalculatorProfile* calculator_profile) {
+    int64 end_time_usec, CalculatorProfile* calculator_profile,
+    LogLinearSamples* log_linear_samples) {
   // Update input streams profiles.
-  int64 min_source_process_start_usec = AddInputStreamTimeSamples(
-      calculator_context, start_time_usec, calculator_profile);
+  int64 min_source_process_start_usec =
+      AddInputStreamTimeSamples(calculator_context, start_time_usec,
+                                calculator_profile, log_linear_samples);
 
   // Update output production times.
   AddPacketInfoForOutputPackets(calculator_context.Outputs(), end_time_usec,
@@ -438,50 +473,69 @@ int64 GraphProfiler::AddStreamLatencies(
 
 void GraphProfiler::SetOpenRuntime(const CalculatorContext& calculator_context,
                                    int64 start_time_usec, int64 end_time_usec) {
-  absl::ReaderMutexLock lock(&profiler_mutex_);
-  if (!is_profiling_) {
-    return;
-  }
+  LogLinearSamples log_linear_samples;
+  {
+    absl::ReaderMutexLock lock(&profiler_mutex_);
+    if (!is_profiling_) {
+      return;
+    }
 
-  const std::string& node_name = calculator_context.NodeName();
-  int64 time_usec = end_time_usec - start_time_usec;
-  auto profile_iter = calculator_profiles_.find(node_name);
-  ABSL_CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
-      "Calculator \"$0\" has not been added during initialization.",
-      calculator_context.NodeName());
-  CalculatorProfile* calculator_profile = &profile_iter->second;
-  calculator_profile->set_open_runtime(time_usec);
+    const std::string& node_name = calculator_context.NodeName();
+    int64 time_usec = end_time_usec - start_time_usec;
+    auto profile_iter = calculator_profiles_.find(node_name);
+    ABSL_CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
+        "Calculator \"$0\" has not been added during initialization.",
+        calculator_context.NodeName());
+    CalculatorProfile* calculator_profile = &profile_iter->second;
+    calculator_profile->set_open_runtime(time_usec);
 
-  if (profiler_config_.enable_stream_latency()) {
-    AddStreamLatencies(calculator_context, start_time_usec, end_time_usec,
-                       calculator_profile);
+    if (profiler_config_.enable_stream_latency()) {
+      AddStreamLatencies(calculator_context, start_time_usec, end_time_usec,
+                         calculator_profile, &log_linear_samples);
+    }
   }
+  RecordLogLinearSamples(log_linear_samples);
 }
 
 void GraphProfiler::SetCloseRuntime(const CalculatorContext& calculator_context,
                                     int64 start_time_usec,
                                     int64 end_time_usec) {
-  absl::ReaderMutexLock lock(&profiler_mutex_);
-  if (!is_profiling_) {
-    return;
+  LogLinearSamples log_linear_samples;
+  {
+    absl::ReaderMutexLock lock(&profiler_mutex_);
+    if (!is_profiling_) {
+      return;
+    }
+    const std::string& node_name = calculator_context.NodeName();
+    int64 time_usec = end_time_usec - start_time_usec;
+    auto profile_iter = calculator_profiles_.find(node_name);
+    ABSL_CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
+        "Calculator \"$0\" has not been added during initialization.",
+        calculator_context.NodeName());
+    CalculatorProfile* calculator_profile = &profile_iter->second;
+    calculator_profile->set_close_runtime(time_usec);
+
+    if (profiler_config_.enable_stream_latency()) {
+      AddStreamLatencies(calculator_context, start_time_usec, end_time_usec,
+                         calculator_profile, &log_linear_samples);
+    }
   }
-  const std::string& node_name = calculator_context.NodeName();
-  int64 time_usec = end_time_usec - start_time_usec;
-  auto profile_iter = calculator_profiles_.find(node_name);
-  ABSL_CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
-      "Calculator \"$0\" has not been added during initialization.",
-      calculator_context.NodeName());
-  CalculatorProfile* calculator_profile = &profile_iter->second;
-  calculator_profile->set_close_runtime(time_usec);
+  RecordLogLinearSamples(log_linear_samples);
+}
 
-  if (profiler_config_.enable_stream_latency()) {
-    AddStreamLatencies(calculator_context, start_time_usec, end_time_usec,
-                       calculator_profile);
+GraphProfiler::LogLinearHistograms* GraphProfiler::FindLogLinearHistograms(
+    const std::string& node_name) {
+  if (log_linear_histograms_.empty()) {
+    return nullptr;
   }
+  auto iter = log_linear_histograms_.find(node_name);
+  return iter == log_linear_histograms_.end() ? nullptr : iter->second.get();
 }
 
 void GraphProfiler::AddTimeSample(int64 start_time_usec, int64 end_time_usec,
-                                  TimeHistogram* histogram) {
+                                  TimeHistogram* histogram,
+                                  LogLinearHistogramRecorder* log_linear,
+                                  LogLinearSamples* log_linear_samples) {
   if (end_time_usec < start_time_usec) {
     ABSL_LOG(ERROR) << absl::Substitute(
         "end_time_usec ($0) is < start_time_usec ($1)", end_time_usec,
@@ -496,14 +550,26 @@ void GraphProfiler::AddTimeSample(int64 start_time_usec, int64 end_time_usec,
     interval_index = histogram->num_intervals() - 1;
   }
   histogram->set_count(interval_index, histogram->count(interval_index) + 1);
+  if (log_linear != nullptr) {
+    log_linear_samples->push_back({log_linear, time_usec});
+  }
+}
+
+void GraphProfiler::RecordLogLinearSamples(const LogLinearSamples& samples) {
+  for (const auto& sample : samples) {
+    sample.first->Record(sample.second);
+  }
 }
 
 int64 GraphProfiler::AddInputStreamTimeSamples(
     const CalculatorContext& calculator_context, int64 start_time_usec,
-    CalculatorProfile* calculator_profile) {
+    CalculatorProfile* calculator_profile,
+    LogLinearSamples* log_linear_samples) {
   int64 input_timestamp_usec = calculator_context.InputTimestamp().Value();
   int64 min_source_process_start_usec = start_time_usec;
   int64 input_stream_counter = -1;
+  LogLinearHistograms* log_linear =
+      FindLogLinearHistograms(calculator_context.NodeName());
   for (CollectionItemId id = calculator_context.Inputs().BeginId();
        id < calculator_context.Inputs().EndId(); ++id) {
     ++input_stream_counter;
@@ -527,7 +593,10 @@ int64 GraphProfiler::AddInputStreamTimeSamples(
     AddTimeSample(
         packet_info->production_time_usec, start_time_usec,
         calculator_profile->mutable_input_stream_profiles(input_stream_counter)
-            ->mutable_latency());
+            ->mutable_latency(),
+        log_linear ? &log_linear->input_stream_latency[input_stream_counter]
+                   : nullptr,
+        log_linear_samples);
 
     min_source_process_start_usec = std::min(
         min_source_process_start_usec, packet_info->source_process_start_usec);
@@ -539,31 +608,47 @@ int64 GraphProfiler::AddInputStreamTimeSamples(
 void GraphProfiler::AddProcessSample(
     const CalculatorContext& calculator_context, int64 start_time_usec,
     int64 end_time_usec) {
-  absl::ReaderMutexLock lock(&profiler_mutex_);
-  if (!is_profiling_) {
-    return;
-  }
+  // The log-linear samples are recorded after the profiler lock is released,
+  // since concurrent calculators would otherwise contend on their buckets
+  // while holding it.
+  LogLinearSamples log_linear_samples;
+  {
+    absl::ReaderMutexLock lock(&profiler_mutex_);
+    if (!is_profiling_) {
+      return;
+    }
 
-  const std::string& node_name = calculator_context.NodeName();
-  auto profile_iter = calculator_profiles_.find(node_name);
-  ABSL_CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
-      "Calculator \"$0\" has not been added during initialization.",
-      calculator_context.NodeName());
-  CalculatorProfile* calculator_profile = &profile_iter->second;
+    const std::string& node_name = calculator_context.NodeName();
+    auto profile_iter = calculator_profiles_.find(node_name);
+    ABSL_CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
+        "Calculator \"$0\" has not been added during initialization.",
+        calculator_context.NodeName());
+    CalculatorProfile* calculator_profile = &profile_iter->second;
+    LogLinearHistograms* log_linear = FindLogLinearHistograms(node_name);
 
-  // Update Process() runtime.
-  AddTimeSample(start_time_usec, end_time_usec,
-                calculator_profile->mutable_process_runtime());
+    // Update Process() runtime.
+    AddTimeSample(start_time_usec, end_time_usec,
+                  calculator_profile->mutable_process_runtime(),
+                  log_linear ? &log_linear->process_runtime : nullptr,
+                  &log_linear_samples);
 
-  if (profiler_config_.enable_stream_latency()) {
-    int64 min_source_process_start_usec = AddStreamLatencies(
-        calculator_context, start_time_usec, end_time_usec, calculator_profile);
-    // Update input and output trace latencies.
-    AddTimeSample(min_source_process_start_usec, start_time_usec,
-                  calculator_profile->mutable_process_input_latency());
-    AddTimeSample(min_source_process_start_usec, end_time_usec,
-                  calculator_profile->mutable_process_output_latency());
+    if (profiler_config_.enable_stream_latency()) {
+      int64 min_source_process_start_usec =
+          AddStreamLatencies(calculator_context, start_time_usec,
+                             end_time_usec, calculator_profile,
+                             &log_linear_samples);
+      // Update input and output trace latencies.
+      AddTimeSample(min_source_process_start_usec, start_time_usec,
+                    calculator_profile->mutable_process_input_latency(),
+                    log_linear ? &log_linear->process_input_latency : nullptr,
+                    &log_linear_samples);
+      AddTimeSample(min_source_process_start_usec, end_time_usec,
+                    calculator_profile->mutable_process_output_latency(),
+                    log_linear ? &log_linear->process_output_latency : nullptr,
+                    &log_linear_samples);
+    }
   }
+  RecordLogLinearSamples(log_linear_samples);
 }
 
 std::unique_ptr<GlProfilingHelper> GraphProfiler::CreateGlProfilingHelper() {
@@ -726,8 +811,14 @@ absl::Status GraphProfiler::WriteProfile() {
     AssignNodeNames(&profile);
   }
 
-  // Write the GraphProfile to the trace_log_path.
+  // Write the GraphProfile to the trace_log_path, and the trace events also
+  // in the Chrome trace format if requested.
   int log_index = previous_log_index_ / log_interval_count % log_file_count;
+  if (profiler_config_.trace_log_format() ==
+      ProfilerConfig::CHROME_TRACE_JSON) {
+    MP_RETURN_IF_ERROR(WriteChromeTrace(
+        trace, absl::StrCat(trace_log_path, log_index, ".json"), is_new_file));
+  }
   std::string log_path = absl::StrCat(trace_log_path, log_index, ".binarypb");
   std::ofstream ofs;
   if (is_new_file) {
@@ -741,4 +832,44 @@ absl::Status GraphProfiler::WriteProfile() {
   return absl::OkStatus();
 }
 
+absl::Status GraphProfiler::WriteChromeTrace(const GraphTrace& trace,
+                                             const std::string& log_path,
+                                             bool is_new_file) {
+  if (!chrome_trace_writer_) {
+    const CalculatorGraphConfig& config = validated_graph_->Config();
+    std::vector<std::string> node_names;
+    node_names.reserve(config.node_size());
+    for (int i = 0; i < config.node_size(); ++i) {
+      node_names.push_back(CanonicalNodeName(config, i));
+    }
+    ChromeTraceWriter::StreamConsumers stream_consumers;
+    for (const EdgeInfo& input : validated_graph_->InputStreamInfos()) {
+      if (input.parent_node.type == NodeTypeInfo::NodeType::CALCULATOR) {
+        stream_consumers[input.name].push_back(input.parent_node.index);
+      }
+    }
+    chrome_trace_writer_ = std::make_unique<ChromeTraceWriter>(
+        graph_id_,
+        config.type().empty() ? absl::StrCat("graph_", graph_id_)
+                              : config.type(),
+        std::move(node_names), std::move(stream_consumers));
+  }
+
+  // Only the events since the previous write are converted and appended.
+  std::string events;
+  if (is_new_file) {
+    events = chrome_trace_writer_->BeginFile();
+  }
+  chrome_trace_writer_->AppendEvents(trace, &events);
+  std::ofstream ofs;
+  if (is_new_file) {
+    ofs.open(log_path, std::ofstream::out | std::ofstream::trunc);
+  } else {
+    ofs.open(log_path, std::ofstream::out | std::ofstream::app);
+  }
+  ofs << events;
+  RET_CHECK(ofs.good()) << "Could not write Chrome trace to: " << log_path;
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
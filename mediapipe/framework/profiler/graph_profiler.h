@@ -20,8 +20,11 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -30,7 +33,9 @@
 #include "mediapipe/framework/deps/monotonic_clock.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
+#include "mediapipe/framework/profiler/log_linear_histogram.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
 #include "mediapipe/framework/validated_graph_config.h"
 
@@ -253,9 +258,18 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
                                       int64 num_intervals,
                                       TimeHistogram* histogram);
   static void ResetTimeHistogram(TimeHistogram* histogram);
-  // Add a sample to a time histogram.
+  // Log-linear histogram samples, which are collected while the profiler lock
+  // is held and recorded once it is released.
+  using LogLinearSamples =
+      absl::InlinedVector<std::pair<LogLinearHistogramRecorder*, int64>, 8>;
+  // Add a sample to a time histogram. If "log_linear" is not null, the sample
+  // is also appended to "log_linear_samples" for that log-linear histogram.
   static void AddTimeSample(int64 start_time_usec, int64 end_time_usec,
-                            TimeHistogram* histogram);
+                            TimeHistogram* histogram,
+                            LogLinearHistogramRecorder* log_linear = nullptr,
+                            LogLinearSamples* log_linear_samples = nullptr);
+  // Records the samples collected by AddTimeSample.
+  static void RecordLogLinearSamples(const LogLinearSamples& samples);
 
   // Add output streams to the stream consumer count map.
   // This is neeeded in case an output stream is not consumed by any calculator.
@@ -283,7 +297,8 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Updates the production time for outputs and the stream profile for inputs.
   int64 AddStreamLatencies(const CalculatorContext& calculator_context,
                            int64 start_time_usec, int64 end_time_usec,
-                           CalculatorProfile* calculator_profile);
+                           CalculatorProfile* calculator_profile,
+                           LogLinearSamples* log_linear_samples);
 
   void SetOpenRuntime(const CalculatorContext& calculator_context,
                       int64 start_time_usec, int64 end_time_usec)
@@ -297,7 +312,8 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // packets and back-edge packets. Returns -1 if there is no input packets.
   int64 AddInputStreamTimeSamples(const CalculatorContext& calculator_context,
                                   int64 start_time_usec,
-                                  CalculatorProfile* calculator_profile);
+                                  CalculatorProfile* calculator_profile,
+                                  LogLinearSamples* log_linear_samples);
 
   // Updates the Process() data for calculator.
   // Requires ReaderLock for is_profiling_.
@@ -305,11 +321,34 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
                         int64 start_time_usec, int64 end_time_usec)
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
 
+  // The log-linear histograms of a calculator. They are kept outside of the
+  // CalculatorProfile and recorded after profiler_mutex_ is released, so
+  // their atomic buckets are never updated under the profiler lock. They are
+  // created in Initialize() and live as long as the profiler.
+  struct LogLinearHistograms {
+    explicit LogLinearHistograms(int num_input_streams)
+        : input_stream_latency(num_input_streams) {}
+    LogLinearHistogramRecorder process_runtime;
+    LogLinearHistogramRecorder process_input_latency;
+    LogLinearHistogramRecorder process_output_latency;
+    // Indexed like CalculatorProfile::input_stream_profiles.
+    std::vector<LogLinearHistogramRecorder> input_stream_latency;
+  };
+
+  // Returns the log-linear histograms of a calculator, or null if they are
+  // disabled.
+  LogLinearHistograms* FindLogLinearHistograms(const std::string& node_name);
+
   // Helper method to get trace_log_path.  If the trace_log_path is empty and
   // tracing is enabled, this function returns a default platform dependent
   // trace_log_path.
   absl::StatusOr<std::string> GetTraceLogPath();
 
+  // Writes the events of "trace" to the Chrome trace file "log_path",
+  // appending them unless "is_new_file" is true.
+  absl::Status WriteChromeTrace(const GraphTrace& trace,
+                                const std::string& log_path, bool is_new_file);
+
   // Helper method to get the clock time in microsecond.
   int64 TimeNowUsec() { return ToUnixMicros(clock_->TimeNow()); }
 
@@ -330,6 +369,10 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Stores all the calculator profiles with the calculator name as the key.
   using CalculatorProfileMap = ShardedMap<std::string, CalculatorProfile>;
   CalculatorProfileMap calculator_profiles_;
+  // Stores the log-linear histograms of each calculator, if enabled.
+  // Only modified by Initialize().
+  absl::flat_hash_map<std::string, std::unique_ptr<LogLinearHistograms>>
+      log_linear_histograms_;
   // Stores the production time of a packet, based on profiler's clock.
   using PacketInfoMap =
       ShardedMap<std::string, std::list<std::pair<int64, PacketInfo>>>;
@@ -360,6 +403,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   class GraphProfileBuilder;
   std::unique_ptr<GraphProfileBuilder> profile_builder_;
 
+  // Converts trace logs to the CHROME_TRACE_JSON format, if selected.
+  std::unique_ptr<ChromeTraceWriter> chrome_trace_writer_;
+
   // The globally incrementing identifier for all graphs in a process.
   static inline std::atomic_int next_instance_id_ = 0;
 
@@ -1045,6 +1045,44 @@ TEST_F(GraphProfilerTestPeer, AddProcessSample) {
   ASSERT_EQ(GetPacketsInfoMap()->size(), 0);
 }
 
+// Tests that AddProcessSample() records the percentiles of |process_runtime|
+// when log-linear histograms are enabled.
+TEST_F(GraphProfilerTestPeer, AddProcessSampleWithLogLinearHistogram) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+      enable_log_linear_histograms: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "output_stream"
+    })");
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream"}, {"output_stream"});
+  for (int i = 0; i < 999; ++i) {
+    AddProcessSample(*context.get(), /*start_time_usec=*/0,
+                     /*end_time_usec=*/20);
+  }
+  AddProcessSample(*context.get(), /*start_time_usec=*/0,
+                   /*end_time_usec=*/50000);
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  ASSERT_EQ(profiles.size(), 1);
+  const LogLinearHistogram& histogram =
+      profiles[0].process_runtime().log_linear();
+  EXPECT_EQ(histogram.p50_usec(), 20);
+  EXPECT_EQ(histogram.p99_usec(), 20);
+  EXPECT_EQ(histogram.p999_usec(), 20);
+  EXPECT_EQ(histogram.max_usec(), 50000);
+  EXPECT_FALSE(profiles[0].has_process_input_latency());
+
+  profiler_.Reset();
+  profiles = Profiles();
+  EXPECT_EQ(profiles[0].process_runtime().log_linear().count_size(), 0);
+}
+
 // Tests that AddProcessSample() updates |process_runtime| and also updates the
 // packet info map when stream latency is enabled.
 TEST_F(GraphProfilerTestPeer, AddProcessSampleWithStreamLatency) {
@@ -23,6 +23,8 @@
 
 #include "absl/flags/flag.h"
 #include "absl/log/absl_check.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -58,6 +60,7 @@ class GraphProfilerTestPeer {
 namespace {
 
 using testing::ElementsAre;
+using testing::HasSubstr;
 
 class GraphTracerTest : public ::testing::Test {
  protected:
@@ -1011,6 +1014,28 @@ TEST_F(GraphTracerE2ETest, DemuxGraphLogFile) {
   EXPECT_EQ(113, profile.graph_trace(0).calculator_trace().size());
 }
 
+TEST_F(GraphTracerE2ETest, DemuxGraphChromeTraceFile) {
+  std::string log_path = absl::StrCat(getenv("TEST_TMPDIR"), "/chrome_trace_");
+  SetUpDemuxInFlightGraph();
+  graph_config_.mutable_profiler_config()->set_trace_log_path(log_path);
+  graph_config_.mutable_profiler_config()->set_trace_log_interval_usec(-1);
+  graph_config_.mutable_profiler_config()->set_trace_log_format(
+      ProfilerConfig::CHROME_TRACE_JSON);
+  RunDemuxInFlightGraph();
+  std::string json;
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(log_path, 0, ".json"), &json));
+  EXPECT_TRUE(absl::StartsWith(json, "[\n"));
+  EXPECT_THAT(json, HasSubstr(R"("name":"RoundRobinDemuxCalculator)"));
+  EXPECT_THAT(json, HasSubstr(R"("ph":"X")"));
+  EXPECT_THAT(json, HasSubstr(R"("ph":"f","bp":"e")"));
+
+  // The GraphProfile is written alongside the Chrome trace.
+  GraphProfile profile;
+  MP_EXPECT_OK(
+      ReadGraphProfile(absl::StrCat(log_path, 0, ".binarypb"), &profile));
+  EXPECT_EQ(113, profile.graph_trace(0).calculator_trace().size());
+}
+
 TEST_F(GraphTracerE2ETest, DemuxGraphLogFiles) {
   std::string log_path = absl::StrCat(getenv("TEST_TMPDIR"), "/log_files_");
   SetUpDemuxInFlightGraph();
@@ -0,0 +1,145 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/log_linear_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr int kSubBuckets = 1 << kLogLinearSubBucketBits;
+
+// Returns the largest time in "histogram", which bounds the last bucket.
+int64_t MaxTime(const LogLinearHistogram& histogram) {
+  if (histogram.has_max_usec()) return histogram.max_usec();
+  return histogram.count_size() == 0
+             ? 0
+             : LogLinearBucketUpperBound(histogram.count_size() - 1);
+}
+
+}  // namespace
+
+int LogLinearBucketIndex(int64_t time_usec) {
+  if (time_usec < kSubBuckets) return std::max<int64_t>(time_usec, 0);
+  // The power of two of "time_usec", and its next bits below the leading one.
+  const int exponent = absl::bit_width(static_cast<uint64_t>(time_usec)) - 1;
+  const int shift = exponent - kLogLinearSubBucketBits;
+  const int index = ((shift + 1) << kLogLinearSubBucketBits) +
+                    static_cast<int>(time_usec >> shift) - kSubBuckets;
+  return std::min(index, kLogLinearNumBuckets - 1);
+}
+
+int64_t LogLinearBucketUpperBound(int index) {
+  if (index < kSubBuckets) return index;
+  const int shift = (index >> kLogLinearSubBucketBits) - 1;
+  const int64_t sub_bucket = kSubBuckets + (index & (kSubBuckets - 1));
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+void AddLogLinearSample(int64_t time_usec, LogLinearHistogram* histogram) {
+  const int index = LogLinearBucketIndex(time_usec);
+  if (histogram->count_size() <= index) {
+    histogram->mutable_count()->Resize(index + 1, 0);
+  }
+  histogram->set_count(index, histogram->count(index) + 1);
+  histogram->set_max_usec(std::max(histogram->max_usec(), time_usec));
+}
+
+absl::Status MergeLogLinearHistogram(const LogLinearHistogram& from,
+                                     LogLinearHistogram* to) {
+  RET_CHECK_EQ(from.sub_bucket_bits(), kLogLinearSubBucketBits)
+      << "Unsupported log-linear histogram layout.";
+  RET_CHECK_EQ(to->sub_bucket_bits(), kLogLinearSubBucketBits)
+      << "Unsupported log-linear histogram layout.";
+  if (to->count_size() < from.count_size()) {
+    to->mutable_count()->Resize(from.count_size(), 0);
+  }
+  for (int i = 0; i < from.count_size(); ++i) {
+    to->set_count(i, to->count(i) + from.count(i));
+  }
+  to->set_max_usec(std::max(to->max_usec(), from.max_usec()));
+  return absl::OkStatus();
+}
+
+int64_t GetLogLinearPercentile(const LogLinearHistogram& histogram,
+                               double percentile) {
+  int64_t total = 0;
+  for (int64_t count : histogram.count()) total += count;
+  if (total == 0) return 0;
+  // The tolerance keeps e.g. the 99.9th percentile of 1000 samples from
+  // rounding up to the 1000th sample.
+  const int64_t rank = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(percentile / 100.0 * total - 1e-6)));
+  const int64_t max_time = MaxTime(histogram);
+  int64_t seen = 0;
+  for (int i = 0; i < histogram.count_size(); ++i) {
+    seen += histogram.count(i);
+    if (seen >= rank) {
+      return i == kLogLinearNumBuckets - 1
+                 ? max_time
+                 : std::min(LogLinearBucketUpperBound(i), max_time);
+    }
+  }
+  return max_time;
+}
+
+void SetLogLinearPercentiles(LogLinearHistogram* histogram) {
+  histogram->set_p50_usec(GetLogLinearPercentile(*histogram, 50));
+  histogram->set_p90_usec(GetLogLinearPercentile(*histogram, 90));
+  histogram->set_p99_usec(GetLogLinearPercentile(*histogram, 99));
+  histogram->set_p999_usec(GetLogLinearPercentile(*histogram, 99.9));
+}
+
+LogLinearHistogramRecorder::LogLinearHistogramRecorder() { Reset(); }
+
+void LogLinearHistogramRecorder::Record(int64_t time_usec) {
+  counts_[LogLinearBucketIndex(time_usec)].fetch_add(
+      1, std::memory_order_relaxed);
+  int64_t max_usec = max_usec_.load(std::memory_order_relaxed);
+  while (time_usec > max_usec &&
+         !max_usec_.compare_exchange_weak(max_usec, time_usec,
+                                          std::memory_order_relaxed)) {
+  }
+}
+
+void LogLinearHistogramRecorder::Reset() {
+  for (auto& count : counts_) count.store(0, std::memory_order_relaxed);
+  max_usec_.store(0, std::memory_order_relaxed);
+}
+
+void LogLinearHistogramRecorder::Get(LogLinearHistogram* histogram) const {
+  histogram->Clear();
+  histogram->set_sub_bucket_bits(kLogLinearSubBucketBits);
+  int size = 0;
+  for (int i = 0; i < kLogLinearNumBuckets; ++i) {
+    if (counts_[i].load(std::memory_order_relaxed) != 0) size = i + 1;
+  }
+  histogram->mutable_count()->Reserve(size);
+  for (int i = 0; i < size; ++i) {
+    histogram->add_count(counts_[i].load(std::memory_order_relaxed));
+  }
+  histogram->set_max_usec(max_usec_.load(std::memory_order_relaxed));
+  SetLogLinearPercentiles(histogram);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,81 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_LOG_LINEAR_HISTOGRAM_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_LOG_LINEAR_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+
+namespace mediapipe {
+
+// The bucket layout of LogLinearHistogram::sub_bucket_bits.
+constexpr int kLogLinearSubBucketBits = 5;
+
+// Times of 2^36 usec (about 19 hours) and more share the last bucket.
+constexpr int kLogLinearNumBuckets = (36 - kLogLinearSubBucketBits + 1)
+                                     << kLogLinearSubBucketBits;
+
+// Returns the index of the bucket that counts "time_usec".
+int LogLinearBucketIndex(int64_t time_usec);
+
+// Returns the largest time counted by the bucket "index".
+int64_t LogLinearBucketUpperBound(int index);
+
+// Adds a sample to "histogram", without updating its percentiles.
+void AddLogLinearSample(int64_t time_usec, LogLinearHistogram* histogram);
+
+// Adds the samples of "from" to "to", without updating its percentiles.
+absl::Status MergeLogLinearHistogram(const LogLinearHistogram& from,
+                                     LogLinearHistogram* to);
+
+// Returns the time that "percentile" percent of the samples do not exceed,
+// rounded up to the end of its bucket. Returns 0 if there are no samples.
+int64_t GetLogLinearPercentile(const LogLinearHistogram& histogram,
+                               double percentile);
+
+// Sets the percentile fields of "histogram" from its counts.
+void SetLogLinearPercentiles(LogLinearHistogram* histogram);
+
+// Records times from any number of threads into a LogLinearHistogram.
+// Record() only increments atomic counters, so concurrent calculators never
+// wait on each other.
+class LogLinearHistogramRecorder {
+ public:
+  LogLinearHistogramRecorder();
+  LogLinearHistogramRecorder(const LogLinearHistogramRecorder&) = delete;
+  LogLinearHistogramRecorder& operator=(const LogLinearHistogramRecorder&) =
+      delete;
+
+  void Record(int64_t time_usec);
+
+  // Discards the recorded times. Times recorded concurrently may be kept.
+  void Reset();
+
+  // Writes the times recorded since the last Reset() to "histogram", with
+  // their percentiles.
+  void Get(LogLinearHistogram* histogram) const;
+
+ private:
+  std::array<std::atomic<int64_t>, kLogLinearNumBuckets> counts_;
+  std::atomic<int64_t> max_usec_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_LOG_LINEAR_HISTOGRAM_H_
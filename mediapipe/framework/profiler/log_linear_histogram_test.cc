@@ -0,0 +1,106 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/log_linear_histogram.h"
+
+#include <cstdint>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(LogLinearHistogramTest, BucketsAreContiguous) {
+  for (int index = 0; index < kLogLinearNumBuckets - 1; ++index) {
+    const int64_t upper_bound = LogLinearBucketUpperBound(index);
+    EXPECT_EQ(LogLinearBucketIndex(upper_bound), index);
+    EXPECT_EQ(LogLinearBucketIndex(upper_bound + 1), index + 1);
+  }
+  EXPECT_EQ(LogLinearBucketIndex(-5), 0);
+  EXPECT_EQ(LogLinearBucketIndex(int64_t{1} << 40), kLogLinearNumBuckets - 1);
+}
+
+TEST(LogLinearHistogramTest, BucketsHaveBoundedRelativeError) {
+  for (int index = 1; index < kLogLinearNumBuckets - 1; ++index) {
+    const int64_t lower_bound = LogLinearBucketUpperBound(index - 1) + 1;
+    const int64_t upper_bound = LogLinearBucketUpperBound(index);
+    EXPECT_LE(upper_bound - lower_bound, lower_bound / 32) << index;
+  }
+}
+
+TEST(LogLinearHistogramTest, ResolvesRareStalls) {
+  LogLinearHistogram histogram;
+  for (int i = 0; i < 995; ++i) AddLogLinearSample(20 + i % 3, &histogram);
+  for (int i = 0; i < 5; ++i) AddLogLinearSample(40000 + i, &histogram);
+  SetLogLinearPercentiles(&histogram);
+
+  EXPECT_EQ(histogram.p50_usec(), 21);
+  EXPECT_EQ(histogram.p99_usec(), 22);
+  EXPECT_GE(histogram.p999_usec(), 40000);
+  EXPECT_LE(histogram.p999_usec(), 40004);
+  EXPECT_EQ(histogram.max_usec(), 40004);
+}
+
+TEST(LogLinearHistogramTest, MergesHistograms) {
+  LogLinearHistogram a;
+  LogLinearHistogram b;
+  AddLogLinearSample(10, &a);
+  AddLogLinearSample(1000, &b);
+  AddLogLinearSample(1000, &b);
+  MP_ASSERT_OK(MergeLogLinearHistogram(b, &a));
+  EXPECT_EQ(GetLogLinearPercentile(a, 33), 10);
+  EXPECT_EQ(GetLogLinearPercentile(a, 50), 1000);
+  EXPECT_EQ(a.max_usec(), 1000);
+
+  LogLinearHistogram other_layout;
+  other_layout.set_sub_bucket_bits(3);
+  EXPECT_FALSE(MergeLogLinearHistogram(other_layout, &a).ok());
+}
+
+TEST(LogLinearHistogramTest, EmptyHistogram) {
+  LogLinearHistogram histogram;
+  EXPECT_EQ(GetLogLinearPercentile(histogram, 99), 0);
+}
+
+TEST(LogLinearHistogramTest, RecordsFromManyThreads) {
+  LogLinearHistogramRecorder recorder;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&recorder, t] {
+      for (int i = 0; i < 1000; ++i) recorder.Record(100 * t + i % 10);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  LogLinearHistogram histogram;
+  recorder.Get(&histogram);
+  int64_t total = 0;
+  for (int64_t count : histogram.count()) total += count;
+  EXPECT_EQ(total, 4000);
+  EXPECT_EQ(histogram.max_usec(), 309);
+  EXPECT_EQ(histogram.p50_usec(), GetLogLinearPercentile(histogram, 50));
+
+  recorder.Reset();
+  recorder.Get(&histogram);
+  EXPECT_EQ(histogram.count_size(), 0);
+  EXPECT_EQ(histogram.p50_usec(), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
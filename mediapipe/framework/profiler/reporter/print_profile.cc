@@ -35,6 +35,9 @@ ABSL_FLAG(std::vector<std::string>, cols, {"*"},
           "allowed.");
 ABSL_FLAG(bool, compact, false,
           "if true, then don't print unnecessary whitespace.");
+ABSL_FLAG(int, critical_paths, 0,
+          "number of critical paths with the highest latency to print after "
+          "the columns.");
 
 using mediapipe::reporter::Reporter;
 
@@ -63,6 +66,8 @@ int main(int argc, char** argv) {
       reporter.Accumulate(proto);
     }
   }
-  reporter.Report()->Print(std::cout);
+  auto report = reporter.Report();
+  report->Print(std::cout);
+  report->PrintCriticalPaths(std::cout, absl::GetFlag(FLAGS_critical_paths));
   return 1;
 }
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "absl/container/btree_map.h"
+#include "absl/log/absl_log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -20,6 +21,7 @@
 #include "mediapipe/framework/port/re2.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/profiler/log_linear_histogram.h"
 
 namespace mediapipe {
 namespace reporter {
@@ -36,6 +38,18 @@ absl::btree_map<std::string,
     kColumns = {
         {"calculator",
          [](const CalculatorData& d) -> const std::string { return d.name; }},
+        {"critical_path_count",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.critical_path_count);
+         }},
+        {"critical_path_percent",
+         [](const CalculatorData& d) -> const std::string {
+           return ToStringF(d.critical_path_percent);
+         }},
+        {"critical_path_time_mean",
+         [](const CalculatorData& d) -> const std::string {
+           return ToStringF(d.critical_path_time_stat.mean());
+         }},
         {"counter",
          [](const CalculatorData& d) -> const std::string {
            return ToString(d.counter);
@@ -60,6 +74,10 @@ absl::btree_map<std::string,
          [](const CalculatorData& d) -> const std::string {
            return ToStringF(d.processing_rate);
          }},
+        {"slack_mean",
+         [](const CalculatorData& d) -> const std::string {
+           return ToStringF(d.slack_stat.mean());
+         }},
         {"thread_count",
          [](const CalculatorData& d) -> const std::string {
            return ToStringF(d.thread_count);
@@ -72,6 +90,22 @@ absl::btree_map<std::string,
          [](const CalculatorData& d) -> const std::string {
            return ToStringF(d.time_stat.stddev());
          }},
+        {"time_p50",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(GetLogLinearPercentile(d.time_histogram, 50));
+         }},
+        {"time_p90",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(GetLogLinearPercentile(d.time_histogram, 90));
+         }},
+        {"time_p99",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(GetLogLinearPercentile(d.time_histogram, 99));
+         }},
+        {"time_p999",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(GetLogLinearPercentile(d.time_histogram, 99.9));
+         }},
         {"time_total",
          [](const CalculatorData& d) -> const std::string {
            return ToString(d.time_stat.total());
@@ -88,6 +122,26 @@ absl::btree_map<std::string,
          [](const CalculatorData& d) -> const std::string {
            return ToStringF(d.input_latency_stat.stddev());
          }},
+        {"input_latency_p50",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(
+               GetLogLinearPercentile(d.input_latency_histogram, 50));
+         }},
+        {"input_latency_p90",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(
+               GetLogLinearPercentile(d.input_latency_histogram, 90));
+         }},
+        {"input_latency_p99",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(
+               GetLogLinearPercentile(d.input_latency_histogram, 99));
+         }},
+        {"input_latency_p999",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(
+               GetLogLinearPercentile(d.input_latency_histogram, 99.9));
+         }},
         {"input_latency_total",
          [](const CalculatorData& d) -> const std::string {
            return ToString(d.input_latency_stat.total());
@@ -192,6 +246,208 @@ void CacheOutputTraceLookup(const mediapipe::GraphProfile& profile,
   }
 }
 
+// Returns true if the calculator profiles include log-linear histograms.
+bool HasLogLinearHistograms(const mediapipe::GraphProfile& profile) {
+  for (const auto& calculator_profile : profile.calculator_profiles()) {
+    if (calculator_profile.process_runtime().has_log_linear()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Adds a log-linear histogram of a calculator profile to "histogram".
+void MergeHistogram(const mediapipe::TimeHistogram& time_histogram,
+                    LogLinearHistogram* histogram) {
+  if (!time_histogram.has_log_linear()) {
+    return;
+  }
+  const absl::Status status =
+      MergeLogLinearHistogram(time_histogram.log_linear(), histogram);
+  if (!status.ok()) {
+    ABSL_LOG_FIRST_N(WARNING, 1) << status.message();
+  }
+}
+
+// A PROCESS invocation of a calculator, joined from its start and finish
+// events if the trace records them separately.
+struct TracedInvocation {
+  int32_t node_id;
+  int64_t timestamp;
+  int64_t start_time;
+  int64_t finish_time;
+  std::vector<const mediapipe::GraphTrace::StreamTrace*> inputs;
+  std::vector<const mediapipe::GraphTrace::StreamTrace*> outputs;
+};
+
+// Collects the completed PROCESS invocations of "profile". An invocation
+// whose start isn't traced, such as the packets of a graph input stream or
+// of a source calculator, starts when it finishes.
+std::vector<TracedInvocation> CollectInvocations(
+    const mediapipe::GraphProfile& profile) {
+  std::vector<TracedInvocation> invocations;
+  // Maps the input timestamp, node ID and thread ID of a started invocation
+  // to its start event.
+  std::map<std::pair<int64_t, std::pair<int32_t, int32_t>>,
+           const mediapipe::GraphTrace::CalculatorTrace*>
+      started;
+  for (const auto& graph_trace : profile.graph_trace()) {
+    for (const auto& calc_trace : graph_trace.calculator_trace()) {
+      if (calc_trace.event_type() != mediapipe::GraphTrace_EventType_PROCESS) {
+        continue;
+      }
+      const auto key = std::make_pair(
+          calc_trace.input_timestamp(),
+          std::make_pair(calc_trace.node_id(), calc_trace.thread_id()));
+      if (!calc_trace.has_finish_time()) {
+        if (calc_trace.has_start_time()) started[key] = &calc_trace;
+        continue;
+      }
+      TracedInvocation invocation;
+      invocation.node_id = calc_trace.node_id();
+      invocation.timestamp = calc_trace.input_timestamp();
+      invocation.finish_time = calc_trace.finish_time();
+      invocation.start_time = calc_trace.has_start_time()
+                                  ? calc_trace.start_time()
+                                  : calc_trace.finish_time();
+      const auto start_it = started.find(key);
+      if (!calc_trace.has_start_time() && start_it != started.end()) {
+        invocation.start_time = start_it->second->start_time();
+        for (const auto& stream_trace : start_it->second->input_trace()) {
+          invocation.inputs.push_back(&stream_trace);
+        }
+        started.erase(start_it);
+      }
+      for (const auto& stream_trace : calc_trace.input_trace()) {
+        invocation.inputs.push_back(&stream_trace);
+      }
+      for (const auto& stream_trace : calc_trace.output_trace()) {
+        invocation.outputs.push_back(&stream_trace);
+      }
+      invocations.push_back(std::move(invocation));
+    }
+  }
+  return invocations;
+}
+
+// Finds the critical path of each timestamp in "profile", and records the
+// critical path time and the slack of each calculator.
+//
+// The invocations of a timestamp form a DAG, in which each invocation
+// depends on the producers of its input packets. The critical path ends at
+// the invocation that finished last, and steps back to the producer of the
+// last-arriving input, which gated the start of the invocation. The slack of
+// an invocation is how much later it could have finished without delaying
+// the end of the critical path, if the wait and run time of its consumers
+// stayed the same.
+void AnalyzeCriticalPaths(
+    const mediapipe::GraphProfile& profile, NameLookup& name_lookup,
+    std::map<std::string, CalculatorData>* calculator_data,
+    GraphData* graph_data, std::vector<CriticalPath>* critical_paths) {
+  const std::vector<TracedInvocation> invocations =
+      CollectInvocations(profile);
+
+  // Maps each output packet to the invocation that produced it, and groups
+  // the invocations by timestamp, in the order they finished.
+  std::map<std::pair<int64_t, int32_t>, int> producers;
+  std::map<int64_t, std::vector<int>> timestamps;
+  for (int i = 0; i < static_cast<int>(invocations.size()); ++i) {
+    for (const auto* stream_trace : invocations[i].outputs) {
+      producers[std::make_pair(stream_trace->packet_timestamp(),
+                               stream_trace->stream_id())] = i;
+    }
+    timestamps[invocations[i].timestamp].push_back(i);
+  }
+
+  for (auto& [timestamp, group] : timestamps) {
+    std::stable_sort(group.begin(), group.end(), [&](int a, int b) {
+      return invocations[a].finish_time < invocations[b].finish_time;
+    });
+
+    // The producers of each invocation within the timestamp, and the one
+    // whose output arrived last.
+    std::map<int, std::vector<int>> inputs_from;
+    std::map<int, int> gate;
+    std::map<int, int64_t> gate_time;
+    for (int i : group) {
+      gate_time[i] = invocations[i].start_time;
+      for (const auto* stream_trace : invocations[i].inputs) {
+        const auto it = producers.find(std::make_pair(
+            stream_trace->packet_timestamp(), stream_trace->stream_id()));
+        if (it == producers.end() || it->second == i ||
+            invocations[it->second].timestamp != timestamp) {
+          continue;
+        }
+        const int producer = it->second;
+        inputs_from[i].push_back(producer);
+        if (gate.find(i) == gate.end() ||
+            invocations[producer].finish_time >
+                invocations[gate[i]].finish_time) {
+          gate[i] = producer;
+          gate_time[i] = std::min(invocations[producer].finish_time,
+                                  invocations[i].start_time);
+        }
+      }
+    }
+
+    // Propagates the latest finish times back from the last invocation.
+    const int last = group.back();
+    const int64_t end_time = invocations[last].finish_time;
+    std::map<int, int64_t> latest_finish;
+    for (auto it = group.rbegin(); it != group.rend(); ++it) {
+      const int i = *it;
+      if (latest_finish.find(i) == latest_finish.end()) {
+        latest_finish[i] = end_time;
+      }
+      const int64_t latest_gate_time =
+          latest_finish[i] - (invocations[i].finish_time - gate_time[i]);
+      for (int producer : inputs_from[i]) {
+        const auto finish_it = latest_finish.find(producer);
+        if (finish_it == latest_finish.end()) {
+          latest_finish[producer] = latest_gate_time;
+        } else {
+          finish_it->second = std::min(finish_it->second, latest_gate_time);
+        }
+      }
+      if (invocations[i].node_id < 0) continue;
+      (*calculator_data)[name_lookup[invocations[i].node_id]].slack_stat.Push(
+          std::max<int64_t>(0, latest_finish[i] - invocations[i].finish_time));
+    }
+
+    // Walks back from the last invocation along the gating producers.
+    CriticalPath path;
+    path.timestamp = timestamp;
+    int first = last;
+    std::vector<int> visited;
+    for (int i = last; std::find(visited.begin(), visited.end(), i) ==
+                       visited.end();) {
+      visited.push_back(i);
+      first = i;
+      const TracedInvocation& invocation = invocations[i];
+      if (invocation.node_id >= 0) {
+        const std::string& name = name_lookup[invocation.node_id];
+        path.steps.push_back(
+            {name, invocation.start_time - gate_time[i],
+             invocation.finish_time - invocation.start_time});
+        auto& calc_data = (*calculator_data)[name];
+        calc_data.name = name;
+        ++calc_data.critical_path_count;
+        calc_data.critical_path_time_stat.Push(invocation.finish_time -
+                                               gate_time[i]);
+      }
+      const auto gate_it = gate.find(i);
+      if (gate_it == gate.end()) break;
+      i = gate_it->second;
+    }
+    if (path.steps.empty()) continue;
+    std::reverse(path.steps.begin(), path.steps.end());
+    path.latency = end_time - gate_time[first];
+    ++graph_data->critical_path_count;
+    graph_data->critical_path_total_time += path.latency;
+    critical_paths->push_back(std::move(path));
+  }
+}
+
 void CompleteCalculatorData(
     const GraphData& graph_data,
     std::map<std::string, CalculatorData>* calculator_data) {
@@ -211,6 +467,11 @@ void CompleteCalculatorData(
                                     ? 0
                                     : 1.0 / calc_data.time_stat.mean() * 1.0E+6;
     calc_data.thread_count = calc_data.threads.size();
+    calc_data.critical_path_percent =
+        graph_data.critical_path_total_time == 0
+            ? 0
+            : 100 * calc_data.critical_path_time_stat.total() /
+                  graph_data.critical_path_total_time;
   }
 }
 
@@ -226,6 +487,10 @@ void Reporter::Accumulate(const mediapipe::GraphProfile& profile) {
   TimestampNodeIdToCalcTrace start_event_lookup;
   CacheOutputTraceLookup(profile, &output_trace_lookup, &start_event_lookup);
 
+  // The percentiles come from the log-linear histograms if present, and
+  // otherwise from the traced durations.
+  const bool has_log_linear = HasLogLinearHistograms(profile);
+
   // Hold the domain of all times found in the trace file.
   auto& min_time = graph_data_.min_time;
   auto& max_time = graph_data_.max_time;
@@ -291,10 +556,29 @@ void Reporter::Accumulate(const mediapipe::GraphProfile& profile) {
               finish_time - (start_time.value() + graph_trace.base_time());
           calc_data.time_stat.Push(duration);
           total_time += duration;
+          if (!has_log_linear) {
+            AddLogLinearSample(input_latency,
+                               &calc_data.input_latency_histogram);
+            AddLogLinearSample(duration, &calc_data.time_histogram);
+          }
         }
       }
     }
   }
+
+  if (has_log_linear) {
+    for (const auto& calculator_profile : profile.calculator_profiles()) {
+      auto& calc_data = calculator_data_[calculator_profile.name()];
+      calc_data.name = calculator_profile.name();
+      MergeHistogram(calculator_profile.process_runtime(),
+                     &calc_data.time_histogram);
+      MergeHistogram(calculator_profile.process_input_latency(),
+                     &calc_data.input_latency_histogram);
+    }
+  }
+
+  AnalyzeCriticalPaths(profile, name_lookup, &calculator_data_, &graph_data_,
+                       &critical_paths_);
 }
 
 absl::Status Reporter::set_columns(const std::vector<std::string>& columns) {
@@ -344,9 +628,13 @@ absl::Status Reporter::set_columns(const std::vector<std::string>& columns) {
 class ReportImpl : public Report {
  public:
   ReportImpl(const std::map<std::string, CalculatorData>& calculator_data,
-             const GraphData& graph_data)
-      : calculator_data_(calculator_data), graph_data_(graph_data) {}
+             const GraphData& graph_data,
+             const std::vector<CriticalPath>& critical_paths)
+      : calculator_data_(calculator_data),
+        graph_data_(graph_data),
+        critical_paths_(critical_paths) {}
   void Print(std::ostream& output) override;
+  void PrintCriticalPaths(std::ostream& output, int max_paths) override;
   const std::vector<std::string>& headers() override { return headers_impl; }
   const std::vector<std::vector<std::string>>& lines() override {
     return lines_impl;
@@ -355,6 +643,9 @@ class ReportImpl : public Report {
   const std::map<std::string, CalculatorData>& calculator_data() override {
     return calculator_data_;
   }
+  const std::vector<CriticalPath>& critical_paths() override {
+    return critical_paths_;
+  }
 
   // Each header name in alphabetical order, except the first column, which is
   // always "calculator".
@@ -370,6 +661,7 @@ class ReportImpl : public Report {
 
   const std::map<std::string, CalculatorData>& calculator_data_;
   const GraphData& graph_data_;
+  const std::vector<CriticalPath>& critical_paths_;
 };
 
 void ReportImpl::Print(std::ostream& output) {
@@ -405,10 +697,31 @@ void ReportImpl::Print(std::ostream& output) {
   }
 }
 
+void ReportImpl::PrintCriticalPaths(std::ostream& output, int max_paths) {
+  std::vector<const CriticalPath*> paths;
+  for (const auto& path : critical_paths_) {
+    paths.push_back(&path);
+  }
+  max_paths = std::min<int>(max_paths, paths.size());
+  std::partial_sort(paths.begin(), paths.begin() + max_paths, paths.end(),
+                    [](const CriticalPath* a, const CriticalPath* b) {
+                      return a->latency > b->latency;
+                    });
+  for (int i = 0; i < max_paths; ++i) {
+    output << "critical path of timestamp " << paths[i]->timestamp << ": "
+           << paths[i]->latency << " us" << std::endl;
+    for (const auto& step : paths[i]->steps) {
+      output << "  " << step.calculator << " wait " << step.wait_time
+             << " us, process " << step.process_time << " us" << std::endl;
+    }
+  }
+}
+
 std::unique_ptr<Report> Reporter::Report() {
   CompleteCalculatorData(graph_data_, &calculator_data_);
 
-  auto report = std::make_unique<ReportImpl>(calculator_data_, graph_data_);
+  auto report = std::make_unique<ReportImpl>(calculator_data_, graph_data_,
+                                             critical_paths_);
   report->compact_flag = compact_flag_;
 
   // First row contains the column headers.
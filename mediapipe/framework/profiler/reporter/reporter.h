@@ -4,6 +4,8 @@
 #include <memory>
 #include <ostream>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "map"
 #include "mediapipe/framework/calculator.pb.h"
@@ -20,6 +22,12 @@ struct GraphData {
   int64_t max_time = std::numeric_limits<int64_t>::min();
 
   int64_t total_time = 0;
+
+  // The number of timestamps with a critical path, and the sum of their
+  // latencies (microseconds).
+  int critical_path_count = 0;
+
+  int64_t critical_path_total_time = 0;
 };
 
 // Holds all of the measured data for a calculator.
@@ -61,10 +69,61 @@ struct CalculatorData {
   // from their origin.
   Statistic input_latency_stat;
 
+  // Records the distributions of time_stat and input_latency_stat, for
+  // percentiles. These are merged from the calculator profiles if they
+  // include log-linear histograms, which count every invocation rather than
+  // only the traced ones.
+  LogLinearHistogram time_histogram;
+  LogLinearHistogram input_latency_histogram;
+
+  // The number of timestamps whose critical path includes this calculator.
+  int critical_path_count;
+
+  // Percentage of the total critical path latency spent waiting for or
+  // running this calculator.
+  double critical_path_percent;
+
+  // Records the time this calculator added to each critical path, from the
+  // arrival of its last input to its finish (microseconds).
+  Statistic critical_path_time_stat;
+
+  // Records the slack of each traced invocation: how much later it could
+  // have finished without delaying the last calculator of its timestamp
+  // (microseconds). Zero on the critical path.
+  Statistic slack_stat;
+
   // The threads on which this calculator ran.
   std::set<int> threads;
 };
 
+// The chain of calculator invocations that bounded the latency of one packet
+// timestamp. The chain ends at the invocation that finished last for the
+// timestamp, and each invocation is preceded by the producer of its
+// last-arriving input.
+struct CriticalPath {
+  struct Step {
+    // Name of the calculator.
+    std::string calculator;
+
+    // Time from the arrival of the last input to the start of PROCESS
+    // (microseconds).
+    int64_t wait_time;
+
+    // Time spent in PROCESS (microseconds).
+    int64_t process_time;
+  };
+
+  // The input timestamp, as recorded in the trace.
+  int64_t timestamp;
+
+  // Time from the first step's inputs to the last step's finish
+  // (microseconds).
+  int64_t latency;
+
+  // The calculators in the order they ran.
+  std::vector<Step> steps;
+};
+
 // A snapshot of statistics generated by Reporter.
 class Report {
  public:
@@ -91,6 +150,13 @@ class Report {
   // Returns summary data for each calculator in the graph. Invalidated if
   // Report() is called again on Reporter.
   virtual const std::map<std::string, CalculatorData>& calculator_data() = 0;
+
+  // Returns the critical path of each traced timestamp. Invalidated if
+  // Report() is called again on Reporter.
+  virtual const std::vector<CriticalPath>& critical_paths() = 0;
+
+  // Prints the "max_paths" critical paths with the highest latency.
+  virtual void PrintCriticalPaths(std::ostream& output, int max_paths) = 0;
 };
 
 // Provides a way to accumulate statistics from one or more
@@ -122,6 +188,7 @@ class Reporter {
   // Maps calculator.name -> profile information for that calculator.
   std::map<std::string, CalculatorData> calculator_data_;
   GraphData graph_data_;
+  std::vector<CriticalPath> critical_paths_;
 };
 
 }  // namespace reporter
@@ -29,8 +29,10 @@
 #include "mediapipe/framework/port/advanced_proto_inc.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/proto_ns.h"
 #include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/profiler/log_linear_histogram.h"
 #include "mediapipe/framework/profiler/reporter/statistic.h"
 #include "mediapipe/framework/tool/test_util.h"
 
@@ -98,7 +100,10 @@ TEST(Reporter, ReportColumnsWithWildcards) {
   auto reporter = loadReporter({"profile_opencv_0.binarypb"});
   MEDIAPIPE_CHECK_OK(reporter->set_columns({"*_m??n", "*l?t*cy*"}));
   EXPECT_THAT(reporter->Report()->headers(),
-              ElementsAre("calculator", "input_latency_mean", "time_mean",
+              ElementsAre("calculator", "critical_path_time_mean",
+                          "input_latency_mean", "slack_mean", "time_mean",
+                          "input_latency_p50", "input_latency_p90",
+                          "input_latency_p99", "input_latency_p999",
                           "input_latency_stddev", "input_latency_total"));
 }
 
@@ -109,8 +114,10 @@ TEST(Reporter, AggregatesAreRecorded) {
   const auto& lines = report->lines();
   EXPECT_EQ(lines.size(), 3);
   EXPECT_THAT(lines[2],
-              ElementsAre("OpenCvWriteTextCalculator", "13823.77", "100.00",
-                          "5541.47", "1976799", "245.13", "464.27", "35054"));
+              ElementsAre("OpenCvWriteTextCalculator", "13823.77", "11519",
+                          "21503", "34815", "38635", "100.00", "5541.47",
+                          "1976799", "245.13", "215", "251", "367", "5730",
+                          "464.27", "35054"));
 }
 
 TEST(Reporter, JoinsFiles) {
@@ -123,8 +130,10 @@ TEST(Reporter, JoinsFiles) {
   const auto& lines = report->lines();
   EXPECT_EQ(lines.size(), 3);
   EXPECT_THAT(lines[2],
-              ElementsAre("OpenCvWriteTextCalculator", "14707.77", "100.00",
-                          "5630.52", "3000385", "237.50", "389.35", "48449"));
+              ElementsAre("OpenCvWriteTextCalculator", "14707.77", "13311",
+                          "23039", "34815", "38635", "100.00", "5630.52",
+                          "3000385", "237.50", "219", "251", "343", "5730",
+                          "389.35", "48449"));
 }
 
 TEST(Reporter, PrintAllColumns) {
@@ -229,4 +238,135 @@ TEST(Reporter, LatencyCalculatedCorrectly) {
       testing::DoubleEq(1500));
 }
 
+// Tests that percentiles are merged from the log-linear histograms of the
+// calculator profiles in each file.
+TEST(Reporter, MergesLogLinearHistograms) {
+  Reporter reporter;
+  reporter.Accumulate(ParseTextProtoOrDie<GraphProfile>(R"pb(
+    calculator_profiles {
+      name: "ACalculator"
+      process_runtime { log_linear { count: [ 0, 3 ] max_usec: 1 } }
+      process_input_latency { log_linear { count: [ 0, 0, 1 ] max_usec: 2 } }
+    }
+  )pb"));
+  reporter.Accumulate(ParseTextProtoOrDie<GraphProfile>(R"pb(
+    calculator_profiles {
+      name: "ACalculator"
+      process_runtime {
+        log_linear { count: [ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 ] max_usec: 10 }
+      }
+    }
+  )pb"));
+  auto report = reporter.Report();
+  const auto& data = report->calculator_data().at("ACalculator");
+  EXPECT_EQ(GetLogLinearPercentile(data.time_histogram, 50), 1);
+  EXPECT_EQ(GetLogLinearPercentile(data.time_histogram, 99), 10);
+  EXPECT_EQ(GetLogLinearPercentile(data.input_latency_histogram, 50), 2);
+}
+
+// Tests that the critical path of a timestamp follows the last-arriving
+// input of each calculator, and that the other calculators get slack.
+TEST(Reporter, CriticalPathCalculatedCorrectly) {
+  // The graph input feeds A, which feeds B and C, which both feed D. B
+  // finishes after C, so the critical path is A, B, D. The start and finish
+  // of D are traced separately.
+  Reporter reporter;
+  reporter.Accumulate(ParseTextProtoOrDie<GraphProfile>(R"pb(
+    graph_trace {
+      calculator_name: [ "A", "B", "C", "D" ]
+      calculator_trace {
+        node_id: -1
+        input_timestamp: 5
+        event_type: PROCESS
+        finish_time: 100
+        output_trace { packet_timestamp: 5 stream_id: 1 }
+      }
+      calculator_trace {
+        node_id: 0
+        input_timestamp: 5
+        event_type: PROCESS
+        start_time: 110
+        finish_time: 200
+        input_trace { packet_timestamp: 5 stream_id: 1 }
+        output_trace { packet_timestamp: 5 stream_id: 2 }
+      }
+      calculator_trace {
+        node_id: 1
+        input_timestamp: 5
+        event_type: PROCESS
+        start_time: 210
+        finish_time: 400
+        input_trace { packet_timestamp: 5 stream_id: 2 }
+        output_trace { packet_timestamp: 5 stream_id: 3 }
+      }
+      calculator_trace {
+        node_id: 2
+        input_timestamp: 5
+        event_type: PROCESS
+        start_time: 220
+        finish_time: 300
+        input_trace { packet_timestamp: 5 stream_id: 2 }
+        output_trace { packet_timestamp: 5 stream_id: 4 }
+      }
+      calculator_trace {
+        node_id: 3
+        input_timestamp: 5
+        event_type: PROCESS
+        start_time: 450
+        input_trace { packet_timestamp: 5 stream_id: 3 }
+        input_trace { packet_timestamp: 5 stream_id: 4 }
+      }
+      calculator_trace {
+        node_id: 3
+        input_timestamp: 5
+        event_type: PROCESS
+        finish_time: 500
+      }
+    }
+  )pb"));
+  auto report = reporter.Report();
+
+  ASSERT_EQ(report->critical_paths().size(), 1);
+  const auto& path = report->critical_paths()[0];
+  EXPECT_EQ(path.timestamp, 5);
+  EXPECT_EQ(path.latency, 400);
+  ASSERT_EQ(path.steps.size(), 3);
+  EXPECT_EQ(path.steps[0].calculator, "A");
+  EXPECT_EQ(path.steps[0].wait_time, 10);
+  EXPECT_EQ(path.steps[0].process_time, 90);
+  EXPECT_EQ(path.steps[1].calculator, "B");
+  EXPECT_EQ(path.steps[2].calculator, "D");
+  EXPECT_EQ(path.steps[2].wait_time, 50);
+  EXPECT_EQ(path.steps[2].process_time, 50);
+
+  const auto& data = report->calculator_data();
+  EXPECT_EQ(data.at("A").critical_path_count, 1);
+  EXPECT_DOUBLE_EQ(data.at("A").critical_path_percent, 25);
+  EXPECT_DOUBLE_EQ(data.at("B").critical_path_percent, 50);
+  EXPECT_DOUBLE_EQ(data.at("D").critical_path_time_stat.mean(), 100);
+  EXPECT_EQ(data.at("C").critical_path_count, 0);
+  EXPECT_DOUBLE_EQ(data.at("B").slack_stat.mean(), 0);
+  EXPECT_DOUBLE_EQ(data.at("C").slack_stat.mean(), 100);
+
+  std::stringstream output;
+  report->PrintCriticalPaths(output, 1);
+  EXPECT_THAT(output.str(),
+              HasSubstr("critical path of timestamp 5: 400 us\n"
+                        "  A wait 10 us, process 90 us\n"));
+}
+
+// Tests that every traced timestamp gets a critical path.
+TEST(Reporter, CriticalPathsOfTrace) {
+  auto reporter = loadReporter({"profile_latency_test.binarypb"});
+  auto report = reporter->Report();
+  // B consumes the graph input directly, and finishes after A.
+  ASSERT_EQ(report->critical_paths().size(), 2);
+  EXPECT_EQ(report->critical_paths()[0].latency, 1000);
+  EXPECT_EQ(report->critical_paths()[1].latency, 1100);
+  EXPECT_EQ(report->calculator_data().at("BCalculator").critical_path_count,
+            2);
+  EXPECT_DOUBLE_EQ(
+      report->calculator_data().at("ACalculator").slack_stat.mean(), 550);
+}
+
 }  // namespace mediapipe
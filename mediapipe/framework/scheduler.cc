@@ -103,6 +103,15 @@ absl::Status Scheduler::SetNonDefaultExecutor(const std::string& name,
   return absl::OkStatus();
 }
 
+void Scheduler::EnableShardedQueues(int num_nodes) {
+  ABSL_CHECK_EQ(state_, STATE_NOT_STARTED)
+      << "EnableShardedQueues must not be called after the scheduler has "
+         "started";
+  for (auto queue : scheduler_queues_) {
+    queue->EnableSharding(num_nodes);
+  }
+}
+
 void Scheduler::SetQueuesRunning(bool running) {
   for (auto queue : scheduler_queues_) {
     queue->SetRunning(running);
@@ -59,6 +59,11 @@ class Scheduler {
   absl::Status SetNonDefaultExecutor(const std::string& name,
                                      Executor* executor);
 
+  // Switches all scheduler queues to sharded mode. Must be called after all
+  // executors have been set and before the scheduler is started.
+  // See SchedulerQueue::EnableSharding.
+  void EnableShardedQueues(int num_nodes);
+
   // Resets the data members at the beginning of each graph run.
   void Reset();
 
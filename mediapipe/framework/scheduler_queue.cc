@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "absl/log/absl_check.h"
+#include "absl/numeric/bits.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/executor.h"
@@ -35,6 +36,14 @@
 namespace mediapipe {
 namespace internal {
 
+namespace {
+
+// Unit of the running count in SchedulerQueue::submit_state_.
+constexpr int64 kRunningCountUnit = int64{1} << 32;
+constexpr int64 kTasksToAddMask = kRunningCountUnit - 1;
+
+}  // namespace
+
 SchedulerQueue::Item::Item(CalculatorNode* node, CalculatorContext* cc)
     : node_(node), cc_(cc) {
   ABSL_CHECK(node);
@@ -87,11 +96,27 @@ bool SchedulerQueue::Item::operator<(const SchedulerQueue::Item& that) const {
   }
 }
 
+void SchedulerQueue::EnableSharding(int num_nodes) {
+  sharded_ = true;
+  shards_.clear();
+  for (int i = 0; i < num_nodes; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+  num_shard_words_ = (num_nodes + 63) / 64;
+  nonempty_shards_ =
+      std::make_unique<std::atomic<uint64>[]>(num_shard_words_);
+  for (int i = 0; i < num_shard_words_; ++i) {
+    nonempty_shards_[i].store(0);
+  }
+}
+
 void SchedulerQueue::Reset() {
   absl::MutexLock lock(&mutex_);
   num_pending_tasks_ = 0;
   num_tasks_to_add_ = 0;
   running_count_ = 0;
+  submit_state_.store(0);
+  num_active_tasks_.store(0);
 }
 
 void SchedulerQueue::SetExecutor(Executor* executor) { executor_ = executor; }
@@ -103,6 +128,10 @@ bool SchedulerQueue::IsIdle() {
 }
 
 void SchedulerQueue::SetRunning(bool running) {
+  if (sharded_) {
+    submit_state_.fetch_add(running ? kRunningCountUnit : -kRunningCountUnit);
+    return;
+  }
   absl::MutexLock lock(&mutex_);
   running_count_ += running ? 1 : -1;
   ABSL_DCHECK_LE(running_count_, 1);
@@ -132,6 +161,10 @@ void SchedulerQueue::AddNodeForOpen(CalculatorNode* node) {
 }
 
 void SchedulerQueue::AddItemToQueue(Item&& item) {
+  if (sharded_) {
+    AddItemToShardedQueue(std::move(item));
+    return;
+  }
   const CalculatorNode* node = item.Node();
   bool was_idle;
   int tasks_to_add = 0;
@@ -173,6 +206,10 @@ void SchedulerQueue::SubmitWaitingTasksToExecutor() {
   // If a node is added to the scheduler queue while the queue is not running,
   // we do not immediately submit tasks to the executor. Here we check for any
   // such waiting tasks, and submit them.
+  if (sharded_) {
+    SubmitTasks(TakeTasksToSubmit());
+    return;
+  }
   int tasks_to_add = 0;
   {
     absl::MutexLock lock(&mutex_);
@@ -190,7 +227,14 @@ void SchedulerQueue::RunNextTask() {
   CalculatorNode* node;
   CalculatorContext* calculator_context;
   bool is_open_node;
-  {
+  if (sharded_) {
+    Item item = PopShardedItem();
+    node = item.Node();
+    calculator_context = item.Context();
+    is_open_node = item.IsOpenNode();
+    ABSL_CHECK(!node->Closed())
+        << "Scheduled a node that was closed. This should not happen.";
+  } else {
     absl::MutexLock lock(&mutex_);
 
     ABSL_CHECK(!queue_.empty())
@@ -221,7 +265,11 @@ void SchedulerQueue::RunNextTask() {
   }
 
   bool is_idle;
-  {
+  if (sharded_) {
+    const int num_active_tasks = num_active_tasks_.fetch_sub(1);
+    ABSL_DCHECK_GT(num_active_tasks, 0);
+    is_idle = num_active_tasks == 1;
+  } else {
     absl::MutexLock lock(&mutex_);
     ABSL_DCHECK_GT(num_pending_tasks_, 0);
     --num_pending_tasks_;
@@ -233,6 +281,108 @@ void SchedulerQueue::RunNextTask() {
   }
 }
 
+void SchedulerQueue::AddItemToShardedQueue(Item&& item) {
+  const CalculatorNode* node = item.Node();
+  // The "became active" callback must run before the item can be taken by
+  // another thread, so that the matching "became idle" callback cannot
+  // precede it. See SetIdleCallback.
+  const bool was_idle = num_active_tasks_.fetch_add(1) == 0;
+  if (was_idle && idle_callback_) {
+    // Became not idle.
+    idle_callback_(false);
+  }
+  const int id = node->Id();
+  if (item.IsOpenNode() || node->IsSource() || id < 0 || id >= shards_.size()) {
+    absl::MutexLock lock(&mutex_);
+    if (item.IsOpenNode()) {
+      num_open_items_.fetch_add(1);
+    }
+    num_queue_items_.fetch_add(1);
+    queue_.push(std::move(item));
+  } else {
+    Shard& shard = *shards_[id];
+    absl::MutexLock lock(&shard.mutex);
+    shard.items.push_back(std::move(item));
+    if (shard.items.size() == 1) {
+      nonempty_shards_[id / 64].fetch_or(uint64{1} << (id % 64));
+    }
+  }
+  VLOG(4) << node->DebugName() << " was added to the scheduler queue.";
+  // The item is visible before it is counted as a task to add, so a task
+  // submitted for it always finds at least one item to run.
+  submit_state_.fetch_add(1);
+  SubmitTasks(TakeTasksToSubmit());
+}
+
+SchedulerQueue::Item SchedulerQueue::PopShardedItem() {
+  // There are at least as many queued items as tasks that have not dequeued
+  // one yet, but a concurrent RunNextTask may take the item this scan was
+  // about to take. In that case another item has been queued, so keep
+  // scanning until one is found.
+  while (true) {
+    if (num_open_items_.load() > 0) {
+      absl::MutexLock lock(&mutex_);
+      if (!queue_.empty() && queue_.top().IsOpenNode()) {
+        Item item = queue_.top();
+        queue_.pop();
+        num_open_items_.fetch_sub(1);
+        num_queue_items_.fetch_sub(1);
+        return item;
+      }
+    }
+    // Non-sources with larger ids run first.
+    for (int word = num_shard_words_ - 1; word >= 0; --word) {
+      uint64 bits = nonempty_shards_[word].load();
+      while (bits != 0) {
+        const int bit = 63 - absl::countl_zero(bits);
+        bits &= ~(uint64{1} << bit);
+        Shard& shard = *shards_[word * 64 + bit];
+        absl::MutexLock lock(&shard.mutex);
+        if (shard.items.empty()) continue;
+        Item item = std::move(shard.items.front());
+        shard.items.pop_front();
+        if (shard.items.empty()) {
+          nonempty_shards_[word].fetch_and(~(uint64{1} << bit));
+        }
+        return item;
+      }
+    }
+    if (num_queue_items_.load() > 0) {
+      absl::MutexLock lock(&mutex_);
+      if (!queue_.empty()) {
+        Item item = queue_.top();
+        queue_.pop();
+        if (item.IsOpenNode()) {
+          num_open_items_.fetch_sub(1);
+        }
+        num_queue_items_.fetch_sub(1);
+        return item;
+      }
+    }
+  }
+}
+
+int SchedulerQueue::TakeTasksToSubmit() {
+  int64 state = submit_state_.load();
+  while (true) {
+    const int64 tasks_to_add = state & kTasksToAddMask;
+    const int64 running_count = (state - tasks_to_add) / kRunningCountUnit;
+    if (running_count <= 0 || tasks_to_add == 0) {
+      return 0;
+    }
+    if (submit_state_.compare_exchange_weak(state, state - tasks_to_add)) {
+      return tasks_to_add;
+    }
+  }
+}
+
+void SchedulerQueue::SubmitTasks(int tasks_to_add) {
+  while (tasks_to_add > 0) {
+    executor_->AddTask(this);
+    --tasks_to_add;
+  }
+}
+
 void SchedulerQueue::RunCalculatorNode(CalculatorNode* node,
                                        CalculatorContext* cc) {
   VLOG(3) << "Running " << node->DebugName();
@@ -298,7 +448,34 @@ void SchedulerQueue::OpenCalculatorNode(CalculatorNode* node) {
 
 void SchedulerQueue::CleanupAfterRun() {
   bool was_idle;
-  {
+  if (sharded_) {
+    const int tasks_to_add = submit_state_.load() & kTasksToAddMask;
+    // No tasks are pending, so every active task is still waiting to be
+    // added and corresponds to one queued item.
+    int num_items = 0;
+    {
+      absl::MutexLock lock(&mutex_);
+      num_items += queue_.size();
+      while (!queue_.empty()) {
+        queue_.pop();
+      }
+    }
+    for (int i = 0; i < shards_.size(); ++i) {
+      absl::MutexLock lock(&shards_[i]->mutex);
+      num_items += shards_[i]->items.size();
+      shards_[i]->items.clear();
+    }
+    for (int i = 0; i < num_shard_words_; ++i) {
+      nonempty_shards_[i].store(0);
+    }
+    was_idle = num_active_tasks_.load() == 0;
+    ABSL_CHECK_EQ(num_active_tasks_.load(), tasks_to_add);
+    ABSL_CHECK_EQ(tasks_to_add, num_items);
+    submit_state_.fetch_sub(tasks_to_add);
+    num_active_tasks_.store(0);
+    num_open_items_.store(0);
+    num_queue_items_.store(0);
+  } else {
     absl::MutexLock lock(&mutex_);
     was_idle = IsIdle();
     ABSL_CHECK_EQ(num_pending_tasks_, 0);
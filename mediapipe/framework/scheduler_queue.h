@@ -16,10 +16,12 @@
 #define MEDIAPIPE_FRAMEWORK_SCHEDULER_QUEUE_H_
 
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <queue>
 #include <utility>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/synchronization/mutex.h"
@@ -96,6 +98,20 @@ class SchedulerQueue : public TaskQueue {
     idle_callback_ = std::move(callback);
   }
 
+  // Switches the queue to sharded mode. Must be called before the scheduler
+  // is started. "num_nodes" is the number of calculator nodes in the graph.
+  //
+  // In sharded mode, ready non-source nodes are kept in one shard per node,
+  // each with its own mutex, and a bitmap records which shards are non-empty.
+  // The task bookkeeping uses atomics instead of mutex_. Only OpenNode()
+  // tasks and source nodes, which are comparatively rare, still go through
+  // the priority queue guarded by mutex_.
+  //
+  // The Item::operator< ordering is preserved: OpenNode() tasks run first,
+  // then non-sources by decreasing node id, then sources. Items for the same
+  // non-source node run in FIFO order.
+  void EnableSharding(int num_nodes);
+
   // Resets the data members at the beginning of each graph run.
   void Reset();
 
@@ -145,6 +161,18 @@ class SchedulerQueue : public TaskQueue {
   // Checks whether the queue has no queued nodes or pending tasks.
   bool IsIdle() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Sharded-mode counterparts of AddItemToQueue and the dequeuing part of
+  // RunNextTask.
+  void AddItemToShardedQueue(Item&& item) ABSL_LOCKS_EXCLUDED(mutex_);
+  Item PopShardedItem() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Sharded mode: atomically takes all tasks waiting to be submitted, if the
+  // queue is running. Returns the number of tasks taken.
+  int TakeTasksToSubmit();
+
+  // Sharded mode: submits "tasks_to_add" tasks to the executor.
+  void SubmitTasks(int tasks_to_add);
+
   Executor* executor_ = nullptr;
 
   IdleCallback idle_callback_;
@@ -168,6 +196,29 @@ class SchedulerQueue : public TaskQueue {
   SchedulerShared* const shared_;
 
   absl::Mutex mutex_;
+
+  // One shard per calculator node, holding that node's ready items when it
+  // is a non-source node. Only used in sharded mode.
+  struct Shard {
+    absl::Mutex mutex;
+    std::deque<Item> items ABSL_GUARDED_BY(mutex);
+  };
+  bool sharded_ = false;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  // Bit i is set iff shards_[i] is non-empty. Bits are only changed while
+  // holding the corresponding shard's mutex.
+  std::unique_ptr<std::atomic<uint64>[]> nonempty_shards_;
+  int num_shard_words_ = 0;
+  // Number of OpenNode() items and of all items in queue_.
+  std::atomic<int> num_open_items_{0};
+  std::atomic<int> num_queue_items_{0};
+  // The running count in the upper 32 bits and the number of tasks that need
+  // to be added to the Executor in the lower 32 bits, so that both can be
+  // updated together with a single atomic operation.
+  std::atomic<int64> submit_state_{0};
+  // Number of tasks that need to be added to the Executor plus tasks added
+  // and not yet complete. The queue is idle when this is zero.
+  std::atomic<int> num_active_tasks_{0};
 };
 
 }  // namespace internal
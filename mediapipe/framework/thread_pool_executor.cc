@@ -14,16 +14,85 @@
 
 #include "mediapipe/framework/thread_pool_executor.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#endif  // __linux__
+
+#include <iterator>
+#include <set>
 #include <utility>
 
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
+#include "mediapipe/framework/work_stealing_executor.h"
 #include "mediapipe/util/cpu_util.h"
 
 namespace mediapipe {
 
+namespace {
+
+// Returns the CPUs selected by the cpu_set and numa_node fields of "options".
+absl::StatusOr<std::set<int>> GetAffinityCpuSet(
+    const ThreadPoolExecutorOptions& options) {
+  if (options.require_processor_performance() !=
+      ThreadPoolExecutorOptions::NORMAL) {
+    return absl::InvalidArgumentError(
+        "require_processor_performance cannot be combined with cpu_set or "
+        "numa_node in ThreadPoolExecutorOptions.");
+  }
+  std::set<int> cpu_set;
+#if defined(__linux__)
+  // CPU ids aren't necessarily contiguous, e.g. when CPUs are offline or the
+  // process is restricted to a cpuset, so they are checked against the CPUs
+  // the process may run on rather than against the number of CPUs.
+  cpu_set_t allowed_cpus;
+  CPU_ZERO(&allowed_cpus);
+  const bool has_allowed_cpus =
+      sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus) == 0;
+  const int max_cpu_id = CPU_SETSIZE - 1;
+#else
+  const int max_cpu_id = NumCPUCores() - 1;
+#endif  // __linux__
+  for (int cpu : options.cpu_set()) {
+    if (cpu < 0 || cpu > max_cpu_id) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "The cpu_set field in ThreadPoolExecutorOptions contains "
+             << cpu << ", but the CPU ids range from 0 to " << max_cpu_id;
+    }
+#if defined(__linux__)
+    if (has_allowed_cpus && !CPU_ISSET(cpu, &allowed_cpus)) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "The cpu_set field in ThreadPoolExecutorOptions contains "
+             << cpu << ", which the process isn't allowed to run on";
+    }
+#endif  // __linux__
+    cpu_set.insert(cpu);
+  }
+  if (options.has_numa_node()) {
+    MP_ASSIGN_OR_RETURN(std::set<int> node_cpus,
+                        GetNumaNodeCoreIds(options.numa_node()));
+    if (cpu_set.empty()) {
+      cpu_set = std::move(node_cpus);
+    } else {
+      for (auto it = cpu_set.begin(); it != cpu_set.end();) {
+        it = node_cpus.count(*it) ? std::next(it) : cpu_set.erase(it);
+      }
+    }
+    if (cpu_set.empty()) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "No CPU of the cpu_set field in ThreadPoolExecutorOptions "
+                "belongs to NUMA node "
+             << options.numa_node();
+    }
+  }
+  return cpu_set;
+}
+
+}  // namespace
+
 // static
 absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
     const MediaPipeOptions& extendable_options) {
@@ -59,6 +128,10 @@ absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
   if (options.has_thread_name_prefix()) {
     thread_options.set_name_prefix(options.thread_name_prefix());
   }
+  if (options.cpu_set_size() > 0 || options.has_numa_node()) {
+    MP_ASSIGN_OR_RETURN(std::set<int> cpu_set, GetAffinityCpuSet(options));
+    thread_options.set_cpu_set(cpu_set);
+  }
 #if defined(__linux__)
   switch (options.require_processor_performance()) {
     case ThreadPoolExecutorOptions::LOW:
@@ -71,6 +144,9 @@ absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
       break;
   }
 #endif
+  if (options.queue_type() == ThreadPoolExecutorOptions::WORK_STEALING) {
+    return new WorkStealingExecutor(thread_options, options.num_threads());
+  }
   return new ThreadPoolExecutor(thread_options, options.num_threads());
 }
 
@@ -23,6 +23,9 @@
 namespace mediapipe {
 
 // A multithreaded executor based on a thread pool.
+//
+// Create() returns a WorkStealingExecutor instead if the options specify
+// queue_type: WORK_STEALING.
 class ThreadPoolExecutor : public Executor {
  public:
   static absl::StatusOr<Executor*> Create(
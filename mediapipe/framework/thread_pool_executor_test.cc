@@ -0,0 +1,140 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/thread_pool_executor.h"
+
+#include <memory>
+#include <set>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+#include "mediapipe/util/cpu_util.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif  // __linux__
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+
+#if defined(__linux__)
+// Returns the CPUs the process is allowed to run on.
+std::set<int> AllowedCpus() {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  std::set<int> cpus;
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpu_set)) cpus.insert(cpu);
+    }
+  }
+  return cpus;
+}
+
+// Runs tasks on "executor" and returns the CPUs they ran on.
+std::set<int> CpusOfTasks(Executor* executor) {
+  absl::Mutex mutex;
+  std::set<int> cpus;
+  int remaining = 100;
+  for (int i = 0; i < 100; ++i) {
+    executor->Schedule([&] {
+      const int cpu = sched_getcpu();
+      absl::MutexLock lock(&mutex);
+      cpus.insert(cpu);
+      --remaining;
+    });
+  }
+  absl::MutexLock lock(&mutex);
+  mutex.Await(absl::Condition(
+      +[](int* remaining) { return *remaining == 0; }, &remaining));
+  return cpus;
+}
+
+TEST(ThreadPoolExecutorTest, PinsWorkersToCpuSet) {
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  const std::set<int> allowed_cpus = AllowedCpus();
+  ASSERT_FALSE(allowed_cpus.empty());
+  const int cpu = *allowed_cpus.rbegin();
+  options->set_num_threads(2);
+  options->add_cpu_set(cpu);
+  MP_ASSERT_OK_AND_ASSIGN(Executor * executor,
+                          ThreadPoolExecutor::Create(extendable_options));
+  std::unique_ptr<Executor> owned(executor);
+  EXPECT_EQ(CpusOfTasks(executor), std::set<int>{cpu});
+}
+
+TEST(ThreadPoolExecutorTest, RejectsCpuOutsideOfAffinity) {
+  const std::set<int> allowed_cpus = AllowedCpus();
+  int cpu = 0;
+  while (cpu < CPU_SETSIZE && allowed_cpus.count(cpu)) ++cpu;
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(1);
+  options->add_cpu_set(cpu);
+  auto executor = ThreadPoolExecutor::Create(extendable_options);
+  EXPECT_THAT(executor.status().message(), HasSubstr("cpu_set"));
+}
+
+TEST(ThreadPoolExecutorTest, PinsWorkersToNumaNode) {
+  auto node_cpus = GetNumaNodeCoreIds(0);
+  if (!node_cpus.ok()) {
+    GTEST_SKIP() << "NUMA topology unavailable: " << node_cpus.status();
+  }
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(2);
+  options->set_numa_node(0);
+  options->set_queue_type(ThreadPoolExecutorOptions::WORK_STEALING);
+  MP_ASSERT_OK_AND_ASSIGN(Executor * executor,
+                          ThreadPoolExecutor::Create(extendable_options));
+  std::unique_ptr<Executor> owned(executor);
+  for (int cpu : CpusOfTasks(executor)) {
+    EXPECT_TRUE(node_cpus->count(cpu)) << cpu;
+  }
+}
+#endif  // __linux__
+
+TEST(ThreadPoolExecutorTest, RejectsInvalidCpuSet) {
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(1);
+  options->add_cpu_set(-1);
+  auto executor = ThreadPoolExecutor::Create(extendable_options);
+  EXPECT_THAT(executor.status().message(), HasSubstr("cpu_set"));
+}
+
+TEST(ThreadPoolExecutorTest, RejectsCpuSetWithProcessorPerformance) {
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(1);
+  options->add_cpu_set(0);
+  options->set_require_processor_performance(ThreadPoolExecutorOptions::HIGH);
+  auto executor = ThreadPoolExecutor::Create(extendable_options);
+  EXPECT_THAT(executor.status().message(),
+              HasSubstr("require_processor_performance"));
+}
+
+}  // namespace
+}  // namespace mediapipe
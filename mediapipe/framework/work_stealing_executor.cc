@@ -0,0 +1,164 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/work_stealing_executor.h"
+
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Number of unsuccessful FindTask rounds before a worker parks.
+constexpr int kSpinRounds = 16;
+
+// Identifies the WorkStealingExecutor worker running on this thread, if any.
+struct CurrentWorker {
+  const void* executor = nullptr;
+  int index = -1;
+};
+thread_local CurrentWorker current_worker;
+
+uint32_t NextRandom(uint32_t* state) {
+  // xorshift32.
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+}  // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(int num_threads)
+    : WorkStealingExecutor(ThreadOptions(), num_threads) {}
+
+WorkStealingExecutor::WorkStealingExecutor(const ThreadOptions& thread_options,
+                                           int num_threads)
+    : num_threads_(num_threads <= 0 ? 1 : num_threads) {
+  workers_.reserve(num_threads_);
+  for (int i = 0; i < num_threads_; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  thread_pool_ = std::make_unique<ThreadPool>(
+      thread_options,
+      thread_options.name_prefix().empty() ? "mediapipe"
+                                           : thread_options.name_prefix(),
+      num_threads_);
+  thread_pool_->StartWorkers();
+  // Each worker loop occupies one pool thread until the executor is stopped.
+  for (int i = 0; i < num_threads_; ++i) {
+    thread_pool_->Schedule([this, i] { RunWorker(i); });
+  }
+  VLOG(2) << "Started work-stealing executor with " << num_threads_
+          << " threads.";
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  VLOG(2) << "Terminating work-stealing executor.";
+  {
+    absl::MutexLock lock(&park_mutex_);
+    stopped_.store(true);
+    park_condition_.SignalAll();
+  }
+  // Waits for the worker loops, which drain all pending tasks before exiting.
+  thread_pool_.reset();
+}
+
+void WorkStealingExecutor::Schedule(std::function<void()> task) {
+  Task* item = new Task(std::move(task));
+  // Counted before it becomes visible, so that pending_tasks_ == 0 implies
+  // that all queues are empty.
+  pending_tasks_.fetch_add(1);
+  if (current_worker.executor == this) {
+    workers_[current_worker.index]->deque.Push(item);
+  } else {
+    absl::MutexLock lock(&injection_mutex_);
+    injection_queue_.push_back(item);
+    injection_size_.fetch_add(1);
+  }
+  WakeOne();
+}
+
+void WorkStealingExecutor::WakeOne() {
+  if (num_parked_.load() > 0) {
+    absl::MutexLock lock(&park_mutex_);
+    park_condition_.Signal();
+  }
+}
+
+WorkStealingExecutor::Task* WorkStealingExecutor::FindTask(
+    int index, uint32_t* rng_state) {
+  if (Task* task = workers_[index]->deque.Pop()) {
+    return task;
+  }
+  if (injection_size_.load(std::memory_order_relaxed) > 0) {
+    absl::MutexLock lock(&injection_mutex_);
+    if (!injection_queue_.empty()) {
+      Task* task = injection_queue_.front();
+      injection_queue_.pop_front();
+      injection_size_.fetch_sub(1);
+      return task;
+    }
+  }
+  const int start = NextRandom(rng_state) % num_threads_;
+  for (int i = 0; i < num_threads_; ++i) {
+    const int victim = (start + i) % num_threads_;
+    if (victim == index) continue;
+    if (Task* task = workers_[victim]->deque.Steal()) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingExecutor::RunWorker(int index) {
+  current_worker.executor = this;
+  current_worker.index = index;
+  uint32_t rng_state = 2654435761u * (index + 1);
+  int failed_rounds = 0;
+  while (true) {
+    if (Task* task = FindTask(index, &rng_state)) {
+      pending_tasks_.fetch_sub(1);
+      (*task)();
+      delete task;
+      failed_rounds = 0;
+      continue;
+    }
+    if (pending_tasks_.load() == 0 && stopped_.load()) {
+      break;
+    }
+    if (++failed_rounds < kSpinRounds) {
+      std::this_thread::yield();
+      continue;
+    }
+    failed_rounds = 0;
+    absl::MutexLock lock(&park_mutex_);
+    // num_parked_ is incremented before pending_tasks_ is checked, and
+    // Schedule increments pending_tasks_ before checking num_parked_, so a
+    // wake-up cannot be lost.
+    num_parked_.fetch_add(1);
+    while (pending_tasks_.load() == 0 && !stopped_.load()) {
+      park_condition_.Wait(&park_mutex_);
+    }
+    num_parked_.fetch_sub(1);
+  }
+  current_worker = CurrentWorker();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,96 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
+#define MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/thread_options.h"
+#include "mediapipe/framework/deps/work_stealing_deque.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// A multithreaded executor in which every worker thread owns a lock-free
+// deque of tasks.
+//
+// Tasks scheduled from a worker thread (which is how the scheduler submits
+// follow-up work after a node finishes) are pushed onto that worker's own
+// deque without taking any lock. Idle workers steal from the other workers'
+// deques. Tasks scheduled from non-worker threads go through a small shared
+// injection queue. A mutex is only taken to park and wake idle workers.
+//
+// Task ordering is not FIFO. This is fine for the MediaPipe scheduler, which
+// only submits "run the next task" closures and keeps its own priority queue.
+//
+// Created by ThreadPoolExecutor::Create when ThreadPoolExecutorOptions
+// specifies queue_type: WORK_STEALING.
+class WorkStealingExecutor : public Executor {
+ public:
+  explicit WorkStealingExecutor(int num_threads);
+  WorkStealingExecutor(const ThreadOptions& thread_options, int num_threads);
+  ~WorkStealingExecutor() override;
+  void Schedule(std::function<void()> task) override;
+
+  // For testing.
+  int num_threads() const { return num_threads_; }
+
+ private:
+  using Task = std::function<void()>;
+  struct Worker {
+    WorkStealingDeque<Task> deque;
+  };
+
+  // Body of the i-th worker thread. Returns when the executor is stopped and
+  // no tasks remain.
+  void RunWorker(int index);
+  // Finds a task for worker "index": own deque, then the injection queue, then
+  // the other workers' deques. Returns nullptr if none was found.
+  Task* FindTask(int index, uint32_t* rng_state);
+  // Wakes one parked worker if there is one.
+  void WakeOne();
+
+  const int num_threads_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Number of tasks scheduled but not yet taken by a worker.
+  std::atomic<int64_t> pending_tasks_{0};
+  // Number of workers parked (or about to park) on park_condition_.
+  std::atomic<int> num_parked_{0};
+  std::atomic<bool> stopped_{false};
+
+  absl::Mutex injection_mutex_;
+  std::deque<Task*> injection_queue_ ABSL_GUARDED_BY(injection_mutex_);
+  // Mirrors injection_queue_.size() so that workers can skip the lock.
+  std::atomic<int64_t> injection_size_{0};
+
+  absl::Mutex park_mutex_;
+  absl::CondVar park_condition_;
+
+  // Hosts the worker loops. Reset in the destructor, before workers_ goes
+  // away.
+  std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
@@ -0,0 +1,125 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Compares the SHARED_QUEUE and WORK_STEALING queue types of
+// ThreadPoolExecutor, both on raw task submission and on wide fan-out graphs.
+//
+// Benchmark arguments are {queue_type, num_threads, width}.
+#include <functional>
+#include <memory>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+namespace mediapipe {
+namespace {
+
+std::unique_ptr<Executor> CreateExecutor(int queue_type, int num_threads) {
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(num_threads);
+  options->set_queue_type(
+      static_cast<ThreadPoolExecutorOptions::QueueType>(queue_type));
+  auto executor = ThreadPoolExecutor::Create(extendable_options);
+  ABSL_CHECK_OK(executor.status());
+  return std::unique_ptr<Executor>(*executor);
+}
+
+// Every iteration schedules "width" tasks, each of which schedules "width"
+// more tasks from the worker thread, mimicking a node whose outputs make many
+// downstream nodes ready at once.
+void BM_ExecutorFanOut(benchmark::State& state) {
+  const int queue_type = state.range(0);
+  const int num_threads = state.range(1);
+  const int width = state.range(2);
+  std::unique_ptr<Executor> executor = CreateExecutor(queue_type, num_threads);
+  for (auto _ : state) {
+    absl::BlockingCounter remaining(width * (width + 1));
+    for (int i = 0; i < width; ++i) {
+      executor->Schedule([&executor, &remaining, width] {
+        for (int j = 0; j < width; ++j) {
+          executor->Schedule([&remaining] { remaining.DecrementCount(); });
+        }
+        remaining.DecrementCount();
+      });
+    }
+    remaining.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * width * (width + 1));
+}
+
+// Runs a graph in which one input stream feeds "width" PassThroughCalculator
+// branches, each of which feeds one more PassThroughCalculator.
+void BM_WideGraph(benchmark::State& state) {
+  const int queue_type = state.range(0);
+  const int num_threads = state.range(1);
+  const int width = state.range(2);
+  constexpr int kNumPackets = 100;
+
+  CalculatorGraphConfig config;
+  config.add_input_stream("in");
+  for (int i = 0; i < width; ++i) {
+    auto* node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    node->add_input_stream("in");
+    node->add_output_stream(absl::StrCat("mid", i));
+    node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    node->add_input_stream(absl::StrCat("mid", i));
+    node->add_output_stream(absl::StrCat("out", i));
+  }
+  auto* executor_config = config.add_executor();
+  ThreadPoolExecutorOptions* options =
+      executor_config->mutable_options()->MutableExtension(
+          ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(num_threads);
+  options->set_queue_type(
+      static_cast<ThreadPoolExecutorOptions::QueueType>(queue_type));
+
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    ABSL_CHECK_OK(graph.Initialize(config));
+    ABSL_CHECK_OK(graph.StartRun({}));
+    for (int t = 0; t < kNumPackets; ++t) {
+      ABSL_CHECK_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<int>(t).At(Timestamp(t))));
+    }
+    ABSL_CHECK_OK(graph.CloseAllInputStreams());
+    ABSL_CHECK_OK(graph.WaitUntilDone());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPackets * width * 2);
+}
+
+void FanOutArgs(benchmark::internal::Benchmark* b) {
+  for (int queue_type : {ThreadPoolExecutorOptions::SHARED_QUEUE,
+                         ThreadPoolExecutorOptions::WORK_STEALING}) {
+    for (int num_threads : {4, 16, 32}) {
+      for (int width : {16, 64}) {
+        b->Args({queue_type, num_threads, width});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_ExecutorFanOut)->Apply(FanOutArgs)->UseRealTime();
+BENCHMARK(BM_WideGraph)->Apply(FanOutArgs)->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,128 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/work_stealing_executor.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(WorkStealingExecutorTest, RunsAllTasksBeforeDestruction) {
+  std::atomic<int> count(0);
+  {
+    WorkStealingExecutor executor(4);
+    ASSERT_EQ(executor.num_threads(), 4);
+    for (int i = 0; i < 1000; ++i) {
+      executor.Schedule([&count] { count.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(WorkStealingExecutorTest, RunsTasksScheduledFromWorkers) {
+  std::atomic<int> count(0);
+  std::function<void(int)> fan_out;
+  {
+    WorkStealingExecutor executor(4);
+    fan_out = [&](int depth) {
+      count.fetch_add(1);
+      if (depth == 0) return;
+      for (int i = 0; i < 4; ++i) {
+        executor.Schedule([&fan_out, depth] { fan_out(depth - 1); });
+      }
+    };
+    executor.Schedule([&fan_out] { fan_out(5); });
+  }
+  // 1 + 4 + 16 + 64 + 256 + 1024.
+  EXPECT_EQ(count.load(), 1365);
+}
+
+TEST(WorkStealingExecutorTest, ZeroThreadsMeansOne) {
+  WorkStealingExecutor executor(0);
+  EXPECT_EQ(executor.num_threads(), 1);
+}
+
+TEST(WorkStealingExecutorTest, CreatedFromThreadPoolExecutorOptions) {
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(3);
+  options->set_queue_type(ThreadPoolExecutorOptions::WORK_STEALING);
+  MP_ASSERT_OK_AND_ASSIGN(Executor * executor,
+                          ThreadPoolExecutor::Create(extendable_options));
+  std::unique_ptr<Executor> owned(executor);
+  auto* work_stealing = dynamic_cast<WorkStealingExecutor*>(executor);
+  ASSERT_NE(work_stealing, nullptr);
+  EXPECT_EQ(work_stealing->num_threads(), 3);
+}
+
+TEST(WorkStealingExecutorTest, RunsWideGraph) {
+  CalculatorGraphConfig config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    executor {
+      options {
+        [mediapipe.ThreadPoolExecutorOptions.ext] {
+          num_threads: 4
+          queue_type: WORK_STEALING
+        }
+      }
+    }
+  )pb");
+  constexpr int kNumBranches = 16;
+  for (int i = 0; i < kNumBranches; ++i) {
+    auto* node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    node->add_input_stream("in");
+    node->add_output_stream(absl::StrCat("out", i));
+    config.add_output_stream(absl::StrCat("out", i));
+  }
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  absl::Mutex mutex;
+  int num_outputs = 0;
+  for (int i = 0; i < kNumBranches; ++i) {
+    MP_ASSERT_OK(graph.ObserveOutputStream(
+        absl::StrCat("out", i), [&mutex, &num_outputs](const Packet&) {
+          absl::MutexLock lock(&mutex);
+          ++num_outputs;
+          return absl::OkStatus();
+        }));
+  }
+  MP_ASSERT_OK(graph.StartRun({}));
+  constexpr int kNumPackets = 100;
+  for (int t = 0; t < kNumPackets; ++t) {
+    MP_ASSERT_OK(
+        graph.AddPacketToInputStream("in", MakePacket<int>(t).At(Timestamp(t))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(num_outputs, kNumBranches * kNumPackets);
+}
+
+}  // namespace
+}  // namespace mediapipe
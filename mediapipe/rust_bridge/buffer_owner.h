@@ -0,0 +1,29 @@
+#ifndef MEDIACANAL_BUFFER_OWNER_H
+#define MEDIACANAL_BUFFER_OWNER_H
+
+#include <memory>
+#include <utility>
+
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediacanal {
+
+    // Wrap SRGB pixels held by "owner" in an ImageFrame without copying them.
+    // "owner" is a movable value, e.g. a rust::Box, that keeps the pixels
+    // alive. It is dropped exactly once, when the frame is destroyed, i.e.
+    // once the last packet holding it is gone. That may happen on a MediaPipe
+    // worker thread.
+    template<typename Owner>
+    std::unique_ptr<mediapipe::ImageFrame> adopt_pixels(int width, int height, int width_step, uint8 *pixels,
+                                                        Owner owner) {
+        // The deleter must be copyable, so the owner is held by a shared_ptr.
+        auto shared_owner = std::make_shared<Owner>(std::move(owner));
+        return std::make_unique<mediapipe::ImageFrame>(
+                mediapipe::ImageFormat::SRGB, width, height, width_step, pixels,
+                [shared_owner](uint8 *) mutable { shared_owner.reset(); });
+    }
+
+}// namespace mediacanal
+
+#endif
@@ -0,0 +1,63 @@
+#include "buffer_owner.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediacanal {
+    namespace {
+
+        // Move-only like rust::Box; counts how many live owners are dropped.
+        class CountingOwner {
+        public:
+            explicit CountingOwner(int *releases) : releases_(releases) {}
+            CountingOwner(CountingOwner &&other) noexcept : releases_(std::exchange(other.releases_, nullptr)) {}
+            CountingOwner(const CountingOwner &) = delete;
+            CountingOwner &operator=(const CountingOwner &) = delete;
+            ~CountingOwner() {
+                if (releases_ != nullptr) ++*releases_;
+            }
+
+        private:
+            int *releases_;
+        };
+
+        TEST(BufferOwnerTest, ReleasesOwnerOnceAfterLastImageFramePacket) {
+            std::vector<uint8> pixels(2 * 2 * 3);
+            int releases = 0;
+            auto frame = adopt_pixels(2, 2, 2 * 3, pixels.data(), CountingOwner(&releases));
+            EXPECT_EQ(frame->PixelData(), pixels.data());
+
+            auto packet = mediapipe::Adopt(frame.release()).At(mediapipe::Timestamp(0));
+            auto copy = packet;
+            auto moved = std::move(packet);
+            auto later = moved.At(mediapipe::Timestamp(1));
+            copy = mediapipe::Packet();
+            moved = mediapipe::Packet();
+            EXPECT_EQ(releases, 0);
+            EXPECT_EQ(later.Get<mediapipe::ImageFrame>().PixelData(), pixels.data());
+            later = mediapipe::Packet();
+            EXPECT_EQ(releases, 1);
+        }
+
+        TEST(BufferOwnerTest, ReleasesOwnerOnceAfterLastImagePacket) {
+            std::vector<uint8> pixels(2 * 2 * 3);
+            int releases = 0;
+            std::shared_ptr<mediapipe::ImageFrame> frame =
+                    adopt_pixels(2, 2, 2 * 3, pixels.data(), CountingOwner(&releases));
+            auto packet = mediapipe::MakePacket<mediapipe::Image>(frame);
+            frame.reset();
+            auto copy = packet;
+            packet = mediapipe::Packet();
+            EXPECT_EQ(releases, 0);
+            copy = mediapipe::Packet();
+            EXPECT_EQ(releases, 1);
+        }
+
+    }// namespace
+}// namespace mediacanal
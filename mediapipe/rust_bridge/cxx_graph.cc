@@ -1,24 +1,61 @@
 #include "mediacanal.h"
 
+#include <map>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/cpu_util.h"
 
 namespace mediacanal {
 
+    namespace {
+
+        std::map<std::string, mediapipe::Packet> get_side_packet_map(rust::Slice<const SidePacket> side_packets) {
+            std::map<std::string, mediapipe::Packet> s_p_map{};
+            for (auto &side_packet : side_packets) {
+                s_p_map[std::string(side_packet.input_id)] = side_packet.packet->packet_;
+            }
+            return s_p_map;
+        }
+
+    }// namespace
+
     std::unique_ptr<CxxGraph> new_cxx_graph(const CallbackHandler &rust_graph, rust::Str config, rust::Slice<const SidePacket> side_packets) {
-        std::map<std::string, mediapipe::Packet> s_p_map{};
-        for (auto &side_packet : side_packets) {
-            s_p_map[std::string(side_packet.input_id)] = side_packet.packet->packet_;
+        return std::make_unique<CxxGraph>(rust_graph, std::string(config), get_side_packet_map(side_packets));
+    }
+
+    std::unique_ptr<CxxGraphHost> new_cxx_graph_host(int32 num_threads) {
+        return std::make_unique<CxxGraphHost>(num_threads);
+    }
+
+    CxxGraphHost::CxxGraphHost(int32 num_threads)
+        : executor_(std::make_shared<mediapipe::FairShareExecutor>(
+                  num_threads > 0 ? static_cast<int>(num_threads) : mediapipe::NumCPUCores())) {}
+    std::unique_ptr<CxxGraph> CxxGraphHost::new_graph(const CallbackHandler &rust_graph, rust::Str config, rust::Slice<const SidePacket> side_packets, int32 priority) const {
+        if (priority <= 0) {
+            throw std::runtime_error("Graph priority must be positive");
         }
-        return std::make_unique<CxxGraph>(rust_graph, std::string(config), s_p_map);
+        return std::make_unique<CxxGraph>(rust_graph, std::string(config), get_side_packet_map(side_packets), executor_, static_cast<int>(priority));
+    }
+    int32 CxxGraphHost::num_threads() const {
+        return static_cast<int32>(executor_->num_threads());
     }
 
     CxxGraph::CxxGraph(const CallbackHandler &rust_graph, const std::string &config, const std::map<std::string, mediapipe::Packet> &side_packets)
-        : rust_graph_(rust_graph), mediapipe_graph_(mediapipe::CalculatorGraph{}) {
+        : CxxGraph(rust_graph, config, side_packets, nullptr, 0) {}
+
+    CxxGraph::CxxGraph(const CallbackHandler &rust_graph, const std::string &config, const std::map<std::string, mediapipe::Packet> &side_packets,
+                       std::shared_ptr<mediapipe::FairShareExecutor> host_executor, int weight)
+        : rust_graph_(rust_graph), host_executor_(std::move(host_executor)), mediapipe_graph_(mediapipe::CalculatorGraph{}) {
+        if (host_executor_ != nullptr) {
+            mp_throw_if_error(mediapipe_graph_.SetExecutor("", host_executor_->AddClient(weight)));
+        }
         auto graph_config = mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(config);
 
         LOG(INFO) << "Initializing the CxxGraph.";
@@ -29,6 +66,8 @@ namespace mediacanal {
     CxxGraph::~CxxGraph() {
         LOG(INFO) << "Shutting down the CxxGraph.";
         if (is_started_) {
+            // Unread packets must not keep the graph from finishing.
+            output_pollers_.remove_queue_limits();
             absl::Status status = mediapipe_graph_.CloseAllPacketSources();
             if (!status.ok()) {
                 LOG(ERROR) << "Error in CloseAllPacketSources(): " << status.ToString();
@@ -64,5 +103,17 @@ namespace mediacanal {
         };
         mp_throw_if_error(mediapipe_graph_.ObserveOutputStream(output_id_str, out_cb));
     }
+    size_t CxxGraph::add_output_poller(rust::Str output_id, int32 max_queue_size) {
+        auto status_or_index = output_pollers_.add(mediapipe_graph_, std::string(output_id), static_cast<int>(max_queue_size));
+        mp_throw_if_error(status_or_index.status());
+        return status_or_index.value();
+    }
+    size_t CxxGraph::poll_outputs(CxxOutputBatch &batch, int32 timeout_ms) {
+        batch.clear();
+        return output_pollers_.poll(absl::Milliseconds(timeout_ms), [&batch](size_t stream_index, mediapipe::Packet packet) {
+            batch.stream_indices_.push_back(stream_index);
+            batch.packets_.emplace_back(std::move(packet));
+        });
+    }
 
 }// namespace mediacanal
@@ -0,0 +1,141 @@
+#include <utility>
+#include <vector>
+
+#include "mediacanal.h"
+
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/packet.h"
+
+namespace mediacanal {
+
+    std::unique_ptr<CxxOutputBatch> new_output_batch() {
+        return std::make_unique<CxxOutputBatch>();
+    }
+    size_t CxxOutputBatch::size() const {
+        return packets_.size();
+    }
+    size_t CxxOutputBatch::stream_index(size_t i) const {
+        return stream_indices_.at(i);
+    }
+    const CxxPacket &CxxOutputBatch::packet(size_t i) const {
+        return packets_.at(i);
+    }
+    void CxxOutputBatch::clear() {
+        // Keeps the capacity of both vectors for the next poll.
+        stream_indices_.clear();
+        packets_.clear();
+    }
+
+    std::unique_ptr<CxxLandmarkBuffer> new_landmark_buffer() {
+        return std::make_unique<CxxLandmarkBuffer>();
+    }
+    void CxxLandmarkBuffer::fill_landmarks(const CxxPacket &packet) {
+        clear();
+        append(packet.packet_.Get<mediapipe::LandmarkList>());
+        list_offsets_.push_back(x_.size());
+    }
+    void CxxLandmarkBuffer::fill_normalized_landmarks(const CxxPacket &packet) {
+        clear();
+        append(packet.packet_.Get<mediapipe::NormalizedLandmarkList>());
+        list_offsets_.push_back(x_.size());
+    }
+    void CxxLandmarkBuffer::fill_landmarks_list(const CxxPacket &packet) {
+        clear();
+        for (auto &landmarks: packet.packet_.Get<std::vector<mediapipe::LandmarkList>>()) {
+            append(landmarks);
+        }
+        list_offsets_.push_back(x_.size());
+    }
+    void CxxLandmarkBuffer::fill_normalized_landmarks_list(const CxxPacket &packet) {
+        clear();
+        for (auto &landmarks: packet.packet_.Get<std::vector<mediapipe::NormalizedLandmarkList>>()) {
+            append(landmarks);
+        }
+        list_offsets_.push_back(x_.size());
+    }
+    rust::Slice<const size_t> CxxLandmarkBuffer::list_offsets() const {
+        return {list_offsets_.data(), list_offsets_.size()};
+    }
+    rust::Slice<const float> CxxLandmarkBuffer::x() const {
+        return {x_.data(), x_.size()};
+    }
+    rust::Slice<const float> CxxLandmarkBuffer::y() const {
+        return {y_.data(), y_.size()};
+    }
+    rust::Slice<const float> CxxLandmarkBuffer::z() const {
+        return {z_.data(), z_.size()};
+    }
+    rust::Slice<const float> CxxLandmarkBuffer::presence() const {
+        return {presence_.data(), presence_.size()};
+    }
+    rust::Slice<const float> CxxLandmarkBuffer::visibility() const {
+        return {visibility_.data(), visibility_.size()};
+    }
+    void CxxLandmarkBuffer::clear() {
+        list_offsets_.clear();
+        x_.clear();
+        y_.clear();
+        z_.clear();
+        presence_.clear();
+        visibility_.clear();
+    }
+    template<typename LandmarkList>
+    void CxxLandmarkBuffer::append(const LandmarkList &landmarks) {
+        list_offsets_.push_back(x_.size());
+        for (const auto &landmark: landmarks.landmark()) {
+            x_.push_back(landmark.x());
+            y_.push_back(landmark.y());
+            z_.push_back(landmark.z());
+            presence_.push_back(landmark.presence());
+            visibility_.push_back(landmark.visibility());
+        }
+    }
+
+    std::unique_ptr<CxxClassificationBuffer> new_classification_buffer() {
+        return std::make_unique<CxxClassificationBuffer>();
+    }
+    void CxxClassificationBuffer::fill_classifications(const CxxPacket &packet) {
+        clear(packet.packet_);
+        append(packet_.Get<mediapipe::ClassificationList>());
+        list_offsets_.push_back(items_.size());
+    }
+    void CxxClassificationBuffer::fill_classifications_list(const CxxPacket &packet) {
+        clear(packet.packet_);
+        for (auto &classifications: packet_.Get<std::vector<mediapipe::ClassificationList>>()) {
+            append(classifications);
+        }
+        list_offsets_.push_back(items_.size());
+    }
+    rust::Slice<const size_t> CxxClassificationBuffer::list_offsets() const {
+        return {list_offsets_.data(), list_offsets_.size()};
+    }
+    rust::Slice<const int32> CxxClassificationBuffer::index() const {
+        return {index_.data(), index_.size()};
+    }
+    rust::Slice<const float> CxxClassificationBuffer::score() const {
+        return {score_.data(), score_.size()};
+    }
+    rust::Str CxxClassificationBuffer::label(size_t i) const {
+        return items_.at(i)->label();
+    }
+    rust::Str CxxClassificationBuffer::display_name(size_t i) const {
+        return items_.at(i)->display_name();
+    }
+    void CxxClassificationBuffer::clear(const mediapipe::Packet &packet) {
+        packet_ = packet;
+        list_offsets_.clear();
+        index_.clear();
+        score_.clear();
+        items_.clear();
+    }
+    void CxxClassificationBuffer::append(const mediapipe::ClassificationList &classifications) {
+        list_offsets_.push_back(items_.size());
+        for (const auto &classification: classifications.classification()) {
+            index_.push_back(classification.index());
+            score_.push_back(classification.score());
+            items_.push_back(&classification);
+        }
+    }
+
+}// namespace mediacanal
@@ -5,6 +5,7 @@
 #include "mediapipe/framework/formats/classification.pb.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/packet.h"
 
@@ -102,12 +103,16 @@ namespace mediacanal {
             return memory_info;
         }
 
+        void check_memory_info(const ImageMemoryInfo &memory_info) {
+            if (memory_info.data == nullptr) {
+                throw std::runtime_error("Input image_data is nullptr");
+            }
+        }
+
     }// namespace helper
 
     std::unique_ptr<CxxPacket> packet_new_image_frame(const ImageMemoryInfo &memory_info) {
-        if (memory_info.data == nullptr) {
-            throw std::runtime_error("Input image_data is nullptr");
-        }
+        helper::check_memory_info(memory_info);
 
         auto data_size_bytes = memory_info.rows * memory_info.step;
         auto packet_data = new uint8[data_size_bytes];
@@ -117,9 +122,7 @@ namespace mediacanal {
         return cxx_packet;
     }
     std::unique_ptr<CxxPacket> packet_new_image(const ImageMemoryInfo &memory_info) {
-        if (memory_info.data == nullptr) {
-            throw std::runtime_error("Input image_data is nullptr");
-        }
+        helper::check_memory_info(memory_info);
 
         auto data_size_bytes = memory_info.rows * memory_info.step;
         auto packet_data = new uint8[data_size_bytes];
@@ -129,6 +132,31 @@ namespace mediacanal {
         auto cxx_packet = std::make_unique<CxxPacket>(packet);
         return cxx_packet;
     }
+    std::unique_ptr<CxxPacket> packet_adopt_image_frame(const ImageMemoryInfo &memory_info, rust::Box<ImageBufferOwner> owner) {
+        helper::check_memory_info(memory_info);
+        auto image_frame = adopt_pixels(static_cast<int>(memory_info.cols), static_cast<int>(memory_info.rows), static_cast<int>(memory_info.step), const_cast<uint8 *>(memory_info.data), std::move(owner));
+        auto packet = mediapipe::Adopt(image_frame.release());
+        return std::make_unique<CxxPacket>(packet);
+    }
+    std::unique_ptr<CxxPacket> packet_adopt_image(const ImageMemoryInfo &memory_info, rust::Box<ImageBufferOwner> owner) {
+        helper::check_memory_info(memory_info);
+        std::shared_ptr<mediapipe::ImageFrame> image_frame = adopt_pixels(static_cast<int>(memory_info.cols), static_cast<int>(memory_info.rows), static_cast<int>(memory_info.step), const_cast<uint8 *>(memory_info.data), std::move(owner));
+        auto packet = mediapipe::MakePacket<mediapipe::Image>(image_frame);
+        return std::make_unique<CxxPacket>(packet);
+    }
+    std::unique_ptr<CxxPacket> packet_from_pooled_image_frame(std::unique_ptr<CxxImageFrame> frame) {
+        auto &pooled = frame->frame_;
+        // The packet's ImageFrame borrows the pixels of the pooled one, and
+        // keeps it out of the pool until destroyed.
+        auto packet = mediapipe::MakePacket<mediapipe::ImageFrame>(
+                pooled->Format(), pooled->Width(), pooled->Height(), pooled->WidthStep(), pooled->MutablePixelData(),
+                [pooled](uint8 *) mutable { pooled.reset(); });
+        return std::make_unique<CxxPacket>(packet);
+    }
+    std::unique_ptr<CxxPacket> packet_from_pooled_image(std::unique_ptr<CxxImageFrame> frame) {
+        auto packet = mediapipe::MakePacket<mediapipe::Image>(std::move(frame->frame_));
+        return std::make_unique<CxxPacket>(packet);
+    }
     std::unique_ptr<CxxPacket> packet_new_int(int32 value) {
         auto packet = mediapipe::MakePacket<int>(static_cast<int>(value));
         auto cxx_packet = std::make_unique<CxxPacket>(packet);
@@ -140,6 +168,23 @@ namespace mediacanal {
         return cxx_packet;
     }
 
+    CxxImageFrame::CxxImageFrame(std::shared_ptr<mediapipe::ImageFrame> frame) : frame_(std::move(frame)) {}
+    ImageMemoryInfo CxxImageFrame::memory_info() const {
+        return helper::from_image_frame(*frame_);
+    }
+
+    std::unique_ptr<CxxImageFramePool> new_image_frame_pool(int32 cols, int32 rows, int32 keep_count) {
+        if (cols <= 0 || rows <= 0 || keep_count < 0) {
+            throw std::runtime_error("Invalid image frame pool dimensions or keep_count");
+        }
+        return std::make_unique<CxxImageFramePool>(cols, rows, keep_count);
+    }
+    CxxImageFramePool::CxxImageFramePool(int32 cols, int32 rows, int32 keep_count)
+        : pool_(mediapipe::ImageFramePool::Create(static_cast<int>(cols), static_cast<int>(rows), mediapipe::ImageFormat::SRGB, static_cast<int>(keep_count))) {}
+    std::unique_ptr<CxxImageFrame> CxxImageFramePool::acquire() const {
+        return std::make_unique<CxxImageFrame>(pool_->GetBuffer());
+    }
+
     CxxPacket::CxxPacket(mediapipe::Packet packet) : packet_(std::move(packet)) {}
     std::unique_ptr<CxxPacket> CxxPacket::clone() const {
         return std::make_unique<CxxPacket>(*this);
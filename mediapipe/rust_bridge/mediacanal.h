@@ -24,15 +24,28 @@
 namespace mediacanal {
     class CxxPacket;
     class CxxGraph;
+    class CxxImageFrame;
+    class CxxImageFramePool;
+    class CxxOutputBatch;
+    class CxxLandmarkBuffer;
+    class CxxClassificationBuffer;
+    class CxxGraphHost;
 }// namespace mediacanal
 
 #include <cstdint>
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/fair_share_executor.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 
+#include "buffer_owner.h"
+#include "output_pollers.h"
 #include "cxx_generated/bridge.rs.h"
 
 // For converting exceptions to rust results
@@ -52,6 +65,16 @@ namespace mediacanal {
 
     std::unique_ptr<CxxPacket> packet_new_image_frame(const ImageMemoryInfo &memory_info);
     std::unique_ptr<CxxPacket> packet_new_image(const ImageMemoryInfo &memory_info);
+    // Wrap the caller's pixels without copying them. "owner" is an opaque
+    // Rust value holding the buffer; it is dropped, possibly on a MediaPipe
+    // worker thread, once the last packet referencing the pixels is destroyed.
+    std::unique_ptr<CxxPacket> packet_adopt_image_frame(const ImageMemoryInfo &memory_info, rust::Box<ImageBufferOwner> owner);
+    std::unique_ptr<CxxPacket> packet_adopt_image(const ImageMemoryInfo &memory_info, rust::Box<ImageBufferOwner> owner);
+    // Wrap a frame acquired from a CxxImageFramePool without copying it. The
+    // frame goes back to the pool once the last packet referencing it is
+    // destroyed.
+    std::unique_ptr<CxxPacket> packet_from_pooled_image_frame(std::unique_ptr<CxxImageFrame> frame);
+    std::unique_ptr<CxxPacket> packet_from_pooled_image(std::unique_ptr<CxxImageFrame> frame);
     std::unique_ptr<CxxPacket> packet_new_int(int32 value);
     std::unique_ptr<CxxPacket> packet_new_bool(bool value);
 
@@ -79,6 +102,121 @@ namespace mediacanal {
         bool get_bool() const;
     };
 
+    // A SRGB frame from a CxxImageFramePool, for the Rust side to fill in
+    // before turning it into a packet.
+    class CxxImageFrame {
+    public:
+        explicit CxxImageFrame(std::shared_ptr<mediapipe::ImageFrame> frame);
+
+        // The data pointer of the result may be written to until the frame
+        // is turned into a packet.
+        ImageMemoryInfo memory_info() const;
+
+    private:
+        friend std::unique_ptr<CxxPacket> packet_from_pooled_image_frame(std::unique_ptr<CxxImageFrame> frame);
+        friend std::unique_ptr<CxxPacket> packet_from_pooled_image(std::unique_ptr<CxxImageFrame> frame);
+
+        std::shared_ptr<mediapipe::ImageFrame> frame_;
+    };
+
+    std::unique_ptr<CxxImageFramePool> new_image_frame_pool(int32 cols, int32 rows, int32 keep_count);
+
+    // Reusable SRGB frames of one size. Frames whose packets were destroyed
+    // are handed out again, keeping at most keep_count idle frames.
+    class CxxImageFramePool {
+    private:
+        std::shared_ptr<mediapipe::ImageFramePool> pool_;
+
+    public:
+        CxxImageFramePool(int32 cols, int32 rows, int32 keep_count);
+
+        std::unique_ptr<CxxImageFrame> acquire() const;
+    };
+
+    std::unique_ptr<CxxOutputBatch> new_output_batch();
+
+    // Packets returned by CxxGraph::poll_outputs. Reused across calls, so
+    // that polling doesn't allocate once the batch has grown to its usual
+    // size. Packets must be cloned to be kept past the next poll.
+    class CxxOutputBatch {
+    public:
+        size_t size() const;
+        // The stream of the i-th packet, as returned by add_output_poller.
+        size_t stream_index(size_t i) const;
+        const CxxPacket &packet(size_t i) const;
+        void clear();
+
+    private:
+        friend class CxxGraph;
+
+        std::vector<size_t> stream_indices_;
+        std::vector<CxxPacket> packets_;
+    };
+
+    std::unique_ptr<CxxLandmarkBuffer> new_landmark_buffer();
+
+    // The landmarks of a packet as flat arrays, one entry per landmark, which
+    // the Rust side can read as slices. Reused across packets.
+    class CxxLandmarkBuffer {
+    public:
+        // Replace the contents with the landmarks of a packet holding the
+        // named type: a (Normalized)LandmarkList, or a vector of them.
+        void fill_landmarks(const CxxPacket &packet);
+        void fill_normalized_landmarks(const CxxPacket &packet);
+        void fill_landmarks_list(const CxxPacket &packet);
+        void fill_normalized_landmarks_list(const CxxPacket &packet);
+
+        // The first landmark of each list, followed by the landmark count.
+        rust::Slice<const size_t> list_offsets() const;
+        rust::Slice<const float> x() const;
+        rust::Slice<const float> y() const;
+        rust::Slice<const float> z() const;
+        rust::Slice<const float> presence() const;
+        rust::Slice<const float> visibility() const;
+
+    private:
+        void clear();
+        template<typename LandmarkList>
+        void append(const LandmarkList &landmarks);
+
+        std::vector<size_t> list_offsets_;
+        std::vector<float> x_;
+        std::vector<float> y_;
+        std::vector<float> z_;
+        std::vector<float> presence_;
+        std::vector<float> visibility_;
+    };
+
+    std::unique_ptr<CxxClassificationBuffer> new_classification_buffer();
+
+    // The classifications of a packet as flat arrays, one entry per
+    // classification. Labels are views into the packet, which the buffer
+    // keeps until it is filled again.
+    class CxxClassificationBuffer {
+    public:
+        // Replace the contents with the classifications of a packet holding a
+        // ClassificationList, or a vector of them.
+        void fill_classifications(const CxxPacket &packet);
+        void fill_classifications_list(const CxxPacket &packet);
+
+        // The first classification of each list, followed by the count.
+        rust::Slice<const size_t> list_offsets() const;
+        rust::Slice<const int32> index() const;
+        rust::Slice<const float> score() const;
+        rust::Str label(size_t i) const;
+        rust::Str display_name(size_t i) const;
+
+    private:
+        void clear(const mediapipe::Packet &packet);
+        void append(const mediapipe::ClassificationList &classifications);
+
+        mediapipe::Packet packet_;
+        std::vector<size_t> list_offsets_;
+        std::vector<int32> index_;
+        std::vector<float> score_;
+        std::vector<const mediapipe::Classification *> items_;
+    };
+
     // Create and initialize using provided config
     // throws runtime exception if initialization failed
     std::unique_ptr<CxxGraph> new_cxx_graph(const CallbackHandler &rust_graph, rust::Str config, rust::Slice<const SidePacket> side_packets);
@@ -86,11 +224,20 @@ namespace mediacanal {
     class CxxGraph {
     private:
         const CallbackHandler &rust_graph_;
+        // The threads of the graph's host, if any. Declared before the graph,
+        // which runs on them.
+        std::shared_ptr<mediapipe::FairShareExecutor> host_executor_;
+        // Declared before the graph, whose threads notify the pollers.
+        OutputPollers output_pollers_;
         mediapipe::CalculatorGraph mediapipe_graph_;
         bool is_started_ = false;
 
     public:
         CxxGraph(const CallbackHandler &rust_graph, const std::string &config, const std::map<std::string, mediapipe::Packet> &side_packets);
+        // Runs the graph's default executor on the threads of host_executor,
+        // with the given weight.
+        CxxGraph(const CallbackHandler &rust_graph, const std::string &config, const std::map<std::string, mediapipe::Packet> &side_packets,
+                 std::shared_ptr<mediapipe::FairShareExecutor> host_executor, int weight);
         CxxGraph(const CxxGraph &other) = delete;
         CxxGraph(CxxGraph &&other) = delete;
         CxxGraph &operator=(const CxxGraph &other) = delete;
@@ -101,6 +248,39 @@ namespace mediacanal {
         void set_input_stream_max_queue_size(rust::Str input_id, int32 size);
         void queue_packet(rust::Str input_id, std::unique_ptr<CxxPacket> packet);
         void observe_output(rust::Str output_id);
+
+        // Poll output_id through poll_outputs instead of a callback. Must be
+        // called before start(). If max_queue_size is not negative, the graph
+        // is throttled while that many packets wait on the stream. Returns the
+        // index of the stream in CxxOutputBatch.
+        size_t add_output_poller(rust::Str output_id, int32 max_queue_size);
+        // Replace the contents of batch with the packets waiting on all polled
+        // streams, waiting up to timeout_ms for at least one. Returns the
+        // number of packets.
+        size_t poll_outputs(CxxOutputBatch &batch, int32 timeout_ms);
+    };
+
+    // Create a host running its graphs on num_threads threads, or one per CPU
+    // core if num_threads is not positive.
+    std::unique_ptr<CxxGraphHost> new_cxx_graph_host(int32 num_threads);
+
+    // Creates graphs that share one set of worker threads, instead of each
+    // starting a thread pool of its own, e.g. one graph per camera stream.
+    // When the threads are busy, each graph gets a share of them proportional
+    // to its priority. Executors named in a graph config are still created
+    // per graph. TfLite models and XNNPACK weights are shared across all
+    // graphs of the process already.
+    class CxxGraphHost {
+    private:
+        std::shared_ptr<mediapipe::FairShareExecutor> executor_;
+
+    public:
+        explicit CxxGraphHost(int32 num_threads);
+
+        // Like new_cxx_graph. priority must be positive. The graphs keep the
+        // threads alive, so they may outlive the host.
+        std::unique_ptr<CxxGraph> new_graph(const CallbackHandler &rust_graph, rust::Str config, rust::Slice<const SidePacket> side_packets, int32 priority) const;
+        int32 num_threads() const;
     };
 
 }// namespace mediacanal
@@ -0,0 +1,63 @@
+#include "output_pollers.h"
+
+#include <utility>
+
+#include "absl/time/clock.h"
+
+namespace mediacanal {
+
+    absl::StatusOr<size_t> OutputPollers::add(mediapipe::CalculatorGraph &graph, const std::string &output_id, int max_queue_size) {
+        auto status_or_poller = graph.AddOutputStreamPoller(output_id);
+        if (!status_or_poller.ok()) {
+            return status_or_poller.status();
+        }
+        auto poller = std::move(status_or_poller).value();
+        if (max_queue_size >= 0) {
+            poller.SetMaxQueueSize(max_queue_size);
+        }
+        poller.SetNotifyCallback([this] {
+            absl::MutexLock lock(&mutex_);
+            ++pending_notifications_;
+        });
+        pollers_.push_back(std::move(poller));
+        return pollers_.size() - 1;
+    }
+
+    size_t OutputPollers::poll(absl::Duration timeout, absl::FunctionRef<void(size_t stream_index, mediapipe::Packet packet)> consume) {
+        const absl::Time deadline = absl::Now() + timeout;
+        size_t num_packets = 0;
+        while (true) {
+            {
+                absl::MutexLock lock(&mutex_);
+                pending_notifications_ = 0;
+            }
+            // Next() doesn't block for packets counted by QueueSize().
+            for (size_t i = 0; i < pollers_.size(); ++i) {
+                for (int n = pollers_[i].QueueSize(); n > 0; --n) {
+                    mediapipe::Packet packet;
+                    if (!pollers_[i].Next(&packet)) {
+                        break;
+                    }
+                    consume(i, std::move(packet));
+                    ++num_packets;
+                }
+            }
+            if (num_packets > 0) {
+                break;
+            }
+            absl::MutexLock lock(&mutex_);
+            auto notified = absl::Condition(+[](int *pending) { return *pending > 0; }, &pending_notifications_);
+            if (!mutex_.AwaitWithDeadline(notified, deadline)) {
+                break;
+            }
+        }
+        return num_packets;
+    }
+
+    void OutputPollers::remove_queue_limits() {
+        for (auto &poller : pollers_) {
+            poller.SetMaxQueueSize(-1);
+        }
+    }
+
+}// namespace mediacanal
@@ -0,0 +1,49 @@
+#ifndef MEDIACANAL_OUTPUT_POLLERS_H
+#define MEDIACANAL_OUTPUT_POLLERS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/output_stream_poller.h"
+
+namespace mediacanal {
+
+    // The output stream pollers of a graph, waited on together. Must be
+    // destroyed after the graph, whose threads notify it.
+    class OutputPollers {
+    public:
+        OutputPollers() = default;
+        OutputPollers(const OutputPollers &other) = delete;
+        OutputPollers &operator=(const OutputPollers &other) = delete;
+
+        // Poll output_id of graph, which must not be started yet. If
+        // max_queue_size is not negative, the graph is throttled while that
+        // many packets wait on the stream. Returns the index of the stream.
+        absl::StatusOr<size_t> add(mediapipe::CalculatorGraph &graph, const std::string &output_id, int max_queue_size);
+
+        // Pass the packets waiting on all streams to consume, in order within
+        // each stream, waiting up to timeout for at least one. Returns the
+        // number of packets.
+        size_t poll(absl::Duration timeout, absl::FunctionRef<void(size_t stream_index, mediapipe::Packet packet)> consume);
+
+        // Lift the queue limits, so that unread packets can't keep the graph
+        // from finishing.
+        void remove_queue_limits();
+
+    private:
+        // Counts poller notifications not yet seen by poll.
+        absl::Mutex mutex_;
+        int pending_notifications_ ABSL_GUARDED_BY(mutex_) = 0;
+        std::vector<mediapipe::OutputStreamPoller> pollers_;
+    };
+
+}// namespace mediacanal
+
+#endif
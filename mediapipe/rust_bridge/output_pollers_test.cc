@@ -0,0 +1,112 @@
+#include "output_pollers.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediacanal {
+    namespace {
+
+        using ::testing::ElementsAre;
+        using ::testing::IsEmpty;
+
+        class OutputPollersTest : public ::testing::Test {
+        protected:
+            void SetUp() override {
+                MP_ASSERT_OK(graph_.Initialize(mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(R"pb(
+                    input_stream: "in_a"
+                    input_stream: "in_b"
+                    node {
+                        calculator: "PassThroughCalculator"
+                        input_stream: "in_a"
+                        output_stream: "out_a"
+                    }
+                    node {
+                        calculator: "PassThroughCalculator"
+                        input_stream: "in_b"
+                        output_stream: "out_b"
+                    }
+                )pb")));
+                MP_ASSERT_OK_AND_ASSIGN(size_t a, pollers_.add(graph_, "out_a", -1));
+                MP_ASSERT_OK_AND_ASSIGN(size_t b, pollers_.add(graph_, "out_b", -1));
+                EXPECT_EQ(a, 0);
+                EXPECT_EQ(b, 1);
+                MP_ASSERT_OK(graph_.StartRun({}));
+            }
+
+            void add(const std::string &stream, int value) {
+                MP_ASSERT_OK(graph_.AddPacketToInputStream(stream, mediapipe::MakePacket<int>(value).At(mediapipe::Timestamp(value))));
+            }
+
+            // Polls until "count" packets arrived, and returns the values
+            // of each stream in the order they were polled.
+            std::vector<std::vector<int>> poll(int count) {
+                std::vector<std::vector<int>> values(2);
+                int polled = 0;
+                while (polled < count) {
+                    const size_t n = pollers_.poll(absl::Seconds(10), [&](size_t stream_index, mediapipe::Packet packet) {
+                        values[stream_index].push_back(packet.Get<int>());
+                    });
+                    if (n == 0) {
+                        ADD_FAILURE() << "Timed out with " << polled << " of " << count << " packets";
+                        break;
+                    }
+                    polled += n;
+                }
+                return values;
+            }
+
+            OutputPollers pollers_;
+            mediapipe::CalculatorGraph graph_;
+        };
+
+        TEST_F(OutputPollersTest, PollsPacketsInOrderPerStream) {
+            for (int i = 0; i < 5; ++i) {
+                add("in_a", i);
+            }
+            add("in_b", 7);
+            auto values = poll(6);
+            EXPECT_THAT(values[0], ElementsAre(0, 1, 2, 3, 4));
+            EXPECT_THAT(values[1], ElementsAre(7));
+
+            MP_ASSERT_OK(graph_.CloseAllInputStreams());
+            MP_ASSERT_OK(graph_.WaitUntilDone());
+        }
+
+        TEST_F(OutputPollersTest, TimesOutWhenStreamsAreEmpty) {
+            int consumed = 0;
+            EXPECT_EQ(pollers_.poll(absl::Milliseconds(20), [&](size_t, mediapipe::Packet) { ++consumed; }), 0);
+            EXPECT_EQ(consumed, 0);
+
+            // Packets on one stream are returned while the other is empty.
+            add("in_b", 1);
+            auto values = poll(1);
+            EXPECT_THAT(values[0], IsEmpty());
+            EXPECT_THAT(values[1], ElementsAre(1));
+
+            MP_ASSERT_OK(graph_.CloseAllInputStreams());
+            MP_ASSERT_OK(graph_.WaitUntilDone());
+        }
+
+        TEST_F(OutputPollersTest, ReturnsRemainingPacketsAfterClose) {
+            add("in_a", 1);
+            add("in_a", 2);
+            MP_ASSERT_OK(graph_.CloseAllInputStreams());
+
+            auto values = poll(2);
+            EXPECT_THAT(values[0], ElementsAre(1, 2));
+            EXPECT_THAT(values[1], IsEmpty());
+            // The closed streams time out without packets.
+            EXPECT_EQ(pollers_.poll(absl::Milliseconds(20), [](size_t, mediapipe::Packet) {}), 0);
+            MP_ASSERT_OK(graph_.WaitUntilDone());
+        }
+
+    }// namespace
+}// namespace mediacanal
@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/core/external_file_handler.h"
@@ -35,6 +36,7 @@ limitations under the License.
 #include "mediapipe/util/resource_util.h"
 #include "mediapipe/util/resource_util_custom.h"
 #include "mediapipe/util/tflite/error_reporter.h"
+#include "mediapipe/util/tflite/tflite_model_cache.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/model_builder.h"
@@ -123,35 +125,71 @@ absl::Status ModelResources::BuildModelFromExternalFileProto() {
   // Verifies that the supplied buffer refers to a valid flatbuffer model,
   // and that it uses only operators that are supported by the OpResolver
   // that was passed to the ModelResources constructor, and then builds
-  // the model from the buffer.
-  auto model = tflite::FlatBufferModel::VerifyAndBuildFromBuffer(
-      buffer_data, buffer_size, &verifier_, &error_reporter_);
-  if (model == nullptr) {
-    static constexpr char kInvalidFlatbufferMessage[] =
-        "The model is not a valid Flatbuffer";
-    // To be replaced with a proper switch-case when TFLite model builder
-    // returns a `MediaPipeTasksStatus` code capturing this type of error.
-    if (absl::StrContains(error_reporter_.message(),
-                          kInvalidFlatbufferMessage)) {
-      return CreateStatusWithPayload(
-          StatusCode::kInvalidArgument, error_reporter_.message(),
-          MediaPipeTasksStatus::kInvalidFlatBufferError);
-    } else if (absl::StrContains(error_reporter_.message(),
-                                 "Error loading model from buffer")) {
-      return CreateStatusWithPayload(
-          StatusCode::kInvalidArgument, kInvalidFlatbufferMessage,
-          MediaPipeTasksStatus::kInvalidFlatBufferError);
-    } else {
-      return CreateStatusWithPayload(
-          StatusCode::kUnknown,
-          absl::StrCat(
-              "Could not build model from the provided pre-loaded flatbuffer: ",
-              error_reporter_.message()));
+  // the model from the buffer. Verification errors go to `error_reporter_`,
+  // while the model reports the errors of its interpreters to
+  // `model_error_reporter`, which must outlive it.
+  auto build_model = [&](tflite::ErrorReporter* model_error_reporter)
+      -> absl::StatusOr<std::unique_ptr<tflite::FlatBufferModel>> {
+    auto model = tflite::FlatBufferModel::VerifyAndBuildFromBuffer(
+        buffer_data, buffer_size, &verifier_, &error_reporter_);
+    if (model == nullptr) {
+      static constexpr char kInvalidFlatbufferMessage[] =
+          "The model is not a valid Flatbuffer";
+      // To be replaced with a proper switch-case when TFLite model builder
+      // returns a `MediaPipeTasksStatus` code capturing this type of error.
+      if (absl::StrContains(error_reporter_.message(),
+                            kInvalidFlatbufferMessage)) {
+        return CreateStatusWithPayload(
+            StatusCode::kInvalidArgument, error_reporter_.message(),
+            MediaPipeTasksStatus::kInvalidFlatBufferError);
+      } else if (absl::StrContains(error_reporter_.message(),
+                                   "Error loading model from buffer")) {
+        return CreateStatusWithPayload(
+            StatusCode::kInvalidArgument, kInvalidFlatbufferMessage,
+            MediaPipeTasksStatus::kInvalidFlatBufferError);
+      } else {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown,
+            absl::StrCat("Could not build model from the provided "
+                         "pre-loaded flatbuffer: ",
+                         error_reporter_.message()));
+      }
+    }
+    if (model_error_reporter != &error_reporter_) {
+      // The buffer is already verified, so it is only wrapped again.
+      model = tflite::FlatBufferModel::BuildFromBuffer(
+          buffer_data, buffer_size, model_error_reporter);
+      RET_CHECK(model != nullptr);
     }
+    return model;
+  };
+
+  std::shared_ptr<const tflite::FlatBufferModel> model;
+  if (model_file_->has_file_pointer_meta()) {
+    // The caller owns the buffer and may release it along with this object,
+    // so the model can't be shared with other graphs.
+    MP_ASSIGN_OR_RETURN(model, build_model(&error_reporter_));
+  } else {
+    // Models with the same contents are shared across graphs. The buffer of a
+    // shared model is kept alive by the model. A shared model may outlive this
+    // object and back the interpreters of other graphs, so it reports their
+    // errors to the process-wide TfLite reporter rather than this object's.
+    auto buffer_owner = std::make_shared<
+        std::pair<std::shared_ptr<proto::ExternalFile>,
+                  std::shared_ptr<ExternalFileHandler>>>(model_file_,
+                                                         model_file_handler_);
+    auto build_shared_model = [&] {
+      return build_model(tflite::DefaultErrorReporter());
+    };
+    MP_ASSIGN_OR_RETURN(model,
+                        TfLiteModelCache::GetInstance().GetOrBuild(
+                            absl::string_view(buffer_data, buffer_size),
+                            std::move(buffer_owner),
+                            &op_resolver_packet_.Get(), build_shared_model));
   }
-
   model_packet_ = MakePacket<ModelPtr>(
-      model.release(), [](tflite::FlatBufferModel* model) { delete model; });
+      const_cast<tflite::FlatBufferModel*>(model.get()),
+      [model](tflite::FlatBufferModel*) {});
   MP_ASSIGN_OR_RETURN(auto model_metadata_extractor,
                       metadata::ModelMetadataExtractor::CreateFromModelBuffer(
                           buffer_data, buffer_size));
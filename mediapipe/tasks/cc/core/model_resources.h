@@ -124,13 +124,14 @@ class ModelResources {
 
   // The model resources tag.
   const std::string tag_;
-  // The model file.
-  std::unique_ptr<proto::ExternalFile> model_file_;
+  // The model file. Shared with the model, which may outlive this object.
+  std::shared_ptr<proto::ExternalFile> model_file_;
   // The packet stores the TFLite op resolver.
   api2::Packet<tflite::OpResolver> op_resolver_packet_;
 
-  // The ExternalFileHandler for the model.
-  std::unique_ptr<ExternalFileHandler> model_file_handler_;
+  // The ExternalFileHandler for the model. Shared with the model, which may
+  // outlive this object.
+  std::shared_ptr<ExternalFileHandler> model_file_handler_;
   // The packet stores the TFLite model for actual inference.
   api2::Packet<ModelPtr> model_packet_;
   // The packet stores the TFLite Metadata extractor built from the model.
@@ -139,7 +140,8 @@ class ModelResources {
   // Extra verifier for FlatBuffer input data.
   Verifier verifier_;
   // Error reporter that captures and prints to stderr low-level TFLite
-  // error messages.
+  // error messages of the model verification, and of the interpreters of a
+  // model that isn't shared with other graphs.
   mediapipe::util::tflite::ErrorReporter error_reporter_;
 };
 
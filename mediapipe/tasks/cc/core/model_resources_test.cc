@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/model_builder.h"
 #include "tensorflow/lite/mutable_op_resolver.h"
 #include "tensorflow/lite/test_util.h"
 
@@ -295,6 +296,27 @@ TEST_F(ModelResourcesTest, CreateSuccessWithCustomOpsPacket) {
                                ->custom_name);
 }
 
+TEST_F(ModelResourcesTest, SharedModelOutlivesErrorReporterOfCreator) {
+  auto create_model_resources = [] {
+    auto model_file = std::make_unique<proto::ExternalFile>();
+    model_file->set_file_content(LoadBinaryContent(kTestModelPath));
+    return ModelResources::Create(kTestModelResourcesTag,
+                                  std::move(model_file));
+  };
+  MP_ASSERT_OK_AND_ASSIGN(auto model_resources1, create_model_resources());
+  MP_ASSERT_OK_AND_ASSIGN(auto model_resources2, create_model_resources());
+  const tflite::FlatBufferModel* model =
+      model_resources2->GetModelPacket().Get<ModelResources::ModelPtr>().get();
+  EXPECT_EQ(model, model_resources1->GetModelPacket()
+                       .Get<ModelResources::ModelPtr>()
+                       .get());
+
+  // The model is still used after the ModelResources that built it is gone,
+  // so its interpreters must not report to an error reporter it owned.
+  model_resources1.reset();
+  EXPECT_EQ(model->error_reporter(), tflite::DefaultErrorReporter());
+}
+
 }  // namespace core
 }  // namespace tasks
 }  // namespace mediapipe
@@ -23,12 +23,19 @@
 #else
 #include <unistd.h>
 #endif
+#if defined(__linux__)
+#include <sched.h>
+#endif
 #include <fstream>
+#include <string>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/match.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/substitute.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -104,6 +111,16 @@ std::set<int> InferLowerOrHigherCoreIds(bool lower) {
     return inferred_cores;
   }
 }
+
+// Reads the first line of a sysfs file.
+absl::StatusOr<std::string> ReadSysfsLine(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  if (!file.is_open() || !std::getline(file, line)) {
+    return absl::NotFoundError(absl::StrCat("Couldn't read ", path));
+  }
+  return line;
+}
 }  // namespace
 
 int NumCPUCores() {
@@ -126,4 +143,82 @@ std::set<int> InferHigherCoreIds() {
   return InferLowerOrHigherCoreIds(/* lower= */ false);
 }
 
+int NumNumaNodes() {
+  static const int num_numa_nodes = [] {
+    auto line_or_status = ReadSysfsLine("/sys/devices/system/node/possible");
+    if (!line_or_status.ok()) return 1;
+    auto nodes_or_status = ParseCpuList(line_or_status.value());
+    if (!nodes_or_status.ok() || nodes_or_status.value().empty()) return 1;
+    return *nodes_or_status.value().rbegin() + 1;
+  }();
+  return num_numa_nodes;
+}
+
+absl::StatusOr<std::set<int>> GetNumaNodeCoreIds(int numa_node) {
+#if defined(__linux__)
+  if (numa_node < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid NUMA node: ", numa_node));
+  }
+  auto line_or_status = ReadSysfsLine(absl::Substitute(
+      "/sys/devices/system/node/node$0/cpulist", numa_node));
+  if (!line_or_status.ok()) {
+    return line_or_status.status();
+  }
+  return ParseCpuList(line_or_status.value());
+#else
+  return absl::UnimplementedError(
+      "NUMA node CPU ids are only available on Linux.");
+#endif
+}
+
+int CurrentNumaNode() {
+#if defined(__linux__)
+  // The NUMA node of each CPU is read once, so that a call only costs a
+  // sched_getcpu(), which is served from the vDSO without a system call.
+  static const std::vector<int>* const cpu_nodes = [] {
+    auto* cpu_nodes = new std::vector<int>();
+    for (int node = 0; node < NumNumaNodes(); ++node) {
+      auto cpus_or_status = GetNumaNodeCoreIds(node);
+      if (!cpus_or_status.ok()) continue;
+      for (int cpu : cpus_or_status.value()) {
+        if (cpu >= cpu_nodes->size()) cpu_nodes->resize(cpu + 1, 0);
+        (*cpu_nodes)[cpu] = node;
+      }
+    }
+    return cpu_nodes;
+  }();
+  const int cpu = sched_getcpu();
+  if (cpu >= 0 && cpu < cpu_nodes->size()) {
+    return (*cpu_nodes)[cpu];
+  }
+#endif
+  return 0;
+}
+
+absl::StatusOr<std::set<int>> ParseCpuList(absl::string_view cpu_list) {
+  std::set<int> cpus;
+  cpu_list = absl::StripAsciiWhitespace(cpu_list);
+  if (cpu_list.empty()) {
+    return cpus;
+  }
+  for (absl::string_view range : absl::StrSplit(cpu_list, ',')) {
+    const size_t dash = range.find('-');
+    int first;
+    int last;
+    if (!absl::SimpleAtoi(range.substr(0, dash), &first) ||
+        !absl::SimpleAtoi(
+            dash == absl::string_view::npos ? range : range.substr(dash + 1),
+            &last) ||
+        first < 0 || last < first) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid CPU list: ", cpu_list));
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.insert(cpu);
+    }
+  }
+  return cpus;
+}
+
 }  // namespace mediapipe.
@@ -17,6 +17,9 @@
 
 #include <set>
 
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
 namespace mediapipe {
 // Returns the number of CPU cores. Compatible with Android.
 int NumCPUCores();
@@ -24,6 +27,17 @@ int NumCPUCores();
 std::set<int> InferLowerCoreIds();
 // Returns a set of inferred CPU ids of higher cores.
 std::set<int> InferHigherCoreIds();
+
+// Returns the number of NUMA nodes, or 1 if it can't be determined.
+int NumNumaNodes();
+// Returns the CPU ids of the given NUMA node. Only supported on Linux.
+absl::StatusOr<std::set<int>> GetNumaNodeCoreIds(int numa_node);
+// Returns the NUMA node of the CPU running the calling thread, or 0 if it
+// can't be determined.
+int CurrentNumaNode();
+// Parses a CPU list in the format of the Linux sysfs "cpulist" files, e.g.
+// "0-3,8,10-11".
+absl::StatusOr<std::set<int>> ParseCpuList(absl::string_view cpu_list);
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_UTIL_CPU_UTIL_H_
@@ -0,0 +1,53 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/cpu_util.h"
+
+#include <set>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(CpuUtilTest, ParsesCpuList) {
+  MP_ASSERT_OK_AND_ASSIGN(std::set<int> cpus, ParseCpuList("0-3,8,10-11\n"));
+  EXPECT_THAT(cpus, ElementsAre(0, 1, 2, 3, 8, 10, 11));
+  MP_ASSERT_OK_AND_ASSIGN(cpus, ParseCpuList("5"));
+  EXPECT_THAT(cpus, ElementsAre(5));
+  MP_ASSERT_OK_AND_ASSIGN(cpus, ParseCpuList(""));
+  EXPECT_THAT(cpus, IsEmpty());
+}
+
+TEST(CpuUtilTest, RejectsInvalidCpuList) {
+  EXPECT_FALSE(ParseCpuList("3-1").ok());
+  EXPECT_FALSE(ParseCpuList("0-").ok());
+  EXPECT_FALSE(ParseCpuList("-2").ok());
+  EXPECT_FALSE(ParseCpuList("0,,1").ok());
+  EXPECT_FALSE(ParseCpuList("a").ok());
+}
+
+TEST(CpuUtilTest, CurrentNumaNodeIsValid) {
+  EXPECT_GE(NumNumaNodes(), 1);
+  EXPECT_GE(CurrentNumaNode(), 0);
+  EXPECT_LT(CurrentNumaNode(), NumNumaNodes());
+}
+
+}  // namespace
+}  // namespace mediapipe
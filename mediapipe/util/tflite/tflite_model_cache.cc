@@ -0,0 +1,110 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/tflite_model_cache.h"
+
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Request counts of cached models are halved every this many requests, so
+// that models which are no longer requested are eventually released.
+constexpr int kRequestCountScrubInterval = 50;
+
+}  // namespace
+
+TfLiteModelCache& TfLiteModelCache::GetInstance() {
+  static NoDestructor<TfLiteModelCache> cache;
+  return *cache;
+}
+
+size_t TfLiteModelCache::HashBuffer(absl::string_view buffer) {
+  return absl::HashOf(buffer);
+}
+
+std::shared_ptr<TfLiteModelCache::Entry> TfLiteModelCache::LookupEntry(
+    const Key& key) {
+  absl::MutexLock lock(&mutex_);
+  std::shared_ptr<Entry> entry =
+      cache_.Lookup(key, [this](const Key& key, int request_count) {
+        mutex_.AssertHeld();
+        auto it = evicted_.find(key);
+        if (it != evicted_.end()) {
+          std::shared_ptr<Entry> evicted = it->second.lock();
+          evicted_.erase(it);
+          if (evicted) return evicted;
+        }
+        return std::make_shared<Entry>(key);
+      });
+  for (std::shared_ptr<Entry>& evicted :
+       cache_.Evict(max_cached_models_, kRequestCountScrubInterval)) {
+    evicted_[evicted->key] = evicted;
+  }
+  absl::erase_if(evicted_,
+                 [](const auto& item) { return item.second.expired(); });
+  return entry;
+}
+
+absl::StatusOr<std::shared_ptr<const tflite::FlatBufferModel>>
+TfLiteModelCache::GetOrBuild(absl::string_view buffer,
+                             std::shared_ptr<const void> buffer_owner,
+                             const tflite::OpResolver* op_resolver,
+                             ModelBuilder build) {
+  const std::type_index op_resolver_type =
+      op_resolver != nullptr ? std::type_index(typeid(*op_resolver))
+                             : std::type_index(typeid(void));
+  std::shared_ptr<Entry> entry = LookupEntry(
+      Key(buffer.size(), hasher_(buffer), op_resolver_type));
+  // Requests for other models proceed while this one is built.
+  absl::MutexLock lock(&entry->mutex);
+  if (entry->model != nullptr) {
+    if (entry->buffer.data() == buffer.data() || entry->buffer == buffer) {
+      ++hits_;
+      // The returned pointer keeps the entry, and so the model buffer, alive.
+      return std::shared_ptr<const tflite::FlatBufferModel>(
+          entry, entry->model.get());
+    }
+    // A hash collision with a different model, which is built but not cached.
+    ++misses_;
+    MP_ASSIGN_OR_RETURN(std::unique_ptr<tflite::FlatBufferModel> model,
+                        build());
+    RET_CHECK(model != nullptr);
+    return std::shared_ptr<const tflite::FlatBufferModel>(
+        model.release(),
+        [buffer_owner = std::move(buffer_owner)](
+            const tflite::FlatBufferModel* model) { delete model; });
+  }
+  ++misses_;
+  MP_ASSIGN_OR_RETURN(entry->model, build());
+  RET_CHECK(entry->model != nullptr);
+  entry->buffer = buffer;
+  entry->buffer_owner = std::move(buffer_owner);
+  return std::shared_ptr<const tflite::FlatBufferModel>(entry,
+                                                         entry->model.get());
+}
+
+}  // namespace mediapipe
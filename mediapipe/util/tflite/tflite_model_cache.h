@@ -0,0 +1,127 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_CACHE_H_
+#define MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <typeindex>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/util/resource_cache.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/model.h"
+
+namespace mediapipe {
+
+// A process-wide cache of TfLite models, keyed by the contents of the model
+// flatbuffer and the type of the op resolver they are built for.
+//
+// Graphs that load the same model, whether from a file, a resource or a
+// serialized side packet, get the same tflite::FlatBufferModel, so the model
+// is verified and built only once and its buffer is held in memory once. The
+// models stay alive as long as any graph uses them. In addition, the cache
+// keeps up to max_cached_models() recently and frequently requested models
+// alive, so that a graph which is restarted doesn't build its models again.
+class TfLiteModelCache {
+ public:
+  using ModelBuilder = absl::FunctionRef<
+      absl::StatusOr<std::unique_ptr<tflite::FlatBufferModel>>()>;
+  // Returns the hash of a flatbuffer.
+  using Hasher = size_t (*)(absl::string_view buffer);
+
+  static constexpr int kDefaultMaxCachedModels = 8;
+
+  struct Stats {
+    // Requests served with a model that was already built.
+    int64_t hits = 0;
+    // Requests that built a new model.
+    int64_t misses = 0;
+  };
+
+  // Returns the cache shared by the whole process.
+  static TfLiteModelCache& GetInstance();
+
+  // "hasher" can be replaced by tests, e.g. to force hash collisions.
+  explicit TfLiteModelCache(int max_cached_models = kDefaultMaxCachedModels,
+                            Hasher hasher = &HashBuffer)
+      : max_cached_models_(max_cached_models), hasher_(hasher) {}
+  TfLiteModelCache(const TfLiteModelCache&) = delete;
+  TfLiteModelCache& operator=(const TfLiteModelCache&) = delete;
+
+  // Returns a model for the flatbuffer in "buffer". If no model with the same
+  // contents is available, "build" is called to build one from "buffer", and
+  // "buffer_owner" is kept alive along with it. "build" is expected to verify
+  // the model; failures are returned and not cached. The model is handed to
+  // other callers and may outlive this one, so it must not reference state of
+  // the caller, such as its tflite::ErrorReporter.
+  //
+  // "op_resolver" is the resolver that "build" verifies the model against, or
+  // null if it doesn't use one. A model is only shared between requests whose
+  // resolvers have the same type, so a model verified for one set of ops is
+  // not handed out for another. Instances of the same resolver class are
+  // treated as equivalent, which keeps models shared across graphs that
+  // create their own resolver.
+  absl::StatusOr<std::shared_ptr<const tflite::FlatBufferModel>> GetOrBuild(
+      absl::string_view buffer, std::shared_ptr<const void> buffer_owner,
+      const tflite::OpResolver* op_resolver, ModelBuilder build);
+
+  int max_cached_models() const { return max_cached_models_; }
+
+  Stats GetStats() const { return {hits_.load(), misses_.load()}; }
+
+ private:
+  // The size and hash of a flatbuffer, and the type of the op resolver.
+  using Key = std::tuple<size_t, size_t, std::type_index>;
+
+  static size_t HashBuffer(absl::string_view buffer);
+
+  struct Entry {
+    explicit Entry(const Key& key) : key(key) {}
+
+    const Key key;
+    absl::Mutex mutex;
+    std::unique_ptr<tflite::FlatBufferModel> model ABSL_GUARDED_BY(mutex);
+    absl::string_view buffer ABSL_GUARDED_BY(mutex);
+    std::shared_ptr<const void> buffer_owner ABSL_GUARDED_BY(mutex);
+  };
+
+  // Returns the entry for "key", creating it if needed.
+  std::shared_ptr<Entry> LookupEntry(const Key& key);
+
+  const int max_cached_models_;
+  const Hasher hasher_;
+  absl::Mutex mutex_;
+  ResourceCache<Key, std::shared_ptr<Entry>> cache_ ABSL_GUARDED_BY(mutex_);
+  // Entries evicted from cache_, which may still be in use. They are put back
+  // into cache_ when requested again, so that models in use remain shared.
+  absl::flat_hash_map<Key, std::weak_ptr<Entry>> evicted_
+      ABSL_GUARDED_BY(mutex_);
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_CACHE_H_
@@ -0,0 +1,160 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/tflite_model_cache.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/mutable_op_resolver.h"
+
+namespace mediapipe {
+namespace {
+
+using ModelPtr = std::shared_ptr<const tflite::FlatBufferModel>;
+
+constexpr char kModelPath[] = "mediapipe/calculators/tensor/testdata/add.bin";
+
+class ResolverA : public tflite::MutableOpResolver {};
+class ResolverB : public tflite::MutableOpResolver {};
+
+class TfLiteModelCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    MP_ASSERT_OK(file::GetContents(kModelPath, &model_contents_));
+  }
+
+  // Returns a copy of the model whose contents differ from the models with
+  // other "suffix" values. Flatbuffers ignore trailing bytes.
+  std::shared_ptr<const std::string> ModelBuffer(absl::string_view suffix) {
+    return std::make_shared<const std::string>(
+        absl::StrCat(model_contents_, suffix));
+  }
+
+  // Requests the model in "buffer" from "cache" and counts the builds.
+  absl::StatusOr<ModelPtr> Get(
+      TfLiteModelCache& cache, std::shared_ptr<const std::string> buffer,
+      const tflite::OpResolver* op_resolver = nullptr) {
+    return cache.GetOrBuild(
+        *buffer, buffer, op_resolver,
+        [&]() -> absl::StatusOr<std::unique_ptr<tflite::FlatBufferModel>> {
+          ++num_builds_;
+          return tflite::FlatBufferModel::BuildFromBuffer(buffer->data(),
+                                                          buffer->size());
+        });
+  }
+
+  std::string model_contents_;
+  int num_builds_ = 0;
+};
+
+TEST_F(TfLiteModelCacheTest, SharesModelsWithSameContents) {
+  TfLiteModelCache cache;
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model1, Get(cache, ModelBuffer("a")));
+  // A different buffer with the same contents.
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model2, Get(cache, ModelBuffer("a")));
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model3, Get(cache, ModelBuffer("b")));
+  EXPECT_EQ(model1, model2);
+  EXPECT_NE(model1, model3);
+  EXPECT_EQ(num_builds_, 2);
+  EXPECT_EQ(cache.GetStats().hits, 1);
+  EXPECT_EQ(cache.GetStats().misses, 2);
+}
+
+TEST_F(TfLiteModelCacheTest, SharesModelsOnlyForSameResolverType) {
+  TfLiteModelCache cache;
+  ResolverA resolver_a1;
+  ResolverA resolver_a2;
+  ResolverB resolver_b;
+  auto buffer = ModelBuffer("a");
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_a1, Get(cache, buffer, &resolver_a1));
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_a2, Get(cache, buffer, &resolver_a2));
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_b, Get(cache, buffer, &resolver_b));
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_none, Get(cache, buffer));
+  EXPECT_EQ(model_a1, model_a2);
+  EXPECT_NE(model_a1, model_b);
+  EXPECT_NE(model_a1, model_none);
+  EXPECT_NE(model_b, model_none);
+  EXPECT_EQ(num_builds_, 3);
+}
+
+TEST_F(TfLiteModelCacheTest, EvictsLeastRequestedIdleModel) {
+  TfLiteModelCache cache(/*max_cached_models=*/1);
+  // "a" is requested more often, so it stays cached while idle.
+  for (int i = 0; i < 2; ++i) {
+    MP_ASSERT_OK(Get(cache, ModelBuffer("a")));
+  }
+  EXPECT_EQ(num_builds_, 1);
+
+  // "b" is evicted right away and is rebuilt on every request.
+  MP_ASSERT_OK(Get(cache, ModelBuffer("b")));
+  MP_ASSERT_OK(Get(cache, ModelBuffer("b")));
+  EXPECT_EQ(num_builds_, 3);
+
+  MP_ASSERT_OK(Get(cache, ModelBuffer("a")));
+  EXPECT_EQ(num_builds_, 3);
+  EXPECT_EQ(cache.GetStats().hits, 2);
+  EXPECT_EQ(cache.GetStats().misses, 3);
+}
+
+TEST_F(TfLiteModelCacheTest, ResurrectsEvictedModelInUse) {
+  TfLiteModelCache cache(/*max_cached_models=*/1);
+  for (int i = 0; i < 2; ++i) {
+    MP_ASSERT_OK(Get(cache, ModelBuffer("a")));
+  }
+  // "b" is evicted, but stays alive while it is used.
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_b, Get(cache, ModelBuffer("b")));
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_b_again,
+                          Get(cache, ModelBuffer("b")));
+  EXPECT_EQ(model_b, model_b_again);
+  EXPECT_EQ(num_builds_, 2);
+
+  // Once released, it is built again.
+  model_b.reset();
+  model_b_again.reset();
+  MP_ASSERT_OK(Get(cache, ModelBuffer("b")));
+  EXPECT_EQ(num_builds_, 3);
+}
+
+TEST_F(TfLiteModelCacheTest, BuildsCollidingModelsSeparately) {
+  TfLiteModelCache cache(TfLiteModelCache::kDefaultMaxCachedModels,
+                         [](absl::string_view) -> size_t { return 0; });
+  // Same size and hash, different contents.
+  auto buffer_a = ModelBuffer("a");
+  auto buffer_b = ModelBuffer("b");
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_a, Get(cache, buffer_a));
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_b, Get(cache, buffer_b));
+  EXPECT_NE(model_a, model_b);
+  EXPECT_EQ(model_a->allocation()->base(), buffer_a->data());
+  EXPECT_EQ(model_b->allocation()->base(), buffer_b->data());
+
+  // The colliding model isn't cached, and doesn't replace the cached one.
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_b_again, Get(cache, buffer_b));
+  EXPECT_NE(model_b, model_b_again);
+  MP_ASSERT_OK_AND_ASSIGN(ModelPtr model_a_again, Get(cache, buffer_a));
+  EXPECT_EQ(model_a, model_a_again);
+  EXPECT_EQ(num_builds_, 3);
+}
+
+}  // namespace
+}  // namespace mediapipe
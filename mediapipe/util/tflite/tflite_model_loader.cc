@@ -14,16 +14,147 @@
 
 #include "mediapipe/util/tflite/tflite_model_loader.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/resource_util.h"
+#include "mediapipe/util/resource_util_custom.h"
+#include "mediapipe/util/tflite/tflite_model_cache.h"
 
 namespace mediapipe {
 
 using FlatBufferModel = ::tflite::FlatBufferModel;
 
-absl::StatusOr<api2::Packet<TfLiteModelPtr>> TfLiteModelLoader::LoadFromPath(
+namespace {
+
+// Models mapped from files, by path. A mapping is shared by all loads of the
+// same path for as long as any of them is alive, so the file is mapped and
+// verified only once.
+class MappedModelRegistry {
+ public:
+  static MappedModelRegistry& Get() {
+    static NoDestructor<MappedModelRegistry> registry;
+    return *registry;
+  }
+
+  absl::StatusOr<std::shared_ptr<const FlatBufferModel>> Load(
+      const std::string& path) {
+    std::shared_ptr<Entry> entry;
+    {
+      absl::MutexLock lock(&mutex_);
+      std::shared_ptr<Entry>& slot = entries_[path];
+      if (!slot) slot = std::make_shared<Entry>();
+      entry = slot;
+    }
+    absl::StatusOr<std::shared_ptr<const FlatBufferModel>> model =
+        LoadEntry(path, entry);
+    // Failed loads don't keep a slot.
+    if (!model.ok()) Release(path, entry);
+    return model;
+  }
+
+  // Returns the number of paths in the registry.
+  int size() {
+    absl::MutexLock lock(&mutex_);
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    absl::Mutex mutex;
+    std::weak_ptr<const FlatBufferModel> model ABSL_GUARDED_BY(mutex);
+  };
+
+  absl::StatusOr<std::shared_ptr<const FlatBufferModel>> LoadEntry(
+      const std::string& path, const std::shared_ptr<Entry>& entry) {
+    // Loads of other paths can proceed while this one is being verified.
+    absl::MutexLock lock(&entry->mutex);
+    std::shared_ptr<const FlatBufferModel> model = entry->model.lock();
+    if (model) return model;
+    VLOG(2) << "Mapping the model from " << path;
+    std::unique_ptr<FlatBufferModel> mapped_model =
+        FlatBufferModel::VerifyAndBuildFromFile(path.c_str());
+    RET_CHECK(mapped_model) << "Failed to load model from path " << path;
+    // The last reference to the model erases the slot of the path. The
+    // deleter lives as long as the weak reference of the entry, so it only
+    // holds a weak reference back to the entry.
+    model = std::shared_ptr<const FlatBufferModel>(
+        mapped_model.release(),
+        [this, path, weak_entry = std::weak_ptr<Entry>(entry)](
+            const FlatBufferModel* model) {
+          delete model;
+          if (std::shared_ptr<Entry> entry = weak_entry.lock()) {
+            Release(path, entry);
+          }
+        });
+    entry->model = model;
+    return model;
+  }
+
+  // Erases the slot of "path" if it still holds "entry", no model of the entry
+  // is alive and no other load of the path is in progress. A load in progress
+  // releases the slot itself when its model is destroyed or when it fails.
+  void Release(const std::string& path, const std::shared_ptr<Entry>& entry) {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(path);
+    // The slot and the caller hold the only references to an idle entry.
+    if (it == entries_.end() || it->second != entry ||
+        entry.use_count() > 2) {
+      return;
+    }
+    absl::MutexLock entry_lock(&entry->mutex);
+    if (entry->model.expired()) {
+      entries_.erase(it);
+    }
+  }
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns true if "path" is a file that can be mapped instead of being read
+// through GetResourceContents().
+bool CanMapFile(const std::string& path) {
+  return !HasCustomGlobalResourceProvider() && file::Exists(path).ok();
+}
+
+// Returns a packet referencing a model shared with other graphs.
+api2::Packet<TfLiteModelPtr> MakeSharedModelPacket(
+    std::shared_ptr<const FlatBufferModel> model) {
+  // The model is immutable, so it can back several interpreters at once. The
+  // pointer is taken before "model" is moved into the deleter.
+  FlatBufferModel* model_ptr = const_cast<FlatBufferModel*>(model.get());
+  return api2::MakePacket<TfLiteModelPtr>(
+      model_ptr, [model = std::move(model)](FlatBufferModel*) {});
+}
+
+absl::StatusOr<api2::Packet<TfLiteModelPtr>> MapModel(
     const std::string& path) {
+  MP_ASSIGN_OR_RETURN(std::shared_ptr<const FlatBufferModel> model,
+                      MappedModelRegistry::Get().Load(path));
+  return MakeSharedModelPacket(std::move(model));
+}
+
+}  // namespace
+
+int TfLiteModelLoader::NumMappedPaths() {
+  return MappedModelRegistry::Get().size();
+}
+
+absl::StatusOr<api2::Packet<TfLiteModelPtr>> TfLiteModelLoader::LoadFromPath(
+    const std::string& path, bool try_mmap) {
   std::string model_path = path;
+  if (try_mmap && CanMapFile(model_path)) {
+    return MapModel(model_path);
+  }
 
   std::string model_blob;
   auto status_or_content =
@@ -33,21 +164,30 @@ absl::StatusOr<api2::Packet<TfLiteModelPtr>> TfLiteModelLoader::LoadFromPath(
   if (!status_or_content.ok()) {
     MP_ASSIGN_OR_RETURN(auto resolved_path,
                         mediapipe::PathToResourceAsFile(model_path));
+    if (try_mmap && CanMapFile(resolved_path)) {
+      return MapModel(resolved_path);
+    }
     VLOG(2) << "Loading the model from " << resolved_path;
     MP_RETURN_IF_ERROR(
         mediapipe::GetResourceContents(resolved_path, &model_blob));
   }
 
-  auto model = FlatBufferModel::VerifyAndBuildFromBuffer(model_blob.data(),
-                                                         model_blob.size());
-  RET_CHECK(model) << "Failed to load model from path " << model_path;
-  return api2::MakePacket<TfLiteModelPtr>(
-      model.release(),
-      [model_blob = std::move(model_blob)](FlatBufferModel* model) {
-        // It's required that model_blob is deleted only after
-        // model is deleted, hence capturing model_blob.
-        delete model;
-      });
+  // Graphs loading the same model from different copies of it share one
+  // model and one copy.
+  auto blob = std::make_shared<const std::string>(std::move(model_blob));
+  MP_ASSIGN_OR_RETURN(
+      std::shared_ptr<const FlatBufferModel> model,
+      TfLiteModelCache::GetInstance().GetOrBuild(
+          *blob, blob, /*op_resolver=*/nullptr,
+          [&]() -> absl::StatusOr<std::unique_ptr<FlatBufferModel>> {
+            auto model =
+                FlatBufferModel::VerifyAndBuildFromBuffer(blob->data(),
+                                                          blob->size());
+            RET_CHECK(model) << "Failed to load model from path "
+                             << model_path;
+            return model;
+          }));
+  return MakeSharedModelPacket(std::move(model));
 }
 
 }  // namespace mediapipe
@@ -35,8 +35,17 @@ class TfLiteModelLoader {
  public:
   // Returns a Packet containing a TfLiteModelPtr, pointing to a model loaded
   // from the specified file path.
+  //
+  // If "try_mmap" is true and the path refers to a file in the file system,
+  // the file is memory-mapped rather than read. Loads of the same path share
+  // one mapping, and its verification, while any of the returned models is
+  // alive. Resources served by a custom resource provider are always read.
   static absl::StatusOr<api2::Packet<TfLiteModelPtr>> LoadFromPath(
-      const std::string& path);
+      const std::string& path, bool try_mmap = true);
+
+  // Returns the number of paths whose memory-mapped model is alive or being
+  // loaded. Exposed for tests.
+  static int NumMappedPaths();
 };
 
 }  // namespace mediapipe
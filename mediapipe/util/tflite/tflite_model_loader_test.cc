@@ -0,0 +1,85 @@
+// Copyright 2024 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/tflite_model_loader.h"
+
+#include <cstdlib>
+#include <optional>
+#include <string>
+
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kModelPath[] = "mediapipe/calculators/tensor/testdata/add.bin";
+
+TEST(TfLiteModelLoaderTest, SharesMappedModelBetweenLoads) {
+  const int num_mapped_paths = TfLiteModelLoader::NumMappedPaths();
+  MP_ASSERT_OK_AND_ASSIGN(api2::Packet<TfLiteModelPtr> model1,
+                          TfLiteModelLoader::LoadFromPath(kModelPath));
+  MP_ASSERT_OK_AND_ASSIGN(api2::Packet<TfLiteModelPtr> model2,
+                          TfLiteModelLoader::LoadFromPath(kModelPath));
+  ASSERT_NE(model1.Get(), nullptr);
+  EXPECT_EQ(model1.Get().get(), model2.Get().get());
+  EXPECT_EQ(TfLiteModelLoader::NumMappedPaths(), num_mapped_paths + 1);
+}
+
+TEST(TfLiteModelLoaderTest, ReleasesPathWithLastModel) {
+  const int num_mapped_paths = TfLiteModelLoader::NumMappedPaths();
+  std::optional<api2::Packet<TfLiteModelPtr>> model1;
+  MP_ASSERT_OK_AND_ASSIGN(model1, TfLiteModelLoader::LoadFromPath(kModelPath));
+  std::optional<api2::Packet<TfLiteModelPtr>> model2;
+  MP_ASSERT_OK_AND_ASSIGN(model2, TfLiteModelLoader::LoadFromPath(kModelPath));
+  // Copies of a packet share the model too.
+  std::optional<api2::Packet<TfLiteModelPtr>> model1_copy = model1;
+  EXPECT_EQ(TfLiteModelLoader::NumMappedPaths(), num_mapped_paths + 1);
+
+  model1.reset();
+  model2.reset();
+  EXPECT_EQ(TfLiteModelLoader::NumMappedPaths(), num_mapped_paths + 1);
+  model1_copy.reset();
+  EXPECT_EQ(TfLiteModelLoader::NumMappedPaths(), num_mapped_paths);
+
+  // The path is mapped again by the next load.
+  MP_ASSERT_OK_AND_ASSIGN(model1, TfLiteModelLoader::LoadFromPath(kModelPath));
+  EXPECT_NE(model1->Get(), nullptr);
+  EXPECT_EQ(TfLiteModelLoader::NumMappedPaths(), num_mapped_paths + 1);
+}
+
+TEST(TfLiteModelLoaderTest, FailedLoadDoesNotKeepPath) {
+  const std::string path =
+      file::JoinPath(std::getenv("TEST_TMPDIR"), "not_a_model.tflite");
+  MP_ASSERT_OK(file::SetContents(path, "not a model"));
+  const int num_mapped_paths = TfLiteModelLoader::NumMappedPaths();
+  EXPECT_FALSE(TfLiteModelLoader::LoadFromPath(path).ok());
+  EXPECT_EQ(TfLiteModelLoader::NumMappedPaths(), num_mapped_paths);
+}
+
+TEST(TfLiteModelLoaderTest, ReadsModelWithoutMmap) {
+  const int num_mapped_paths = TfLiteModelLoader::NumMappedPaths();
+  MP_ASSERT_OK_AND_ASSIGN(
+      api2::Packet<TfLiteModelPtr> model,
+      TfLiteModelLoader::LoadFromPath(kModelPath, /*try_mmap=*/false));
+  EXPECT_NE(model.Get(), nullptr);
+  EXPECT_EQ(TfLiteModelLoader::NumMappedPaths(), num_mapped_paths);
+}
+
+}  // namespace
+}  // namespace mediapipe